@@ -121,6 +121,20 @@ public:
 
 	// TODO: Document this.
 	virtual void metaEvent(byte type, byte *data, uint16 length) { }
+
+	/**
+	 * Notify the midi device that the music jumped back to its loop
+	 * start, without the player changing anything about it. Devices
+	 * synthesizing the music in software may then play back their
+	 * earlier output instead, see MidiDriver_Emulated.
+	 */
+	virtual void musicLooped() { }
+
+	/**
+	 * Notify the midi device that the music stopped, or is about to be
+	 * replaced by other music.
+	 */
+	virtual void musicStopped() { }
 };
 
 /**
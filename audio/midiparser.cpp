@@ -248,6 +248,7 @@ bool MidiParser::processEvent(const EventInfo &info, bool fireEvents) {
 			// End of Track must be processed by us,
 			// as well as sending it to the output device.
 			if (_autoLoop) {
+				_driver->musicLooped();
 				jumpToTick(0);
 				parseNextEvent(_nextEvent);
 			} else {
@@ -451,6 +452,8 @@ bool MidiParser::jumpToTick(uint32 tick, bool fireEvents, bool stopNotes, bool d
 }
 
 void MidiParser::unloadMusic() {
+	if (_driver)
+		_driver->musicStopped();
 	resetTracking();
 	allNotesOff();
 	_numTracks = 0;
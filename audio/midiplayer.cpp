@@ -134,9 +134,20 @@ void MidiPlayer::metaEvent(byte type, byte *data, uint16 length) {
 	}
 }
 
+void MidiPlayer::musicLooped() {
+	if (_driver)
+		_driver->musicLooped();
+}
+
+void MidiPlayer::musicStopped() {
+	if (_driver)
+		_driver->musicStopped();
+}
+
 void MidiPlayer::endOfTrack() {
 	if (_isLooping) {
 		assert(_parser);
+		musicLooped();
 		_parser->jumpToTick(0);
 	} else
 		stop();
@@ -117,6 +117,8 @@ public:
 	// MidiDriver_BASE implementation
 	virtual void send(uint32 b);
 	virtual void metaEvent(byte type, byte *data, uint16 length);
+	virtual void musicLooped();
+	virtual void musicStopped();
 
 protected:
 	/**
@@ -22,12 +22,14 @@
 
 #include "gui/EventRecorder.h"
 
+#include "common/config-manager.h"
 #include "common/util.h"
 #include "common/system.h"
 #include "common/textconsole.h"
 
 #include "audio/mixer_intern.h"
 #include "audio/rate.h"
+#include "audio/rate_mix.h"
 #include "audio/audiostream.h"
 #include "audio/timestamp.h"
 
@@ -44,7 +46,7 @@ namespace Audio {
  */
 class Channel {
 public:
-	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent);
+	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent, ResamplerQuality quality, FIRFilterBankCache *firFilterBanks);
 	~Channel();
 
 	/**
@@ -61,7 +63,7 @@ public:
 	/**
 	 * Queries whether the channel is still playing or not.
 	 */
-	bool isFinished() const { return _stream->endOfStream(); }
+	bool isFinished() const { return _stream->endOfStream() && !_converter->hasPendingOutput(); }
 
 	/**
 	 * Queries whether the channel is a permanent channel.
@@ -173,12 +175,57 @@ private:
 #pragma mark --- Mixer ---
 #pragma mark -
 
+/**
+ * Locks a mutex for the scope of the object, and records how long it took
+ * to get hold of it and how long it was held.
+ */
+class TimedStackLock {
+public:
+	TimedStackLock(Common::Mutex &mutex, MixerImpl::Histogram &waitTime, MixerImpl::Histogram &holdTime) : _mutex(mutex), _holdTime(holdTime) {
+		const uint32 start = g_system->getMillis(true);
+		_mutex.lock();
+		_locked = g_system->getMillis(true);
+		waitTime.add(_locked - start);
+	}
+
+	~TimedStackLock() {
+		_holdTime.add(g_system->getMillis(true) - _locked);
+		_mutex.unlock();
+	}
+
+private:
+	Common::Mutex &_mutex;
+	MixerImpl::Histogram &_holdTime;
+	uint32 _locked;
+};
+
+void MixerImpl::Histogram::add(uint32 msecs) {
+	uint bucket = 0;
+	while (msecs >> bucket && bucket < kNumBuckets - 1)
+		bucket++;
+
+	buckets[bucket]++;
+	if (msecs > max)
+		max = msecs;
+}
+
 // TODO: parameter "system" is unused
 MixerImpl::MixerImpl(OSystem *system, uint sampleRate)
-	: _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _mutex(), _stateMutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings(),
+	  _commandStart(0), _commandCount(0), _resamplerQuality(kResamplerLinear),
+	  _headroomMixing(false), _bus(0), _channelBuffer(0), _busSize(0) {
 
 	assert(sampleRate > 0);
 
+	if (ConfMan.hasKey("resampler_quality"))
+		_resamplerQuality = parseResamplerQuality(ConfMan.get("resampler_quality"));
+
+#ifndef OUTPUT_UNSIGNED_AUDIO
+	// The mixing bus only deals with signed output samples
+	if (ConfMan.hasKey("headroom_mixing"))
+		_headroomMixing = ConfMan.getBool("headroom_mixing");
+#endif
+
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		_channels[i] = 0;
 }
@@ -186,6 +233,9 @@ MixerImpl::MixerImpl(OSystem *system, uint sampleRate)
 MixerImpl::~MixerImpl() {
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		delete _channels[i];
+
+	delete[] _bus;
+	delete[] _channelBuffer;
 }
 
 void MixerImpl::setReady(bool ready) {
@@ -196,7 +246,7 @@ uint MixerImpl::getOutputRate() const {
 	return _sampleRate;
 }
 
-void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
+bool MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 	int index = -1;
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] == 0) {
@@ -206,12 +256,9 @@ void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 	}
 	if (index == -1) {
 		warning("MixerImpl::out of mixer slots");
-		delete chan;
-		return;
+		return false;
 	}
 
-	_channels[index] = chan;
-
 	SoundHandle chanHandle;
 	chanHandle._val = index + (_handleSeed * NUM_CHANNELS);
 
@@ -219,6 +266,107 @@ void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 	_handleSeed++;
 	if (handle)
 		*handle = chanHandle;
+
+	Common::StackLock lock(_stateMutex);
+	_channels[index] = chan;
+
+	ChannelState &state = _channelState[index];
+	state.active = true;
+	state.handle = chanHandle._val;
+	state.id = chan->getId();
+	state.type = chan->getType();
+	state.volume = chan->getVolume();
+	state.balance = chan->getBalance();
+	return true;
+}
+
+Channel *MixerImpl::removeChannel(int index) {
+	Common::StackLock lock(_stateMutex);
+	Channel *chan = _channels[index];
+	_channels[index] = 0;
+	_channelState[index].active = false;
+	return chan;
+}
+
+int MixerImpl::findChannel(SoundHandle handle) const {
+	// The state is only changed while both mutexes are held, so holding
+	// either of them is enough to call this
+	const int index = handle._val % NUM_CHANNELS;
+	if (!_channelState[index].active || _channelState[index].handle != handle._val)
+		return -1;
+	return index;
+}
+
+void MixerImpl::queueCommand(Command::Type type, uint32 handle, int value) {
+	Command command;
+	command.type = type;
+	command.handle = handle;
+	command.value = value;
+
+	{
+		Common::StackLock lock(_stateMutex);
+		if (_commandCount < COMMAND_QUEUE_SIZE) {
+			_commands[(_commandStart + _commandCount++) % COMMAND_QUEUE_SIZE] = command;
+			_stats.queuedCommands++;
+			return;
+		}
+	}
+
+	// The mixer callback did not run for a while, apply the change here,
+	// after the ones queued before it
+	TimedStackLock lock(_mutex, _stats.engineLockWait, _stats.engineLockHold);
+	applyCommands();
+	applyCommand(command);
+	_stats.directCommands++;
+}
+
+void MixerImpl::applyCommands() {
+	Command commands[COMMAND_QUEUE_SIZE];
+	uint count;
+
+	{
+		Common::StackLock lock(_stateMutex);
+		count = _commandCount;
+		for (uint i = 0; i < count; i++)
+			commands[i] = _commands[(_commandStart + i) % COMMAND_QUEUE_SIZE];
+		_commandStart = (_commandStart + count) % COMMAND_QUEUE_SIZE;
+		_commandCount = 0;
+	}
+
+	for (uint i = 0; i < count; i++)
+		applyCommand(commands[i]);
+}
+
+void MixerImpl::applyCommand(const Command &command) {
+	if (command.type == Command::kUpdateTypeVolume) {
+		for (int i = 0; i != NUM_CHANNELS; ++i) {
+			if (_channels[i] && _channels[i]->getType() == (SoundType)command.handle)
+				_channels[i]->notifyGlobalVolChange();
+		}
+		return;
+	}
+
+	// Changes to sounds which stopped in the meantime are dropped
+	const int index = command.handle % NUM_CHANNELS;
+	if (!_channels[index] || _channels[index]->getHandle()._val != command.handle)
+		return;
+
+	if (command.type == Command::kSetVolume)
+		_channels[index]->setVolume(command.value);
+	else
+		_channels[index]->setBalance(command.value);
+}
+
+MixerImpl::Stats MixerImpl::getStats() {
+	Common::StackLock lock(_mutex);
+	Common::StackLock stateLock(_stateMutex);
+	return _stats;
+}
+
+void MixerImpl::resetStats() {
+	Common::StackLock lock(_mutex);
+	Common::StackLock stateLock(_stateMutex);
+	_stats = Stats();
 }
 
 void MixerImpl::playStream(
@@ -229,8 +377,6 @@ void MixerImpl::playStream(
 			DisposeAfterUse::Flag autofreeStream,
 			bool permanent,
 			bool reverseStereo) {
-	Common::StackLock lock(_mutex);
-
 	if (stream == 0) {
 		warning("stream is 0");
 		return;
@@ -239,37 +385,50 @@ void MixerImpl::playStream(
 
 	assert(_mixerReady);
 
-	// Prevent duplicate sounds
-	if (id != -1) {
-		for (int i = 0; i != NUM_CHANNELS; i++)
-			if (_channels[i] != 0 && _channels[i]->getId() == id) {
-				// Delete the stream if were asked to auto-dispose it.
-				// Note: This could cause trouble if the client code does not
-				// yet expect the stream to be gone. The primary example to
-				// keep in mind here is QueuingAudioStream.
-				// Thus, as a quick rule of thumb, you should never, ever,
-				// try to play QueuingAudioStreams with a sound id.
-				if (autofreeStream == DisposeAfterUse::YES)
-					delete stream;
-				return;
-			}
-	}
-
 #ifdef AUDIO_REVERSE_STEREO
 	reverseStereo = !reverseStereo;
 #endif
 
-	// Create the channel
-	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent);
+	// Create the channel. Setting up the rate converter can take a while,
+	// so the mixer callback is not held up for it.
+	Channel *chan;
+	{
+		Common::StackLock lock(_firFilterBankMutex);
+		chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent, _resamplerQuality, &_firFilterBanks);
+	}
 	chan->setVolume(volume);
 	chan->setBalance(balance);
-	insertChannel(handle, chan);
+
+	{
+		TimedStackLock lock(_mutex, _stats.engineLockWait, _stats.engineLockHold);
+
+		// Prevent duplicate sounds
+		bool duplicate = false;
+		if (id != -1) {
+			for (int i = 0; i != NUM_CHANNELS; i++)
+				if (_channelState[i].active && _channelState[i].id == id)
+					duplicate = true;
+		}
+
+		if (!duplicate && insertChannel(handle, chan))
+			return;
+	}
+
+	// Deleting the channel deletes the stream if we were asked to
+	// auto-dispose it.
+	// Note: This could cause trouble if the client code does not
+	// yet expect the stream to be gone. The primary example to
+	// keep in mind here is QueuingAudioStream.
+	// Thus, as a quick rule of thumb, you should never, ever,
+	// try to play QueuingAudioStreams with a sound id.
+	delete chan;
 }
 
 int MixerImpl::mixCallback(byte *samples, uint len) {
 	assert(samples);
 
-	Common::StackLock lock(_mutex);
+	const uint32 start = g_system->getMillis(true);
+	TimedStackLock lock(_mutex, _stats.callbackLockWait, _stats.callbackLockHold);
 
 	int16 *buf = (int16 *)samples;
 	// we store stereo, 16-bit samples
@@ -282,105 +441,170 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 	//  zero the buf
 	memset(buf, 0, 2 * len * sizeof(int16));
 
+	// Apply the volume and balance changes made since the last call
+	applyCommands();
+
+	// With headroom mixing, each channel is mixed on its own and added to
+	// the 32 bit bus, so that channels don't clip each other. The bus goes
+	// through the limiter into the output buffer at the end.
+	const RateMixProcs &procs = getRateMixProcs();
+	int16 *mixBuf = buf;
+	if (_headroomMixing) {
+		if (_busSize < 2 * len) {
+			delete[] _bus;
+			delete[] _channelBuffer;
+			_busSize = 2 * len;
+			_bus = new int32[_busSize];
+			_channelBuffer = new int16[_busSize];
+		}
+
+		memset(_bus, 0, 2 * len * sizeof(int32));
+		mixBuf = _channelBuffer;
+	}
+
 	// mix all channels
 	int res = 0, tmp;
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i]) {
 			if (_channels[i]->isFinished()) {
-				delete _channels[i];
-				_channels[i] = 0;
+				delete removeChannel(i);
 			} else if (!_channels[i]->isPaused()) {
-				tmp = _channels[i]->mix(buf, len);
+				if (_headroomMixing)
+					memset(_channelBuffer, 0, 2 * len * sizeof(int16));
+
+				tmp = _channels[i]->mix(mixBuf, len);
+
+				if (_headroomMixing)
+					procs.busAccumulate(_bus, _channelBuffer, 2 * tmp);
 
 				if (tmp > res)
 					res = tmp;
 			}
 		}
 
+	if (_headroomMixing)
+		procs.busLimit(buf, _bus, 2 * len);
+
+	_stats.callbackTime.add(g_system->getMillis(true) - start);
 	return res;
 }
 
+// The stop functions only take the channels out of the mixer while holding
+// the lock. Destroying them, and with that often their streams, is done
+// afterwards, but still before returning, as callers may free data the
+// streams use right after stopping them.
+
 void MixerImpl::stopAll() {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && !_channels[i]->isPermanent()) {
-			delete _channels[i];
-			_channels[i] = 0;
+	Channel *stopped[NUM_CHANNELS];
+	int numStopped = 0;
+
+	{
+		TimedStackLock lock(_mutex, _stats.engineLockWait, _stats.engineLockHold);
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channels[i] != 0 && !_channels[i]->isPermanent())
+				stopped[numStopped++] = removeChannel(i);
 		}
 	}
+
+	for (int i = 0; i < numStopped; i++)
+		delete stopped[i];
 }
 
 void MixerImpl::stopID(int id) {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			delete _channels[i];
-			_channels[i] = 0;
+	Channel *stopped[NUM_CHANNELS];
+	int numStopped = 0;
+
+	{
+		TimedStackLock lock(_mutex, _stats.engineLockWait, _stats.engineLockHold);
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channels[i] != 0 && _channels[i]->getId() == id)
+				stopped[numStopped++] = removeChannel(i);
 		}
 	}
+
+	for (int i = 0; i < numStopped; i++)
+		delete stopped[i];
 }
 
 void MixerImpl::stopHandle(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
+	Channel *stopped;
 
-	// Simply ignore stop requests for handles of sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
+	{
+		TimedStackLock lock(_mutex, _stats.engineLockWait, _stats.engineLockHold);
 
-	delete _channels[index];
-	_channels[index] = 0;
+		// Simply ignore stop requests for handles of sounds that already terminated
+		const int index = findChannel(handle);
+		if (index == -1)
+			return;
+
+		stopped = removeChannel(index);
+	}
+
+	delete stopped;
 }
 
 void MixerImpl::muteSoundType(SoundType type, bool mute) {
 	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
-	_soundTypeSettings[type].mute = mute;
-
-	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
+	{
+		Common::StackLock lock(_stateMutex);
+		_soundTypeSettings[type].mute = mute;
 	}
+
+	queueCommand(Command::kUpdateTypeVolume, type, 0);
 }
 
 bool MixerImpl::isSoundTypeMuted(SoundType type) const {
 	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
+	Common::StackLock lock(_stateMutex);
 	return _soundTypeSettings[type].mute;
 }
 
 void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
-	Common::StackLock lock(_mutex);
+	{
+		Common::StackLock lock(_stateMutex);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
+		const int index = findChannel(handle);
+		if (index == -1)
+			return;
 
-	_channels[index]->setVolume(volume);
+		_channelState[index].volume = volume;
+	}
+
+	queueCommand(Command::kSetVolume, handle._val, volume);
 }
 
 byte MixerImpl::getChannelVolume(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	Common::StackLock lock(_stateMutex);
+
+	const int index = findChannel(handle);
+	if (index == -1)
 		return 0;
 
-	return _channels[index]->getVolume();
+	return _channelState[index].volume;
 }
 
 void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
-	Common::StackLock lock(_mutex);
+	{
+		Common::StackLock lock(_stateMutex);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
+		const int index = findChannel(handle);
+		if (index == -1)
+			return;
 
-	_channels[index]->setBalance(balance);
+		_channelState[index].balance = balance;
+	}
+
+	queueCommand(Command::kSetBalance, handle._val, balance);
 }
 
 int8 MixerImpl::getChannelBalance(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	Common::StackLock lock(_stateMutex);
+
+	const int index = findChannel(handle);
+	if (index == -1)
 		return 0;
 
-	return _channels[index]->getBalance();
+	return _channelState[index].balance;
 }
 
 uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
@@ -388,17 +612,17 @@ uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
 }
 
 Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
+	TimedStackLock lock(_mutex, _stats.engineLockWait, _stats.engineLockHold);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const int index = findChannel(handle);
+	if (index == -1)
 		return Timestamp(0, _sampleRate);
 
 	return _channels[index]->getElapsedTime();
 }
 
 void MixerImpl::pauseAll(bool paused) {
-	Common::StackLock lock(_mutex);
+	TimedStackLock lock(_mutex, _stats.engineLockWait, _stats.engineLockHold);
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != 0) {
 			_channels[i]->pause(paused);
@@ -407,7 +631,7 @@ void MixerImpl::pauseAll(bool paused) {
 }
 
 void MixerImpl::pauseID(int id, bool paused) {
-	Common::StackLock lock(_mutex);
+	TimedStackLock lock(_mutex, _stats.engineLockWait, _stats.engineLockHold);
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != 0 && _channels[i]->getId() == id) {
 			_channels[i]->pause(paused);
@@ -417,52 +641,52 @@ void MixerImpl::pauseID(int id, bool paused) {
 }
 
 void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
-	Common::StackLock lock(_mutex);
+	TimedStackLock lock(_mutex, _stats.engineLockWait, _stats.engineLockHold);
 
 	// Simply ignore (un)pause requests for sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const int index = findChannel(handle);
+	if (index == -1)
 		return;
 
 	_channels[index]->pause(paused);
 }
 
-bool MixerImpl::isSoundIDActive(int id) {
-	Common::StackLock lock(_mutex);
+// The queries below only look at the channel state, so they don't have to
+// wait for the mixer callback to finish mixing.
 
+bool MixerImpl::isSoundIDActive(int id) {
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
 #endif
 
+	Common::StackLock lock(_stateMutex);
 	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i] && _channels[i]->getId() == id)
+		if (_channelState[i].active && _channelState[i].id == id)
 			return true;
 	return false;
 }
 
 int MixerImpl::getSoundID(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-	const int index = handle._val % NUM_CHANNELS;
-	if (_channels[index] && _channels[index]->getHandle()._val == handle._val)
-		return _channels[index]->getId();
+	Common::StackLock lock(_stateMutex);
+	const int index = findChannel(handle);
+	if (index != -1)
+		return _channelState[index].id;
 	return 0;
 }
 
 bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
 #endif
 
-	const int index = handle._val % NUM_CHANNELS;
-	return _channels[index] && _channels[index]->getHandle()._val == handle._val;
+	Common::StackLock lock(_stateMutex);
+	return findChannel(handle) != -1;
 }
 
 bool MixerImpl::hasActiveChannelOfType(SoundType type) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_stateMutex);
 	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i] && _channels[i]->getType() == type)
+		if (_channelState[i].active && _channelState[i].type == type)
 			return true;
 	return false;
 }
@@ -479,17 +703,17 @@ void MixerImpl::setVolumeForSoundType(SoundType type, int volume) {
 	// TODO: Maybe we should do logarithmic (not linear) volume
 	// scaling? See also Player_V2::setMasterVolume
 
-	Common::StackLock lock(_mutex);
-	_soundTypeSettings[type].volume = volume;
-
-	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
+	{
+		Common::StackLock lock(_stateMutex);
+		_soundTypeSettings[type].volume = volume;
 	}
+
+	queueCommand(Command::kUpdateTypeVolume, type, 0);
 }
 
 int MixerImpl::getVolumeForSoundType(SoundType type) const {
 	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
+	Common::StackLock lock(_stateMutex);
 
 	return _soundTypeSettings[type].volume;
 }
@@ -500,7 +724,8 @@ int MixerImpl::getVolumeForSoundType(SoundType type) const {
 #pragma mark -
 
 Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
-                 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent)
+                 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent, ResamplerQuality quality,
+                 FIRFilterBankCache *firFilterBanks)
     : _type(type), _mixer(mixer), _id(id), _permanent(permanent), _volume(Mixer::kMaxChannelVolume),
       _balance(0), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
       _pauseStartTime(0), _pauseTime(0), _converter(0), _volL(0), _volR(0),
@@ -509,7 +734,7 @@ Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
 	assert(stream);
 
 	// Get a rate converter instance
-	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo);
+	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo, quality, firFilterBanks);
 }
 
 Channel::~Channel() {
@@ -611,7 +836,7 @@ int Channel::mix(int16 *data, uint len) {
 	assert(_stream);
 
 	int res = 0;
-	if (_stream->endOfData()) {
+	if (_stream->endOfData() && !_converter->hasPendingOutput()) {
 		// TODO: call drain method
 	} else {
 		assert(_converter);
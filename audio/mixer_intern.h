@@ -26,6 +26,7 @@
 #include "common/scummsys.h"
 #include "common/mutex.h"
 #include "audio/mixer.h"
+#include "audio/rate.h"
 
 namespace Audio {
 
@@ -49,13 +50,93 @@ namespace Audio {
  * @see OSystem::getMixer()
  */
 class MixerImpl : public Mixer {
+public:
+	/**
+	 * A histogram of durations in milliseconds. Bucket 0 counts durations
+	 * below 1 ms, bucket n those from 2^(n-1) to 2^n - 1 ms and the last
+	 * bucket all longer ones. The durations are measured with getMillis(),
+	 * so anything shorter than its resolution ends up in bucket 0.
+	 */
+	struct Histogram {
+		enum {
+			kNumBuckets = 8
+		};
+
+		Histogram() : max(0) { memset(buckets, 0, sizeof(buckets)); }
+
+		void add(uint32 msecs);
+
+		uint32 buckets[kNumBuckets];
+		uint32 max;
+	};
+
+	/**
+	 * Timing statistics of the mixer, to verify that the mixer callback
+	 * and the engine threads don't hold each other up.
+	 */
+	struct Stats {
+		Stats() : queuedCommands(0), directCommands(0) {}
+
+		Histogram callbackTime;     ///< Duration of mixCallback(), including the wait for the lock
+		Histogram callbackLockWait; ///< Time mixCallback() waited for the engine threads
+		Histogram callbackLockHold; ///< Time mixCallback() held the mixer lock
+		Histogram engineLockWait;   ///< Time engine calls waited for the mixer lock
+		Histogram engineLockHold;   ///< Time engine calls held the mixer lock
+		uint32 queuedCommands;      ///< Channel changes handed to the mixer callback
+		uint32 directCommands;      ///< Channel changes applied directly because the queue was full
+	};
+
 private:
 	enum {
-		NUM_CHANNELS = 16
+		NUM_CHANNELS = 16,
+		COMMAND_QUEUE_SIZE = 64
 	};
 
+	/**
+	 * Guards the channels. mixCallback() holds it while mixing, the engine
+	 * threads only while adding, removing or pausing channels. Channels are
+	 * created and destroyed outside of it.
+	 */
 	Common::Mutex _mutex;
 
+	/**
+	 * Guards _channelState, _soundTypeSettings and the command queue. It is
+	 * only ever held for a few instructions, so neither side waits on the
+	 * mixing or on engine code for it.
+	 */
+	Common::Mutex _stateMutex;
+
+	/**
+	 * What engine threads can query about a channel without waiting for the
+	 * mixer callback. It is updated together with _channels, and at once
+	 * for volume and balance changes, which are queued for the callback.
+	 */
+	struct ChannelState {
+		ChannelState() : active(false), handle(0), id(-1), type(kPlainSoundType), volume(0), balance(0) {}
+
+		bool active;
+		uint32 handle;
+		int id;
+		SoundType type;
+		byte volume;
+		int8 balance;
+	};
+
+	/**
+	 * A channel change which the mixer callback applies before mixing.
+	 */
+	struct Command {
+		enum Type {
+			kSetVolume,
+			kSetBalance,
+			kUpdateTypeVolume
+		};
+
+		Type type;
+		uint32 handle;  ///< The channel to change, or the sound type for kUpdateTypeVolume
+		int value;
+	};
+
 	const uint _sampleRate;
 	bool _mixerReady;
 	uint32 _handleSeed;
@@ -69,6 +150,34 @@ private:
 
 	SoundTypeSettings _soundTypeSettings[4];
 	Channel *_channels[NUM_CHANNELS];
+	ChannelState _channelState[NUM_CHANNELS];
+
+	Command _commands[COMMAND_QUEUE_SIZE];
+	uint _commandStart;
+	uint _commandCount;
+
+	ResamplerQuality _resamplerQuality;
+
+	/** The filter banks of the channels' rate converters, freed after the channels. */
+	FIRFilterBankCache _firFilterBanks;
+
+	/**
+	 * Guards _firFilterBanks while playStream() creates a channel. The
+	 * mixer callback never takes it, so computing a new filter bank only
+	 * holds up other engine threads starting a sound.
+	 */
+	Common::Mutex _firFilterBankMutex;
+
+	/**
+	 * Whether channels are summed on a 32 bit bus with a final limiter,
+	 * instead of clipping each other in the 16 bit output buffer.
+	 */
+	bool _headroomMixing;
+	int32 *_bus;
+	int16 *_channelBuffer;
+	uint _busSize;
+
+	Stats _stats;
 
 
 public:
@@ -118,8 +227,21 @@ public:
 
 	virtual uint getOutputRate() const;
 
+	/**
+	 * Return the timing statistics collected since the mixer was created or
+	 * resetStats() was called.
+	 */
+	Stats getStats();
+	void resetStats();
+
 protected:
-	void insertChannel(SoundHandle *handle, Channel *chan);
+	bool insertChannel(SoundHandle *handle, Channel *chan);
+	Channel *removeChannel(int index);
+	int findChannel(SoundHandle handle) const;
+
+	void queueCommand(Command::Type type, uint32 handle, int value);
+	void applyCommands();
+	void applyCommand(const Command &command);
 
 public:
 	/**
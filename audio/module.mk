@@ -56,7 +56,9 @@ MODULE_OBJS := \
 	softsynth/fluidsynth.o \
 	softsynth/mt32.o \
 	softsynth/eas.o \
+	softsynth/emumidi.o \
 	softsynth/pcspk.o \
+	softsynth/rendercache.o \
 	softsynth/sid.o \
 	softsynth/wave6581.o
 
@@ -65,6 +67,29 @@ MODULE_OBJS += \
 	alsa_opl.o
 endif
 
+# The mixing kernels are also used by the mixing bus of MixerImpl, so they
+# are needed with the ARM rate converters as well
+MODULE_OBJS += \
+	rate_mix.o
+
+ifdef SCUMMVM_SSE2
+MODULE_OBJS += \
+	rate_mix_sse2.o
+$(MODULE)/rate_mix_sse2.o: CXXFLAGS += $(SSE2_CXXFLAGS)
+endif
+
+ifdef SCUMMVM_AVX2
+MODULE_OBJS += \
+	rate_mix_avx2.o
+$(MODULE)/rate_mix_avx2.o: CXXFLAGS += $(AVX2_CXXFLAGS)
+endif
+
+ifdef SCUMMVM_NEON
+MODULE_OBJS += \
+	rate_mix_neon.o
+$(MODULE)/rate_mix_neon.o: CXXFLAGS += $(NEON_CXXFLAGS)
+endif
+
 ifndef USE_ARM_SOUND_ASM
 MODULE_OBJS += \
 	rate.o
@@ -74,5 +99,23 @@ MODULE_OBJS += \
 	rate_arm_asm.o
 endif
 
+ifdef SCUMMVM_SSE2
+MODULE_OBJS += \
+	softsynth/opl/dbopl_sse2.o
+$(MODULE)/softsynth/opl/dbopl_sse2.o: CXXFLAGS += $(SSE2_CXXFLAGS)
+endif
+
+ifdef SCUMMVM_AVX2
+MODULE_OBJS += \
+	softsynth/opl/dbopl_avx2.o
+$(MODULE)/softsynth/opl/dbopl_avx2.o: CXXFLAGS += $(AVX2_CXXFLAGS)
+endif
+
+ifdef SCUMMVM_NEON
+MODULE_OBJS += \
+	softsynth/opl/dbopl_neon.o
+$(MODULE)/softsynth/opl/dbopl_neon.o: CXXFLAGS += $(NEON_CXXFLAGS)
+endif
+
 # Include common rules
 include $(srcdir)/rules.mk
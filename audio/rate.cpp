@@ -30,11 +30,14 @@
 
 #include "audio/audiostream.h"
 #include "audio/rate.h"
+#include "audio/rate_mix.h"
 #include "audio/mixer.h"
 #include "common/frac.h"
 #include "common/textconsole.h"
 #include "common/util.h"
 
+#include <math.h>
+
 namespace Audio {
 
 
@@ -70,6 +73,10 @@ protected:
 	const st_sample_t *inPtr;
 	int inLen;
 
+	/** resampled output, waiting to be mixed into the output buffer */
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
+	RateMixProc mixProc;
+
 	/** position of how far output is ahead of input */
 	/** Holds what would have been opos-ipos */
 	long opos;
@@ -105,6 +112,8 @@ SimpleRateConverter<stereo, reverseStereo>::SimpleRateConverter(st_rate_t inrate
 	opos_inc = inrate / outrate;
 
 	inLen = 0;
+
+	mixProc = getRateMixProc(stereo, reverseStereo);
 }
 
 /*
@@ -113,43 +122,52 @@ SimpleRateConverter<stereo, reverseStereo>::SimpleRateConverter(st_rate_t inrate
  */
 template<bool stereo, bool reverseStereo>
 int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
-	st_sample_t *ostart, *oend;
-
-	ostart = obuf;
-	oend = obuf + osamp * 2;
-
-	while (obuf < oend) {
-
-		// read enough input samples so that opos >= 0
-		do {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
-			}
-			inLen -= (stereo ? 2 : 1);
-			opos--;
-			if (opos >= 0) {
-				inPtr += (stereo ? 2 : 1);
-			}
-		} while (opos >= 0);
-
-		st_sample_t out0, out1;
-		out0 = *inPtr++;
-		out1 = (stereo ? *inPtr++ : out0);
+	st_sample_t *ostart = obuf;
+	bool inputDone = false;
+
+	while (osamp > 0 && !inputDone) {
+		// Resample a block into outBuf, then mix it in one go
+		const st_size_t blockSize = MIN<st_size_t>(osamp, ARRAYSIZE(outBuf) / (stereo ? 2 : 1));
+		st_sample_t *outPtr = outBuf;
+		st_size_t produced = 0;
+
+		while (produced < blockSize) {
+
+			// read enough input samples so that opos >= 0
+			do {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						inLen = 0;
+						inputDone = true;
+						break;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				opos--;
+				if (opos >= 0) {
+					inPtr += (stereo ? 2 : 1);
+				}
+			} while (opos >= 0);
+
+			if (inputDone)
+				break;
+
+			*outPtr++ = *inPtr++;
+			if (stereo)
+				*outPtr++ = *inPtr++;
 
-		// Increment output position
-		opos += opos_inc;
-
-		// output left channel
-		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+			// Increment output position
+			opos += opos_inc;
 
-		// output right channel
-		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+			++produced;
+		}
 
-		obuf += 2;
+		mixProc(obuf, outBuf, produced, vol_l, vol_r);
+		obuf += produced * 2;
+		osamp -= produced;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -183,6 +201,10 @@ protected:
 	/** current sample(s) in the input stream (left/right channel) */
 	st_sample_t icur0, icur1;
 
+	/** interpolated output, waiting to be mixed into the output buffer */
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
+	RateMixProc mixProc;
+
 public:
 	LinearRateConverter(st_rate_t inrate, st_rate_t outrate);
 	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
@@ -214,6 +236,8 @@ LinearRateConverter<stereo, reverseStereo>::LinearRateConverter(st_rate_t inrate
 	icur0 = icur1 = 0;
 
 	inLen = 0;
+
+	mixProc = getRateMixProc(stereo, reverseStereo);
 }
 
 /*
@@ -222,53 +246,60 @@ LinearRateConverter<stereo, reverseStereo>::LinearRateConverter(st_rate_t inrate
  */
 template<bool stereo, bool reverseStereo>
 int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
-	st_sample_t *ostart, *oend;
-
-	ostart = obuf;
-	oend = obuf + osamp * 2;
-
-	while (obuf < oend) {
-
-		// read enough input samples so that opos < 0
-		while ((frac_t)FRAC_ONE_LOW <= opos) {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
+	st_sample_t *ostart = obuf;
+	bool inputDone = false;
+
+	while (osamp > 0 && !inputDone) {
+		// Interpolate a block into outBuf, then mix it in one go
+		const st_size_t blockSize = MIN<st_size_t>(osamp, ARRAYSIZE(outBuf) / (stereo ? 2 : 1));
+		st_sample_t *outPtr = outBuf;
+		st_size_t produced = 0;
+
+		while (produced < blockSize) {
+
+			// read enough input samples so that opos < 0
+			while ((frac_t)FRAC_ONE_LOW <= opos) {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						inLen = 0;
+						inputDone = true;
+						break;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				ilast0 = icur0;
+				icur0 = *inPtr++;
+				if (stereo) {
+					ilast1 = icur1;
+					icur1 = *inPtr++;
+				}
+				opos -= FRAC_ONE_LOW;
 			}
-			inLen -= (stereo ? 2 : 1);
-			ilast0 = icur0;
-			icur0 = *inPtr++;
-			if (stereo) {
-				ilast1 = icur1;
-				icur1 = *inPtr++;
-			}
-			opos -= FRAC_ONE_LOW;
-		}
-
-		// Loop as long as the outpos trails behind, and as long as there is
-		// still space in the output buffer.
-		while (opos < (frac_t)FRAC_ONE_LOW && obuf < oend) {
-			// interpolate
-			st_sample_t out0, out1;
-			out0 = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
-			out1 = (stereo ?
-						  (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW)) :
-						  out0);
 
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+			if (inputDone)
+				break;
 
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+			// Loop as long as the outpos trails behind, and as long as there is
+			// still space in the output block.
+			while (opos < (frac_t)FRAC_ONE_LOW && produced < blockSize) {
+				// interpolate
+				*outPtr++ = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
+				if (stereo)
+					*outPtr++ = (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
 
-			obuf += 2;
+				++produced;
 
-			// Increment output position
-			opos += opos_inc;
+				// Increment output position
+				opos += opos_inc;
+			}
 		}
+
+		mixProc(obuf, outBuf, produced, vol_l, vol_r);
+		obuf += produced * 2;
+		osamp -= produced;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -284,8 +315,9 @@ template<bool stereo, bool reverseStereo>
 class CopyRateConverter : public RateConverter {
 	st_sample_t *_buffer;
 	st_size_t _bufferSize;
+	RateMixProc _mixProc;
 public:
-	CopyRateConverter() : _buffer(0), _bufferSize(0) {}
+	CopyRateConverter() : _buffer(0), _bufferSize(0), _mixProc(getRateMixProc(stereo, reverseStereo)) {}
 	~CopyRateConverter() {
 		free(_buffer);
 	}
@@ -293,11 +325,8 @@ public:
 	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 		assert(input.isStereo() == stereo);
 
-		st_sample_t *ptr;
 		st_size_t len;
 
-		st_sample_t *ostart = obuf;
-
 		if (stereo)
 			osamp *= 2;
 
@@ -315,35 +344,322 @@ public:
 		len = input.readBuffer(_buffer, osamp);
 
 		// Mix the data into the output buffer
-		ptr = _buffer;
-		for (; len > 0; len -= (stereo ? 2 : 1)) {
-			st_sample_t out0, out1;
-			out0 = *ptr++;
-			out1 = (stereo ? *ptr++ : out0);
+		const st_size_t frames = (stereo ? len / 2 : len);
+		_mixProc(obuf, _buffer, frames, vol_l, vol_r);
+		return frames;
+	}
+
+	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
+		return ST_SUCCESS;
+	}
+};
+
+
+#pragma mark -
+
+
+/**
+ * The coefficients of a polyphase windowed-sinc interpolation filter for
+ * one conversion ratio and quality setting. A bank is immutable once built,
+ * so all channels converting between the same rates share one instance.
+ */
+struct FIRFilterBank {
+	enum {
+		/** Upper limit of the number of phases stored in a bank. */
+		kMaxPhases = 1024,
+		/** Fixed point precision of the coefficients. */
+		kCoefBits = 14
+	};
+
+	st_rate_t inrate;
+	st_rate_t outrate;
+	ResamplerQuality quality;
+
+	/** Output samples are produced at positions which are multiples of inStep / outStep input samples. */
+	uint32 inStep;
+	uint32 outStep;
+
+	/** Number of phases stored in 'coefs'. */
+	uint32 numPhases;
+	/** Number of taps per phase. Always a multiple of 8. */
+	uint32 numTaps;
+
+	/** numPhases rows of numTaps coefficients each. */
+	int16 *coefs;
+
+	FIRFilterBank(st_rate_t in, st_rate_t out, ResamplerQuality q);
+	~FIRFilterBank() { delete[] coefs; }
+
+	const int16 *getPhase(uint32 phase) const {
+		if (outStep > numPhases)
+			phase = (uint32)(((uint64)phase * numPhases) / outStep);
+		return coefs + phase * numTaps;
+	}
+};
+
+static uint32 gcd(uint32 a, uint32 b) {
+	while (b) {
+		uint32 t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+/** Zeroth order modified Bessel function of the first kind, used by the Kaiser window. */
+static double besselI0(double x) {
+	double sum = 1.0, term = 1.0;
+	for (int k = 1; k < 32; ++k) {
+		term *= (x / (2 * k)) * (x / (2 * k));
+		sum += term;
+		if (term < sum * 1e-12)
+			break;
+	}
+	return sum;
+}
+
+FIRFilterBank::FIRFilterBank(st_rate_t in, st_rate_t out, ResamplerQuality q)
+	: inrate(in), outrate(out), quality(q) {
+	const uint32 div = gcd(in, out);
+	inStep = in / div;
+	outStep = out / div;
+	numPhases = MIN<uint32>(outStep, kMaxPhases);
+
+	// When downsampling the cutoff frequency moves below the input Nyquist
+	// frequency, and the filter has to get wider to keep its steepness.
+	const uint32 baseTaps = (q == kResamplerHigh) ? 32 : 16;
+	const double beta = (q == kResamplerHigh) ? 9.0 : 6.0;
+	const uint32 widen = MIN<uint32>((inStep + outStep - 1) / outStep, 4);
+	numTaps = baseTaps * widen;
+
+	const double rolloff = (q == kResamplerHigh) ? 0.95 : 0.9;
+	const double cutoff = rolloff * MIN<double>(1.0, (double)outStep / inStep);
+	const double halfWidth = numTaps / 2.0;
+
+	coefs = new int16[numPhases * numTaps];
+
+	double *row = new double[numTaps];
+	for (uint32 p = 0; p < numPhases; ++p) {
+		// Distance between the output position and the first tap
+		const double frac = (double)p / numPhases;
+		double sum = 0.0;
+
+		for (uint32 k = 0; k < numTaps; ++k) {
+			const double t = (double)k - (halfWidth - 1) - frac;
+			const double x = cutoff * t * M_PI;
+			const double sinc = (x == 0.0) ? 1.0 : sin(x) / x;
+			const double w = t / halfWidth;
+			const double window = (w <= -1.0 || w >= 1.0) ? 0.0 : besselI0(beta * sqrt(1.0 - w * w)) / besselI0(beta);
+			row[k] = cutoff * sinc * window;
+			sum += row[k];
+		}
+
+		// Normalize every phase to unity gain, so that constant signals
+		// do not pick up a ripple at the output rate. The rounding error
+		// is put on the largest tap to make the sum exact.
+		int16 *phase = coefs + p * numTaps;
+		int32 intSum = 0;
+		uint32 center = 0;
+		for (uint32 k = 0; k < numTaps; ++k) {
+			const double c = row[k] / sum * (1 << kCoefBits);
+			phase[k] = (int16)CLIP<double>(floor(c + 0.5), -32768.0, 32767.0);
+			intSum += phase[k];
+			if (phase[k] > phase[center])
+				center = k;
+		}
+		phase[center] += (1 << kCoefBits) - intSum;
+	}
+	delete[] row;
+}
 
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+FIRFilterBankCache::FIRFilterBankCache() {
+	memset(_banks, 0, sizeof(_banks));
+}
 
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+FIRFilterBankCache::~FIRFilterBankCache() {
+	for (int i = 0; i < kSize; ++i)
+		delete _banks[i];
+}
 
-			obuf += 2;
+const FIRFilterBank *FIRFilterBankCache::get(st_rate_t inrate, st_rate_t outrate, ResamplerQuality quality) {
+	for (int i = 0; i < kSize; ++i) {
+		if (!_banks[i]) {
+			_banks[i] = new FIRFilterBank(inrate, outrate, quality);
+			return _banks[i];
 		}
-		return (obuf - ostart) / 2;
+		if (_banks[i]->inrate == inrate && _banks[i]->outrate == outrate && _banks[i]->quality == quality)
+			return _banks[i];
 	}
+	return 0;
+}
 
-	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
+/**
+ * Audio rate converter based on a polyphase windowed-sinc FIR filter.
+ *
+ * The input is deinterleaved into one history buffer per channel, so that
+ * every output sample is a plain dot product of a filter phase with a
+ * contiguous run of input samples. The position stepping is done with the
+ * exact integer ratio of the two rates, which avoids both the drift and the
+ * rate limits of the fixed point stepping used by the other converters.
+ */
+template<bool stereo, bool reverseStereo>
+class FIRRateConverter : public RateConverter {
+protected:
+	enum {
+		kHistorySize = INTERMEDIATE_BUFFER_SIZE + 4 * 32
+	};
+
+	const FIRFilterBank *_bank;
+	FIRFilterBank *_ownedBank;
+
+	st_sample_t _inBuf[INTERMEDIATE_BUFFER_SIZE];
+
+	/** deinterleaved input, one row per channel */
+	st_sample_t _history[stereo ? 2 : 1][kHistorySize];
+	/** number of valid frames in _history */
+	uint32 _historyLen;
+	/** index of the frame the first filter tap applies to */
+	uint32 _historyPos;
+	/** current filter phase, in units of 1 / _bank->outStep input frames */
+	uint32 _phase;
+	/** whether the input ended, and _history was padded with silence to convert its tail */
+	bool _flushing;
+
+	/** filtered output, waiting to be mixed into the output buffer */
+	st_sample_t _outBuf[INTERMEDIATE_BUFFER_SIZE];
+	RateMixProc _mixProc;
+
+	bool refill(AudioStream &input);
+
+	static st_sample_t filter(const st_sample_t *in, const int16 *coefs, uint32 numTaps) {
+		int32 acc = 1 << (FIRFilterBank::kCoefBits - 1);
+		for (uint32 k = 0; k < numTaps; ++k)
+			acc += in[k] * coefs[k];
+		acc >>= FIRFilterBank::kCoefBits;
+		return (st_sample_t)CLIP<int32>(acc, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+	}
+
+public:
+	FIRRateConverter(st_rate_t inrate, st_rate_t outrate, ResamplerQuality quality, FIRFilterBankCache *cache);
+	~FIRRateConverter() { delete _ownedBank; }
+
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return ST_SUCCESS;
 	}
+	bool hasPendingOutput() const {
+		return !_flushing || _historyPos + _bank->numTaps <= _historyLen;
+	}
 };
 
+template<bool stereo, bool reverseStereo>
+FIRRateConverter<stereo, reverseStereo>::FIRRateConverter(st_rate_t inrate, st_rate_t outrate, ResamplerQuality quality, FIRFilterBankCache *cache) {
+	_ownedBank = 0;
+	_bank = cache ? cache->get(inrate, outrate, quality) : 0;
+	if (!_bank) {
+		_ownedBank = new FIRFilterBank(inrate, outrate, quality);
+		_bank = _ownedBank;
+	}
+	assert(_bank->numTaps <= kHistorySize - INTERMEDIATE_BUFFER_SIZE);
+
+	// Center the filter on the first input sample
+	_historyLen = _bank->numTaps / 2 - 1;
+	memset(_history, 0, sizeof(_history));
+	_historyPos = 0;
+	_phase = 0;
+	_flushing = false;
+
+	_mixProc = getRateMixProc(stereo, reverseStereo);
+}
+
+/*
+ * Move the still needed history to the front and append new input. Once the
+ * stream ended, half a filter length of silence is appended instead, so that
+ * the output covers the last input samples too.
+ * Returns false if there is nothing more to append.
+ */
+template<bool stereo, bool reverseStereo>
+bool FIRRateConverter<stereo, reverseStereo>::refill(AudioStream &input) {
+	const uint32 keep = _historyLen - _historyPos;
+	for (int c = 0; c < (stereo ? 2 : 1); ++c)
+		memmove(_history[c], _history[c] + _historyPos, keep * sizeof(st_sample_t));
+	_historyLen = keep;
+	_historyPos = 0;
+
+	const int maxSamples = MIN<int>(ARRAYSIZE(_inBuf), (kHistorySize - _historyLen) * (stereo ? 2 : 1));
+	const int len = input.readBuffer(_inBuf, maxSamples);
+	if (len <= 0) {
+		if (_flushing || !input.endOfStream())
+			return false;
+
+		const uint32 padding = _bank->numTaps / 2;
+		for (int c = 0; c < (stereo ? 2 : 1); ++c)
+			memset(_history[c] + _historyLen, 0, padding * sizeof(st_sample_t));
+		_historyLen += padding;
+		_flushing = true;
+		return true;
+	}
+
+	const st_sample_t *in = _inBuf;
+	for (int i = 0; i < len; i += (stereo ? 2 : 1)) {
+		_history[0][_historyLen] = *in++;
+		if (stereo)
+			_history[stereo ? 1 : 0][_historyLen] = *in++;
+		++_historyLen;
+	}
+	return true;
+}
+
+template<bool stereo, bool reverseStereo>
+int FIRRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	st_sample_t *ostart = obuf;
+	const uint32 numTaps = _bank->numTaps;
+	const uint32 inStep = _bank->inStep;
+	const uint32 outStep = _bank->outStep;
+	bool inputDone = false;
+
+	while (osamp > 0 && !inputDone) {
+		// Filter a block into _outBuf, then mix it in one go
+		const st_size_t blockSize = MIN<st_size_t>(osamp, ARRAYSIZE(_outBuf) / (stereo ? 2 : 1));
+		st_sample_t *outPtr = _outBuf;
+		st_size_t produced = 0;
+
+		while (produced < blockSize) {
+			if (_historyPos + numTaps > _historyLen) {
+				if (!refill(input)) {
+					inputDone = true;
+					break;
+				}
+				continue;
+			}
+
+			const int16 *coefs = _bank->getPhase(_phase);
+			*outPtr++ = filter(_history[0] + _historyPos, coefs, numTaps);
+			if (stereo)
+				*outPtr++ = filter(_history[stereo ? 1 : 0] + _historyPos, coefs, numTaps);
+			++produced;
+
+			_phase += inStep;
+			_historyPos += _phase / outStep;
+			_phase %= outStep;
+		}
+
+		_mixProc(obuf, _outBuf, produced, vol_l, vol_r);
+		obuf += produced * 2;
+		osamp -= produced;
+	}
+	return (obuf - ostart) / 2;
+}
+
 
 #pragma mark -
 
 template<bool stereo, bool reverseStereo>
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, ResamplerQuality quality, FIRFilterBankCache *cache) {
 	if (inrate != outrate) {
-		if ((inrate % outrate) == 0 && (inrate < 65536)) {
+		if (quality != kResamplerLinear) {
+			return new FIRRateConverter<stereo, reverseStereo>(inrate, outrate, quality, cache);
+		} else if ((inrate % outrate) == 0 && (inrate < 65536)) {
 			return new SimpleRateConverter<stereo, reverseStereo>(inrate, outrate);
 		} else {
 			return new LinearRateConverter<stereo, reverseStereo>(inrate, outrate);
@@ -356,14 +672,23 @@ RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
 /**
  * Create and return a RateConverter object for the specified input and output rates.
  */
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, ResamplerQuality quality, FIRFilterBankCache *cache) {
 	if (stereo) {
 		if (reverseStereo)
-			return makeRateConverter<true, true>(inrate, outrate);
+			return makeRateConverter<true, true>(inrate, outrate, quality, cache);
 		else
-			return makeRateConverter<true, false>(inrate, outrate);
+			return makeRateConverter<true, false>(inrate, outrate, quality, cache);
 	} else
-		return makeRateConverter<false, false>(inrate, outrate);
+		return makeRateConverter<false, false>(inrate, outrate, quality, cache);
+}
+
+ResamplerQuality parseResamplerQuality(const Common::String &str) {
+	if (str.equalsIgnoreCase("medium"))
+		return kResamplerMedium;
+	else if (str.equalsIgnoreCase("high"))
+		return kResamplerHigh;
+	else
+		return kResamplerLinear;
 }
 
 } // End of namespace Audio
@@ -25,6 +25,10 @@
 
 #include "common/scummsys.h"
 
+namespace Common {
+class String;
+}
+
 namespace Audio {
 
 class AudioStream;
@@ -76,9 +80,69 @@ public:
 	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) = 0;
 
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) = 0;
+
+	/**
+	 * Whether input already read from the stream still has to be converted.
+	 * If so, flow() has to be called again even after the stream ended.
+	 */
+	virtual bool hasPendingOutput() const { return false; }
+};
+
+/**
+ * Interpolation quality used by the rate converters.
+ */
+enum ResamplerQuality {
+	/** Nearest neighbour or linear interpolation. Cheap, but aliases audibly. */
+	kResamplerLinear = 0,
+	/** Polyphase windowed-sinc filter with 16 taps. */
+	kResamplerMedium,
+	/** Polyphase windowed-sinc filter with 32 taps. */
+	kResamplerHigh
+};
+
+struct FIRFilterBank;
+
+/**
+ * Keeps the filter banks of the windowed-sinc rate converters, so that all
+ * converters between the same rates share one instead of building their
+ * own. The banks are freed together with the cache, which therefore has to
+ * outlive all converters created with it.
+ */
+class FIRFilterBankCache {
+public:
+	FIRFilterBankCache();
+	~FIRFilterBankCache();
+
+	/**
+	 * Return the filter bank for the given rates, building it if it is not
+	 * in the cache yet.
+	 *
+	 * @return the bank, or 0 if the cache is full
+	 */
+	const FIRFilterBank *get(st_rate_t inrate, st_rate_t outrate, ResamplerQuality quality);
+
+private:
+	enum {
+		kSize = 16
+	};
+
+	FIRFilterBank *_banks[kSize];
 };
 
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false);
+/**
+ * Create a RateConverter for the given input and output rates. If both
+ * rates are equal, the quality setting has no effect.
+ *
+ * @param cache	the cache windowed-sinc converters take their filter bank from;
+ *		without one, they build their own
+ */
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false, ResamplerQuality quality = kResamplerLinear, FIRFilterBankCache *cache = 0);
+
+/**
+ * Convert the value of the "resampler_quality" config key ("linear",
+ * "medium" or "high") into a ResamplerQuality.
+ */
+ResamplerQuality parseResamplerQuality(const Common::String &str);
 
 } // End of namespace Audio
 
@@ -444,10 +444,24 @@ public:
 #pragma mark -
 
 
+// The ARM converters have no filter banks to share
+FIRFilterBankCache::FIRFilterBankCache() {
+	memset(_banks, 0, sizeof(_banks));
+}
+
+FIRFilterBankCache::~FIRFilterBankCache() {
+}
+
+const FIRFilterBank *FIRFilterBankCache::get(st_rate_t inrate, st_rate_t outrate, ResamplerQuality quality) {
+	return 0;
+}
+
 /**
  * Create and return a RateConverter object for the specified input and output rates.
+ * The ARM converters only implement linear interpolation, so the quality setting
+ * is ignored.
  */
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, ResamplerQuality quality, FIRFilterBankCache *cache) {
 	if (inrate != outrate) {
 		if ((inrate % outrate) == 0 && (inrate < 65536)) {
 			if (stereo) {
@@ -477,4 +491,8 @@ RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stere
 	}
 }
 
+ResamplerQuality parseResamplerQuality(const Common::String &str) {
+	return kResamplerLinear;
+}
+
 } // End of namespace Audio
@@ -0,0 +1,86 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/rate_mix.h"
+#include "common/cpudetect.h"
+
+namespace Audio {
+
+template<bool stereo, bool reverseStereo>
+static void mixScalar(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r) {
+	for (; frames > 0; --frames) {
+		st_sample_t out0, out1;
+		out0 = *ibuf++;
+		out1 = (stereo ? *ibuf++ : out0);
+
+		// output left channel
+		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+
+		// output right channel
+		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+
+		obuf += 2;
+	}
+}
+
+static void busAccumulateScalar(int32 *bus, const st_sample_t *ibuf, st_size_t samples) {
+	for (; samples > 0; --samples)
+		*bus++ += *ibuf++;
+}
+
+static void busLimitScalar(st_sample_t *obuf, const int32 *bus, st_size_t samples) {
+	for (; samples > 0; --samples)
+		*obuf++ = limitBusSample(*bus++);
+}
+
+const RateMixProcs g_rateMixProcsScalar = {
+	mixScalar<false, false>,
+	mixScalar<true, false>,
+	mixScalar<true, true>,
+	busAccumulateScalar,
+	busLimitScalar
+};
+
+const RateMixProcs &getRateMixProcs() {
+#ifndef OUTPUT_UNSIGNED_AUDIO
+	// The SIMD kernels only deal with signed output samples
+#ifdef SCUMMVM_AVX2
+	if (Common::hasCPUFeature(Common::kCPUFeatureAVX2))
+		return g_rateMixProcsAVX2;
+#endif
+#ifdef SCUMMVM_SSE2
+	if (Common::hasCPUFeature(Common::kCPUFeatureSSE2))
+		return g_rateMixProcsSSE2;
+#endif
+#ifdef SCUMMVM_NEON
+	if (Common::hasCPUFeature(Common::kCPUFeatureNEON))
+		return g_rateMixProcsNEON;
+#endif
+#endif
+	return g_rateMixProcsScalar;
+}
+
+RateMixProc getRateMixProc(bool stereo, bool reverseStereo) {
+	return selectRateMixProc(getRateMixProcs(), stereo, reverseStereo);
+}
+
+} // End of namespace Audio
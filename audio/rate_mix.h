@@ -0,0 +1,156 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef AUDIO_RATE_MIX_H
+#define AUDIO_RATE_MIX_H
+
+#include "audio/mixer.h"
+#include "audio/rate.h"
+
+namespace Audio {
+
+/**
+ * Mixes a block of samples, which are already at the output rate, into the
+ * interleaved stereo output buffer of a RateConverter. Each output sample is
+ * computed exactly like clampedAdd(out, (in * vol) / Mixer::kMaxMixerVolume).
+ *
+ * @param obuf   stereo output buffer, receives 2 * frames samples
+ * @param ibuf   input samples, either mono or interleaved stereo
+ * @param frames number of sample frames to mix
+ * @param vol_l  volume of the left output channel
+ * @param vol_r  volume of the right output channel
+ */
+typedef void (*RateMixProc)(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r);
+
+/**
+ * Adds a block of samples to the 32 bit mixing bus, without clipping.
+ *
+ * @param bus     the mixing bus
+ * @param ibuf    the samples to add
+ * @param samples number of samples (not frames) to add
+ */
+typedef void (*BusAccumulateProc)(int32 *bus, const st_sample_t *ibuf, st_size_t samples);
+
+/**
+ * Converts the samples of the 32 bit mixing bus into output samples,
+ * passing each one through limitBusSample().
+ *
+ * @param obuf    the output buffer
+ * @param bus     the mixing bus
+ * @param samples number of samples (not frames) to convert
+ */
+typedef void (*BusLimitProc)(st_sample_t *obuf, const int32 *bus, st_size_t samples);
+
+/**
+ * The set of mixing kernels for one instruction set.
+ */
+struct RateMixProcs {
+	/** Mixes mono input into both output channels. */
+	RateMixProc mono;
+	/** Mixes interleaved stereo input. */
+	RateMixProc stereo;
+	/** Mixes interleaved stereo input with left and right swapped. */
+	RateMixProc stereoReverse;
+	/** Adds samples to the mixing bus. */
+	BusAccumulateProc busAccumulate;
+	/** Converts the mixing bus to output samples. */
+	BusLimitProc busLimit;
+};
+
+enum {
+	/** Mixing bus samples up to this magnitude pass the limiter unchanged. */
+	kBusLimiterThreshold = 24576
+};
+
+/**
+ * The soft limiter applied to the mixing bus. Samples up to
+ * kBusLimiterThreshold are passed through unchanged. Above it the curve
+ * continues with the same slope and then bends smoothly towards full
+ * scale, which it never exceeds, however loud the mix gets.
+ */
+inline st_sample_t limitBusSample(int32 sample) {
+	const int32 range = ST_SAMPLE_MAX - kBusLimiterThreshold;
+
+	if (sample > kBusLimiterThreshold) {
+		const int32 over = sample - kBusLimiterThreshold;
+		return kBusLimiterThreshold + (int32)(((int64)over * range) / (over + range));
+	} else if (sample < -kBusLimiterThreshold) {
+		const int32 over = -kBusLimiterThreshold - sample;
+		return -kBusLimiterThreshold - (int32)(((int64)over * range) / (over + range));
+	}
+
+	return sample;
+}
+
+/**
+ * Pick the kernel matching the given channel configuration out of a set.
+ */
+inline RateMixProc selectRateMixProc(const RateMixProcs &procs, bool stereo, bool reverseStereo) {
+	if (!stereo)
+		return procs.mono;
+	else if (reverseStereo)
+		return procs.stereoReverse;
+	else
+		return procs.stereo;
+}
+
+/**
+ * The portable C++ kernels. These are the reference all other kernels
+ * have to be bit exact with.
+ */
+extern const RateMixProcs g_rateMixProcsScalar;
+
+#ifdef SCUMMVM_SSE2
+extern const RateMixProcs g_rateMixProcsSSE2;
+#endif
+
+#ifdef SCUMMVM_AVX2
+extern const RateMixProcs g_rateMixProcsAVX2;
+#endif
+
+#ifdef SCUMMVM_NEON
+extern const RateMixProcs g_rateMixProcsNEON;
+#endif
+
+/**
+ * Return the fastest set of kernels supported by the CPU we run on.
+ */
+const RateMixProcs &getRateMixProcs();
+
+/**
+ * Return the kernel matching the given channel configuration out of the
+ * fastest set of kernels supported by the CPU we run on.
+ */
+RateMixProc getRateMixProc(bool stereo, bool reverseStereo);
+
+/**
+ * The SIMD kernels compute the volume scaled sample in 16 bits. This is only
+ * exact as long as the volume does not exceed the maximum mixer volume,
+ * hence they fall back to the scalar kernels for any larger volume.
+ */
+inline bool isRateMixVolumeInRange(st_volume_t vol_l, st_volume_t vol_r) {
+	return vol_l <= Mixer::kMaxMixerVolume && vol_r <= Mixer::kMaxMixerVolume;
+}
+
+} // End of namespace Audio
+
+#endif
@@ -0,0 +1,139 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/rate_mix.h"
+
+#include <immintrin.h>
+
+namespace Audio {
+
+/**
+ * Scale sixteen samples by the per lane volume and add them with saturation
+ * to sixteen output samples.
+ */
+static inline __m256i mixVolume(__m256i out, __m256i in, __m256i vol) {
+	const __m256i roundMask = _mm256_set1_epi32(Mixer::kMaxMixerVolume - 1);
+
+	// Build the full 32 bit products. Unpacking and packing both work within
+	// 128 bit lanes, so the sample order is preserved.
+	const __m256i lo = _mm256_mullo_epi16(in, vol);
+	const __m256i hi = _mm256_mulhi_epi16(in, vol);
+	__m256i p0 = _mm256_unpacklo_epi16(lo, hi);
+	__m256i p1 = _mm256_unpackhi_epi16(lo, hi);
+
+	// Divide by kMaxMixerVolume, rounding towards zero like C division does
+	p0 = _mm256_srai_epi32(_mm256_add_epi32(p0, _mm256_and_si256(_mm256_srai_epi32(p0, 31), roundMask)), 8);
+	p1 = _mm256_srai_epi32(_mm256_add_epi32(p1, _mm256_and_si256(_mm256_srai_epi32(p1, 31), roundMask)), 8);
+
+	return _mm256_adds_epi16(out, _mm256_packs_epi32(p0, p1));
+}
+
+template<bool stereo, bool reverseStereo>
+static void mixAVX2(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r) {
+	if (!isRateMixVolumeInRange(vol_l, vol_r)) {
+		selectRateMixProc(g_rateMixProcsScalar, stereo, reverseStereo)(obuf, ibuf, frames, vol_l, vol_r);
+		return;
+	}
+
+	// See mixSSE2() for the volume layout with reversed stereo
+	const __m256i vol = reverseStereo ?
+		_mm256_set1_epi32((vol_l << 16) | vol_r) :
+		_mm256_set1_epi32((vol_r << 16) | vol_l);
+
+	if (stereo) {
+		for (; frames >= 8; frames -= 8) {
+			__m256i in = _mm256_loadu_si256((const __m256i *)ibuf);
+			if (reverseStereo)
+				in = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(in, 0xB1), 0xB1);
+			const __m256i out = _mm256_loadu_si256((const __m256i *)obuf);
+			_mm256_storeu_si256((__m256i *)obuf, mixVolume(out, in, vol));
+
+			ibuf += 16;
+			obuf += 16;
+		}
+	} else {
+		for (; frames >= 8; frames -= 8) {
+			// Spread the eight input samples so that each 128 bit lane holds
+			// four of them in its lower half, then duplicate each sample.
+			__m256i in = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)ibuf));
+			in = _mm256_permute4x64_epi64(in, 0x50);
+			in = _mm256_unpacklo_epi16(in, in);
+			const __m256i out = _mm256_loadu_si256((const __m256i *)obuf);
+			_mm256_storeu_si256((__m256i *)obuf, mixVolume(out, in, vol));
+
+			ibuf += 8;
+			obuf += 16;
+		}
+	}
+
+	if (frames)
+		selectRateMixProc(g_rateMixProcsScalar, stereo, reverseStereo)(obuf, ibuf, frames, vol_l, vol_r);
+}
+
+static void busAccumulateAVX2(int32 *bus, const st_sample_t *ibuf, st_size_t samples) {
+	for (; samples >= 16; samples -= 16) {
+		const __m256i lo = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)ibuf));
+		const __m256i hi = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(ibuf + 8)));
+		_mm256_storeu_si256((__m256i *)bus, _mm256_add_epi32(_mm256_loadu_si256((const __m256i *)bus), lo));
+		_mm256_storeu_si256((__m256i *)(bus + 8), _mm256_add_epi32(_mm256_loadu_si256((const __m256i *)(bus + 8)), hi));
+
+		ibuf += 16;
+		bus += 16;
+	}
+
+	g_rateMixProcsScalar.busAccumulate(bus, ibuf, samples);
+}
+
+static void busLimitAVX2(st_sample_t *obuf, const int32 *bus, st_size_t samples) {
+	const __m256i high = _mm256_set1_epi32(kBusLimiterThreshold);
+	const __m256i low = _mm256_set1_epi32(-kBusLimiterThreshold);
+
+	for (; samples >= 16; samples -= 16) {
+		const __m256i lo = _mm256_loadu_si256((const __m256i *)bus);
+		const __m256i hi = _mm256_loadu_si256((const __m256i *)(bus + 8));
+		const __m256i over = _mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpgt_epi32(lo, high), _mm256_cmpgt_epi32(low, lo)),
+			_mm256_or_si256(_mm256_cmpgt_epi32(hi, high), _mm256_cmpgt_epi32(low, hi)));
+
+		// Only loud blocks need the limiter curve. Packing works within
+		// 128 bit lanes, so the result has to be put back in order.
+		if (_mm256_movemask_epi8(over))
+			g_rateMixProcsScalar.busLimit(obuf, bus, 16);
+		else
+			_mm256_storeu_si256((__m256i *)obuf, _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xD8));
+
+		bus += 16;
+		obuf += 16;
+	}
+
+	g_rateMixProcsScalar.busLimit(obuf, bus, samples);
+}
+
+const RateMixProcs g_rateMixProcsAVX2 = {
+	mixAVX2<false, false>,
+	mixAVX2<true, false>,
+	mixAVX2<true, true>,
+	busAccumulateAVX2,
+	busLimitAVX2
+};
+
+} // End of namespace Audio
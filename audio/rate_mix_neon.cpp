@@ -0,0 +1,127 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/rate_mix.h"
+
+#include <arm_neon.h>
+
+namespace Audio {
+
+/**
+ * Scale four samples by the per lane volume, dividing by kMaxMixerVolume
+ * with rounding towards zero like C division does.
+ */
+static inline int16x4_t scaleVolume(int16x4_t in, int16x4_t vol) {
+	int32x4_t p = vmull_s16(in, vol);
+	p = vaddq_s32(p, vandq_s32(vshrq_n_s32(p, 31), vdupq_n_s32(Mixer::kMaxMixerVolume - 1)));
+	return vmovn_s32(vshrq_n_s32(p, 8));
+}
+
+/**
+ * Scale eight samples by the per lane volume and add them with saturation
+ * to eight output samples.
+ */
+static inline int16x8_t mixVolume(int16x8_t out, int16x8_t in, int16x8_t vol) {
+	const int16x8_t scaled = vcombine_s16(scaleVolume(vget_low_s16(in), vget_low_s16(vol)),
+	                                      scaleVolume(vget_high_s16(in), vget_high_s16(vol)));
+	return vqaddq_s16(out, scaled);
+}
+
+template<bool stereo, bool reverseStereo>
+static void mixNEON(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r) {
+	if (!isRateMixVolumeInRange(vol_l, vol_r)) {
+		selectRateMixProc(g_rateMixProcsScalar, stereo, reverseStereo)(obuf, ibuf, frames, vol_l, vol_r);
+		return;
+	}
+
+	// See mixSSE2() for the volume layout with reversed stereo
+	const int16x8_t vol = vreinterpretq_s16_s32(vdupq_n_s32(reverseStereo ?
+		((vol_l << 16) | vol_r) : ((vol_r << 16) | vol_l)));
+
+	if (stereo) {
+		for (; frames >= 4; frames -= 4) {
+			int16x8_t in = vld1q_s16(ibuf);
+			if (reverseStereo)
+				in = vrev32q_s16(in);
+			vst1q_s16(obuf, mixVolume(vld1q_s16(obuf), in, vol));
+
+			ibuf += 8;
+			obuf += 8;
+		}
+	} else {
+		for (; frames >= 4; frames -= 4) {
+			const int16x4_t in = vld1_s16(ibuf);
+			const int16x4x2_t dup = vzip_s16(in, in);
+			vst1q_s16(obuf, mixVolume(vld1q_s16(obuf), vcombine_s16(dup.val[0], dup.val[1]), vol));
+
+			ibuf += 4;
+			obuf += 8;
+		}
+	}
+
+	if (frames)
+		selectRateMixProc(g_rateMixProcsScalar, stereo, reverseStereo)(obuf, ibuf, frames, vol_l, vol_r);
+}
+
+static void busAccumulateNEON(int32 *bus, const st_sample_t *ibuf, st_size_t samples) {
+	for (; samples >= 8; samples -= 8) {
+		const int16x8_t in = vld1q_s16(ibuf);
+		vst1q_s32(bus, vaddw_s16(vld1q_s32(bus), vget_low_s16(in)));
+		vst1q_s32(bus + 4, vaddw_s16(vld1q_s32(bus + 4), vget_high_s16(in)));
+
+		ibuf += 8;
+		bus += 8;
+	}
+
+	g_rateMixProcsScalar.busAccumulate(bus, ibuf, samples);
+}
+
+static void busLimitNEON(st_sample_t *obuf, const int32 *bus, st_size_t samples) {
+	const int32x4_t threshold = vdupq_n_s32(kBusLimiterThreshold);
+
+	for (; samples >= 8; samples -= 8) {
+		const int32x4_t lo = vld1q_s32(bus);
+		const int32x4_t hi = vld1q_s32(bus + 4);
+		const uint32x4_t over = vorrq_u32(vcgtq_s32(vabsq_s32(lo), threshold), vcgtq_s32(vabsq_s32(hi), threshold));
+
+		// Only loud blocks need the limiter curve
+		if (vgetq_lane_u32(over, 0) | vgetq_lane_u32(over, 1) | vgetq_lane_u32(over, 2) | vgetq_lane_u32(over, 3))
+			g_rateMixProcsScalar.busLimit(obuf, bus, 8);
+		else
+			vst1q_s16(obuf, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+
+		bus += 8;
+		obuf += 8;
+	}
+
+	g_rateMixProcsScalar.busLimit(obuf, bus, samples);
+}
+
+const RateMixProcs g_rateMixProcsNEON = {
+	mixNEON<false, false>,
+	mixNEON<true, false>,
+	mixNEON<true, true>,
+	busAccumulateNEON,
+	busLimitNEON
+};
+
+} // End of namespace Audio
@@ -0,0 +1,137 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/rate_mix.h"
+
+#include <emmintrin.h>
+
+namespace Audio {
+
+/**
+ * Scale eight samples by the per lane volume and add them with saturation
+ * to eight output samples.
+ */
+static inline __m128i mixVolume(__m128i out, __m128i in, __m128i vol) {
+	const __m128i roundMask = _mm_set1_epi32(Mixer::kMaxMixerVolume - 1);
+
+	// Build the full 32 bit products
+	const __m128i lo = _mm_mullo_epi16(in, vol);
+	const __m128i hi = _mm_mulhi_epi16(in, vol);
+	__m128i p0 = _mm_unpacklo_epi16(lo, hi);
+	__m128i p1 = _mm_unpackhi_epi16(lo, hi);
+
+	// Divide by kMaxMixerVolume, rounding towards zero like C division does
+	p0 = _mm_srai_epi32(_mm_add_epi32(p0, _mm_and_si128(_mm_srai_epi32(p0, 31), roundMask)), 8);
+	p1 = _mm_srai_epi32(_mm_add_epi32(p1, _mm_and_si128(_mm_srai_epi32(p1, 31), roundMask)), 8);
+
+	return _mm_adds_epi16(out, _mm_packs_epi32(p0, p1));
+}
+
+template<bool stereo, bool reverseStereo>
+static void mixSSE2(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r) {
+	if (!isRateMixVolumeInRange(vol_l, vol_r)) {
+		selectRateMixProc(g_rateMixProcsScalar, stereo, reverseStereo)(obuf, ibuf, frames, vol_l, vol_r);
+		return;
+	}
+
+	// With reversed stereo the left input goes to the right output, and
+	// the right input is scaled by the right volume, ending up on the left.
+	const __m128i vol = reverseStereo ?
+		_mm_set_epi16(vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r) :
+		_mm_set_epi16(vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l);
+
+	if (stereo) {
+		for (; frames >= 4; frames -= 4) {
+			__m128i in = _mm_loadu_si128((const __m128i *)ibuf);
+			if (reverseStereo)
+				in = _mm_shufflehi_epi16(_mm_shufflelo_epi16(in, 0xB1), 0xB1);
+			const __m128i out = _mm_loadu_si128((const __m128i *)obuf);
+			_mm_storeu_si128((__m128i *)obuf, mixVolume(out, in, vol));
+
+			ibuf += 8;
+			obuf += 8;
+		}
+	} else {
+		for (; frames >= 4; frames -= 4) {
+			__m128i in = _mm_loadl_epi64((const __m128i *)ibuf);
+			in = _mm_unpacklo_epi16(in, in);
+			const __m128i out = _mm_loadu_si128((const __m128i *)obuf);
+			_mm_storeu_si128((__m128i *)obuf, mixVolume(out, in, vol));
+
+			ibuf += 4;
+			obuf += 8;
+		}
+	}
+
+	if (frames)
+		selectRateMixProc(g_rateMixProcsScalar, stereo, reverseStereo)(obuf, ibuf, frames, vol_l, vol_r);
+}
+
+static void busAccumulateSSE2(int32 *bus, const st_sample_t *ibuf, st_size_t samples) {
+	for (; samples >= 8; samples -= 8) {
+		// Sign extend the samples by unpacking them into the upper halves
+		const __m128i in = _mm_loadu_si128((const __m128i *)ibuf);
+		const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16);
+		const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(in, in), 16);
+		_mm_storeu_si128((__m128i *)bus, _mm_add_epi32(_mm_loadu_si128((const __m128i *)bus), lo));
+		_mm_storeu_si128((__m128i *)(bus + 4), _mm_add_epi32(_mm_loadu_si128((const __m128i *)(bus + 4)), hi));
+
+		ibuf += 8;
+		bus += 8;
+	}
+
+	g_rateMixProcsScalar.busAccumulate(bus, ibuf, samples);
+}
+
+static void busLimitSSE2(st_sample_t *obuf, const int32 *bus, st_size_t samples) {
+	const __m128i high = _mm_set1_epi32(kBusLimiterThreshold);
+	const __m128i low = _mm_set1_epi32(-kBusLimiterThreshold);
+
+	for (; samples >= 8; samples -= 8) {
+		const __m128i lo = _mm_loadu_si128((const __m128i *)bus);
+		const __m128i hi = _mm_loadu_si128((const __m128i *)(bus + 4));
+		const __m128i over = _mm_or_si128(
+			_mm_or_si128(_mm_cmpgt_epi32(lo, high), _mm_cmplt_epi32(lo, low)),
+			_mm_or_si128(_mm_cmpgt_epi32(hi, high), _mm_cmplt_epi32(hi, low)));
+
+		// Only loud blocks need the limiter curve
+		if (_mm_movemask_epi8(over))
+			g_rateMixProcsScalar.busLimit(obuf, bus, 8);
+		else
+			_mm_storeu_si128((__m128i *)obuf, _mm_packs_epi32(lo, hi));
+
+		bus += 8;
+		obuf += 8;
+	}
+
+	g_rateMixProcsScalar.busLimit(obuf, bus, samples);
+}
+
+const RateMixProcs g_rateMixProcsSSE2 = {
+	mixSSE2<false, false>,
+	mixSSE2<true, false>,
+	mixSSE2<true, true>,
+	busAccumulateSSE2,
+	busLimitSSE2
+};
+
+} // End of namespace Audio
@@ -0,0 +1,173 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/softsynth/emumidi.h"
+#include "audio/softsynth/rendercache.h"
+
+#include "common/config-manager.h"
+#include "common/fs.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+#include "common/timer.h"
+
+MidiDriver_Emulated::~MidiDriver_Emulated() {
+	if (_renderCache) {
+		g_system->getTimerManager()->removeTimerProc(renderCacheTimer);
+
+		// Store the pass recorded last, if it was not stored yet
+		_renderCache->runJobs();
+		delete _renderCache;
+	}
+}
+
+void MidiDriver_Emulated::renderCacheTimer(void *refCon) {
+	MidiDriver_Emulated *driver = (MidiDriver_Emulated *)refCon;
+
+	// The files are accessed without the lock, so the mixer never waits for
+	// them. Jobs are short, and only one is done per call so that the other
+	// timer procs are not held up.
+	MidiRenderCache::Job *job;
+	{
+		Common::StackLock lock(driver->_renderCacheMutex);
+		job = driver->_renderCache->takeJob();
+	}
+	if (!job)
+		return;
+
+	driver->_renderCache->runJob(job);
+
+	Common::StackLock lock(driver->_renderCacheMutex);
+	driver->_renderCache->finishJob(job);
+}
+
+int MidiDriver_Emulated::open() {
+	_isOpen = true;
+
+	int d = getRate() / _baseFreq;
+	int r = getRate() % _baseFreq;
+
+	// This is equivalent to (getRate() << FIXP_SHIFT) / BASE_FREQ
+	// but less prone to arithmetic overflow.
+
+	_samplesPerTick = (d << FIXP_SHIFT) + (r << FIXP_SHIFT) / _baseFreq;
+
+	// Looping music is only synthesized until it is in the render cache,
+	// when the user picked a directory for it
+	if (_renderCache)
+		g_system->getTimerManager()->removeTimerProc(renderCacheTimer);
+
+	Common::StackLock lock(_renderCacheMutex);
+	if (_renderCache) {
+		_renderCache->runJobs();
+		delete _renderCache;
+		_renderCache = 0;
+	}
+
+	const Common::String config = getRenderCacheConfig();
+	if (!config.empty() && ConfMan.hasKey("midi_cache_path")) {
+		Common::FSNode directory(ConfMan.get("midi_cache_path"));
+		if (directory.isDirectory())
+			_renderCache = new MidiRenderCache(this, directory, Common::String::format("%s %d %d", config.c_str(), getRate(), isStereo()), isStereo() ? 2 : 1);
+		else
+			warning("MIDI cache path '%s' is not a directory", directory.getPath().c_str());
+	}
+
+	// Loading and storing the cached output is left to a timer, the mixer
+	// must not wait for the files
+	if (_renderCache)
+		g_system->getTimerManager()->installTimerProc(renderCacheTimer, 50000, this, "MidiRenderCache");
+
+	return 0;
+}
+
+bool MidiDriver_Emulated::cacheEvent(uint32 b) {
+	Common::StackLock lock(_renderCacheMutex);
+	return _renderCache && _renderCache->send(b);
+}
+
+bool MidiDriver_Emulated::cacheSysEx(const byte *msg, uint16 length) {
+	Common::StackLock lock(_renderCacheMutex);
+	return _renderCache && _renderCache->sysEx(msg, length);
+}
+
+void MidiDriver_Emulated::musicLooped() {
+	Common::StackLock lock(_renderCacheMutex);
+	if (_renderCache)
+		_renderCache->loop();
+}
+
+void MidiDriver_Emulated::musicStopped() {
+	Common::StackLock lock(_renderCacheMutex);
+	if (_renderCache)
+		_renderCache->stop();
+}
+
+int MidiDriver_Emulated::readBuffer(int16 *data, const int numSamples) {
+	const int stereoFactor = isStereo() ? 2 : 1;
+	int len = numSamples / stereoFactor;
+	int step;
+
+	do {
+		step = len;
+		if (step > (_nextTick >> FIXP_SHIFT))
+			step = (_nextTick >> FIXP_SHIFT);
+
+		if (!_renderCache) {
+			generateSamples(data, step);
+		} else {
+			bool replayed;
+			{
+				Common::StackLock lock(_renderCacheMutex);
+				replayed = _renderCache->replay(data, step);
+			}
+
+			// The synthesizer does not need the lock, which keeps drivers
+			// sending events from other threads from waiting for it
+			if (!replayed) {
+				generateSamples(data, step);
+
+				Common::StackLock lock(_renderCacheMutex);
+				_renderCache->record(data, step);
+			}
+		}
+
+		_nextTick -= step << FIXP_SHIFT;
+		if (!(_nextTick >> FIXP_SHIFT)) {
+			if (_timerProc)
+				(*_timerProc)(_timerParam);
+
+			onTimer();
+
+			if (_renderCache) {
+				Common::StackLock lock(_renderCacheMutex);
+				_renderCache->tick();
+			}
+
+			_nextTick += _samplesPerTick;
+		}
+
+		data += step * stereoFactor;
+		len -= step;
+	} while (len);
+
+	return numSamples;
+}
@@ -26,6 +26,9 @@
 #include "audio/audiostream.h"
 #include "audio/mididrv.h"
 #include "audio/mixer.h"
+#include "common/mutex.h"
+
+class MidiRenderCache;
 
 class MidiDriver_Emulated : public Audio::AudioStream, public MidiDriver {
 protected:
@@ -44,12 +47,35 @@ private:
 	int _nextTick;
 	int _samplesPerTick;
 
+	MidiRenderCache *_renderCache;
+	Common::Mutex _renderCacheMutex;
+
+	static void renderCacheTimer(void *refCon);
+
 protected:
 	int _baseFreq;
 
 	virtual void generateSamples(int16 *buf, int len) = 0;
 	virtual void onTimer() {}
 
+	/**
+	 * Return a description of the synthesizer and its settings, which
+	 * identifies its output in the render cache. The default empty string
+	 * means the output of the driver is never cached.
+	 */
+	virtual Common::String getRenderCacheConfig() { return Common::String(); }
+
+	/**
+	 * Let the render cache follow an event before it reaches the
+	 * synthesizer. Drivers supporting the cache call these first in
+	 * send() and sysEx().
+	 *
+	 * @return true if the event must be dropped, as the cache plays back
+	 *         the output it belongs to
+	 */
+	bool cacheEvent(uint32 b);
+	bool cacheSysEx(const byte *msg, uint16 length);
+
 public:
 	MidiDriver_Emulated(Audio::Mixer *mixer) :
 		_mixer(mixer),
@@ -58,23 +84,14 @@ public:
 		_timerParam(0),
 		_nextTick(0),
 		_samplesPerTick(0),
+		_renderCache(0),
 		_baseFreq(250) {
 	}
 
-	// MidiDriver API
-	virtual int open() {
-		_isOpen = true;
-
-		int d = getRate() / _baseFreq;
-		int r = getRate() % _baseFreq;
-
-		// This is equivalent to (getRate() << FIXP_SHIFT) / BASE_FREQ
-		// but less prone to arithmetic overflow.
-
-		_samplesPerTick = (d << FIXP_SHIFT) + (r << FIXP_SHIFT) / _baseFreq;
+	virtual ~MidiDriver_Emulated();
 
-		return 0;
-	}
+	// MidiDriver API
+	virtual int open();
 
 	bool isOpen() const { return _isOpen; }
 
@@ -87,35 +104,12 @@ public:
 		return 1000000 / _baseFreq;
 	}
 
-	// AudioStream API
-	virtual int readBuffer(int16 *data, const int numSamples) {
-		const int stereoFactor = isStereo() ? 2 : 1;
-		int len = numSamples / stereoFactor;
-		int step;
-
-		do {
-			step = len;
-			if (step > (_nextTick >> FIXP_SHIFT))
-				step = (_nextTick >> FIXP_SHIFT);
-
-			generateSamples(data, step);
-
-			_nextTick -= step << FIXP_SHIFT;
-			if (!(_nextTick >> FIXP_SHIFT)) {
-				if (_timerProc)
-					(*_timerProc)(_timerParam);
-
-				onTimer();
+	// MidiDriver_BASE API
+	virtual void musicLooped();
+	virtual void musicStopped();
 
-				_nextTick += _samplesPerTick;
-			}
-
-			data += step * stereoFactor;
-			len -= step;
-		} while (len);
-
-		return numSamples;
-	}
+	// AudioStream API
+	virtual int readBuffer(int16 *data, const int numSamples);
 
 	virtual bool endOfData() const {
 		return false;
@@ -52,6 +52,7 @@ protected:
 	void setStr(const char *name, const char *str);
 
 	void generateSamples(int16 *buf, int len);
+	Common::String getRenderCacheConfig();
 
 public:
 	MidiDriver_FluidSynth(Audio::Mixer *mixer);
@@ -217,7 +218,26 @@ void MidiDriver_FluidSynth::close() {
 	delete_fluid_settings(_settings);
 }
 
+Common::String MidiDriver_FluidSynth::getRenderCacheConfig() {
+	// All the settings open() passes to FluidSynth make a difference to the output
+	static const char *const keys[] = {
+		"soundfont", "midi_gain",
+		"fluidsynth_chorus_activate", "fluidsynth_chorus_nr", "fluidsynth_chorus_level",
+		"fluidsynth_chorus_speed", "fluidsynth_chorus_depth", "fluidsynth_chorus_waveform",
+		"fluidsynth_reverb_activate", "fluidsynth_reverb_roomsize", "fluidsynth_reverb_damping",
+		"fluidsynth_reverb_width", "fluidsynth_reverb_level", "fluidsynth_misc_interpolation"
+	};
+
+	Common::String config = "fluidsynth";
+	for (int i = 0; i < ARRAYSIZE(keys); ++i)
+		config += " " + ConfMan.get(keys[i]);
+	return config;
+}
+
 void MidiDriver_FluidSynth::send(uint32 b) {
+	if (cacheEvent(b))
+		return;
+
 	//byte param3 = (byte) ((b >> 24) & 0xFF);
 	uint param2 = (byte) ((b >> 16) & 0xFF);
 	uint param1 = (byte) ((b >>  8) & 0xFF);
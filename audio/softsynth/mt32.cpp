@@ -115,6 +115,7 @@ private:
 
 protected:
 	void generateSamples(int16 *buf, int len);
+	Common::String getRenderCacheConfig();
 
 public:
 	MidiDriver_MT32(Audio::Mixer *mixer);
@@ -227,6 +228,9 @@ int MidiDriver_MT32::open() {
 }
 
 void MidiDriver_MT32::send(uint32 b) {
+	if (cacheEvent(b))
+		return;
+
 	Common::StackLock lock(_mutex);
 	_service.playMsg(b);
 }
@@ -237,12 +241,17 @@ void MidiDriver_MT32::setPitchBendRange(byte channel, uint range) {
 	if (range > 24) {
 		warning("setPitchBendRange() called with range > 24: %d", range);
 	}
-	byte benderRangeSysex[4] = { 0, 0, 4, (uint8)range };
-	Common::StackLock lock(_mutex);
-	_service.writeSysex(channel, benderRangeSysex, 4);
+	// Send it as a DT1 SysEx message writing to the part's patch temporary
+	// area, so the render cache follows it like any other SysEx
+	byte benderRangeSysex[9] = { 0x41, channel, 0x16, 0x12, 0, 0, 4, (uint8)range, 0 };
+	benderRangeSysex[8] = (128 - ((4 + range) & 0x7F)) & 0x7F;
+	sysEx(benderRangeSysex, 9);
 }
 
 void MidiDriver_MT32::sysEx(const byte *msg, uint16 length) {
+	if (cacheSysEx(msg, length))
+		return;
+
 	if (msg[0] == 0xf0) {
 		Common::StackLock lock(_mutex);
 		_service.playSysex(msg, length);
@@ -285,6 +294,13 @@ void MidiDriver_MT32::generateSamples(int16 *data, int len) {
 	_service.renderBit16s(data, len);
 }
 
+Common::String MidiDriver_MT32::getRenderCacheConfig() {
+	// The ROMs and the gain make a difference to the output
+	mt32emu_rom_info romInfo;
+	_service.getROMInfo(&romInfo);
+	return Common::String::format("mt32 %s %s %d", romInfo.control_rom_id, romInfo.pcm_rom_id, ConfMan.getInt("midi_gain"));
+}
+
 uint32 MidiDriver_MT32::property(int prop, uint32 param) {
 	switch (prop) {
 	case PROP_CHANNEL_MASK:
@@ -18,6 +18,8 @@
 #ifndef MT32EMU_TABLES_H
 #define MT32EMU_TABLES_H
 
+#include <cstddef>
+
 #include "globals.h"
 #include "Types.h"
 
@@ -29,8 +31,14 @@ private:
 	Tables(Tables &);
 	~Tables() {}
 
+	static const Tables *instance;
+	static const Tables &createInstance();
+
 public:
-	static const Tables &getInstance();
+	// Inline, as the wave generators look up the tables several times for every output sample.
+	static const Tables &getInstance() {
+		return instance != NULL ? *instance : createInstance();
+	}
 
 	// Constant LUTs
 
@@ -54,6 +62,10 @@ public:
 	Bit16u exp9[512];
 	Bit16u logsin9[512];
 
+	// The values of exp9 linearly interpolated for every 12-bit fraction, as the LA32 chip does it using the table of differences.
+	// Precomputed as the wave generators need one of them for every output sample of every partial.
+	Bit16u interpolatedExp[4096];
+
 	const Bit8u *resAmpDecayFactor;
 }; // class Tables
 
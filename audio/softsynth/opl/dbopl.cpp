@@ -35,6 +35,7 @@
 // Last synch with DOSBox SVN trunk r3752
 
 #include "dbopl.h"
+#include "common/cpudetect.h"
 
 #ifndef DISABLE_DOSBOX_OPL
 
@@ -146,7 +147,8 @@ static Bit16u SinTable[ 512 ];
 
 //6 is just 0 shifted and masked
 
-static Bit16s WaveTable[ 8 * 512 ];
+//One extra entry so the vectorized block renderer can read 32 bits at the last index
+static Bit16s WaveTable[ 8 * 512 + 1 ];
 //Distance into WaveTable the wave starts
 static const Bit16u WaveBaseTable[8] = {
 	0x000, 0x200, 0x200, 0x800,
@@ -596,6 +598,119 @@ INLINE Bits Operator::GetSample( Bits modulation ) {
 	}
 }
 
+#if ( DBOPL_WAVE == WAVE_TABLEMUL )
+INLINE Bitu Operator::RateSteps( Bit32u add ) const {
+	//Samples RateForward can do before it returns something other than 0
+	if ( !add )
+		return ~(Bitu)0;
+	return ( RATE_MASK - rateIndex ) / add;
+}
+
+static INLINE void FillMul( Bit16u* mul, Bitu count, Bit16u m ) {
+	//Copying a small pattern turns into vector stores on most compilers
+	Bit16u pattern[ 8 ] = { m, m, m, m, m, m, m, m };
+	Bitu i = 0;
+	for ( ; i + 8 <= count; i += 8 )
+		memcpy( mul + i, pattern, sizeof( pattern ) );
+	for ( ; i < count; i++ )
+		mul[i] = m;
+}
+
+template< Operator::State yes >
+INLINE Bitu Operator::EnvelopeTemplate( Bitu i, Bitu samples, Bit16u* mul, Bit16u& audible ) {
+	while ( i < samples && state == yes ) {
+		//Find how long the volume holds still, without changing the state
+		Bitu run = samples - i;
+		Bit32u add = 0;
+		switch ( yes ) {
+		case OFF:
+			break;
+		case ATTACK:
+			add = attackAdd;
+			run = RateSteps( add );
+			break;
+		case DECAY:
+			add = decayAdd;
+			run = volume < sustainLevel ? RateSteps( add ) : 0;
+			break;
+		case SUSTAIN:
+			if ( reg20 & MASK_SUSTAIN )
+				break;
+			//fall through
+		case RELEASE:
+			add = releaseAdd;
+			run = volume < ENV_MAX ? RateSteps( add ) : 0;
+			break;
+		}
+		//A silent sample gets a zero multiplier, which gives the same 0 as GetSample
+		if ( run ) {
+			if ( run > samples - i )
+				run = samples - i;
+			rateIndex += add * run;
+			Bitu vol = currentLevel + ( yes == OFF ? ENV_MAX : volume );
+			Bit16u m = ENV_SILENT( vol ) ? 0 : MulTable[ vol >> ENV_EXTRA ];
+			FillMul( mul + i, run, m );
+			audible |= m;
+			i += run;
+		} else {
+			Bitu vol = currentLevel + TemplateVolume< yes >();
+			Bit16u m = ENV_SILENT( vol ) ? 0 : MulTable[ vol >> ENV_EXTRA ];
+			mul[i++] = m;
+			audible |= m;
+		}
+	}
+	return i;
+}
+
+bool Operator::GenerateEnvelope( Bitu samples, Bit16u* mul ) {
+	//Same as calling the volume handler for every sample, but skipping ahead while the volume holds
+	Bit16u audible = 0;
+	for ( Bitu i = 0; i < samples; ) {
+		switch ( state ) {
+		case OFF:
+			i = EnvelopeTemplate< OFF >( i, samples, mul, audible );
+			break;
+		case RELEASE:
+			i = EnvelopeTemplate< RELEASE >( i, samples, mul, audible );
+			break;
+		case SUSTAIN:
+			i = EnvelopeTemplate< SUSTAIN >( i, samples, mul, audible );
+			break;
+		case DECAY:
+			i = EnvelopeTemplate< DECAY >( i, samples, mul, audible );
+			break;
+		case ATTACK:
+			i = EnvelopeTemplate< ATTACK >( i, samples, mul, audible );
+			break;
+		}
+	}
+	return audible != 0;
+}
+
+void Operator::GenerateBlock( WaveBlockHandler handler, const Bit32s* modulation, Bitu samples, Bit32s* output ) {
+	Bit16u mul[ WAVE_BLOCK ];
+	if ( !GenerateEnvelope( samples, mul ) ) {
+		waveIndex += waveCurrent * samples;
+		memset( output, 0, sizeof( Bit32s ) * samples );
+		return;
+	}
+	WaveBlock block;
+	block.waveBase = waveBase;
+	block.waveMask = waveMask;
+	block.waveIndex = waveIndex;
+	block.waveCurrent = waveCurrent;
+	block.waveShift = WAVE_SH;
+	Bitu done = handler( block, modulation, mul, output, samples );
+	waveIndex += waveCurrent * done;
+	for ( Bitu i = done; i < samples; i++ ) {
+		Bitu index = ForwardWave();
+		if ( modulation )
+			index += modulation[i];
+		output[i] = (waveBase[ index & waveMask ] * mul[i]) >> MUL_SH;
+	}
+}
+#endif
+
 Operator::Operator() {
 	chanData = 0;
 	freqMul = 0;
@@ -912,6 +1027,15 @@ Channel* Channel::BlockTemplate( Chip* chip, Bit32u samples, Bit32s* output ) {
 		Op( 4 )->Prepare( chip );
 		Op( 5 )->Prepare( chip );
 	}
+#if ( DBOPL_WAVE == WAVE_TABLEMUL )
+	//Leave two operator channels to GenerateBatch
+	if ( mode < sm4Start && chip->waveBlockHandler ) {
+		chip->batch[ chip->batchCount ] = this;
+		chip->batchAM[ chip->batchCount ] = ( mode == sm2AM || mode == sm3AM );
+		chip->batchCount++;
+		return ( this + 1 );
+	}
+#endif
 	for ( Bitu i = 0; i < samples; i++ ) {
 		//Early out for percussion handlers
 		if ( mode == sm2Percussion ) {
@@ -1025,6 +1149,10 @@ Chip::Chip() {
 	regBD = 0;
 	reg104 = 0;
 	opl3Active = 0;
+#if ( DBOPL_WAVE == WAVE_TABLEMUL )
+	waveBlockHandler = 0;
+	batchCount = 0;
+#endif
 }
 
 INLINE Bit32u Chip::ForwardNoise() {
@@ -1220,6 +1348,123 @@ Bit32u Chip::WriteAddr( Bit32u port, Bit8u val ) {
 	return 0;
 }
 
+#if ( DBOPL_WAVE == WAVE_TABLEMUL )
+//The self modulating first operator of a channel, rendered by GenerateFeedback
+struct FeedbackLane {
+	Bit32s old0, old1;
+	const Bit16s* waveBase;
+	Bit32u waveMask;
+	Bit8u feedback;
+	const Bit32u* phase;
+	const Bit16u* mul;
+	Bit32s* out;
+
+	//Same as GetSample with the volume and wave counter already known
+	INLINE void Step( Bitu i ) {
+		Bit32s mod = (Bit32u)((old0 + old1)) >> feedback;
+		old0 = old1;
+		Bitu index = phase[i] + mod;
+		old1 = (waveBase[ index & waveMask ] * mul[i]) >> MUL_SH;
+		out[i] = old0;
+	}
+};
+
+//Render the first operators of several channels side by side. The feedback makes each
+//sample depend on the previous two, doing several channels lets the cpu overlap them
+template< Bitu lanes >
+static void GenerateFeedback( Channel* const* chans, const Bit16u (*mul)[ WAVE_BLOCK ], Bit32s (*out)[ WAVE_BLOCK ], Bitu samples ) {
+	Bit32u phase[ lanes ][ WAVE_BLOCK ];
+	FeedbackLane lane[ lanes ];
+	for ( Bitu l = 0; l < lanes; l++ ) {
+		//The wave counter doesn't depend on the feedback, so it's done up front
+		Operator* op = chans[l]->Op( 0 );
+		Bit32u waveIndex = op->waveIndex;
+		for ( Bitu i = 0; i < samples; i++ ) {
+			waveIndex += op->waveCurrent;
+			phase[l][i] = waveIndex >> WAVE_SH;
+		}
+		op->waveIndex = waveIndex;
+		lane[l].old0 = chans[l]->old[0];
+		lane[l].old1 = chans[l]->old[1];
+		lane[l].waveBase = op->waveBase;
+		lane[l].waveMask = op->waveMask;
+		lane[l].feedback = chans[l]->feedback;
+		lane[l].phase = phase[l];
+		lane[l].mul = mul[l];
+		lane[l].out = out[l];
+	}
+	//Written out so each lane can stay in registers
+	for ( Bitu i = 0; i < samples; i++ ) {
+		lane[0].Step( i );
+		if ( lanes > 1 )
+			lane[1 % lanes].Step( i );
+		if ( lanes > 2 )
+			lane[2 % lanes].Step( i );
+		if ( lanes > 3 )
+			lane[3 % lanes].Step( i );
+	}
+	for ( Bitu l = 0; l < lanes; l++ ) {
+		chans[l]->old[0] = lane[l].old0;
+		chans[l]->old[1] = lane[l].old1;
+	}
+}
+
+template< bool opl3Mode >
+void Chip::GenerateBatch( Bitu total, Bit32s* output ) {
+	Bit16u mul[ BATCH_LANES ][ WAVE_BLOCK ];
+	Bit32s out0[ BATCH_LANES ][ WAVE_BLOCK ];
+	Bit32s out1[ WAVE_BLOCK ];
+	//Spread the channels evenly over the groups, a group with a single channel can't overlap anything
+	Bitu groups = ( batchCount + BATCH_LANES - 1 ) / BATCH_LANES;
+	while ( total > 0 ) {
+		Bitu samples = total < WAVE_BLOCK ? total : WAVE_BLOCK;
+		Bitu lanes;
+		for ( Bitu first = 0, group = 0; first < batchCount; first += lanes, group++ ) {
+			Channel* const* chans = batch + first;
+			lanes = ( batchCount - first ) / ( groups - group );
+			for ( Bitu l = 0; l < lanes; l++ )
+				chans[l]->Op( 0 )->GenerateEnvelope( samples, mul[l] );
+			switch ( lanes ) {
+			case 1:
+				GenerateFeedback< 1 >( chans, mul, out0, samples );
+				break;
+			case 2:
+				GenerateFeedback< 2 >( chans, mul, out0, samples );
+				break;
+			case 3:
+				GenerateFeedback< 3 >( chans, mul, out0, samples );
+				break;
+			default:
+				GenerateFeedback< BATCH_LANES >( chans, mul, out0, samples );
+				break;
+			}
+			for ( Bitu l = 0; l < lanes; l++ ) {
+				Channel* ch = chans[l];
+				if ( batchAM[ first + l ] ) {
+					ch->Op( 1 )->GenerateBlock( waveBlockHandler, 0, samples, out1 );
+					for ( Bitu i = 0; i < samples; i++ )
+						out1[i] += out0[l][i];
+				} else {
+					ch->Op( 1 )->GenerateBlock( waveBlockHandler, out0[l], samples, out1 );
+				}
+				if ( opl3Mode ) {
+					for ( Bitu i = 0; i < samples; i++ ) {
+						output[ i * 2 + 0 ] += out1[i] & ch->maskLeft;
+						output[ i * 2 + 1 ] += out1[i] & ch->maskRight;
+					}
+				} else {
+					for ( Bitu i = 0; i < samples; i++ )
+						output[i] += out1[i];
+				}
+			}
+		}
+		total -= samples;
+		output += opl3Mode ? samples * 2 : samples;
+	}
+	batchCount = 0;
+}
+#endif
+
 void Chip::GenerateBlock2( Bitu total, Bit32s* output ) {
 	while ( total > 0 ) {
 		Bit32u samples = ForwardLFO( total );
@@ -1229,6 +1474,9 @@ void Chip::GenerateBlock2( Bitu total, Bit32s* output ) {
 			count++;
 			ch = (ch->*(ch->synthHandler))( this, samples, output );
 		}
+#if ( DBOPL_WAVE == WAVE_TABLEMUL )
+		GenerateBatch< false >( samples, output );
+#endif
 		total -= samples;
 		output += samples;
 	}
@@ -1243,6 +1491,9 @@ void Chip::GenerateBlock3( Bitu total, Bit32s* output  ) {
 			count++;
 			ch = (ch->*(ch->synthHandler))( this, samples, output );
 		}
+#if ( DBOPL_WAVE == WAVE_TABLEMUL )
+		GenerateBatch< true >( samples, output );
+#endif
 		total -= samples;
 		output += samples * 2;
 	}
@@ -1251,6 +1502,22 @@ void Chip::GenerateBlock3( Bitu total, Bit32s* output  ) {
 void Chip::Setup( Bit32u rate ) {
 	double scale = OPLRATE / (double)rate;
 
+#if ( DBOPL_WAVE == WAVE_TABLEMUL )
+	waveBlockHandler = 0;
+#ifdef SCUMMVM_AVX2
+	if ( !waveBlockHandler && Common::hasCPUFeature( Common::kCPUFeatureAVX2 ) )
+		waveBlockHandler = WaveBlockAVX2;
+#endif
+#ifdef SCUMMVM_SSE2
+	if ( !waveBlockHandler && Common::hasCPUFeature( Common::kCPUFeatureSSE2 ) )
+		waveBlockHandler = WaveBlockSSE2;
+#endif
+#ifdef SCUMMVM_NEON
+	if ( !waveBlockHandler && Common::hasCPUFeature( Common::kCPUFeatureNEON ) )
+		waveBlockHandler = WaveBlockNEON;
+#endif
+#endif
+
 	//Noise counter is run at the same precision as general waves
 	noiseAdd = (Bit32u)( 0.5 + scale * ( 1 << LFO_SH ) );
 	noiseCounter = 0;
@@ -69,6 +69,36 @@ typedef Bits ( DB_FASTCALL *WaveHandler) ( Bitu i, Bitu volume );
 typedef Bits ( DBOPL::Operator::*VolumeHandler) ( );
 typedef Channel* ( DBOPL::Channel::*SynthHandler) ( Chip* chip, Bit32u samples, Bit32s* output );
 
+#if (DBOPL_WAVE == WAVE_TABLEMUL)
+//Most samples an operator renders in one go with a WaveBlockHandler
+#define WAVE_BLOCK	256
+//Two operator channels rendered side by side
+#define BATCH_LANES	4
+
+//Wave generator state of an operator at the start of a block
+struct WaveBlock {
+	const Bit16s* waveBase;
+	Bit32u waveMask;
+	Bit32u waveIndex;
+	Bit32u waveCurrent;
+	Bit32u waveShift;
+};
+
+//Render output[i] = ( wave[ ( index >> shift ) + modulation[i] ] * mul[i] ) >> 16 for a block of samples
+//modulation can be 0, returns the amount of samples handled, the caller does the remainder
+typedef Bitu ( *WaveBlockHandler ) ( const WaveBlock& block, const Bit32s* modulation, const Bit16u* mul, Bit32s* output, Bitu samples );
+
+#ifdef SCUMMVM_SSE2
+Bitu WaveBlockSSE2( const WaveBlock& block, const Bit32s* modulation, const Bit16u* mul, Bit32s* output, Bitu samples );
+#endif
+#ifdef SCUMMVM_AVX2
+Bitu WaveBlockAVX2( const WaveBlock& block, const Bit32s* modulation, const Bit16u* mul, Bit32s* output, Bitu samples );
+#endif
+#ifdef SCUMMVM_NEON
+Bitu WaveBlockNEON( const WaveBlock& block, const Bit32s* modulation, const Bit16u* mul, Bit32s* output, Bitu samples );
+#endif
+#endif
+
 //Different synth modes that can generate blocks of data
 typedef enum {
 	sm2AM,
@@ -178,6 +208,15 @@ public:
 
 	Bits GetSample( Bits modulation );
 	Bits GetWave( Bitu index, Bitu vol );
+#if (DBOPL_WAVE == WAVE_TABLEMUL)
+	Bitu RateSteps( Bit32u add ) const;
+	template< State state>
+	Bitu EnvelopeTemplate( Bitu i, Bitu samples, Bit16u* mul, Bit16u& audible );
+	//Step the envelope for a block, storing the MulTable entries, false when it's silent all along
+	bool GenerateEnvelope( Bitu samples, Bit16u* mul );
+	//Same as calling GetSample for every sample, at most WAVE_BLOCK samples
+	void GenerateBlock( WaveBlockHandler handler, const Bit32s* modulation, Bitu samples, Bit32s* output );
+#endif
 public:
 	Operator();
 };
@@ -253,6 +292,14 @@ struct Chip {
 	Bit8u waveFormMask;
 	//0 or -1 when enabled
 	Bit8s opl3Active;
+#if (DBOPL_WAVE == WAVE_TABLEMUL)
+	//Vectorized block renderer for the cpu we're on, 0 to render sample by sample
+	WaveBlockHandler waveBlockHandler;
+	//Two operator channels left by their synth handlers to render together
+	Channel* batch[ 18 ];
+	bool batchAM[ 18 ];
+	Bitu batchCount;
+#endif
 
 	//Return the maximum amount of samples before and LFO change
 	Bit32u ForwardLFO( Bit32u samples );
@@ -263,6 +310,10 @@ struct Chip {
 
 	Bit32u WriteAddr( Bit32u port, Bit8u val );
 
+#if (DBOPL_WAVE == WAVE_TABLEMUL)
+	template< bool opl3Mode >
+	void GenerateBatch( Bitu samples, Bit32s* output );
+#endif
 	void GenerateBlock2( Bitu samples, Bit32s* output );
 	void GenerateBlock3( Bitu samples, Bit32s* output );
 
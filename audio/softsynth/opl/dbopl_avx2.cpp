@@ -0,0 +1,71 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/softsynth/opl/dbopl.h"
+
+#ifndef DISABLE_DOSBOX_OPL
+#if (DBOPL_WAVE == WAVE_TABLEMUL)
+
+#include <immintrin.h>
+
+namespace OPL {
+namespace DOSBox {
+namespace DBOPL {
+
+Bitu WaveBlockAVX2(const WaveBlock &block, const Bit32s *modulation, const Bit16u *mul, Bit32s *output, Bitu samples) {
+	const __m128i shift = _mm_cvtsi32_si128(block.waveShift);
+	const __m256i mask = _mm256_set1_epi32(block.waveMask);
+	const __m256i step = _mm256_set1_epi32(block.waveCurrent * 8);
+	// The gathers below load 32 bits per sample, the wave table has an extra
+	// entry at the end so this never reads past it
+	const int *waveBase = (const int *)block.waveBase;
+
+	// The counter is forwarded before each sample
+	__m256i index = _mm256_add_epi32(_mm256_set1_epi32(block.waveIndex),
+		_mm256_mullo_epi32(_mm256_set1_epi32(block.waveCurrent), _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 8)));
+
+	Bitu i = 0;
+	for (; i + 8 <= samples; i += 8) {
+		__m256i pos = _mm256_srl_epi32(index, shift);
+		if (modulation)
+			pos = _mm256_add_epi32(pos, _mm256_loadu_si256((const __m256i *)(modulation + i)));
+		pos = _mm256_and_si256(pos, mask);
+
+		// Keep the low 16 bits of each gathered value, sign extended
+		__m256i wave = _mm256_i32gather_epi32(waveBase, pos, 2);
+		wave = _mm256_srai_epi32(_mm256_slli_epi32(wave, 16), 16);
+
+		const __m256i m = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(mul + i)));
+		_mm256_storeu_si256((__m256i *)(output + i), _mm256_srai_epi32(_mm256_mullo_epi32(wave, m), 16));
+
+		index = _mm256_add_epi32(index, step);
+	}
+
+	return i;
+}
+
+} // End of namespace DBOPL
+} // End of namespace DOSBox
+} // End of namespace OPL
+
+#endif
+#endif // !DISABLE_DOSBOX_OPL
@@ -0,0 +1,82 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/softsynth/opl/dbopl.h"
+
+#ifndef DISABLE_DOSBOX_OPL
+#if (DBOPL_WAVE == WAVE_TABLEMUL)
+
+#include <arm_neon.h>
+
+namespace OPL {
+namespace DOSBox {
+namespace DBOPL {
+
+Bitu WaveBlockNEON(const WaveBlock &block, const Bit32s *modulation, const Bit16u *mul, Bit32s *output, Bitu samples) {
+	// A negative shift count shifts right
+	const int32x4_t shift = vdupq_n_s32(-(int32)block.waveShift);
+	const uint32x4_t mask = vdupq_n_u32(block.waveMask);
+	const uint32x4_t step = vdupq_n_u32(block.waveCurrent * 8);
+	const Bit16s *waveBase = block.waveBase;
+
+	// The counter is forwarded before each sample
+	const Bit32u add = block.waveCurrent;
+	const Bit32u start[4] = { block.waveIndex + add, block.waveIndex + add * 2, block.waveIndex + add * 3, block.waveIndex + add * 4 };
+	uint32x4_t index0 = vld1q_u32(start);
+	uint32x4_t index1 = vaddq_u32(index0, vdupq_n_u32(add * 4));
+
+	Bitu i = 0;
+	for (; i + 8 <= samples; i += 8) {
+		uint32x4_t pos0 = vshlq_u32(index0, shift);
+		uint32x4_t pos1 = vshlq_u32(index1, shift);
+		if (modulation) {
+			pos0 = vaddq_u32(pos0, vreinterpretq_u32_s32(vld1q_s32(modulation + i)));
+			pos1 = vaddq_u32(pos1, vreinterpretq_u32_s32(vld1q_s32(modulation + i + 4)));
+		}
+
+		Bit32u pos[8];
+		vst1q_u32(pos, vandq_u32(pos0, mask));
+		vst1q_u32(pos + 4, vandq_u32(pos1, mask));
+		Bit16s waves[8];
+		for (int j = 0; j < 8; j++)
+			waves[j] = waveBase[pos[j]];
+
+		const int16x8_t wave = vld1q_s16(waves);
+		const uint16x8_t m = vld1q_u16(mul + i);
+		const int32x4_t p0 = vmulq_s32(vmovl_s16(vget_low_s16(wave)), vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(m))));
+		const int32x4_t p1 = vmulq_s32(vmovl_s16(vget_high_s16(wave)), vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(m))));
+		vst1q_s32(output + i, vshrq_n_s32(p0, 16));
+		vst1q_s32(output + i + 4, vshrq_n_s32(p1, 16));
+
+		index0 = vaddq_u32(index0, step);
+		index1 = vaddq_u32(index1, step);
+	}
+
+	return i;
+}
+
+} // End of namespace DBOPL
+} // End of namespace DOSBox
+} // End of namespace OPL
+
+#endif
+#endif // !DISABLE_DOSBOX_OPL
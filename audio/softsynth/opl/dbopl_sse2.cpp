@@ -0,0 +1,91 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/softsynth/opl/dbopl.h"
+
+#ifndef DISABLE_DOSBOX_OPL
+#if (DBOPL_WAVE == WAVE_TABLEMUL)
+
+#include <emmintrin.h>
+
+namespace OPL {
+namespace DOSBox {
+namespace DBOPL {
+
+/**
+ * Multiply eight signed wave samples by eight unsigned multipliers and return
+ * the high halves of the products, which equals shifting them right by 16.
+ * The unsigned high multiply is corrected by the multiplier where the wave
+ * sample is negative.
+ */
+static inline __m128i mulWave(__m128i wave, __m128i mul) {
+	const __m128i hi = _mm_mulhi_epu16(wave, mul);
+	return _mm_sub_epi16(hi, _mm_and_si128(_mm_srai_epi16(wave, 15), mul));
+}
+
+Bitu WaveBlockSSE2(const WaveBlock &block, const Bit32s *modulation, const Bit16u *mul, Bit32s *output, Bitu samples) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i shift = _mm_cvtsi32_si128(block.waveShift);
+	const __m128i mask = _mm_set1_epi32(block.waveMask);
+	const __m128i step = _mm_set1_epi32(block.waveCurrent * 8);
+	const Bit16s *waveBase = block.waveBase;
+
+	// The counter is forwarded before each sample
+	const Bit32u add = block.waveCurrent;
+	__m128i index0 = _mm_setr_epi32(block.waveIndex + add, block.waveIndex + add * 2, block.waveIndex + add * 3, block.waveIndex + add * 4);
+	__m128i index1 = _mm_add_epi32(index0, _mm_set1_epi32(add * 4));
+
+	Bitu i = 0;
+	for (; i + 8 <= samples; i += 8) {
+		__m128i pos0 = _mm_srl_epi32(index0, shift);
+		__m128i pos1 = _mm_srl_epi32(index1, shift);
+		if (modulation) {
+			pos0 = _mm_add_epi32(pos0, _mm_loadu_si128((const __m128i *)(modulation + i)));
+			pos1 = _mm_add_epi32(pos1, _mm_loadu_si128((const __m128i *)(modulation + i + 4)));
+		}
+		pos0 = _mm_and_si128(pos0, mask);
+		pos1 = _mm_and_si128(pos1, mask);
+
+		// There is no gather, so fetch the wave samples one by one
+		Bit32u pos[8];
+		_mm_storeu_si128((__m128i *)pos, pos0);
+		_mm_storeu_si128((__m128i *)(pos + 4), pos1);
+		const __m128i wave = _mm_setr_epi16(waveBase[pos[0]], waveBase[pos[1]], waveBase[pos[2]], waveBase[pos[3]],
+		                                    waveBase[pos[4]], waveBase[pos[5]], waveBase[pos[6]], waveBase[pos[7]]);
+
+		const __m128i hi = mulWave(wave, _mm_loadu_si128((const __m128i *)(mul + i)));
+		_mm_storeu_si128((__m128i *)(output + i), _mm_srai_epi32(_mm_unpacklo_epi16(zero, hi), 16));
+		_mm_storeu_si128((__m128i *)(output + i + 4), _mm_srai_epi32(_mm_unpackhi_epi16(zero, hi), 16));
+
+		index0 = _mm_add_epi32(index0, step);
+		index1 = _mm_add_epi32(index1, step);
+	}
+
+	return i;
+}
+
+} // End of namespace DBOPL
+} // End of namespace DOSBox
+} // End of namespace OPL
+
+#endif
+#endif // !DISABLE_DOSBOX_OPL
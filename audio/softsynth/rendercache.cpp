@@ -0,0 +1,813 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/softsynth/rendercache.h"
+#include "audio/mididrv.h"
+
+#include "common/debug.h"
+#include "common/endian.h"
+#include "common/stream.h"
+#include "common/textconsole.h"
+#include "common/zlib.h"
+
+// The events of a pass are stored in <name>.evt:
+//   uint32 tag 'MRC1', uint32 channels, uint32 ticks, uint32 frames, uint32 event count,
+//   then for every event uint32 tick, uint32 msg, uint16 SysEx length and the SysEx data.
+// Its output is stored gzip compressed in <name>.pcm, as the 16 bit little endian
+// differences between consecutive samples of every channel, which compress
+// much better than the samples themselves.
+
+enum {
+	kFNVOffset = 2166136261u,
+	kFNVPrime = 16777619u,
+	kBlockSamples = 512,
+	kSliceSamples = 16384,		// The most samples a job reads or writes
+	kSkipSamples = 4 * kSliceSamples,	// The most samples a job skips to catch up with the playback
+	kRingSamples = 131072,		// The samples read ahead, 2 seconds of 32 kHz stereo output
+	kMaxBacklogSamples = 1048576	// The most samples waiting to be written
+};
+
+static uint32 hashBytes(uint32 hash, const byte *data, uint32 length) {
+	for (uint32 i = 0; i < length; ++i)
+		hash = (hash ^ data[i]) * kFNVPrime;
+	return hash;
+}
+
+struct MidiRenderCache::Job {
+	enum Type {
+		kTypeOpen,	///< Read the events of a stored pass and open its output
+		kTypeWrite,	///< Write a slice of the output of a recording
+		kTypeFinish,	///< Complete the files of a recording
+		kTypeFill,	///< Read a slice of the output of a stored pass
+		kTypeClose	///< Delete retired recordings and players
+	};
+
+	Job(Type t) : type(t), recording(0), player(0), position(0), success(false) {}
+
+	Type type;
+	Recording *recording;
+	Player *player;
+	Common::Array<int16> samples;	///< The samples to write, or read
+	uint64 position;		///< The stream position to read from
+	bool success;
+	Common::Array<Recording *> recordings;
+	Common::Array<Player *> players;
+};
+
+void MidiRenderCache::Pass::addEvent(uint32 tick, uint32 msg, const byte *data, uint16 length) {
+	Event event;
+	event.tick = tick;
+	event.msg = msg;
+	event.sysExOffset = sysExData.size();
+	event.sysExLength = length;
+	events.push_back(event);
+	for (uint16 i = 0; i < length; ++i)
+		sysExData.push_back(data[i]);
+}
+
+bool MidiRenderCache::Pass::matches(uint index, uint32 tick, uint32 msg, const byte *data, uint16 length) const {
+	if (index >= events.size())
+		return false;
+	const Event &event = events[index];
+	return event.tick == tick && event.msg == msg && event.sysExLength == length &&
+	       (!length || !memcmp(&sysExData[event.sysExOffset], data, length));
+}
+
+MidiRenderCache::Recording::Recording(const Common::String &name, bool s, bool p) :
+	pass(name), store(s), probing(p), backlogRead(0), writer(0) {
+	previous[0] = previous[1] = 0;
+}
+
+MidiRenderCache::Recording::~Recording() {
+	delete writer;
+}
+
+MidiRenderCache::Player::Player(const Common::String &name) :
+	pass(name), opened(false), failed(false), ring(new int16[kRingSamples]),
+	ringBase(0), ringStart(0), ringCount(0), reader(0), readPos(0) {
+	previous[0] = previous[1] = 0;
+}
+
+MidiRenderCache::Player::~Player() {
+	delete[] ring;
+	delete reader;
+}
+
+void MidiRenderCache::Player::append(const int16 *buf, uint32 count) {
+	assert(ringCount + count <= kRingSamples);
+	while (count) {
+		const uint32 offset = (ringStart + ringCount) % kRingSamples;
+		const uint32 block = MIN<uint32>(count, kRingSamples - offset);
+		memcpy(ring + offset, buf, block * sizeof(int16));
+		buf += block;
+		count -= block;
+		ringCount += block;
+	}
+}
+
+void MidiRenderCache::Player::read(int16 *buf, uint32 count) {
+	assert(count <= ringCount);
+	while (count) {
+		const uint32 block = MIN<uint32>(count, kRingSamples - ringStart);
+		memcpy(buf, ring + ringStart, block * sizeof(int16));
+		buf += block;
+		count -= block;
+		ringStart = (ringStart + block) % kRingSamples;
+		ringCount -= block;
+		ringBase += block;
+	}
+}
+
+void MidiRenderCache::Player::drop(uint64 position) {
+	// Discard the samples before the position, which were skipped
+	if (position <= ringBase)
+		return;
+	if (position - ringBase >= ringCount) {
+		ringBase = position;
+		ringStart = 0;
+		ringCount = 0;
+		return;
+	}
+
+	const uint32 count = position - ringBase;
+	ringStart = (ringStart + count) % kRingSamples;
+	ringCount -= count;
+	ringBase = position;
+}
+
+MidiRenderCache::MidiRenderCache(MidiDriver_BASE *driver, const Common::FSNode &directory, const Common::String &config, int channels) :
+	_driver(driver),
+	_directory(directory),
+	_configHash(hashBytes(kFNVOffset, (const byte *)config.c_str(), config.size())),
+	_channels(channels),
+	_state(kStateIdentify),
+	_partial(false),
+	_chasing(false),
+	_tick(0),
+	_hash(kFNVOffset),
+	_startState(0),
+	_sysExHash(kFNVOffset),
+	_recording(0),
+	_saving(0),
+	_player(0),
+	_diverged(false),
+	_nextEvent(0),
+	_missedFrom(0),
+	_passStart(0),
+	_position(0) {
+
+	assert(channels == 1 || channels == 2);
+	_previous[0] = _previous[1] = 0;
+
+	memset(_velocities, 0, sizeof(_velocities));
+	memset(_controllers, 0, sizeof(_controllers));
+	memset(_programs, 0, sizeof(_programs));
+	for (int i = 0; i < 16; ++i)
+		_pitchBends[i] = 0x2000;
+}
+
+MidiRenderCache::~MidiRenderCache() {
+	delete _recording;
+	delete _saving;
+	delete _player;
+	for (uint i = 0; i < _retiredRecordings.size(); ++i)
+		delete _retiredRecordings[i];
+	for (uint i = 0; i < _retiredPlayers.size(); ++i)
+		delete _retiredPlayers[i];
+}
+
+Common::SeekableReadStream *MidiRenderCache::openForReading(const Common::String &name) {
+	Common::FSNode node = _directory.getChild(name);
+	if (!node.exists())
+		return 0;
+	return node.createReadStream();
+}
+
+Common::WriteStream *MidiRenderCache::openForWriting(const Common::String &name) {
+	return _directory.getChild(name).createWriteStream();
+}
+
+bool MidiRenderCache::send(uint32 b) {
+	return follow(b, 0, 0);
+}
+
+bool MidiRenderCache::sysEx(const byte *msg, uint16 length) {
+	return follow(0xF0, msg, length);
+}
+
+bool MidiRenderCache::follow(uint32 msg, const byte *data, uint16 length) {
+	if (_chasing)
+		return false;
+
+	bool consumed = false;
+	switch (_state) {
+	case kStateIdentify:
+		hash(_tick);
+		hash(msg);
+		_hash = hashBytes(_hash, data, length);
+		break;
+
+	case kStateRecord:
+		_recording->pass.addEvent(_tick, msg, data, length);
+		if (_player && _player->opened && !_player->pass.matches(_recording->pass.events.size() - 1, _tick, msg, data, length))
+			_diverged = true;
+		break;
+
+	case kStateReplay:
+		if (_player->pass.matches(_nextEvent, _tick, msg, data, length)) {
+			++_nextEvent;
+			consumed = true;
+			break;
+		}
+		debug(3, "MidiRenderCache: Event %02X differs from %s at tick %u, synthesizing again", msg & 0xFF, _name.c_str(), _tick);
+		resume(true);
+		break;
+	}
+
+	track(msg, data, length);
+	return consumed;
+}
+
+void MidiRenderCache::track(uint32 msg, const byte *data, uint16 length) {
+	const byte channel = msg & 0x0F;
+	const byte param1 = (msg >> 8) & 0x7F;
+	const byte param2 = (msg >> 16) & 0x7F;
+
+	switch (msg & 0xF0) {
+	case 0x80:
+		_velocities[channel][param1] = 0;
+		break;
+	case 0x90:
+		_velocities[channel][param1] = param2;
+		break;
+	case 0xB0:
+		_controllers[channel][param1] = param2;
+		// All Sound Off and All Notes Off
+		if (param1 == 0x78 || param1 == 0x7B)
+			memset(_velocities[channel], 0, sizeof(_velocities[channel]));
+		break;
+	case 0xC0:
+		_programs[channel] = param1;
+		break;
+	case 0xE0:
+		_pitchBends[channel] = param1 | (param2 << 7);
+		break;
+	case 0xF0:
+		// SysEx may change anything, so the order they came in matters
+		_sysExHash = hashBytes(_sysExHash, data, length);
+		break;
+	}
+}
+
+uint32 MidiRenderCache::hashState() const {
+	uint32 hash = _sysExHash;
+	hash = hashBytes(hash, &_velocities[0][0], sizeof(_velocities));
+	hash = hashBytes(hash, &_controllers[0][0], sizeof(_controllers));
+	hash = hashBytes(hash, _programs, sizeof(_programs));
+	for (int i = 0; i < 16; ++i) {
+		byte data[2];
+		WRITE_LE_UINT16(data, _pitchBends[i]);
+		hash = hashBytes(hash, data, 2);
+	}
+	return hash;
+}
+
+void MidiRenderCache::hash(uint32 value) {
+	byte data[4];
+	WRITE_LE_UINT32(data, value);
+	_hash = hashBytes(_hash, data, 4);
+}
+
+void MidiRenderCache::tick() {
+	++_tick;
+
+	if (_state == kStateRecord && _player && _player->opened && !_diverged)
+		switchToStored();
+
+	// Events which should have been sent by now are missing as well
+	if (_state == kStateReplay && ((_nextEvent < _player->pass.events.size() && _player->pass.events[_nextEvent].tick < _tick) || _tick > _player->pass.ticks)) {
+		debug(3, "MidiRenderCache: Events missing from %s at tick %u, synthesizing again", _name.c_str(), _tick);
+		resume(true);
+	}
+}
+
+void MidiRenderCache::loop() {
+	switch (_state) {
+	case kStateIdentify:
+		if (!_partial) {
+			// The output of the next pass depends on the state it starts in
+			hash(_tick);
+			_startState = hashState();
+			_name = Common::String::format("midi_%08x_%08x_%08x.", _configHash, _startState, _hash);
+
+			// Record the pass, unless it was stored before
+			_recording = new Recording(_name, true, true);
+			_player = new Player(_name);
+			_diverged = false;
+			_passStart = 0;
+			_position = 0;
+			_state = kStateRecord;
+		}
+		break;
+
+	case kStateRecord:
+		if (_recording->store && !_recording->probing && !_saving) {
+			// Write the rest of the pass, and play it back once it is read
+			_recording->pass.ticks = _tick;
+			_saving = _recording;
+			_recording = new Recording(_name, false, false);
+			retire(_player);
+			_player = new Player(_name);
+			_diverged = false;
+			_passStart = 0;
+			_position = 0;
+		} else if (_player && !_player->failed && !_diverged && hashState() == _startState) {
+			// Keep following the music until the stored pass can be played back
+			retire(_recording);
+			_recording = new Recording(_name, false, false);
+			if (_player->opened)
+				_passStart += passSamples();
+			_position = 0;
+		} else {
+			retire(_recording);
+			retire(_player);
+			_state = kStateIdentify;
+		}
+		break;
+
+	case kStateReplay:
+		if (_nextEvent != _player->pass.events.size() || _tick != _player->pass.ticks || hashState() != _startState) {
+			debug(3, "MidiRenderCache: %s looped at tick %u instead of %u, synthesizing again", _name.c_str(), _tick, _player->pass.ticks);
+			resume(true);
+		} else {
+			_nextEvent = 0;
+			_missedFrom = 0;
+			_passStart += passSamples();
+			_position = 0;
+		}
+		break;
+	}
+
+	_partial = false;
+	_tick = 0;
+	_hash = kFNVOffset;
+}
+
+void MidiRenderCache::stop() {
+	if (_state == kStateReplay)
+		resume(false);
+	reset();
+}
+
+bool MidiRenderCache::replay(int16 *buf, int len) {
+	if (_state != kStateReplay)
+		return false;
+
+	const uint32 samples = len * _channels;
+	const uint32 available = MIN<uint32>(samples, passSamples() - _position);
+	const uint64 position = _passStart + _position;
+	_player->drop(position);
+	if (_player->ringBase != position || _player->ringCount < available) {
+		debug(2, "MidiRenderCache: Reading %s fell behind, synthesizing again", _name.c_str());
+		resume(true);
+		return false;
+	}
+
+	_player->read(buf, available);
+	_position += available;
+	if (available >= (uint32)_channels) {
+		for (int i = 0; i < _channels; ++i)
+			_previous[i] = buf[available - _channels + i];
+	}
+
+	// The passes may differ by a sample frame, depending on where the loop
+	// falls between two samples. Hold the last one until the loop point.
+	for (uint32 i = available; i < samples; ++i)
+		buf[i] = _previous[i % _channels];
+
+	return true;
+}
+
+void MidiRenderCache::record(const int16 *buf, int len) {
+	if (_state != kStateRecord)
+		return;
+
+	const uint32 samples = len * _channels;
+	_position += samples;
+	Recording &recording = *_recording;
+	if (!recording.store)
+		return;
+
+	recording.pass.frames += len;
+	const uint32 size = recording.backlog.size();
+	if (size + samples > kMaxBacklogSamples) {
+		debug(2, "MidiRenderCache: Writing %s fell behind, not storing it", _name.c_str());
+		stopStoring(recording);
+		return;
+	}
+	recording.backlog.resize(size + samples);
+	memcpy(&recording.backlog[size], buf, samples * sizeof(int16));
+}
+
+void MidiRenderCache::switchToStored() {
+	// The synthesizer already got the events so far, and the stored pass
+	// must continue them without any event due before this tick
+	const Pass &pass = _player->pass;
+	const uint count = _recording->pass.events.size();
+	if ((count < pass.events.size() && pass.events[count].tick < _tick) || _tick > pass.ticks) {
+		_diverged = true;
+		return;
+	}
+	if (_position > passSamples())
+		return;
+
+	// Wait until a slice of the output from here on is read
+	const uint64 position = _passStart + _position;
+	_player->drop(position);
+	if (_player->ringBase != position || _player->ringCount < MIN<uint32>(passSamples() - _position, kSliceSamples))
+		return;
+
+	debug(2, "MidiRenderCache: Switching to the stored %s at tick %u", _name.c_str(), _tick);
+	retire(_recording);
+	_nextEvent = _missedFrom = count;
+	_previous[0] = _previous[1] = 0;
+	_state = kStateReplay;
+}
+
+void MidiRenderCache::stopStoring(Recording &recording) {
+	recording.store = false;
+	recording.backlog.clear();
+	recording.backlogRead = 0;
+}
+
+void MidiRenderCache::retire(Recording *&recording) {
+	// A job may still use it, and closing its file is left to a job as well
+	if (recording)
+		_retiredRecordings.push_back(recording);
+	recording = 0;
+}
+
+void MidiRenderCache::retire(Player *&player) {
+	if (player)
+		_retiredPlayers.push_back(player);
+	player = 0;
+}
+
+MidiRenderCache::Job *MidiRenderCache::takeJob() {
+	// Jobs are taken one at a time, so none of them is running here
+	Recording *writing = _saving;
+	if (!writing && _recording && _recording->store && !_recording->probing && _recording->backlogRead < _recording->backlog.size())
+		writing = _recording;
+
+	if (writing && writing->backlogRead < writing->backlog.size()) {
+		Job *job = new Job(Job::kTypeWrite);
+		job->recording = writing;
+		const uint32 count = MIN<uint32>(writing->backlog.size() - writing->backlogRead, kSliceSamples);
+		job->samples.resize(count);
+		memcpy(&job->samples[0], &writing->backlog[writing->backlogRead], count * sizeof(int16));
+		writing->backlogRead += count;
+		if (writing->backlogRead == writing->backlog.size()) {
+			writing->backlog.resize(0);
+			writing->backlogRead = 0;
+		}
+		return job;
+	}
+
+	if (_saving) {
+		Job *job = new Job(Job::kTypeFinish);
+		job->recording = _saving;
+		return job;
+	}
+
+	if (_player && !_player->opened && !_player->failed) {
+		Job *job = new Job(Job::kTypeOpen);
+		job->player = _player;
+		return job;
+	}
+
+	if (_player && _player->opened && !_player->failed && (_state == kStateReplay || !_diverged) && _player->ringCount < kRingSamples) {
+		Job *job = new Job(Job::kTypeFill);
+		job->player = _player;
+		job->position = _player->ringCount ? _player->ringBase + _player->ringCount : _passStart + _position;
+		job->samples.resize(MIN<uint32>(kRingSamples - _player->ringCount, kSliceSamples));
+		return job;
+	}
+
+	if (!_retiredRecordings.empty() || !_retiredPlayers.empty()) {
+		Job *job = new Job(Job::kTypeClose);
+		job->recordings = _retiredRecordings;
+		job->players = _retiredPlayers;
+		_retiredRecordings.clear();
+		_retiredPlayers.clear();
+		return job;
+	}
+
+	return 0;
+}
+
+void MidiRenderCache::runJob(Job *job) {
+	switch (job->type) {
+	case Job::kTypeOpen:
+		job->success = openPass(*job->player);
+		break;
+	case Job::kTypeWrite:
+		job->success = writeSamples(*job->recording, job->samples);
+		break;
+	case Job::kTypeFinish:
+		job->success = finishPass(*job->recording);
+		break;
+	case Job::kTypeFill:
+		job->success = readSamples(*job->player, job->position, job->samples);
+		break;
+	case Job::kTypeClose:
+		for (uint i = 0; i < job->recordings.size(); ++i)
+			delete job->recordings[i];
+		for (uint i = 0; i < job->players.size(); ++i)
+			delete job->players[i];
+		job->success = true;
+		break;
+	}
+}
+
+void MidiRenderCache::finishJob(Job *job) {
+	switch (job->type) {
+	case Job::kTypeOpen:
+		if (job->player != _player)
+			break;
+		if (!job->success) {
+			// Record the pass, if it was still to be stored
+			_player->failed = true;
+			if (_recording)
+				_recording->probing = false;
+			break;
+		}
+
+		debug(2, "MidiRenderCache: Found %s, %u ticks and %u events", _name.c_str(), _player->pass.ticks, _player->pass.events.size());
+		_player->opened = true;
+		if (_recording) {
+			// The synthesizer may have got other events than the stored pass already
+			const Pass &recorded = _recording->pass;
+			for (uint i = 0; i < recorded.events.size() && !_diverged; ++i) {
+				const Event &event = recorded.events[i];
+				if (!_player->pass.matches(i, event.tick, event.msg, event.sysExLength ? &recorded.sysExData[event.sysExOffset] : 0, event.sysExLength))
+					_diverged = true;
+			}
+			_recording->probing = false;
+			stopStoring(*_recording);
+		}
+		break;
+
+	case Job::kTypeWrite:
+		if (!job->success) {
+			warning("MidiRenderCache: Failed to write %spcm", job->recording->pass.name.c_str());
+			if (job->recording == _saving)
+				retire(_saving);
+			else if (job->recording == _recording)
+				stopStoring(*_recording);
+		}
+		break;
+
+	case Job::kTypeFinish:
+		if (job->success)
+			debug(2, "MidiRenderCache: Stored %s, %u ticks and %u events", _saving->pass.name.c_str(), _saving->pass.ticks, _saving->pass.events.size());
+		else
+			warning("MidiRenderCache: Failed to write %s", _saving->pass.name.c_str());
+		retire(_saving);
+		break;
+
+	case Job::kTypeFill:
+		if (job->player != _player)
+			break;
+		if (!job->success) {
+			warning("MidiRenderCache: Failed to read %spcm", _name.c_str());
+			_player->failed = true;
+			break;
+		}
+
+		if (!_player->ringCount) {
+			_player->ringBase = job->position;
+			_player->ringStart = 0;
+		}
+		if (!job->samples.empty() && _player->ringBase + _player->ringCount == job->position)
+			_player->append(&job->samples[0], job->samples.size());
+		_player->drop(_passStart + _position);
+		break;
+
+	case Job::kTypeClose:
+		break;
+	}
+
+	delete job;
+}
+
+void MidiRenderCache::runJobs() {
+	while (Job *job = takeJob()) {
+		runJob(job);
+		finishJob(job);
+	}
+}
+
+bool MidiRenderCache::openPass(Player &player) {
+	Pass &pass = player.pass;
+	Common::SeekableReadStream *in = openForReading(pass.name + "evt");
+	if (!in)
+		return false;
+
+	bool valid = in->readUint32BE() == MKTAG('M','R','C','1') && (int)in->readUint32LE() == _channels;
+	pass.ticks = in->readUint32LE();
+	pass.frames = in->readUint32LE();
+	const uint32 count = in->readUint32LE();
+
+	for (uint32 i = 0; valid && i < count; ++i) {
+		Event event;
+		event.tick = in->readUint32LE();
+		event.msg = in->readUint32LE();
+		event.sysExOffset = pass.sysExData.size();
+		event.sysExLength = in->readUint16LE();
+		if (in->eos() || event.tick > pass.ticks)
+			valid = false;
+		else if (event.sysExLength) {
+			pass.sysExData.resize(event.sysExOffset + event.sysExLength);
+			in->read(&pass.sysExData[event.sysExOffset], event.sysExLength);
+		}
+		pass.events.push_back(event);
+	}
+
+	valid = valid && pass.frames && !in->eos() && !in->err();
+	delete in;
+	if (!valid)
+		return false;
+
+	// The output is only read as the playback goes
+	player.reader = Common::wrapCompressedReadStream(openForReading(pass.name + "pcm"), 0, 0);
+	return player.reader && player.reader->size() == (int32)(pass.frames * _channels * 2);
+}
+
+bool MidiRenderCache::readSamples(Player &player, uint64 position, Common::Array<int16> &samples) {
+	const uint32 length = player.pass.frames * _channels;
+
+	// Start over from the pass the position is in, unless the reader is
+	// already there
+	if (position < player.readPos || position / length != player.readPos / length) {
+		if (!player.reader->seek(0))
+			return false;
+		player.readPos = position - position % length;
+		player.previous[0] = player.previous[1] = 0;
+	}
+
+	// When synthesizing, the playback position may be ahead. Catching up
+	// takes a few jobs if it is far ahead.
+	const uint32 skip = (uint32)MIN<uint64>(position - player.readPos, kSkipSamples);
+	if (skip && !decodeSamples(player, 0, skip))
+		return false;
+	if (player.readPos != position) {
+		samples.clear();
+		return true;
+	}
+
+	return decodeSamples(player, &samples[0], samples.size());
+}
+
+bool MidiRenderCache::decodeSamples(Player &player, int16 *buf, uint32 count) {
+	const uint32 length = player.pass.frames * _channels;
+	byte data[kBlockSamples * 2];
+	while (count) {
+		const uint32 offset = player.readPos % length;
+		const uint32 block = MIN<uint32>(MIN<uint32>(count, kBlockSamples), length - offset);
+		if (player.reader->read(data, block * 2) != block * 2)
+			return false;
+		for (uint32 i = 0; i < block; ++i) {
+			const int channel = (offset + i) % _channels;
+			player.previous[channel] += (int16)READ_LE_UINT16(data + i * 2);
+			if (buf)
+				*buf++ = player.previous[channel];
+		}
+		count -= block;
+		player.readPos += block;
+
+		// The stream continues with the next pass
+		if (offset + block == length) {
+			if (!player.reader->seek(0))
+				return false;
+			player.previous[0] = player.previous[1] = 0;
+		}
+	}
+	return true;
+}
+
+bool MidiRenderCache::writeSamples(Recording &recording, const Common::Array<int16> &samples) {
+	if (!recording.writer) {
+		recording.writer = Common::wrapCompressedWriteStream(openForWriting(recording.pass.name + "pcm"));
+		if (!recording.writer)
+			return false;
+	}
+
+	byte data[kBlockSamples * 2];
+	for (uint32 done = 0; done < samples.size(); ) {
+		const uint32 block = MIN<uint32>(samples.size() - done, kBlockSamples);
+		for (uint32 i = 0; i < block; ++i, ++done) {
+			const int channel = done % _channels;
+			WRITE_LE_UINT16(data + i * 2, (uint16)(samples[done] - recording.previous[channel]));
+			recording.previous[channel] = samples[done];
+		}
+		recording.writer->write(data, block * 2);
+	}
+	return !recording.writer->err();
+}
+
+bool MidiRenderCache::finishPass(Recording &recording) {
+	const Pass &pass = recording.pass;
+	if (!recording.writer && !writeSamples(recording, Common::Array<int16>()))
+		return false;
+
+	recording.writer->finalize();
+	bool written = !recording.writer->err();
+	delete recording.writer;
+	recording.writer = 0;
+	if (!written)
+		return false;
+
+	// The output is written before the events, which makes it complete when
+	// the events are
+	Common::WriteStream *out = openForWriting(pass.name + "evt");
+	if (!out)
+		return false;
+
+	out->writeUint32BE(MKTAG('M','R','C','1'));
+	out->writeUint32LE(_channels);
+	out->writeUint32LE(pass.ticks);
+	out->writeUint32LE(pass.frames);
+	out->writeUint32LE(pass.events.size());
+	for (uint i = 0; i < pass.events.size(); ++i) {
+		const Event &event = pass.events[i];
+		out->writeUint32LE(event.tick);
+		out->writeUint32LE(event.msg);
+		out->writeUint16LE(event.sysExLength);
+		if (event.sysExLength)
+			out->write(&pass.sysExData[event.sysExOffset], event.sysExLength);
+	}
+
+	out->finalize();
+	written = !out->err();
+	delete out;
+	return written;
+}
+
+void MidiRenderCache::resume(bool restartNotes) {
+	// Send the events of this pass the synthesizer missed, except for their
+	// note ons, then start the notes which are still held again
+	_state = kStateIdentify;
+	_chasing = true;
+	const Pass &pass = _player->pass;
+	for (uint i = _missedFrom; i < _nextEvent; ++i) {
+		const Event &event = pass.events[i];
+		if (event.msg == 0xF0)
+			_driver->sysEx(&pass.sysExData[event.sysExOffset], event.sysExLength);
+		else if ((event.msg & 0xF0) != 0x90 || !(event.msg & 0x7F0000))
+			_driver->send(event.msg);
+	}
+
+	if (restartNotes) {
+		for (int channel = 0; channel < 16; ++channel) {
+			for (int note = 0; note < 128; ++note) {
+				if (_velocities[channel][note])
+					_driver->send(0x90 | channel | (note << 8) | (_velocities[channel][note] << 16));
+			}
+		}
+	}
+	_chasing = false;
+	retire(_player);
+
+	// The rest of this pass can not identify the music
+	_partial = true;
+}
+
+void MidiRenderCache::reset() {
+	// A complete pass is still written
+	retire(_recording);
+	retire(_player);
+
+	_state = kStateIdentify;
+	_partial = false;
+	_tick = 0;
+	_hash = kFNVOffset;
+}
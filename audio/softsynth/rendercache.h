@@ -0,0 +1,265 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef AUDIO_SOFTSYNTH_RENDERCACHE_H
+#define AUDIO_SOFTSYNTH_RENDERCACHE_H
+
+#include "common/array.h"
+#include "common/fs.h"
+#include "common/str.h"
+
+namespace Common {
+class SeekableReadStream;
+class WriteStream;
+}
+
+class MidiDriver_BASE;
+
+/**
+ * Cache for the output of a software synthesizer playing looping music.
+ *
+ * The cache follows the MIDI events sent to the synthesizer between the
+ * loop points of the music, which the player reports through loop(). The
+ * first pass is only used to identify the music, by hashing its events
+ * and the state of the MIDI channels at its end. The output of the second
+ * pass is compressed into the cache directory while it plays, together
+ * with its events. All later passes are played back from there instead of
+ * being synthesized again, as long as the events sent match the stored
+ * ones. In later sessions, the second pass switches to playing back the
+ * stored pass as soon as its output is read.
+ *
+ * Only a bounded part of the output is held in memory: what was not
+ * compressed yet, and what was read ahead of the playback position. A pass
+ * whose output piles up because it is not written in time is not stored.
+ *
+ * Any other event, e.g. a volume change or a jump triggered by the game,
+ * switches back to live synthesis. The synthesizer then first gets the
+ * events of the current pass it missed, without their note ons, and the
+ * notes still held are started again.
+ *
+ * The methods following the music never access files, since the mixer
+ * calls them while mixing. Loading and storing passes are jobs which the
+ * owner runs elsewhere, see takeJob().
+ */
+class MidiRenderCache {
+public:
+	/** A pending file operation, see takeJob(). */
+	struct Job;
+
+	/**
+	 * Create a cache storing its files in the given directory.
+	 *
+	 * @param driver	the driver which gets the missed events when switching back to live synthesis
+	 * @param directory	the directory to store the output in
+	 * @param config	a description of the synthesizer and its settings, which is part of the cache key
+	 * @param channels	the number of output channels, 1 or 2
+	 */
+	MidiRenderCache(MidiDriver_BASE *driver, const Common::FSNode &directory, const Common::String &config, int channels);
+	virtual ~MidiRenderCache();
+
+	/**
+	 * Follow an event sent to the synthesizer.
+	 *
+	 * @return true if the event is part of the output played back, and must not reach the synthesizer
+	 */
+	bool send(uint32 b);
+
+	/** @see send() */
+	bool sysEx(const byte *msg, uint16 length);
+
+	/** Advance to the next timer tick, after the events of the current one were sent. */
+	void tick();
+
+	/** The music jumped back to its loop start, without being changed. */
+	void loop();
+
+	/** The music stopped, or is about to be replaced. */
+	void stop();
+
+	/**
+	 * Play back len sample frames of stored output.
+	 *
+	 * @return false if the output must be synthesized instead
+	 */
+	bool replay(int16 *buf, int len);
+
+	/** Keep len synthesized sample frames, if the current pass is being recorded. */
+	void record(const int16 *buf, int len);
+
+	/** Whether the output is currently played back from the cache. */
+	bool isReplaying() const { return _state == kStateReplay; }
+
+	/**
+	 * Take the next pending file operation, or return 0 if there is none.
+	 * The job is done in three steps, so that a caller serializing access
+	 * to the cache only needs to hold its lock for the first and the last:
+	 * takeJob() and finishJob() work on the state of the cache, while
+	 * runJob() only accesses the job and the files.
+	 */
+	Job *takeJob();
+
+	/**
+	 * Do a job taken with takeJob(). A job only reads or writes a bounded
+	 * slice of the output, so it never takes long.
+	 */
+	void runJob(Job *job);
+
+	/** Apply the result of a job done with runJob() and delete it. */
+	void finishJob(Job *job);
+
+	/**
+	 * Do all pending jobs, for callers which do not need to lock the cache.
+	 * This also reads ahead of the playback as far as the ring buffer goes.
+	 */
+	void runJobs();
+
+protected:
+	virtual Common::SeekableReadStream *openForReading(const Common::String &name);
+	virtual Common::WriteStream *openForWriting(const Common::String &name);
+
+private:
+	enum State {
+		kStateIdentify,	///< Synthesizing, and hashing the events of the pass
+		kStateRecord,	///< Synthesizing, and keeping the output and events of the pass
+		kStateReplay	///< Playing back the stored output
+	};
+
+	struct Event {
+		uint32 tick;
+		uint32 msg;		///< The packed event, 0xF0 for SysEx
+		uint32 sysExOffset;	///< The offset of the SysEx data in Pass::sysExData
+		uint16 sysExLength;
+	};
+
+	/** The events of one pass of the music, and the length of its output. */
+	struct Pass {
+		Pass(const Common::String &n) : name(n), ticks(0), frames(0) {}
+
+		void addEvent(uint32 tick, uint32 msg, const byte *data, uint16 length);
+		bool matches(uint index, uint32 tick, uint32 msg, const byte *data, uint16 length) const;
+
+		Common::String name;
+		uint32 ticks;
+		uint32 frames;
+		Common::Array<Event> events;
+		Common::Array<byte> sysExData;
+	};
+
+	/**
+	 * A pass being synthesized. Unless it is only followed to switch to a
+	 * stored copy, its output is kept until a job writes it to the file.
+	 */
+	struct Recording {
+		Recording(const Common::String &name, bool s, bool p);
+		~Recording();
+
+		Pass pass;
+		bool store;		///< Whether the output is stored
+		bool probing;		///< Whether a stored copy is looked for, before writing anything
+		Common::Array<int16> backlog;	///< The output not taken by a job yet, from backlogRead on
+		uint32 backlogRead;
+
+		// Only accessed by the jobs
+		Common::WriteStream *writer;
+		int16 previous[2];
+	};
+
+	/**
+	 * A stored pass played back. The passes played back form a stream,
+	 * which jobs read ahead of the playback position into a ring buffer.
+	 * They start over at the end of the pass, so that the start of the
+	 * next pass is read before the loop point.
+	 */
+	struct Player {
+		Player(const Common::String &name);
+		~Player();
+
+		void append(const int16 *buf, uint32 count);
+		void read(int16 *buf, uint32 count);
+		void drop(uint64 position);
+
+		Pass pass;
+		bool opened;
+		bool failed;
+		int16 *ring;
+		uint64 ringBase;	///< The stream position of the first sample in the ring
+		uint32 ringStart;	///< The offset of that sample in ring
+		uint32 ringCount;
+
+		// Only accessed by the jobs
+		Common::SeekableReadStream *reader;
+		uint64 readPos;		///< The stream position of the next sample of reader
+		int16 previous[2];
+	};
+
+	bool follow(uint32 msg, const byte *data, uint16 length);
+	void track(uint32 msg, const byte *data, uint16 length);
+	uint32 hashState() const;
+	void hash(uint32 value);
+	uint32 passSamples() const { return _player->pass.frames * _channels; }
+	void switchToStored();
+	void stopStoring(Recording &recording);
+	void retire(Recording *&recording);
+	void retire(Player *&player);
+	void resume(bool restartNotes);
+	void reset();
+
+	bool openPass(Player &player);
+	bool readSamples(Player &player, uint64 position, Common::Array<int16> &samples);
+	bool decodeSamples(Player &player, int16 *buf, uint32 count);
+	bool writeSamples(Recording &recording, const Common::Array<int16> &samples);
+	bool finishPass(Recording &recording);
+
+	MidiDriver_BASE *_driver;
+	Common::FSNode _directory;
+	uint32 _configHash;
+	int _channels;
+
+	State _state;
+	bool _partial;		///< Whether the current pass did not start at the loop start
+	bool _chasing;		///< Whether missed events are being sent to the synthesizer
+	uint32 _tick;
+	uint32 _hash;
+	uint32 _startState;	///< The state of the channels at the start of the stored pass
+	Common::String _name;
+
+	// The state of the MIDI channels, as far as the events sent tell
+	byte _velocities[16][128];
+	byte _controllers[16][128];
+	byte _programs[16];
+	uint16 _pitchBends[16];
+	uint32 _sysExHash;
+
+	Recording *_recording;	///< The pass being synthesized, when recording
+	Recording *_saving;	///< A complete pass still being written
+	Player *_player;	///< The stored copy of the pass, if there may be one
+	Common::Array<Recording *> _retiredRecordings;	///< Left for a job to close their files
+	Common::Array<Player *> _retiredPlayers;
+	bool _diverged;		///< Whether the pass synthesized differs from the one of _player
+	uint _nextEvent;	///< The next event of _player expected
+	uint _missedFrom;	///< The first event of _player the synthesizer missed
+	uint64 _passStart;	///< The stream position of the current pass
+	uint32 _position;	///< The samples of the current pass synthesized or played back
+	int16 _previous[2];	///< The last sample played back of every channel
+};
+
+#endif
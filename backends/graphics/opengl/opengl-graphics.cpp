@@ -52,6 +52,7 @@ namespace OpenGL {
 
 OpenGLGraphicsManager::OpenGLGraphicsManager()
     : _currentState(), _oldState(), _transactionMode(kTransactionNone), _screenChangeID(1 << (sizeof(int) * 8 - 2)),
+      _lastFrameUploadSize(0),
       _pipeline(nullptr),
       _defaultFormat(), _defaultFormatAlpha(),
       _gameScreen(nullptr), _gameScreenShakeOffset(0), _overlay(nullptr),
@@ -408,6 +409,10 @@ void OpenGLGraphicsManager::updateScreen() {
 	}
 	_overlay->updateGLTexture();
 
+	_lastFrameUploadSize = GLTexture::getUploadedBytes();
+	GLTexture::resetUploadedBytes();
+	debug(9, "OpenGL: Uploaded %u bytes of texture data", _lastFrameUploadSize);
+
 	// Clear the screen buffer.
 	GL_CALL(glClear(GL_COLOR_BUFFER_BIT));
 
@@ -117,6 +117,12 @@ public:
 	virtual void setPalette(const byte *colors, uint start, uint num) override;
 	virtual void grabPalette(byte *colors, uint start, uint num) const override;
 
+	/**
+	 * Query the number of bytes of texture data uploaded for the last frame
+	 * drawn by updateScreen().
+	 */
+	uint32 getLastFrameUploadSize() const { return _lastFrameUploadSize; }
+
 protected:
 	/**
 	 * Whether an GLES or GLES2 context is active.
@@ -229,6 +235,11 @@ private:
 	 */
 	int _screenChangeID;
 
+	/**
+	 * The number of bytes of texture data uploaded for the last frame.
+	 */
+	uint32 _lastFrameUploadSize;
+
 protected:
 	/**
 	 * Set up the requested video mode. This takes parameters which describe
@@ -44,16 +44,23 @@ static GLuint nextHigher2(GLuint v) {
 }
 
 
+uint32 GLTexture::_uploadedBytes = 0;
+
 GLTexture::GLTexture(GLenum glIntFormat, GLenum glFormat, GLenum glType)
     : _glIntFormat(glIntFormat), _glFormat(glFormat), _glType(glType),
       _width(0), _height(0), _logicalWidth(0), _logicalHeight(0),
       _texCoords(), _glFilter(GL_NEAREST),
-      _glTexture(0) {
+      _glTexture(0), _pixelBuffers(), _nextPixelBuffer(0) {
 	create();
 }
 
 GLTexture::~GLTexture() {
 	GL_CALL_SAFE(glDeleteTextures, (1, &_glTexture));
+#if !USE_FORCED_GLES && !USE_FORCED_GLES2
+	if (_pixelBuffers[0]) {
+		GL_CALL_SAFE(glDeleteBuffers, (2, _pixelBuffers));
+	}
+#endif
 }
 
 void GLTexture::enableLinearFiltering(bool enable) {
@@ -72,6 +79,13 @@ void GLTexture::enableLinearFiltering(bool enable) {
 void GLTexture::destroy() {
 	GL_CALL(glDeleteTextures(1, &_glTexture));
 	_glTexture = 0;
+
+#if !USE_FORCED_GLES && !USE_FORCED_GLES2
+	if (_pixelBuffers[0]) {
+		GL_CALL(glDeleteBuffers(2, _pixelBuffers));
+		_pixelBuffers[0] = _pixelBuffers[1] = 0;
+	}
+#endif
 }
 
 void GLTexture::create() {
@@ -81,6 +95,13 @@ void GLTexture::create() {
 	// Get a new texture name.
 	GL_CALL(glGenTextures(1, &_glTexture));
 
+#if !USE_FORCED_GLES && !USE_FORCED_GLES2
+	// Get the buffers to stage uploads in.
+	if (g_context.pixelBufferObjectSupported) {
+		GL_CALL(glGenBuffers(2, _pixelBuffers));
+	}
+#endif
+
 	// Set up all texture parameters.
 	bind();
 	GL_CALL(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
@@ -146,6 +167,12 @@ void GLTexture::updateArea(const Common::Rect &area, const Graphics::Surface &sr
 	// Set the texture on the active texture unit.
 	bind();
 
+	// Prefer going through a pixel buffer. This also only uploads the
+	// columns inside the area.
+	if (updateAreaBuffered(area, src)) {
+		return;
+	}
+
 	// Update the actual texture.
 	// Although we have the area of the texture buffer we want to update we
 	// cannot take advantage of the left/right boundries here because it is
@@ -156,7 +183,9 @@ void GLTexture::updateArea(const Common::Rect &area, const Graphics::Surface &sr
 	//
 	// 1) (As we do right now) Simply always update the whole texture lines of
 	//    rect changed. This is simplest to implement. In case performance is
-	//    really an issue we can think of switching to another method.
+	//    really an issue we can think of switching to another method. The
+	//    textures merge dirty areas sharing rows beforehand, so each row is
+	//    uploaded once (see Surface::mergeDirtyRows()).
 	//
 	// 2) Copy the dirty rect to a temporary buffer and upload that by using
 	//    glTexSubImage2D. This is what the Android backend does. It is more
@@ -166,6 +195,67 @@ void GLTexture::updateArea(const Common::Rect &area, const Graphics::Surface &sr
 	//    graphics manager did but it is much slower! Thus, we do not use it.
 	GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, area.top, src.w, area.height(),
 	                       _glFormat, _glType, src.getBasePtr(0, area.top)));
+
+	_uploadedBytes += src.w * src.format.bytesPerPixel * area.height();
+}
+
+bool GLTexture::uploadsWholeRows() const {
+#if !USE_FORCED_GLES && !USE_FORCED_GLES2
+	return !_pixelBuffers[0];
+#else
+	return true;
+#endif
+}
+
+bool GLTexture::updateAreaBuffered(const Common::Rect &area, const Graphics::Surface &src) {
+#if !USE_FORCED_GLES && !USE_FORCED_GLES2
+	if (!_pixelBuffers[0]) {
+		return false;
+	}
+
+	const uint rowSize = area.width() * src.format.bytesPerPixel;
+
+	GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _pixelBuffers[_nextPixelBuffer]));
+	_nextPixelBuffer ^= 1;
+
+	// Allocating new storage each time keeps the driver from waiting for a
+	// pending transfer out of the old storage.
+	GL_CALL(glBufferData(GL_PIXEL_UNPACK_BUFFER, rowSize * area.height(), NULL, GL_STREAM_DRAW));
+
+	GLvoid *mapped;
+	GL_ASSIGN(mapped, glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY));
+	if (!mapped) {
+		GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+		return false;
+	}
+
+	_uploadedBytes += rowSize * area.height();
+
+	// Pack the rows of the area tightly, which GL_UNPACK_ALIGNMENT = 1
+	// allows for.
+	byte *dst = (byte *)mapped;
+	const byte *srcRow = (const byte *)src.getBasePtr(area.left, area.top);
+	for (int y = area.top; y < area.bottom; ++y) {
+		memcpy(dst, srcRow, rowSize);
+		dst += rowSize;
+		srcRow += src.pitch;
+	}
+
+	GLboolean unmapped;
+	GL_ASSIGN(unmapped, glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+
+	// The buffer contents are undefined in the rare case unmapping fails,
+	// e.g. on a mode switch. Upload from our copy instead then.
+	if (unmapped) {
+		GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, area.left, area.top, area.width(), area.height(),
+		                        _glFormat, _glType, NULL));
+	}
+
+	GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+	return unmapped;
+#else
+	return false;
+#endif
 }
 
 //
@@ -173,7 +263,7 @@ void GLTexture::updateArea(const Common::Rect &area, const Graphics::Surface &sr
 //
 
 Surface::Surface()
-    : _allDirty(false), _dirtyArea() {
+    : _allDirty(false), _dirtyAreas(), _numDirtyAreas(0) {
 }
 
 void Surface::copyRectToTexture(uint x, uint y, uint w, uint h, const void *srcPtr, uint srcPitch) {
@@ -181,15 +271,7 @@ void Surface::copyRectToTexture(uint x, uint y, uint w, uint h, const void *srcP
 	assert(x + w <= dstSurf->w);
 	assert(y + h <= dstSurf->h);
 
-	// *sigh* Common::Rect::extend behaves unexpected whenever one of the two
-	// parameters is an empty rect. Thus, we check whether the current dirty
-	// area is valid. In case it is not we simply use the parameters as new
-	// dirty area. Otherwise, we simply call extend.
-	if (_dirtyArea.isEmpty()) {
-		_dirtyArea = Common::Rect(x, y, x + w, y + h);
-	} else {
-		_dirtyArea.extend(Common::Rect(x, y, x + w, y + h));
-	}
+	addDirtyArea(Common::Rect(x, y, x + w, y + h));
 
 	const byte *src = (const byte *)srcPtr;
 	byte *dst = (byte *)dstSurf->getBasePtr(x, y);
@@ -214,11 +296,103 @@ void Surface::fill(uint32 color) {
 	flagDirty();
 }
 
-Common::Rect Surface::getDirtyArea() const {
+Common::Rect Surface::getDirtyArea(uint index) const {
 	if (_allDirty) {
 		return Common::Rect(getWidth(), getHeight());
 	} else {
-		return _dirtyArea;
+		return _dirtyAreas[index];
+	}
+}
+
+namespace {
+inline int rectArea(const Common::Rect &rect) {
+	return rect.width() * rect.height();
+}
+} // End of anonymous namespace
+
+void Surface::addDirtyArea(const Common::Rect &area) {
+	// *sigh* Common::Rect::extend behaves unexpected whenever one of the two
+	// parameters is an empty rect. Thus, we ignore empty areas.
+	if (_allDirty || area.isEmpty()) {
+		return;
+	}
+
+	Common::Rect merged = area;
+
+	// Merge all areas which overlap the new area, or are close enough that
+	// uploading their bounding rect costs nothing extra. Each merge can make
+	// the merged area reach further areas, so start over after each one.
+	for (uint i = 0; i < _numDirtyAreas;) {
+		Common::Rect bounds = merged;
+		bounds.extend(_dirtyAreas[i]);
+
+		if (merged.intersects(_dirtyAreas[i]) || rectArea(bounds) <= rectArea(merged) + rectArea(_dirtyAreas[i])) {
+			merged = bounds;
+			_dirtyAreas[i] = _dirtyAreas[--_numDirtyAreas];
+			i = 0;
+		} else {
+			++i;
+		}
+	}
+
+	// When the list is full, merge with the area whose bounding rect wastes
+	// the fewest pixels.
+	if (_numDirtyAreas == kMaxDirtyAreas) {
+		uint best = 0;
+		int bestWaste = 0;
+
+		for (uint i = 0; i < _numDirtyAreas; ++i) {
+			Common::Rect bounds = merged;
+			bounds.extend(_dirtyAreas[i]);
+
+			const int waste = rectArea(bounds) - rectArea(merged) - rectArea(_dirtyAreas[i]);
+			if (i == 0 || waste < bestWaste) {
+				best = i;
+				bestWaste = waste;
+			}
+		}
+
+		// The result might now overlap others, so add it again.
+		merged.extend(_dirtyAreas[best]);
+		_dirtyAreas[best] = _dirtyAreas[--_numDirtyAreas];
+		addDirtyArea(merged);
+		return;
+	}
+
+	if (merged.width() == (int)getWidth() && merged.height() == (int)getHeight()) {
+		flagDirty();
+		return;
+	}
+
+	_dirtyAreas[_numDirtyAreas++] = merged;
+}
+
+void Surface::mergeDirtyRows() {
+	if (_allDirty) {
+		return;
+	}
+
+	for (uint i = 0; i < _numDirtyAreas; ++i) {
+		_dirtyAreas[i].left = 0;
+		_dirtyAreas[i].right = getWidth();
+	}
+
+	// Each merge can make the area reach further areas, so start over after
+	// each one.
+	for (uint i = 0; i < _numDirtyAreas;) {
+		uint j = i + 1;
+		while (j < _numDirtyAreas && (_dirtyAreas[j].top > _dirtyAreas[i].bottom || _dirtyAreas[j].bottom < _dirtyAreas[i].top)) {
+			++j;
+		}
+
+		if (j < _numDirtyAreas) {
+			_dirtyAreas[i].top = MIN(_dirtyAreas[i].top, _dirtyAreas[j].top);
+			_dirtyAreas[i].bottom = MAX(_dirtyAreas[i].bottom, _dirtyAreas[j].bottom);
+			_dirtyAreas[j] = _dirtyAreas[--_numDirtyAreas];
+			i = 0;
+		} else {
+			++i;
+		}
 	}
 }
 
@@ -279,8 +453,19 @@ void Texture::updateGLTexture() {
 		return;
 	}
 
-	Common::Rect dirtyArea = getDirtyArea();
+	if (_glTexture.uploadsWholeRows()) {
+		mergeDirtyRows();
+	}
+
+	for (uint i = 0; i < getDirtyAreaCount(); ++i) {
+		updateArea(getDirtyArea(i));
+	}
+
+	// We should have handled everything, thus not dirty anymore.
+	clearDirty();
+}
 
+void Texture::updateArea(Common::Rect dirtyArea) {
 	// In case we use linear filtering we might need to duplicate the last
 	// pixel row/column to avoid glitches with filtering.
 	if (_glTexture.isLinearFilteringEnabled()) {
@@ -311,9 +496,6 @@ void Texture::updateGLTexture() {
 	}
 
 	_glTexture.updateArea(dirtyArea, _textureData);
-
-	// We should have handled everything, thus not dirty anymore.
-	clearDirty();
 }
 
 TextureCLUT8::TextureCLUT8(GLenum glIntFormat, GLenum glFormat, GLenum glType, const Graphics::PixelFormat &format)
@@ -410,20 +592,23 @@ void TextureCLUT8::updateGLTexture() {
 	// Do the palette look up
 	Graphics::Surface *outSurf = Texture::getSurface();
 
-	Common::Rect dirtyArea = getDirtyArea();
-
-	if (outSurf->format.bytesPerPixel == 2) {
-		doPaletteLookUp<uint16>((uint16 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top),
-		                        (const byte *)_clut8Data.getBasePtr(dirtyArea.left, dirtyArea.top),
-		                        dirtyArea.width(), dirtyArea.height(),
-		                        outSurf->pitch, _clut8Data.pitch, (const uint16 *)_palette);
-	} else if (outSurf->format.bytesPerPixel == 4) {
-		doPaletteLookUp<uint32>((uint32 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top),
-		                        (const byte *)_clut8Data.getBasePtr(dirtyArea.left, dirtyArea.top),
-		                        dirtyArea.width(), dirtyArea.height(),
-		                        outSurf->pitch, _clut8Data.pitch, (const uint32 *)_palette);
-	} else {
-		warning("TextureCLUT8::updateTexture: Unsupported pixel depth: %d", outSurf->format.bytesPerPixel);
+	for (uint i = 0; i < getDirtyAreaCount(); ++i) {
+		const Common::Rect dirtyArea = getDirtyArea(i);
+
+		if (outSurf->format.bytesPerPixel == 2) {
+			doPaletteLookUp<uint16>((uint16 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top),
+			                        (const byte *)_clut8Data.getBasePtr(dirtyArea.left, dirtyArea.top),
+			                        dirtyArea.width(), dirtyArea.height(),
+			                        outSurf->pitch, _clut8Data.pitch, (const uint16 *)_palette);
+		} else if (outSurf->format.bytesPerPixel == 4) {
+			doPaletteLookUp<uint32>((uint32 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top),
+			                        (const byte *)_clut8Data.getBasePtr(dirtyArea.left, dirtyArea.top),
+			                        dirtyArea.width(), dirtyArea.height(),
+			                        outSurf->pitch, _clut8Data.pitch, (const uint32 *)_palette);
+		} else {
+			warning("TextureCLUT8::updateTexture: Unsupported pixel depth: %d", outSurf->format.bytesPerPixel);
+			break;
+		}
 	}
 
 	// Do generic handling of updating the texture.
@@ -456,7 +641,7 @@ Graphics::PixelFormat TextureRGB555::getFormat() const {
 	return Graphics::PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0);
 }
 
-void TextureRGB555::updateTexture() {
+void TextureRGB555::updateGLTexture() {
 	if (!isDirty()) {
 		return;
 	}
@@ -464,25 +649,27 @@ void TextureRGB555::updateTexture() {
 	// Convert color space.
 	Graphics::Surface *outSurf = Texture::getSurface();
 
-	const Common::Rect dirtyArea = getDirtyArea();
+	for (uint i = 0; i < getDirtyAreaCount(); ++i) {
+		const Common::Rect dirtyArea = getDirtyArea(i);
 
-	uint16 *dst = (uint16 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top);
-	const uint dstAdd = outSurf->pitch - 2 * dirtyArea.width();
+		uint16 *dst = (uint16 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top);
+		const uint dstAdd = outSurf->pitch - 2 * dirtyArea.width();
 
-	const uint16 *src = (const uint16 *)_rgb555Data.getBasePtr(dirtyArea.left, dirtyArea.top);
-	const uint srcAdd = _rgb555Data.pitch - 2 * dirtyArea.width();
+		const uint16 *src = (const uint16 *)_rgb555Data.getBasePtr(dirtyArea.left, dirtyArea.top);
+		const uint srcAdd = _rgb555Data.pitch - 2 * dirtyArea.width();
 
-	for (int height = dirtyArea.height(); height > 0; --height) {
-		for (int width = dirtyArea.width(); width > 0; --width) {
-			const uint16 color = *src++;
+		for (int height = dirtyArea.height(); height > 0; --height) {
+			for (int width = dirtyArea.width(); width > 0; --width) {
+				const uint16 color = *src++;
 
-			*dst++ =   ((color & 0x7C00) << 1)                             // R
-			         | (((color & 0x03E0) << 1) | ((color & 0x0200) >> 4)) // G
-			         | (color & 0x001F);                                   // B
-		}
+				*dst++ =   ((color & 0x7C00) << 1)                             // R
+				         | (((color & 0x03E0) << 1) | ((color & 0x0200) >> 4)) // G
+				         | (color & 0x001F);                                   // B
+			}
 
-		src = (const uint16 *)((const byte *)src + srcAdd);
-		dst = (uint16 *)((byte *)dst + dstAdd);
+			src = (const uint16 *)((const byte *)src + srcAdd);
+			dst = (uint16 *)((byte *)dst + dstAdd);
+		}
 	}
 
 	// Do generic handling of updating the texture.
@@ -609,7 +796,13 @@ void TextureCLUT8GPU::updateGLTexture() {
 
 	// Update CLUT8 texture if necessary.
 	if (Surface::isDirty()) {
-		_clut8Texture.updateArea(getDirtyArea(), _clut8Data);
+		if (_clut8Texture.uploadsWholeRows()) {
+			mergeDirtyRows();
+		}
+
+		for (uint i = 0; i < getDirtyAreaCount(); ++i) {
+			_clut8Texture.updateArea(getDirtyArea(i), _clut8Data);
+		}
 		clearDirty();
 	}
 
@@ -92,6 +92,11 @@ public:
 	/**
 	 * Copy image data to the texture.
 	 *
+	 * When pixel buffer objects are supported, the data is staged in one of
+	 * two buffers which are used in turns. The driver can then transfer it
+	 * to the texture asynchronously instead of blocking until the texture
+	 * is no longer in use.
+	 *
 	 * @param area     The area to update.
 	 * @param src      Surface for the whole texture containing the pixel data
 	 *                 to upload. Only the area described by area will be
@@ -99,6 +104,23 @@ public:
 	 */
 	void updateArea(const Common::Rect &area, const Graphics::Surface &src);
 
+	/**
+	 * Query whether updateArea() uploads whole texture rows, which it does
+	 * when pixel buffer objects are not available.
+	 */
+	bool uploadsWholeRows() const;
+
+	/**
+	 * Query the number of bytes passed to OpenGL by updateArea() of all
+	 * textures since the last resetUploadedBytes() call.
+	 */
+	static uint32 getUploadedBytes() { return _uploadedBytes; }
+
+	/**
+	 * Reset the counter returned by getUploadedBytes().
+	 */
+	static void resetUploadedBytes() { _uploadedBytes = 0; }
+
 	/**
 	 * Query the GL texture's width.
 	 */
@@ -132,6 +154,8 @@ public:
 	 */
 	GLuint getGLTexture() const { return _glTexture; }
 private:
+	bool updateAreaBuffered(const Common::Rect &area, const Graphics::Surface &src);
+
 	const GLenum _glIntFormat;
 	const GLenum _glFormat;
 	const GLenum _glType;
@@ -143,6 +167,11 @@ private:
 	GLint _glFilter;
 
 	GLuint _glTexture;
+
+	GLuint _pixelBuffers[2];
+	uint _nextPixelBuffer;
+
+	static uint32 _uploadedBytes;
 };
 
 /**
@@ -201,7 +230,7 @@ public:
 	void fill(uint32 color);
 
 	void flagDirty() { _allDirty = true; }
-	virtual bool isDirty() const { return _allDirty || !_dirtyArea.isEmpty(); }
+	virtual bool isDirty() const { return _allDirty || _numDirtyAreas != 0; }
 
 	virtual uint getWidth() const = 0;
 	virtual uint getHeight() const = 0;
@@ -239,12 +268,35 @@ public:
 	 */
 	virtual const GLTexture &getGLTexture() const = 0;
 protected:
-	void clearDirty() { _allDirty = false; _dirtyArea = Common::Rect(); }
+	void clearDirty() { _allDirty = false; _numDirtyAreas = 0; }
 
-	Common::Rect getDirtyArea() const;
+	/**
+	 * @return The number of areas which need to be updated.
+	 */
+	uint getDirtyAreaCount() const { return _allDirty ? 1 : _numDirtyAreas; }
+
+	/**
+	 * @return The area with the given index, which does not overlap any
+	 *         other dirty area.
+	 */
+	Common::Rect getDirtyArea(uint index) const;
+
+	/**
+	 * Extend the dirty areas to whole rows and merge the ones which share
+	 * or touch rows. Use this when the texture can only upload whole rows,
+	 * so every row is uploaded once.
+	 */
+	void mergeDirtyRows();
 private:
+	void addDirtyArea(const Common::Rect &area);
+
+	enum {
+		kMaxDirtyAreas = 16
+	};
+
 	bool _allDirty;
-	Common::Rect _dirtyArea;
+	Common::Rect _dirtyAreas[kMaxDirtyAreas];
+	uint _numDirtyAreas;
 };
 
 /**
@@ -289,6 +341,8 @@ protected:
 	const Graphics::PixelFormat _format;
 
 private:
+	void updateArea(Common::Rect area);
+
 	GLTexture _glTexture;
 
 	Graphics::Surface _textureData;
@@ -331,7 +385,7 @@ public:
 	virtual Graphics::Surface *getSurface() { return &_rgb555Data; }
 	virtual const Graphics::Surface *getSurface() const { return &_rgb555Data; }
 
-	virtual void updateTexture();
+	virtual void updateGLTexture();
 private:
 	Graphics::Surface _rgb555Data;
 };
@@ -25,6 +25,7 @@
 
 #include "backends/graphics/graphics.h"
 #include "backends/graphics/sdl/sdl-graphics.h"
+#include "backends/graphics/surfacesdl/surfacesdl-scalerpool.h"
 #include "graphics/pixelformat.h"
 #include "graphics/scaler.h"
 #include "common/events.h"
@@ -273,6 +274,7 @@ protected:
 #endif
 
 	ScalerProc *_scalerProc;
+	SdlScalerPool _scalerPool;
 	int _scalerType;
 	int _transactionMode;
 
@@ -0,0 +1,157 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+#include "common/scummsys.h"
+
+#if defined(SDL_BACKEND)
+
+#include "backends/graphics/surfacesdl/surfacesdl-scalerpool.h"
+#include "common/textconsole.h"
+#include "common/util.h"
+
+SdlScalerPool::SdlScalerPool()
+	: _mutex(nullptr), _workCond(nullptr), _doneCond(nullptr),
+	  _nextBand(0), _pendingBands(0), _quit(false) {
+	memset(&_job, 0, sizeof(_job));
+
+	int numThreads = 1;
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	numThreads = MIN<int>(SDL_GetCPUCount(), kMaxThreads);
+#endif
+	if (numThreads <= 1)
+		return;
+
+	_mutex = SDL_CreateMutex();
+	_workCond = SDL_CreateCond();
+	_doneCond = SDL_CreateCond();
+	if (!_mutex || !_workCond || !_doneCond) {
+		warning("Could not create scaler thread synchronization objects: %s", SDL_GetError());
+		return;
+	}
+
+	for (int i = 1; i < numThreads; ++i) {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+		SDL_Thread *thread = SDL_CreateThread(workerThread, "ScummVM Scaler", this);
+#else
+		SDL_Thread *thread = SDL_CreateThread(workerThread, this);
+#endif
+		if (!thread) {
+			warning("Could not create scaler thread: %s", SDL_GetError());
+			break;
+		}
+		_threads.push_back(thread);
+	}
+}
+
+SdlScalerPool::~SdlScalerPool() {
+	if (!_threads.empty()) {
+		SDL_LockMutex(_mutex);
+		_quit = true;
+		SDL_CondBroadcast(_workCond);
+		SDL_UnlockMutex(_mutex);
+	}
+
+	for (uint i = 0; i < _threads.size(); ++i)
+		SDL_WaitThread(_threads[i], nullptr);
+
+	if (_doneCond)
+		SDL_DestroyCond(_doneCond);
+	if (_workCond)
+		SDL_DestroyCond(_workCond);
+	if (_mutex)
+		SDL_DestroyMutex(_mutex);
+}
+
+void SdlScalerPool::scale(ScalerProc *scalerProc, const byte *srcPtr, uint32 srcPitch,
+                          byte *dstPtr, uint32 dstPitch, int width, int height, int scaleFactor) {
+	if (_threads.empty() || width * height < kMinParallelPixels) {
+		scalerProc(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+		return;
+	}
+
+	// Split the rect into one band per thread. The band height is kept even,
+	// since Normal1o5x scales pairs of lines and DotMatrix uses a pattern
+	// which depends on the line number within the rect.
+	const int numThreads = _threads.size() + 1;
+	const int bandHeight = ((height + numThreads - 1) / numThreads + 1) & ~1;
+
+	SDL_LockMutex(_mutex);
+	_job.scalerProc = scalerProc;
+	_job.srcPtr = srcPtr;
+	_job.srcPitch = srcPitch;
+	_job.dstPtr = dstPtr;
+	_job.dstPitch = dstPitch;
+	_job.width = width;
+	_job.height = height;
+	_job.scaleFactor = scaleFactor;
+	_job.bandHeight = bandHeight;
+	_job.numBands = (height + bandHeight - 1) / bandHeight;
+	_nextBand = 0;
+	_pendingBands = _job.numBands;
+	SDL_CondBroadcast(_workCond);
+	SDL_UnlockMutex(_mutex);
+
+	runBands();
+
+	SDL_LockMutex(_mutex);
+	while (_pendingBands > 0)
+		SDL_CondWait(_doneCond, _mutex);
+	SDL_UnlockMutex(_mutex);
+}
+
+void SdlScalerPool::runBands() {
+	SDL_LockMutex(_mutex);
+	while (_nextBand < _job.numBands) {
+		const Job job = _job;
+		const int y = _nextBand++ * job.bandHeight;
+		SDL_UnlockMutex(_mutex);
+
+		const int h = MIN(job.bandHeight, job.height - y);
+		job.scalerProc(job.srcPtr + y * job.srcPitch, job.srcPitch,
+		               job.dstPtr + y * job.scaleFactor * job.dstPitch, job.dstPitch,
+		               job.width, h);
+
+		SDL_LockMutex(_mutex);
+		if (--_pendingBands == 0)
+			SDL_CondSignal(_doneCond);
+	}
+	SDL_UnlockMutex(_mutex);
+}
+
+int SDLCALL SdlScalerPool::workerThread(void *data) {
+	SdlScalerPool *pool = (SdlScalerPool *)data;
+
+	SDL_LockMutex(pool->_mutex);
+	while (!pool->_quit) {
+		if (pool->_nextBand < pool->_job.numBands) {
+			SDL_UnlockMutex(pool->_mutex);
+			pool->runBands();
+			SDL_LockMutex(pool->_mutex);
+		} else {
+			SDL_CondWait(pool->_workCond, pool->_mutex);
+		}
+	}
+	SDL_UnlockMutex(pool->_mutex);
+
+	return 0;
+}
+
+#endif
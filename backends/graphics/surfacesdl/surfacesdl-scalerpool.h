@@ -0,0 +1,91 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+#ifndef BACKENDS_GRAPHICS_SURFACESDL_SCALERPOOL_H
+#define BACKENDS_GRAPHICS_SURFACESDL_SCALERPOOL_H
+
+#include "backends/platform/sdl/sdl-sys.h"
+#include "graphics/scaler.h"
+#include "common/array.h"
+
+/**
+ * Runs a scaler over a rect using several threads.
+ *
+ * Large rects are split into horizontal bands, which are scaled by worker
+ * threads and the calling thread at the same time. The scalers only read the
+ * source surface, including the pixels around each band, and every band
+ * writes a disjoint part of the destination, so the result is identical to
+ * a single call of the scaler on the whole rect.
+ */
+class SdlScalerPool {
+public:
+	SdlScalerPool();
+	~SdlScalerPool();
+
+	/**
+	 * Scale the given rect, returning once all of it has been scaled.
+	 * The parameters match those of ScalerProc, with scaleFactor being the
+	 * number of destination lines each source line is scaled to.
+	 */
+	void scale(ScalerProc *scalerProc, const byte *srcPtr, uint32 srcPitch,
+	           byte *dstPtr, uint32 dstPitch, int width, int height, int scaleFactor);
+
+private:
+	enum {
+		/** Maximum number of threads to use, including the calling one. */
+		kMaxThreads = 4,
+		/** Rects with fewer source pixels are always scaled on the calling thread. */
+		kMinParallelPixels = 320 * 32
+	};
+
+	struct Job {
+		ScalerProc *scalerProc;
+		const byte *srcPtr;
+		uint32 srcPitch;
+		byte *dstPtr;
+		uint32 dstPitch;
+		int width;
+		int height;
+		int scaleFactor;
+		int bandHeight;
+		int numBands;
+	};
+
+	static int SDLCALL workerThread(void *data);
+
+	/**
+	 * Scale bands of the current job until none is left. The mutex must not
+	 * be locked by the caller.
+	 */
+	void runBands();
+
+	Common::Array<SDL_Thread *> _threads;
+	SDL_mutex *_mutex;
+	SDL_cond *_workCond;
+	SDL_cond *_doneCond;
+
+	Job _job;
+	int _nextBand;
+	int _pendingBands;
+	bool _quit;
+};
+
+#endif
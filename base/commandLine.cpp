@@ -42,6 +42,7 @@
 #include "gui/ThemeEngine.h"
 
 #include "audio/musicplugin.h"
+#include "video/bink_decoder.h"
 
 #define DETECTOR_TESTING_HACK
 #define UPGRADE_ALL_TARGETS_HACK
@@ -115,6 +116,10 @@ static const char HELP_STRING[] =
 	"  --debug-channels-only    Show only the specified debug channels\n"
 	"  -u, --dump-scripts       Enable script dumping if a directory called 'dumps'\n"
 	"                           exists in the current directory\n"
+#ifdef USE_BINK
+	"  --benchmark-video=FILE   Decode a Bink video as fast as possible and report\n"
+	"                           the frame rate\n"
+#endif
 	"\n"
 	"  --cdrom=DRIVE            CD drive to play CD audio from; can either be a\n"
 	"                           drive, path, or numeric index (default: 0 = best\n"
@@ -212,6 +217,9 @@ void registerDefaults() {
 	ConfMan.registerDefault("speech_mute", false);
 	ConfMan.registerDefault("mute", false);
 
+	ConfMan.registerDefault("resampler_quality", "linear");
+	ConfMan.registerDefault("headroom_mixing", false);
+
 	ConfMan.registerDefault("multi_midi", false);
 	ConfMan.registerDefault("native_mt32", false);
 	ConfMan.registerDefault("enable_gs", false);
@@ -450,6 +458,11 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
 				return "list-saves";
 			END_OPTION
 
+#ifdef USE_BINK
+			DO_LONG_OPTION("benchmark-video")
+			END_OPTION
+#endif
+
 			DO_OPTION('c', "config")
 			END_OPTION
 
@@ -1134,6 +1147,34 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
 #endif // DISABLE_COMMAND_LINE
 
 
+#ifdef USE_BINK
+Common::Error benchmarkVideo(const Common::String &filename) {
+	Common::FSNode node(filename);
+	Common::SeekableReadStream *stream = node.createReadStream();
+	if (!stream) {
+		printf("Could not open '%s'\n", filename.c_str());
+		return Common::kReadingFailed;
+	}
+
+	Video::BinkDecoder video;
+	if (!video.loadStream(stream)) {
+		printf("'%s' is not a Bink video\n", filename.c_str());
+		delete stream;
+		return Common::kUnknownError;
+	}
+
+	const int frameCount = video.getFrameCount();
+	const uint32 start = g_system->getMillis();
+	while (video.getCurFrame() + 1 < frameCount)
+		video.decodeNextFrame();
+	const uint32 time = MAX<uint32>(g_system->getMillis() - start, 1);
+
+	printf("%s: %dx%d, %d frames in %d ms, %.1f fps\n", filename.c_str(), video.getWidth(), video.getHeight(),
+			frameCount, time, frameCount * 1000.0 / time);
+	return Common::kNoError;
+}
+#endif
+
 bool processSettings(Common::String &command, Common::StringMap &settings, Common::Error &err) {
 	err = Common::kNoError;
 
@@ -55,6 +55,15 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
  */
 bool processSettings(Common::String &command, Common::StringMap &settings, Common::Error &err);
 
+#ifdef USE_BINK
+/**
+ * Decode all frames of a Bink video as fast as possible and print the
+ * resulting frame rate. Used for --benchmark-video, after the backend
+ * has been initialized.
+ */
+Common::Error benchmarkVideo(const Common::String &filename);
+#endif
+
 } // End of namespace Base
 
 #endif
@@ -178,6 +178,9 @@ static Common::Error runGame(const Plugin *plugin, OSystem &system, const Common
 			ConfMan.registerDefault(engineOptions[i].configOption, engineOptions[i].defaultState);
 		}
 
+		// Count the string heap traffic caused by the engine
+		Common::String::resetAllocStats();
+
 		err = metaEngine.createInstance(&system, &engine);
 	}
 
@@ -266,6 +269,10 @@ static Common::Error runGame(const Plugin *plugin, OSystem &system, const Common
 	// Inform backend that the engine finished
 	system.engineDone();
 
+	const Common::String::AllocStats &stringStats = Common::String::getAllocStats();
+	debug(1, "String heap allocations: %u allocs, %u frees, %u bytes, %u shared copies",
+		stringStats.allocs, stringStats.frees, stringStats.bytes, stringStats.shares);
+
 	// Clean up any game-specific keymaps
 	engine->deinitKeymap();
 
@@ -496,6 +503,13 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 	CloudMan.syncSaves();
 #endif
 
+#ifdef USE_BINK
+	if (settings.contains("benchmark-video")) {
+		Common::Error result = Base::benchmarkVideo(settings["benchmark-video"]);
+		if (result.getCode() != Common::kNoError)
+			warning("%s", result.getDesc().c_str());
+	} else
+#endif
 	// Unless a game was specified, show the launcher dialog
 	if (0 == ConfMan.getActiveDomain())
 		launcherDialog();
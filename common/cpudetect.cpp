@@ -0,0 +1,135 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/cpudetect.h"
+
+#if defined(SCUMMVM_SSE2) || defined(SCUMMVM_AVX2)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__GNUC__)
+#include <cpuid.h>
+#endif
+#endif
+
+#if defined(SCUMMVM_NEON) && !defined(__ARM_NEON) && !defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+namespace Common {
+
+#if defined(SCUMMVM_SSE2) || defined(SCUMMVM_AVX2)
+
+static void cpuid(uint32 leaf, uint32 subLeaf, uint32 regs[4]) {
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuidex(info, leaf, subLeaf);
+	for (int i = 0; i < 4; ++i)
+		regs[i] = info[i];
+#elif defined(__GNUC__)
+	regs[0] = regs[1] = regs[2] = regs[3] = 0;
+	if (leaf <= __get_cpuid_max(0, 0))
+		__cpuid_count(leaf, subLeaf, regs[0], regs[1], regs[2], regs[3]);
+#else
+	regs[0] = regs[1] = regs[2] = regs[3] = 0;
+#endif
+}
+
+static uint32 detectX86Features() {
+	uint32 features = 0;
+	uint32 regs[4];
+
+	cpuid(1, 0, regs);
+	if (regs[3] & (1 << 26))
+		features |= kCPUFeatureSSE2;
+
+	// AVX2 additionally needs the OS to save the upper YMM register
+	// halves on context switches, which is signalled through XCR0.
+	const bool osxsave = (regs[2] & (1 << 27)) != 0;
+	const bool avx = (regs[2] & (1 << 28)) != 0;
+	if (osxsave && avx) {
+		uint32 xcr0;
+#if defined(_MSC_VER)
+		xcr0 = (uint32)_xgetbv(0);
+#elif defined(__GNUC__)
+		uint32 edx;
+		__asm__ volatile("xgetbv" : "=a" (xcr0), "=d" (edx) : "c" (0));
+#else
+		xcr0 = 0;
+#endif
+		if ((xcr0 & 6) == 6) {
+			cpuid(7, 0, regs);
+			if (regs[1] & (1 << 5))
+				features |= kCPUFeatureAVX2;
+		}
+	}
+
+	return features;
+}
+
+#endif
+
+static uint32 detectFeatures() {
+	uint32 features = 0;
+
+#if defined(SCUMMVM_SSE2) || defined(SCUMMVM_AVX2)
+	features |= detectX86Features();
+#endif
+
+#ifdef SCUMMVM_NEON
+#if defined(__ARM_NEON) || defined(__aarch64__)
+	// NEON is part of the baseline of the architecture we compile for
+	features |= kCPUFeatureNEON;
+#elif defined(__linux__)
+	if (getauxval(AT_HWCAP) & HWCAP_NEON)
+		features |= kCPUFeatureNEON;
+#endif
+#endif
+
+#ifndef SCUMMVM_SSE2
+	features &= ~kCPUFeatureSSE2;
+#endif
+#ifndef SCUMMVM_AVX2
+	features &= ~kCPUFeatureAVX2;
+#endif
+
+	return features;
+}
+
+static bool s_featuresDetected = false;
+static uint32 s_features = 0;
+static uint32 s_featureMask = 0xFFFFFFFF;
+
+bool hasCPUFeature(CPUFeature feature) {
+	if (!s_featuresDetected) {
+		s_features = detectFeatures();
+		s_featuresDetected = true;
+	}
+
+	return (s_features & s_featureMask & feature) != 0;
+}
+
+void setCPUFeatureMask(uint32 mask) {
+	s_featureMask = mask;
+}
+
+} // End of namespace Common
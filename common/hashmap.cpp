@@ -20,9 +20,9 @@
  *
  */
 
-// The hash map (associative array) implementation in this file is
-// based on the PyDict implementation of CPython. The erase() method
-// is based on example code in the Wikipedia article on Hash tables.
+// The hash map (associative array) itself is implemented in hashmap.h;
+// this file only contains the string hash functions and the collision
+// statistics.
 
 #include "common/hashmap.h"
 
@@ -20,8 +20,10 @@
  *
  */
 
-// The hash map (associative array) implementation in this file is
-// based on the PyDict implementation of CPython.
+// The hash map (associative array) implementation in this file uses
+// open addressing with linear probing and Robin Hood insertion. The
+// hash of every entry is stored in the bucket next to the node pointer,
+// so that probing rarely has to touch the nodes themselves.
 
 #ifndef COMMON_HASHMAP_H
 #define COMMON_HASHMAP_H
@@ -95,7 +97,6 @@ private:
 	};
 
 	enum {
-		HASHMAP_PERTURB_SHIFT = 5,
 		HASHMAP_MIN_CAPACITY = 16,
 
 		// The quotient of the next two constants controls how much the
@@ -113,7 +114,16 @@ private:
 	ObjectPool<Node, HASHMAP_MEMORYPOOL_SIZE> _nodePool;
 #endif
 
-	Node **_storage;	///< hashtable of size arrsize.
+	/**
+	 * A bucket of the hashtable. The hash of the node is stored right next
+	 * to it, so that probing rarely has to touch the nodes themselves.
+	 */
+	struct Bucket {
+		Node *_node;
+		size_type _hash;	///< Stored hash of the node; 0 for empty buckets
+	};
+
+	Bucket *_storage;	///< hashtable of size arrsize.
 	size_type _mask;		///< Capacity of the HashMap minus one; must be a power of two of minus one
 	size_type _size;
 	size_type _deleted; ///< Number of deleted elements (_dummyNodes)
@@ -127,6 +137,12 @@ private:
 	/** Dummy node, used as marker for erased objects. */
 	#define HASHMAP_DUMMY_NODE	((Node *)1)
 
+	/**
+	 * Set on every stored hash, so that a zero stored hash always
+	 * denotes an empty bucket.
+	 */
+	#define HASHMAP_HASH_USED	0x80000000U
+
 #ifdef DEBUG_HASH_COLLISIONS
 	mutable int _collisions, _lookups, _dummyHits;
 #endif
@@ -148,9 +164,30 @@ private:
 #endif
 	}
 
+	/**
+	 * Compute the hash stored for the given key. The hash functor result is
+	 * scrambled first, since linear probing only looks at the low bits and
+	 * many of our hash functors (e.g. for integers) are the identity.
+	 */
+	size_type storedHash(const Key &key) const {
+		size_type hash = _hash(key);
+		hash ^= hash >> 16;
+		hash *= 0x45D9F3BU;
+		hash ^= hash >> 16;
+		return hash | HASHMAP_HASH_USED;
+	}
+
+	/** Distance of the entry in the given bucket from its home bucket. */
+	size_type probeDistance(size_type idx) const {
+		return (idx - _storage[idx]._hash) & _mask;
+	}
+
+	void allocStorage(size_type capacity);
 	void assign(const HM_t &map);
-	size_type lookup(const Key &key) const;
+	size_type lookup(const Key &key, size_type hash, size_type *probeLength = 0) const;
 	size_type lookupAndCreateIfMissing(const Key &key);
+	size_type insertNode(Node *node, size_type hash, size_type dist = 0);
+	void eraseBucket(size_type ctr);
 	void expandStorage(size_type newCapacity);
 
 #if !defined(__sgi) || defined(__GNUC__)
@@ -180,7 +217,7 @@ private:
 		NodeType *deref() const {
 			assert(_hashmap != 0);
 			assert(_idx <= _hashmap->_mask);
-			Node *node = _hashmap->_storage[_idx];
+			Node *node = _hashmap->_storage[_idx]._node;
 			assert(node != 0);
 			assert(node != HASHMAP_DUMMY_NODE);
 			return node;
@@ -201,7 +238,7 @@ private:
 			assert(_hashmap);
 			do {
 				_idx++;
-			} while (_idx <= _hashmap->_mask && (_hashmap->_storage[_idx] == 0 || _hashmap->_storage[_idx] == HASHMAP_DUMMY_NODE));
+			} while (_idx <= _hashmap->_mask && (_hashmap->_storage[_idx]._node == 0 || _hashmap->_storage[_idx]._node == HASHMAP_DUMMY_NODE));
 			if (_idx > _hashmap->_mask)
 				_idx = (size_type)-1;
 
@@ -255,7 +292,7 @@ public:
 	iterator	begin() {
 		// Find and return the first non-empty entry
 		for (size_type ctr = 0; ctr <= _mask; ++ctr) {
-			if (_storage[ctr] && _storage[ctr] != HASHMAP_DUMMY_NODE)
+			if (_storage[ctr]._node && _storage[ctr]._node != HASHMAP_DUMMY_NODE)
 				return iterator(ctr, this);
 		}
 		return end();
@@ -267,7 +304,7 @@ public:
 	const_iterator	begin() const {
 		// Find and return the first non-empty entry
 		for (size_type ctr = 0; ctr <= _mask; ++ctr) {
-			if (_storage[ctr] && _storage[ctr] != HASHMAP_DUMMY_NODE)
+			if (_storage[ctr]._node && _storage[ctr]._node != HASHMAP_DUMMY_NODE)
 				return const_iterator(ctr, this);
 		}
 		return end();
@@ -277,15 +314,15 @@ public:
 	}
 
 	iterator	find(const Key &key) {
-		size_type ctr = lookup(key);
-		if (_storage[ctr])
+		size_type ctr = lookup(key, storedHash(key));
+		if (ctr <= _mask)
 			return iterator(ctr, this);
 		return end();
 	}
 
 	const_iterator	find(const Key &key) const {
-		size_type ctr = lookup(key);
-		if (_storage[ctr])
+		size_type ctr = lookup(key, storedHash(key));
+		if (ctr <= _mask)
 			return const_iterator(ctr, this);
 		return end();
 	}
@@ -313,10 +350,7 @@ HashMap<Key, Val, HashFunc, EqualFunc>::HashMap()
 #else
 	: _defaultVal() {
 #endif
-	_mask = HASHMAP_MIN_CAPACITY - 1;
-	_storage = new Node *[HASHMAP_MIN_CAPACITY];
-	assert(_storage != NULL);
-	memset(_storage, 0, HASHMAP_MIN_CAPACITY * sizeof(Node *));
+	allocStorage(HASHMAP_MIN_CAPACITY);
 
 	_size = 0;
 	_deleted = 0;
@@ -350,7 +384,7 @@ HashMap<Key, Val, HashFunc, EqualFunc>::HashMap(const HM_t &map) :
 template<class Key, class Val, class HashFunc, class EqualFunc>
 HashMap<Key, Val, HashFunc, EqualFunc>::~HashMap() {
 	for (size_type ctr = 0; ctr <= _mask; ++ctr)
-	  freeNode(_storage[ctr]);
+	  freeNode(_storage[ctr]._node);
 
 	delete[] _storage;
 #ifdef DEBUG_HASH_COLLISIONS
@@ -359,6 +393,21 @@ HashMap<Key, Val, HashFunc, EqualFunc>::~HashMap() {
 #endif
 }
 
+/**
+ * Internal method for allocating empty storage with the given capacity,
+ * which must be a power of two.
+ *
+ * @note We do *not* deallocate the previous storage here -- the caller is
+ *       responsible for doing that!
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void HashMap<Key, Val, HashFunc, EqualFunc>::allocStorage(size_type capacity) {
+	_mask = capacity - 1;
+	_storage = new Bucket[capacity];
+	assert(_storage != NULL);
+	memset(_storage, 0, capacity * sizeof(Bucket));
+}
+
 /**
  * Internal method for assigning the content of another HashMap
  * to this one.
@@ -368,21 +417,19 @@ HashMap<Key, Val, HashFunc, EqualFunc>::~HashMap() {
  */
 template<class Key, class Val, class HashFunc, class EqualFunc>
 void HashMap<Key, Val, HashFunc, EqualFunc>::assign(const HM_t &map) {
-	_mask = map._mask;
-	_storage = new Node *[_mask+1];
-	assert(_storage != NULL);
-	memset(_storage, 0, (_mask+1) * sizeof(Node *));
+	allocStorage(map._mask + 1);
 
 	// Simply clone the map given to us, one by one.
 	_size = 0;
 	_deleted = 0;
 	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
-		if (map._storage[ctr] == HASHMAP_DUMMY_NODE) {
-			_storage[ctr] = HASHMAP_DUMMY_NODE;
+		_storage[ctr]._hash = map._storage[ctr]._hash;
+		if (map._storage[ctr]._node == HASHMAP_DUMMY_NODE) {
+			_storage[ctr]._node = HASHMAP_DUMMY_NODE;
 			_deleted++;
-		} else if (map._storage[ctr] != NULL) {
-			_storage[ctr] = allocNode(map._storage[ctr]->_key);
-			_storage[ctr]->_value = map._storage[ctr]->_value;
+		} else if (map._storage[ctr]._node != NULL) {
+			_storage[ctr]._node = allocNode(map._storage[ctr]._node->_key);
+			_storage[ctr]._node->_value = map._storage[ctr]._node->_value;
 			_size++;
 		}
 	}
@@ -395,8 +442,9 @@ void HashMap<Key, Val, HashFunc, EqualFunc>::assign(const HM_t &map) {
 template<class Key, class Val, class HashFunc, class EqualFunc>
 void HashMap<Key, Val, HashFunc, EqualFunc>::clear(bool shrinkArray) {
 	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
-		freeNode(_storage[ctr]);
-		_storage[ctr] = NULL;
+		freeNode(_storage[ctr]._node);
+		_storage[ctr]._node = NULL;
+		_storage[ctr]._hash = 0;
 	}
 
 #ifdef USE_HASHMAP_MEMORY_POOL
@@ -406,50 +454,42 @@ void HashMap<Key, Val, HashFunc, EqualFunc>::clear(bool shrinkArray) {
 	if (shrinkArray && _mask >= HASHMAP_MIN_CAPACITY) {
 		delete[] _storage;
 
-		_mask = HASHMAP_MIN_CAPACITY;
-		_storage = new Node *[HASHMAP_MIN_CAPACITY];
-		assert(_storage != NULL);
-		memset(_storage, 0, HASHMAP_MIN_CAPACITY * sizeof(Node *));
+		allocStorage(HASHMAP_MIN_CAPACITY);
 	}
 
 	_size = 0;
 	_deleted = 0;
 }
 
+/**
+ * Rehash all entries into new storage of the given capacity. This also
+ * drops all erased entries, so it may be called with the current capacity
+ * to get rid of them.
+ */
 template<class Key, class Val, class HashFunc, class EqualFunc>
 void HashMap<Key, Val, HashFunc, EqualFunc>::expandStorage(size_type newCapacity) {
-	assert(newCapacity > _mask+1);
+	assert(newCapacity >= _mask+1);
 
 #ifndef NDEBUG
 	const size_type old_size = _size;
 #endif
 	const size_type old_mask = _mask;
-	Node **old_storage = _storage;
+	Bucket *old_storage = _storage;
 
 	// allocate a new array
 	_size = 0;
 	_deleted = 0;
-	_mask = newCapacity - 1;
-	_storage = new Node *[newCapacity];
-	assert(_storage != NULL);
-	memset(_storage, 0, newCapacity * sizeof(Node *));
+	allocStorage(newCapacity);
 
 	// rehash all the old elements
 	for (size_type ctr = 0; ctr <= old_mask; ++ctr) {
-		if (old_storage[ctr] == NULL || old_storage[ctr] == HASHMAP_DUMMY_NODE)
+		if (old_storage[ctr]._node == NULL || old_storage[ctr]._node == HASHMAP_DUMMY_NODE)
 			continue;
 
 		// Insert the element from the old table into the new table.
 		// Since we know that no key exists twice in the old table, we
-		// can do this slightly better than by calling lookup, since we
-		// don't have to call _equal().
-		const size_type hash = _hash(old_storage[ctr]->_key);
-		size_type idx = hash & _mask;
-		for (size_type perturb = hash; _storage[idx] != NULL && _storage[idx] != HASHMAP_DUMMY_NODE; perturb >>= HASHMAP_PERTURB_SHIFT) {
-			idx = (5 * idx + perturb + 1) & _mask;
-		}
-
-		_storage[idx] = old_storage[ctr];
+		// don't have to look for it first, and the hash is known already.
+		insertNode(old_storage[ctr]._node, old_storage[ctr]._hash);
 		_size++;
 	}
 
@@ -462,21 +502,34 @@ void HashMap<Key, Val, HashFunc, EqualFunc>::expandStorage(size_type newCapacity
 	return;
 }
 
+/**
+ * Look up the bucket of the given key. Returns _mask + 1 if the key is not
+ * contained in the hashmap. In that case, the number of buckets probed is
+ * stored in probeLength, if given; insertNode() can start from there.
+ */
 template<class Key, class Val, class HashFunc, class EqualFunc>
-typename HashMap<Key, Val, HashFunc, EqualFunc>::size_type HashMap<Key, Val, HashFunc, EqualFunc>::lookup(const Key &key) const {
-	const size_type hash = _hash(key);
+typename HashMap<Key, Val, HashFunc, EqualFunc>::size_type HashMap<Key, Val, HashFunc, EqualFunc>::lookup(const Key &key, size_type hash, size_type *probeLength) const {
 	size_type ctr = hash & _mask;
-	for (size_type perturb = hash; ; perturb >>= HASHMAP_PERTURB_SHIFT) {
-		if (_storage[ctr] == NULL)
+	size_type result = _mask + 1;
+	size_type dist;
+	for (dist = 0; ; ++dist) {
+		// Robin Hood insertion guarantees that no entry is stored further
+		// away from its home bucket than an entry probed before it. Hence
+		// the key can't be stored past an entry closer to its home bucket.
+		if (_storage[ctr]._hash == 0 || probeDistance(ctr) < dist)
 			break;
-		if (_storage[ctr] == HASHMAP_DUMMY_NODE) {
+		if (_storage[ctr]._hash == hash) {
+			if (_storage[ctr]._node == HASHMAP_DUMMY_NODE) {
 #ifdef DEBUG_HASH_COLLISIONS
-			_dummyHits++;
+				_dummyHits++;
 #endif
-		} else if (_equal(_storage[ctr]->_key, key))
-			break;
+			} else if (_equal(_storage[ctr]._node->_key, key)) {
+				result = ctr;
+				break;
+			}
+		}
 
-		ctr = (5 * ctr + perturb + 1) & _mask;
+		ctr = (ctr + 1) & _mask;
 
 #ifdef DEBUG_HASH_COLLISIONS
 		_collisions++;
@@ -490,74 +543,120 @@ typename HashMap<Key, Val, HashFunc, EqualFunc>::size_type HashMap<Key, Val, Has
 		(const void *)this, _mask+1, _size);
 #endif
 
-	return ctr;
+	if (probeLength)
+		*probeLength = dist;
+	return result;
 }
 
 template<class Key, class Val, class HashFunc, class EqualFunc>
 typename HashMap<Key, Val, HashFunc, EqualFunc>::size_type HashMap<Key, Val, HashFunc, EqualFunc>::lookupAndCreateIfMissing(const Key &key) {
-	const size_type hash = _hash(key);
-	size_type ctr = hash & _mask;
+	const size_type hash = storedHash(key);
+	size_type dist;
+	size_type ctr = lookup(key, hash, &dist);
+	if (ctr <= _mask)
+		return ctr;
+
+	// Keep the load factor below a certain threshold. Deleted nodes are
+	// also counted, since they still take up buckets. We grow the storage
+	// before inserting, so that the new node does not move afterwards.
+	size_type capacity = _mask + 1;
+	if ((_size + _deleted + 1) * HASHMAP_LOADFACTOR_DENOMINATOR >
+	        capacity * HASHMAP_LOADFACTOR_NUMERATOR) {
+		// If erased entries make up most of the load, rehashing at the
+		// current capacity is enough to get rid of them.
+		if ((_size + 1) * 2 * HASHMAP_LOADFACTOR_DENOMINATOR >
+		        capacity * HASHMAP_LOADFACTOR_NUMERATOR)
+			capacity = capacity < 500 ? (capacity * 4) : (capacity * 2);
+		expandStorage(capacity);
+		dist = 0;
+	}
+
+	ctr = insertNode(allocNode(key), hash, dist);
+	assert(_storage[ctr]._node != NULL);
+	_size++;
+
+	return ctr;
+}
+
+/**
+ * Insert a node which is not contained in the hashmap yet, using Robin
+ * Hood hashing: whenever the node to be inserted is further away from its
+ * home bucket than the entry currently in a bucket, the two swap places
+ * and insertion continues with the displaced entry. This keeps probe
+ * sequences short and lets lookups stop early.
+ *
+ * Probing starts dist buckets after the home bucket of the node; lookup()
+ * tells how many buckets can be skipped.
+ *
+ * Returns the bucket the given node ended up in. The caller is responsible
+ * for keeping the load factor in check and for updating _size.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename HashMap<Key, Val, HashFunc, EqualFunc>::size_type HashMap<Key, Val, HashFunc, EqualFunc>::insertNode(Node *node, size_type hash, size_type dist) {
 	const size_type NONE_FOUND = _mask + 1;
-	size_type first_free = NONE_FOUND;
-	bool found = false;
-	for (size_type perturb = hash; ; perturb >>= HASHMAP_PERTURB_SHIFT) {
-		if (_storage[ctr] == NULL)
-			break;
-		if (_storage[ctr] == HASHMAP_DUMMY_NODE) {
-#ifdef DEBUG_HASH_COLLISIONS
-			_dummyHits++;
-#endif
-			if (first_free != _mask + 1)
-				first_free = ctr;
-		} else if (_equal(_storage[ctr]->_key, key)) {
-			found = true;
+	size_type result = NONE_FOUND;
+	size_type ctr = (hash + dist) & _mask;
+	for (; ; ++dist) {
+		if (_storage[ctr]._hash == 0)
 			break;
-		}
 
-		ctr = (5 * ctr + perturb + 1) & _mask;
+		const size_type ctrDist = probeDistance(ctr);
+		if (_storage[ctr]._node == HASHMAP_DUMMY_NODE) {
+			// An erased entry which is not further away from its home bucket
+			// than we are can be reused without breaking the invariant.
+			if (ctrDist <= dist) {
+				_deleted--;
+				break;
+			}
+		} else if (ctrDist < dist) {
+			Node *const tmpNode = _storage[ctr]._node;
+			_storage[ctr]._node = node;
+			node = tmpNode;
+			const size_type tmpHash = _storage[ctr]._hash;
+			_storage[ctr]._hash = hash;
+			hash = tmpHash;
+			if (result == NONE_FOUND)
+				result = ctr;
+			dist = ctrDist;
+		}
 
-#ifdef DEBUG_HASH_COLLISIONS
-		_collisions++;
-#endif
+		ctr = (ctr + 1) & _mask;
 	}
 
-#ifdef DEBUG_HASH_COLLISIONS
-	_lookups++;
-	debug("collisions %d, dummies hit %d, lookups %d, ratio %f in HashMap %p; size %d num elements %d",
-		_collisions, _dummyHits, _lookups, ((double) _collisions / (double)_lookups),
-		(const void *)this, _mask+1, _size);
-#endif
+	_storage[ctr]._node = node;
+	_storage[ctr]._hash = hash;
+	if (result == NONE_FOUND)
+		result = ctr;
 
-	if (!found && first_free != _mask + 1)
-		ctr = first_free;
+	return result;
+}
 
-	if (!found) {
-		if (_storage[ctr])
-			_deleted--;
-		_storage[ctr] = allocNode(key);
-		assert(_storage[ctr] != NULL);
-		_size++;
+/**
+ * Remove the entry in the given bucket. The bucket is turned into a dummy
+ * node instead of shifting back the following entries, so that erasing
+ * does not move any other entries around. This keeps iterators to the
+ * other entries valid.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void HashMap<Key, Val, HashFunc, EqualFunc>::eraseBucket(size_type ctr) {
+	freeNode(_storage[ctr]._node);
+	_storage[ctr]._node = HASHMAP_DUMMY_NODE;
+	_size--;
+	_deleted++;
 
-		// Keep the load factor below a certain threshold.
-		// Deleted nodes are also counted
-		size_type capacity = _mask + 1;
-		if ((_size + _deleted) * HASHMAP_LOADFACTOR_DENOMINATOR >
-		        capacity * HASHMAP_LOADFACTOR_NUMERATOR) {
-			capacity = capacity < 500 ? (capacity * 4) : (capacity * 2);
-			expandStorage(capacity);
-			ctr = lookup(key);
-			assert(_storage[ctr] != NULL);
-		}
+	// Dummy nodes directly in front of an empty bucket do not lengthen any
+	// probe sequence, so they can be turned into empty buckets right away.
+	while (_storage[ctr]._node == HASHMAP_DUMMY_NODE && _storage[(ctr + 1) & _mask]._hash == 0) {
+		_storage[ctr]._node = NULL;
+		_storage[ctr]._hash = 0;
+		_deleted--;
+		ctr = (ctr - 1) & _mask;
 	}
-
-	return ctr;
 }
 
-
 template<class Key, class Val, class HashFunc, class EqualFunc>
 bool HashMap<Key, Val, HashFunc, EqualFunc>::contains(const Key &key) const {
-	size_type ctr = lookup(key);
-	return (_storage[ctr] != NULL);
+	return lookup(key, storedHash(key)) <= _mask;
 }
 
 template<class Key, class Val, class HashFunc, class EqualFunc>
@@ -573,8 +672,8 @@ const Val &HashMap<Key, Val, HashFunc, EqualFunc>::operator[](const Key &key) co
 template<class Key, class Val, class HashFunc, class EqualFunc>
 Val &HashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) {
 	size_type ctr = lookupAndCreateIfMissing(key);
-	assert(_storage[ctr] != NULL);
-	return _storage[ctr]->_value;
+	assert(_storage[ctr]._node != NULL);
+	return _storage[ctr]._node->_value;
 }
 
 template<class Key, class Val, class HashFunc, class EqualFunc>
@@ -584,9 +683,9 @@ const Val &HashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) const
 
 template<class Key, class Val, class HashFunc, class EqualFunc>
 const Val &HashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key, const Val &defaultVal) const {
-	size_type ctr = lookup(key);
-	if (_storage[ctr] != NULL)
-		return _storage[ctr]->_value;
+	size_type ctr = lookup(key, storedHash(key));
+	if (ctr <= _mask)
+		return _storage[ctr]._node->_value;
 	else
 		return defaultVal;
 }
@@ -594,8 +693,8 @@ const Val &HashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key, const
 template<class Key, class Val, class HashFunc, class EqualFunc>
 void HashMap<Key, Val, HashFunc, EqualFunc>::setVal(const Key &key, const Val &val) {
 	size_type ctr = lookupAndCreateIfMissing(key);
-	assert(_storage[ctr] != NULL);
-	_storage[ctr]->_value = val;
+	assert(_storage[ctr]._node != NULL);
+	_storage[ctr]._node->_value = val;
 }
 
 template<class Key, class Val, class HashFunc, class EqualFunc>
@@ -604,32 +703,22 @@ void HashMap<Key, Val, HashFunc, EqualFunc>::erase(iterator entry) {
 	assert(entry._hashmap == this);
 	const size_type ctr = entry._idx;
 	assert(ctr <= _mask);
-	Node * const node = _storage[ctr];
-	assert(node != NULL);
-	assert(node != HASHMAP_DUMMY_NODE);
+	assert(_storage[ctr]._node != NULL);
+	assert(_storage[ctr]._node != HASHMAP_DUMMY_NODE);
 
-	// If we remove a key, we replace it with a dummy node.
-	freeNode(node);
-	_storage[ctr] = HASHMAP_DUMMY_NODE;
-	_size--;
-	_deleted++;
+	eraseBucket(ctr);
 }
 
 template<class Key, class Val, class HashFunc, class EqualFunc>
 void HashMap<Key, Val, HashFunc, EqualFunc>::erase(const Key &key) {
-
-	size_type ctr = lookup(key);
-	if (_storage[ctr] == NULL)
+	size_type ctr = lookup(key, storedHash(key));
+	if (ctr > _mask)
 		return;
 
-	// If we remove a key, we replace it with a dummy node.
-	freeNode(_storage[ctr]);
-	_storage[ctr] = HASHMAP_DUMMY_NODE;
-	_size--;
-	_deleted++;
-	return;
+	eraseBucket(ctr);
 }
 
+#undef HASHMAP_HASH_USED
 #undef HASHMAP_DUMMY_NODE
 
 } // End of namespace Common
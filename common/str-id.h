@@ -0,0 +1,85 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_STRING_ID_H
+#define COMMON_STRING_ID_H
+
+#include "common/func.h"
+#include "common/str.h"
+
+namespace Common {
+
+/**
+ * An interned string. All StringIds created from equal strings refer to
+ * the same, shared copy of the string, which is kept until ScummVM exits.
+ * Hence copying and comparing StringIds is as cheap as copying and
+ * comparing a pointer, which makes them well suited as keys for HashMaps
+ * which are looked up a lot with a limited set of strings, like resource
+ * names or selector names.
+ *
+ * Creating a StringId requires a lookup in the global table of interned
+ * strings, so create them once and keep them around, instead of creating
+ * them from Strings on the fly. The table is not synchronized, so
+ * StringIds should only be created on the main thread.
+ *
+ * StringIds are case sensitive.
+ */
+class StringId {
+public:
+	/** Construct the id of the empty string. */
+	StringId() : _str(0) {}
+
+	explicit StringId(const String &str);
+	explicit StringId(const char *str);
+
+	/** Return the interned string. */
+	const String &toString() const;
+	const char *c_str() const { return toString().c_str(); }
+
+	bool empty() const { return _str == 0; }
+
+	bool operator==(const StringId &x) const { return _str == x._str; }
+	bool operator!=(const StringId &x) const { return _str != x._str; }
+
+	/** Return the number of strings interned so far. */
+	static uint getInternedCount();
+
+private:
+	friend struct Hash<StringId>;
+
+	void intern(const String &str);
+
+	/** The interned copy of the string, or 0 for the empty string. */
+	const String *_str;
+};
+
+template<>
+struct Hash<StringId> {
+	uint operator()(const StringId &id) const {
+		// The interned strings are at least 4 byte aligned
+		return (uint)((size_t)id._str >> 2);
+	}
+};
+
+} // End of namespace Common
+
+#endif
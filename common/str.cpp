@@ -22,20 +22,54 @@
 
 #include "common/hash-str.h"
 #include "common/list.h"
-#include "common/memorypool.h"
 #include "common/str.h"
+#include "common/str-id.h"
 #include "common/util.h"
 
 namespace Common {
 
-MemoryPool *g_refCountPool = 0; // FIXME: This is never freed right now
+static String::AllocStats g_allocStats;
 
 static uint32 computeCapacity(uint32 len) {
 	// By default, for the capacity we use the next multiple of 32
 	return ((len + 32 - 1) & ~0x1F);
 }
 
-String::String(const char *str) : _size(0), _str(_storage) {
+// Heap storage blocks start with the reference count of the string
+// data, followed by the string itself. Keeping both in a single block
+// saves an allocation whenever a heap string gets copied.
+static const uint32 kRefCountSize = sizeof(int);
+
+static inline int &refCount(char *str) {
+	return *(int *)(str - kRefCountSize);
+}
+
+static char *allocStorage(uint32 capacity) {
+	char *block = new char[kRefCountSize + capacity];
+	assert(block);
+	*(int *)block = 1;
+
+	g_allocStats.allocs++;
+	g_allocStats.bytes += capacity;
+	return block + kRefCountSize;
+}
+
+static void freeStorage(char *str) {
+	g_allocStats.frees++;
+	delete[] (str - kRefCountSize);
+}
+
+// static
+const String::AllocStats &String::getAllocStats() {
+	return g_allocStats;
+}
+
+// static
+void String::resetAllocStats() {
+	memset(&g_allocStats, 0, sizeof(g_allocStats));
+}
+
+String::String(const char *str) : _str(_storage), _size(0) {
 	if (str == 0) {
 		_storage[0] = 0;
 		_size = 0;
@@ -43,11 +77,11 @@ String::String(const char *str) : _size(0), _str(_storage) {
 		initWithCStr(str, strlen(str));
 }
 
-String::String(const char *str, uint32 len) : _size(0), _str(_storage) {
+String::String(const char *str, uint32 len) : _str(_storage), _size(0) {
 	initWithCStr(str, len);
 }
 
-String::String(const char *beginP, const char *endP) : _size(0), _str(_storage) {
+String::String(const char *beginP, const char *endP) : _str(_storage), _size(0) {
 	assert(endP >= beginP);
 	initWithCStr(beginP, endP - beginP);
 }
@@ -64,9 +98,7 @@ void String::initWithCStr(const char *str, uint32 len) {
 	if (len >= _builtinCapacity) {
 		// Not enough internal storage, so allocate more
 		_extern._capacity = computeCapacity(len+1);
-		_extern._refCount = 0;
-		_str = new char[_extern._capacity];
-		assert(_str != 0);
+		_str = allocStorage(_extern._capacity);
 	}
 
 	// Copy the string into the storage area
@@ -83,7 +115,6 @@ String::String(const String &str)
 	} else {
 		// String in external storage: use refcount mechanism
 		str.incRefCount();
-		_extern._refCount = str._extern._refCount;
 		_extern._capacity = str._extern._capacity;
 		_str = str._str;
 	}
@@ -91,7 +122,7 @@ String::String(const String &str)
 }
 
 String::String(char c)
-	: _size(0), _str(_storage) {
+	: _str(_storage), _size(0) {
 
 	_storage[0] = c;
 	_storage[1] = 0;
@@ -100,7 +131,7 @@ String::String(char c)
 }
 
 String::~String() {
-	decRefCount(_extern._refCount);
+	decRefCount();
 }
 
 void String::makeUnique() {
@@ -117,13 +148,12 @@ void String::ensureCapacity(uint32 new_size, bool keep_old) {
 	bool isShared;
 	uint32 curCapacity, newCapacity;
 	char *newStorage;
-	int *oldRefCount = _extern._refCount;
 
 	if (isStorageIntern()) {
 		isShared = false;
 		curCapacity = _builtinCapacity;
 	} else {
-		isShared = (oldRefCount && *oldRefCount > 1);
+		isShared = (refCount(_str) > 1);
 		curCapacity = _extern._capacity;
 	}
 
@@ -142,8 +172,7 @@ void String::ensureCapacity(uint32 new_size, bool keep_old) {
 		newCapacity = MAX(curCapacity * 2, computeCapacity(new_size+1));
 
 	// Allocate new storage
-	newStorage = new char[newCapacity];
-	assert(newStorage);
+	newStorage = allocStorage(newCapacity);
 
 
 	// Copy old data if needed, elsewise reset the new storage.
@@ -156,50 +185,28 @@ void String::ensureCapacity(uint32 new_size, bool keep_old) {
 	}
 
 	// Release hold on the old storage ...
-	decRefCount(oldRefCount);
+	decRefCount();
 
-	// ... in favor of the new storage
+	// ... in favor of the new storage. Set the capacity only *after*
+	// copying any old content, else we would override data that has
+	// not yet been copied!
 	_str = newStorage;
-
-	if (!isStorageIntern()) {
-		// Set the ref count & capacity if we use an external storage.
-		// It is important to do this *after* copying any old content,
-		// else we would override data that has not yet been copied!
-		_extern._refCount = 0;
-		_extern._capacity = newCapacity;
-	}
+	_extern._capacity = newCapacity;
 }
 
 void String::incRefCount() const {
 	assert(!isStorageIntern());
-	if (_extern._refCount == 0) {
-		if (g_refCountPool == 0) {
-			g_refCountPool = new MemoryPool(sizeof(int));
-			assert(g_refCountPool);
-		}
-
-		_extern._refCount = (int *)g_refCountPool->allocChunk();
-		*_extern._refCount = 2;
-	} else {
-		++(*_extern._refCount);
-	}
+	++refCount(_str);
+	g_allocStats.shares++;
 }
 
-void String::decRefCount(int *oldRefCount) {
+void String::decRefCount() {
 	if (isStorageIntern())
 		return;
 
-	if (oldRefCount) {
-		--(*oldRefCount);
-	}
-	if (!oldRefCount || *oldRefCount <= 0) {
-		// The ref count reached zero, so we free the string storage
-		// and the ref count storage.
-		if (oldRefCount) {
-			assert(g_refCountPool);
-			g_refCountPool->freeChunk(oldRefCount);
-		}
-		delete[] _str;
+	if (--refCount(_str) <= 0) {
+		// The ref count reached zero, so we free the string storage.
+		freeStorage(_str);
 
 		// Even though _str points to a freed memory block now,
 		// we do not change its value, because any code that calls
@@ -220,15 +227,14 @@ String &String::operator=(const String &str) {
 		return *this;
 
 	if (str.isStorageIntern()) {
-		decRefCount(_extern._refCount);
+		decRefCount();
 		_size = str._size;
 		_str = _storage;
 		memcpy(_str, str._str, _size + 1);
 	} else {
 		str.incRefCount();
-		decRefCount(_extern._refCount);
+		decRefCount();
 
-		_extern._refCount = str._extern._refCount;
 		_extern._capacity = str._extern._capacity;
 		_size = str._size;
 		_str = str._str;
@@ -238,7 +244,7 @@ String &String::operator=(const String &str) {
 }
 
 String &String::operator=(char c) {
-	decRefCount(_extern._refCount);
+	decRefCount();
 	_str = _storage;
 
 	_str[0] = c;
@@ -386,7 +392,7 @@ void String::erase(uint32 p, uint32 len) {
 }
 
 void String::clear() {
-	decRefCount(_extern._refCount);
+	decRefCount();
 
 	_size = 0;
 	_str = _storage;
@@ -987,6 +993,47 @@ size_t strnlen(const char *src, size_t maxSize) {
 	return counter;
 }
 
+#pragma mark -
+
+// The table of all interned strings. The keys of a HashMap are stored in
+// nodes which never move, so StringIds can point right at them.
+typedef HashMap<String, bool> StringIdTable;
+static StringIdTable *g_stringIds = 0; // FIXME: This is never freed right now
+
+StringId::StringId(const String &str) : _str(0) {
+	intern(str);
+}
+
+StringId::StringId(const char *str) : _str(0) {
+	if (str && *str)
+		intern(String(str));
+}
+
+void StringId::intern(const String &str) {
+	if (str.empty())
+		return;
+
+	if (!g_stringIds)
+		g_stringIds = new StringIdTable();
+
+	StringIdTable::const_iterator i = g_stringIds->find(str);
+	if (i == g_stringIds->end()) {
+		g_stringIds->setVal(str, true);
+		i = g_stringIds->find(str);
+	}
+	_str = &i->_key;
+}
+
+const String &StringId::toString() const {
+	static const String empty;
+	return _str ? *_str : empty;
+}
+
+// static
+uint StringId::getInternedCount() {
+	return g_stringIds ? g_stringIds->size() : 0;
+}
+
 } // End of namespace Common
 
 // Portable implementation of stricmp / strcasecmp / strcmpi.
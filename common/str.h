@@ -27,6 +27,16 @@
 
 #include <stdarg.h>
 
+/**
+ * @def SCUMMVM_STRING_SIZE
+ * The size of a String object in bytes, which determines how long strings
+ * may get before they are moved to the heap (see String::_builtinCapacity).
+ * Ports which are very short on stack space may lower this, e.g. to 32.
+ */
+#ifndef SCUMMVM_STRING_SIZE
+#define SCUMMVM_STRING_SIZE 48
+#endif
+
 namespace Common {
 
 /**
@@ -57,19 +67,45 @@ public:
 	typedef char *        iterator;
 	typedef const char *  const_iterator;
 
+	/**
+	 * Heap allocation statistics of all String objects, to measure how
+	 * much heap traffic strings cause, e.g. while starting a game.
+	 * The counters are plain globals which are updated without any
+	 * locking, so they are only approximate while strings are allocated
+	 * or freed on several threads at once (e.g. the mixer and the
+	 * engine). Use them for measurements, not for program logic.
+	 */
+	struct AllocStats {
+		uint32 allocs;	///< Number of heap buffers allocated
+		uint32 frees;	///< Number of heap buffers freed
+		uint32 bytes;	///< Total size of all heap buffers allocated
+		uint32 shares;	///< Number of copies which shared an existing heap buffer
+	};
+
+	/** Return the heap allocation statistics since the last reset. */
+	static const AllocStats &getAllocStats();
+
+	/** Reset the heap allocation statistics. */
+	static void resetAllocStats();
+
 protected:
 	/**
 	 * The size of the internal storage. Increasing this means less heap
 	 * allocations are needed, at the cost of more stack memory usage,
 	 * and of course lots of wasted memory. Empirically, 90% or more of
 	 * all String instances are less than 32 chars long. If a platform
-	 * is very short on stack space, it would be possible to lower this.
-	 * A value of 24 still seems acceptable, though considerably worse,
-	 * while 16 seems to be the lowest you want to go... Anything lower
-	 * than 8 makes no sense, since that's the size of member _extern
-	 * (on 32 bit machines; 12 bytes on systems with 64bit pointers).
+	 * is very short on stack space, it would be possible to lower this
+	 * via SCUMMVM_STRING_SIZE. Anything lower than 8 makes no sense,
+	 * since that's the size of member _extern.
 	 */
-	static const uint32 _builtinCapacity = 32 - sizeof(uint32) - sizeof(char *);
+	static const uint32 _builtinCapacity = SCUMMVM_STRING_SIZE - sizeof(uint32) - sizeof(char *);
+
+	/**
+	 * Pointer to the actual string storage. Either points to _storage,
+	 * or into a block allocated on the heap, which is preceded by the
+	 * reference count of the block.
+	 */
+	char  *_str;
 
 	/**
 	 * Length of the string. Stored to avoid having to call strlen
@@ -78,24 +114,16 @@ protected:
 	 */
 	uint32 _size;
 
-	/**
-	 * Pointer to the actual string storage. Either points to _storage,
-	 * or to a block allocated on the heap via malloc.
-	 */
-	char  *_str;
-
-
 	union {
 		/**
 		 * Internal string storage.
 		 */
 		char _storage[_builtinCapacity];
 		/**
-		 * External string storage data -- the refcounter, and the
-		 * capacity of the string _str points to.
+		 * External string storage data -- the capacity of the string
+		 * _str points to.
 		 */
 		struct {
-			mutable int *_refCount;
 			uint32       _capacity;
 		} _extern;
 	};
@@ -106,7 +134,7 @@ protected:
 
 public:
 	/** Construct a new empty string. */
-	String() : _size(0), _str(_storage) { _storage[0] = 0; }
+	String() : _str(_storage), _size(0) { _storage[0] = 0; }
 
 	/** Construct a new string from the given NULL-terminated C string. */
 	String(const char *str);
@@ -322,7 +350,7 @@ protected:
 	void makeUnique();
 	void ensureCapacity(uint32 new_size, bool keep_old);
 	void incRefCount() const;
-	void decRefCount(int *oldRefCount);
+	void decRefCount();
 	void initWithCStr(const char *str, uint32 len);
 };
 
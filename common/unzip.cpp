@@ -106,6 +106,10 @@ typedef struct {
 #include "common/fs.h"
 #include "common/unzip.h"
 #include "common/memstream.h"
+#include "common/mutex.h"
+#include "common/ptr.h"
+#include "common/textconsole.h"
+#include "common/zlib.h"
 
 #include "common/hashmap.h"
 #include "common/hash-str.h"
@@ -1420,8 +1424,133 @@ int unzGetGlobalComment(unzFile file, char *szComment, uLong uSizeBuf) {
 namespace Common {
 
 
+/**
+ * The archive file and the lock serializing access to it. Member streams
+ * share it with the archive, so they stay usable after the archive itself
+ * has been deleted.
+ */
+struct ZipSharedStream {
+	SeekableReadStream *stream;
+	Mutex mutex;
+
+	ZipSharedStream(SeekableReadStream *s) : stream(s) {}
+	~ZipSharedStream() { delete stream; }
+};
+
+typedef SharedPtr<ZipSharedStream> ZipSharedStreamPtr;
+
+/**
+ * A stream over the data of a member in the archive. Multiple member
+ * streams can be used at the same time, even from different threads, as
+ * each read() repositions the archive stream while holding the lock of
+ * the archive.
+ */
+class ZipMemberReadStream : public SeekableReadStream {
+	ZipSharedStreamPtr _parent;
+	uint32 _begin;
+	uint32 _size;
+	uint32 _pos;
+	bool _eos;
+
+public:
+	ZipMemberReadStream(const ZipSharedStreamPtr &parent, uint32 begin, uint32 size)
+		: _parent(parent), _begin(begin), _size(size), _pos(0), _eos(false) {
+	}
+
+	virtual bool eos() const { return _eos; }
+	virtual bool err() const { return _parent->stream->err(); }
+	virtual void clearErr() { _eos = false; _parent->stream->clearErr(); }
+
+	virtual int32 pos() const { return _pos; }
+	virtual int32 size() const { return _size; }
+
+	virtual bool seek(int32 offset, int whence = SEEK_SET) {
+		int32 newPos = offset;
+		if (whence == SEEK_CUR)
+			newPos += _pos;
+		else if (whence == SEEK_END)
+			newPos += _size;
+
+		if (newPos < 0 || (uint32)newPos > _size)
+			return false;
+
+		_pos = newPos;
+		_eos = false;
+		return true;
+	}
+
+	virtual uint32 read(void *dataPtr, uint32 dataSize) {
+		if (dataSize > _size - _pos) {
+			dataSize = _size - _pos;
+			_eos = true;
+		}
+
+		StackLock lock(_parent->mutex);
+		_parent->stream->seek(_begin + _pos, SEEK_SET);
+		dataSize = _parent->stream->read(dataPtr, dataSize);
+		_pos += dataSize;
+
+		return dataSize;
+	}
+};
+
+#ifdef USE_ZLIB
+
+/**
+ * Verifies the CRC of a member once all of its data has been read. The
+ * CRC is computed over the data read in order from the start of the
+ * member; reading after a seek only counts once it continues right where
+ * that data ends. On a mismatch err() is set, like a failed read.
+ */
+class ZipCRCReadStream : public SeekableReadStream {
+	SeekableReadStream *_member;
+	String _name;
+	uint32 _expectedCRC;
+	uint32 _crc;
+	uint32 _checked;	///< The number of bytes from the start included in _crc
+	bool _crcError;
+
+public:
+	ZipCRCReadStream(SeekableReadStream *member, const String &name, uint32 expectedCRC)
+		: _member(member), _name(name), _expectedCRC(expectedCRC), _crc(crc32(0, Z_NULL, 0)), _checked(0), _crcError(false) {
+	}
+
+	~ZipCRCReadStream() {
+		delete _member;
+	}
+
+	virtual bool eos() const { return _member->eos(); }
+	virtual bool err() const { return _crcError || _member->err(); }
+	virtual void clearErr() { _member->clearErr(); }
+
+	virtual int32 pos() const { return _member->pos(); }
+	virtual int32 size() const { return _member->size(); }
+	virtual bool seek(int32 offset, int whence = SEEK_SET) { return _member->seek(offset, whence); }
+
+	virtual uint32 read(void *dataPtr, uint32 dataSize) {
+		const uint32 start = _member->pos();
+		dataSize = _member->read(dataPtr, dataSize);
+
+		if (start <= _checked && start + dataSize > _checked) {
+			const uint32 skip = _checked - start;
+			_crc = crc32(_crc, (const Bytef *)dataPtr + skip, dataSize - skip);
+			_checked = start + dataSize;
+
+			if (_checked == (uint32)_member->size() && _crc != _expectedCRC) {
+				warning("ZipArchive: CRC mismatch in member '%s'", _name.c_str());
+				_crcError = true;
+			}
+		}
+
+		return dataSize;
+	}
+};
+
+#endif
+
 class ZipArchive : public Archive {
 	unzFile _zipFile;
+	ZipSharedStreamPtr _shared;
 
 public:
 	ZipArchive(unzFile zipFile);
@@ -1455,13 +1584,19 @@ public:
 
 ZipArchive::ZipArchive(unzFile zipFile) : _zipFile(zipFile) {
 	assert(_zipFile);
+	_shared = ZipSharedStreamPtr(new ZipSharedStream(((unz_s *)_zipFile)->_stream));
 }
 
 ZipArchive::~ZipArchive() {
+	// The archive stream is owned by _shared, and possibly still in use by
+	// member streams
+	StackLock lock(_shared->mutex);
+	((unz_s *)_zipFile)->_stream = 0;
 	unzClose(_zipFile);
 }
 
 bool ZipArchive::hasFile(const String &name) const {
+	StackLock lock(_shared->mutex);
 	return (unzLocateFile(_zipFile, name.c_str(), 2) == UNZ_OK);
 }
 
@@ -1486,6 +1621,8 @@ const ArchiveMemberPtr ZipArchive::getMember(const String &name) const {
 }
 
 SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) const {
+	StackLock lock(_shared->mutex);
+
 	if (unzLocateFile(_zipFile, name.c_str(), 2) != UNZ_OK)
 		return 0;
 
@@ -1496,25 +1633,28 @@ SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) co
 	if (unzGetCurrentFileInfo(_zipFile, &fileInfo, NULL, 0, NULL, 0, NULL, 0) != UNZ_OK)
 		return 0;
 
-	byte *buffer = (byte *)malloc(fileInfo.uncompressed_size);
-	assert(buffer);
-
-	if (unzReadCurrentFile(_zipFile, buffer, fileInfo.uncompressed_size) != (int)fileInfo.uncompressed_size) {
-		free(buffer);
-		return 0;
-	}
+	// Instead of decompressing the whole member into memory, return a
+	// stream over its data in the archive, decompressing on the fly
+	const unz_s *archive = (const unz_s *)_zipFile;
+	const file_in_zip_read_info_s *member = archive->pfile_in_zip_read;
+	const uint32 begin = member->pos_in_zipfile + member->byte_before_the_zipfile;
+	const bool stored = (member->compression_method == 0);
 
-	if (unzCloseCurrentFile(_zipFile) != UNZ_OK) {
-		free(buffer);
+	if (unzCloseCurrentFile(_zipFile) != UNZ_OK)
 		return 0;
-	}
 
-	return new MemoryReadStream(buffer, fileInfo.uncompressed_size, DisposeAfterUse::YES);
+	SeekableReadStream *stream;
+	if (stored)
+		stream = new ZipMemberReadStream(_shared, begin, fileInfo.uncompressed_size);
+	else
+		stream = wrapDeflateReadStream(new ZipMemberReadStream(_shared, begin, fileInfo.compressed_size),
+		                               fileInfo.uncompressed_size);
 
-	// FIXME: instead of reading all into a memory stream, we could
-	// instead create a new ZipStream class. But then we have to be
-	// careful to handle the case where the client code opens multiple
-	// files in the archive and tries to use them independently.
+#ifdef USE_ZLIB
+	if (stream)
+		stream = new ZipCRCReadStream(stream, name, fileInfo.crc);
+#endif
+	return stream;
 }
 
 Archive *makeZipArchive(const String &name) {
@@ -26,7 +26,7 @@
 
 namespace Common {
 
-extern MemoryPool *g_refCountPool;
+MemoryPool *g_refCountPool = 0; // FIXME: This is never freed right now
 
 static uint32 computeCapacity(uint32 len) {
 	// By default, for the capacity we use the next multiple of 32
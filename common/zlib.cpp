@@ -24,6 +24,7 @@
 #define FORBIDDEN_SYMBOL_ALLOW_ALL
 
 #include "common/zlib.h"
+#include "common/array.h"
 #include "common/ptr.h"
 #include "common/util.h"
 #include "common/stream.h"
@@ -146,14 +147,31 @@ static bool _shownBackwardSeekingWarning = false;
 #endif
 
 /**
- * A simple wrapper class which can be used to wrap around an arbitrary
- * other SeekableReadStream and will then provide on-the-fly decompression support.
- * Assumes the compressed data to be in gzip format.
+ * A wrapper class around an arbitrary other SeekableReadStream containing
+ * deflate data, which provides on-the-fly decompression support. The data
+ * may have a zlib or gzip header, depending on the windowBits passed to
+ * zlib.
+ *
+ * While decompressing, the stream lazily records checkpoints every
+ * _checkpointInterval bytes of output. A checkpoint consists of the state
+ * of the decompressor at a deflate block boundary: the input position and
+ * the last 32 KiB of output. Seeking then restarts the decompression at the
+ * closest checkpoint instead of the start of the data, so it costs at most
+ * _checkpointInterval bytes of decompression.
  */
-class GZipReadStream : public SeekableReadStream {
+class InflateReadStream : public SeekableReadStream {
 protected:
 	enum {
-		BUFSIZE = 16384		// 1 << MAX_WBITS
+		BUFSIZE = 16384,
+		WINDOWSIZE = 32768		// 1 << MAX_WBITS
+	};
+
+	struct Checkpoint {
+		uint32 outPos;		///< Position in the decompressed data
+		uint32 inPos;		///< Position of the next input byte in the wrapped stream
+		int bits;			///< Number of bits of the previous input byte still to be used
+		uint32 windowSize;
+		byte *window;		///< The last windowSize bytes of output before outPos
 	};
 
 	byte	_buf[BUFSIZE];
@@ -162,39 +180,114 @@ protected:
 	z_stream _stream;
 	int _zlibErr;
 	uint32 _pos;
-	uint32 _origSize;
+	uint32 _size;
 	bool _eos;
+	int _windowBits;
+
+	uint32 _checkpointInterval;
+	Array<Checkpoint> _checkpoints;
+
+	/**
+	 * Records a checkpoint if the decompressor is at a block boundary and
+	 * far enough behind the last checkpoint.
+	 */
+	void updateCheckpoints(uint32 outPos) {
+#if ZLIB_VERNUM >= 0x1280
+		// Bit 7 of data_type is set at the end of a block, bit 6 is set
+		// while decoding the last block, after which no checkpoint is needed
+		if (!(_stream.data_type & 128) || (_stream.data_type & 64))
+			return;
 
-public:
+		uint32 lastPos = _checkpoints.empty() ? 0 : _checkpoints.back().outPos;
+		if (outPos < lastPos + _checkpointInterval)
+			return;
 
-	GZipReadStream(SeekableReadStream *w, uint32 knownSize = 0) : _wrapped(w), _stream() {
-		assert(w != 0);
+		Checkpoint checkpoint;
+		checkpoint.outPos = outPos;
+		checkpoint.inPos = _wrapped->pos() - _stream.avail_in;
+		checkpoint.bits = _stream.data_type & 7;
+		checkpoint.window = (byte *)malloc(WINDOWSIZE);
+		checkpoint.windowSize = WINDOWSIZE;
 
-		// Verify file header is correct
-		w->seek(0, SEEK_SET);
-		uint16 header = w->readUint16BE();
-		assert(header == 0x1F8B ||
-		       ((header & 0x0F00) == 0x0800 && header % 31 == 0));
+		if (!checkpoint.window || inflateGetDictionary(&_stream, checkpoint.window, &checkpoint.windowSize) != Z_OK) {
+			free(checkpoint.window);
+			return;
+		}
 
-		if (header == 0x1F8B) {
-			// Retrieve the original file size
-			w->seek(-4, SEEK_END);
-			_origSize = w->readUint32LE();
+		_checkpoints.push_back(checkpoint);
+#endif
+	}
+
+	/**
+	 * Restarts the decompression at the given checkpoint, or at the start
+	 * of the data if checkpoint is NULL.
+	 */
+	bool restart(const Checkpoint *checkpoint) {
+		inflateEnd(&_stream);
+		_stream = z_stream();
+		_stream.next_in = _buf;
+		_stream.avail_in = 0;
+		_eos = false;
+
+		if (!checkpoint) {
+#ifndef RELEASE_BUILD
+			if (!_shownBackwardSeekingWarning) {
+				// We only throw this warning once, to avoid getting the
+				// console swarmed with warnings when consecutive seeks
+				// are made.
+				debug(1, "Restarting decompression from the start of the data");
+				_shownBackwardSeekingWarning = true;
+			}
+#endif
+
+			_pos = 0;
+			_wrapped->seek(0, SEEK_SET);
+			_zlibErr = inflateInit2(&_stream, _windowBits);
+			return _zlibErr == Z_OK;
+		}
+
+		// The checkpoint lies within the deflate data, past any header
+		_zlibErr = inflateInit2(&_stream, -MAX_WBITS);
+		if (_zlibErr != Z_OK)
+			return false;
+
+#if ZLIB_VERNUM >= 0x1280
+		_pos = checkpoint->outPos;
+
+		if (checkpoint->bits) {
+			// Feed the decompressor the remaining bits of the byte the
+			// checkpoint lies in
+			_wrapped->seek(checkpoint->inPos - 1, SEEK_SET);
+			int value = _wrapped->readByte();
+			_zlibErr = inflatePrime(&_stream, checkpoint->bits, value >> (8 - checkpoint->bits));
+			if (_zlibErr != Z_OK)
+				return false;
 		} else {
-			// Original size not available in zlib format
-			// use an otherwise known size if supplied.
-			_origSize = knownSize;
+			_wrapped->seek(checkpoint->inPos, SEEK_SET);
 		}
+
+		_zlibErr = inflateSetDictionary(&_stream, checkpoint->window, checkpoint->windowSize);
+		return _zlibErr == Z_OK;
+#else
+		return false;
+#endif
+	}
+
+public:
+
+	InflateReadStream(SeekableReadStream *w, int windowBits, uint32 size, uint32 checkpointInterval) : _wrapped(w), _stream(), _size(size), _windowBits(windowBits) {
+		assert(w != 0);
+
 		_pos = 0;
-		w->seek(0, SEEK_SET);
 		_eos = false;
+		_checkpointInterval = checkpointInterval;
+#if ZLIB_VERNUM < 0x1280
+		// inflateGetDictionary() is needed to record the checkpoints
+		_checkpointInterval = 0;
+#endif
 
-		// Adding 32 to windowBits indicates to zlib that it is supposed to
-		// automatically detect whether gzip or zlib headers are used for
-		// the compressed file. This feature was added in zlib 1.2.0.4,
-		// released 10 August 2003.
-		// Note: This is *crucial* for savegame compatibility, do *not* remove!
-		_zlibErr = inflateInit2(&_stream, MAX_WBITS + 32);
+		w->seek(0, SEEK_SET);
+		_zlibErr = inflateInit2(&_stream, _windowBits);
 		if (_zlibErr != Z_OK)
 			return;
 
@@ -203,8 +296,11 @@ public:
 		_stream.avail_in = 0;
 	}
 
-	~GZipReadStream() {
+	~InflateReadStream() {
 		inflateEnd(&_stream);
+
+		for (uint i = 0; i < _checkpoints.size(); ++i)
+			free(_checkpoints[i].window);
 	}
 
 	bool err() const { return (_zlibErr != Z_OK) && (_zlibErr != Z_STREAM_END); }
@@ -224,7 +320,17 @@ public:
 				_stream.next_in = _buf;
 				_stream.avail_in = _wrapped->read(_buf, BUFSIZE);
 			}
-			_zlibErr = inflate(&_stream, Z_NO_FLUSH);
+
+			if (!_checkpointInterval) {
+				_zlibErr = inflate(&_stream, Z_NO_FLUSH);
+				continue;
+			}
+
+			// Stop at each block boundary to give a chance to record a
+			// checkpoint there
+			_zlibErr = inflate(&_stream, Z_BLOCK);
+			if (_zlibErr == Z_OK)
+				updateCheckpoints(_pos + dataSize - _stream.avail_out);
 		}
 
 		// Update the position counter
@@ -243,7 +349,7 @@ public:
 		return _pos;
 	}
 	int32 size() const {
-		return _origSize;
+		return _size;
 	}
 	bool seek(int32 offset, int whence = SEEK_SET) {
 		int32 newPos = 0;
@@ -255,49 +361,74 @@ public:
 			newPos = _pos + offset;
 			break;
 		case SEEK_END:
-			// NOTE: This can be an expensive operation (see below).
 			newPos = size() + offset;
 			break;
 		}
 
-		assert(newPos >= 0);
-
-		if ((uint32)newPos < _pos) {
-			// To search backward, we have to restart the whole decompression
-			// from the start of the file. A rather wasteful operation, best
-			// to avoid it. :/
+		if (newPos < 0)
+			return false;
 
-#ifndef RELEASE_BUILD
-			if (!_shownBackwardSeekingWarning) {
-				// We only throw this warning once per stream, to avoid
-				// getting the console swarmed with warnings when consecutive
-				// seeks are made.
-				debug(1, "Backward seeking in GZipReadStream detected");
-				_shownBackwardSeekingWarning = true;
+		// Find the last checkpoint before the new position
+		const Checkpoint *checkpoint = 0;
+		for (uint i = _checkpoints.size(); i > 0; --i) {
+			if (_checkpoints[i - 1].outPos <= (uint32)newPos) {
+				checkpoint = &_checkpoints[i - 1];
+				break;
 			}
-#endif
+		}
 
-			_pos = 0;
-			_wrapped->seek(0, SEEK_SET);
-			_zlibErr = inflateReset(&_stream);
-			if (_zlibErr != Z_OK)
-				return false;	// FIXME: STREAM REWRITE
-			_stream.next_in = _buf;
-			_stream.avail_in = 0;
+		// Restart the decompression when seeking backward, or when jumping
+		// over a checkpoint recorded earlier
+		if ((uint32)newPos < _pos || (checkpoint && checkpoint->outPos > _pos)) {
+			if (!restart(checkpoint))
+				return false;
 		}
 
 		offset = newPos - _pos;
 
-		// Skip the given amount of data (very inefficient if one tries to skip
-		// huge amounts of data, but usually client code will only skip a few
-		// bytes, so this should be fine.
-		byte tmpBuf[1024];
-		while (!err() && offset > 0) {
+		// Skip the remaining amount of data
+		byte tmpBuf[4096];
+		while (!err() && !_eos && offset > 0) {
 			offset -= read(tmpBuf, MIN((int32)sizeof(tmpBuf), offset));
 		}
 
 		_eos = false;
-		return true;	// FIXME: STREAM REWRITE
+		return !err();
+	}
+};
+
+/**
+ * A simple wrapper class which can be used to wrap around an arbitrary
+ * other SeekableReadStream and will then provide on-the-fly decompression support.
+ * Assumes the compressed data to be in gzip format.
+ */
+class GZipReadStream : public InflateReadStream {
+	static uint32 getOrigSize(SeekableReadStream *w, uint32 knownSize) {
+		// Verify file header is correct
+		w->seek(0, SEEK_SET);
+		uint16 header = w->readUint16BE();
+		assert(header == 0x1F8B ||
+		       ((header & 0x0F00) == 0x0800 && header % 31 == 0));
+
+		if (header == 0x1F8B) {
+			// Retrieve the original file size
+			w->seek(-4, SEEK_END);
+			return w->readUint32LE();
+		}
+
+		// Original size not available in zlib format
+		// use an otherwise known size if supplied.
+		return knownSize;
+	}
+
+public:
+	// Adding 32 to windowBits indicates to zlib that it is supposed to
+	// automatically detect whether gzip or zlib headers are used for
+	// the compressed file. This feature was added in zlib 1.2.0.4,
+	// released 10 August 2003.
+	// Note: This is *crucial* for savegame compatibility, do *not* remove!
+	GZipReadStream(SeekableReadStream *w, uint32 knownSize, uint32 checkpointInterval)
+		: InflateReadStream(w, MAX_WBITS + 32, getOrigSize(w, knownSize), checkpointInterval) {
 	}
 };
 
@@ -413,7 +544,7 @@ public:
 
 #endif	// USE_ZLIB
 
-SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, uint32 knownSize) {
+SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, uint32 knownSize, uint32 checkpointInterval) {
 	if (toBeWrapped) {
 		uint16 header = toBeWrapped->readUint16BE();
 		bool isCompressed = (header == 0x1F8B ||
@@ -422,7 +553,7 @@ SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, ui
 		toBeWrapped->seek(-2, SEEK_CUR);
 		if (isCompressed) {
 #if defined(USE_ZLIB)
-			return new GZipReadStream(toBeWrapped, knownSize);
+			return new GZipReadStream(toBeWrapped, knownSize, checkpointInterval);
 #else
 			delete toBeWrapped;
 			return NULL;
@@ -432,6 +563,19 @@ SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, ui
 	return toBeWrapped;
 }
 
+SeekableReadStream *wrapDeflateReadStream(SeekableReadStream *toBeWrapped, uint32 size, uint32 checkpointInterval) {
+	if (!toBeWrapped)
+		return NULL;
+
+#if defined(USE_ZLIB)
+	// The raw deflate data has neither a zlib nor a gzip header
+	return new InflateReadStream(toBeWrapped, -MAX_WBITS, size, checkpointInterval);
+#else
+	delete toBeWrapped;
+	return NULL;
+#endif
+}
+
 WriteStream *wrapCompressedWriteStream(WriteStream *toBeWrapped) {
 #if defined(USE_ZLIB)
 	if (toBeWrapped)
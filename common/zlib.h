@@ -113,13 +113,39 @@ bool inflateZlibInstallShield(byte *dst, uint dstLen, const byte *src, uint srcL
  * here. knownSize will be ignored if the GZip-stream DOES include a length.
  * The created stream also becomes responsible for freeing the passed stream.
  *
+ * Seeking backward in the wrapped stream restarts the decompression at the
+ * closest checkpoint, see wrapDeflateReadStream(). Streams smaller than
+ * checkpointInterval never record any checkpoint.
+ *
+ * It is safe to call this with a NULL parameter (in this case, NULL is
+ * returned).
+ *
+ * @param toBeWrapped			the stream to be wrapped (if it is in gzip-format)
+ * @param knownSize				a supplied length of the compressed data (if not available directly)
+ * @param checkpointInterval	the distance between checkpoints in the decompressed data, 0 to disable them
+ */
+SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, uint32 knownSize = 0, uint32 checkpointInterval = 1024 * 1024);
+
+/**
+ * Take an arbitrary SeekableReadStream containing raw deflate data, i.e.
+ * without any zlib or gzip header, and wrap it in a custom stream which
+ * provides transparent on-the-fly decompression. If there is no ZLIB
+ * support, NULL is returned and the stream is destroyed.
+ *
+ * Seeking backward restarts the decompression at the closest checkpoint.
+ * Checkpoints are recorded while reading, every checkpointInterval bytes
+ * of decompressed data, and cost 32 KiB of memory each. Pass 0 to disable
+ * them, in which case the decompression restarts at the start of the data.
+ * The created stream also becomes responsible for freeing the passed stream.
+ *
  * It is safe to call this with a NULL parameter (in this case, NULL is
  * returned).
  *
- * @param toBeWrapped	the stream to be wrapped (if it is in gzip-format)
- * @param knownSize		a supplied length of the compressed data (if not available directly)
+ * @param toBeWrapped			the stream to be wrapped
+ * @param size					the size of the decompressed data
+ * @param checkpointInterval	the distance between checkpoints in the decompressed data
  */
-SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, uint32 knownSize = 0);
+SeekableReadStream *wrapDeflateReadStream(SeekableReadStream *toBeWrapped, uint32 size, uint32 checkpointInterval = 1024 * 1024);
 
 /**
  * Take an arbitrary WriteStream and wrap it in a custom stream which provides
@@ -117,6 +117,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("resource_types",		WRAP_METHOD(Console, cmdResourceTypes));
 	registerCmd("list",				WRAP_METHOD(Console, cmdList));
 	registerCmd("alloc_list",				WRAP_METHOD(Console, cmdAllocList));
+	registerCmd("resource_cache",		WRAP_METHOD(Console, cmdResourceCache));
 	registerCmd("hexgrep",			WRAP_METHOD(Console, cmdHexgrep));
 	registerCmd("verify_scripts",		WRAP_METHOD(Console, cmdVerifyScripts));
 	registerCmd("integrity_dump",	WRAP_METHOD(Console, cmdResourceIntegrityDump));
@@ -163,6 +164,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("gc_reachable",		WRAP_METHOD(Console, cmdGCShowReachable));
 	registerCmd("gc_freeable",		WRAP_METHOD(Console, cmdGCShowFreeable));
 	registerCmd("gc_normalize",		WRAP_METHOD(Console, cmdGCNormalize));
+	registerCmd("gc_stats",			WRAP_METHOD(Console, cmdGCStats));
 	// Music/SFX
 	registerCmd("songlib",			WRAP_METHOD(Console, cmdSongLib));
 	registerCmd("songinfo",			WRAP_METHOD(Console, cmdSongInfo));
@@ -225,6 +227,8 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("bpe",				WRAP_METHOD(Console, cmdBreakpointFunction));		// alias
 	// VM
 	registerCmd("script_steps",		WRAP_METHOD(Console, cmdScriptSteps));
+	registerCmd("vm_benchmark",		WRAP_METHOD(Console, cmdVMBenchmark));
+	registerCmd("avoidpath_benchmark",	WRAP_METHOD(Console, cmdAvoidPathBenchmark));
 	registerCmd("script_objects",   WRAP_METHOD(Console, cmdScriptObjects));
 	registerCmd("scro",             WRAP_METHOD(Console, cmdScriptObjects));
 	registerCmd("script_strings",   WRAP_METHOD(Console, cmdScriptStrings));
@@ -256,6 +260,8 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	_debugState.breakpointWasHit = false;
 	_debugState._breakpoints.clear(); // No breakpoints defined
 	_debugState._activeBreakpointTypes = 0;
+	_debugState._vmTraceRemaining = 0;
+	_debugState._avoidPathTraceRemaining = 0;
 }
 
 Console::~Console() {
@@ -338,6 +344,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" resource_types - Shows the valid resource types\n");
 	debugPrintf(" list - Lists all the resources of a given type\n");
 	debugPrintf(" alloc_list - Lists all allocated resources\n");
+	debugPrintf(" resource_cache - Shows or changes the size and statistics of the resource cache\n");
 	debugPrintf(" hexgrep - Searches some resources for a particular sequence of bytes, represented as hexadecimal numbers\n");
 	debugPrintf(" verify_scripts - Performs sanity checks on SCI1.1-SCI2.1 game scripts (e.g. if they're up to 64KB in total)\n");
 	debugPrintf(" integrity_dump - Dumps integrity data about resources in the current game to disk\n");
@@ -379,6 +386,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" gc_reachable - Lists all addresses directly reachable from a given memory object\n");
 	debugPrintf(" gc_freeable - Lists all addresses freeable in a given segment\n");
 	debugPrintf(" gc_normalize - Prints the \"normal\" address of a given address\n");
+	debugPrintf(" gc_stats - Shows pause times and object counts of the garbage collector\n");
 	debugPrintf("\n");
 	debugPrintf("Music/SFX:\n");
 	debugPrintf(" songlib - Shows the song library\n");
@@ -424,6 +432,8 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf("\n");
 	debugPrintf("VM:\n");
 	debugPrintf(" script_steps - Shows the number of executed SCI operations\n");
+	debugPrintf(" vm_benchmark - Records executed SCI operations and replays their decoding\n");
+	debugPrintf(" avoidpath_benchmark - Records pathfinding requests and replays them\n");
 	debugPrintf(" vm_varlist / vmvarlist / vl - Shows the addresses of variables in the VM\n");
 	debugPrintf(" vm_vars / vmvars / vv - Displays or changes variables in the VM\n");
 	debugPrintf(" stack - Lists the specified number of stack elements\n");
@@ -1092,6 +1102,43 @@ bool Console::cmdResourceTypes(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdResourceCache(int argc, const char **argv) {
+	ResourceManager *resMan = _engine->getResMan();
+
+	if (argc > 1) {
+		if (!scumm_stricmp(argv[1], "reset")) {
+			resMan->resetCacheStats();
+		} else if (!scumm_stricmp(argv[1], "verify")) {
+			const uint errors = resMan->verifyCache();
+			debugPrintf("%u problems found in the resource cache\n", errors);
+			return true;
+		} else {
+			int size = atoi(argv[1]);
+			if (size <= 0) {
+				debugPrintf("Shows the memory use and hit rates of the resource cache.\n");
+				debugPrintf("Usage: %s [reset | verify | <size in KiB>]\n", argv[0]);
+				debugPrintf(" reset - resets the statistics\n");
+				debugPrintf(" verify - checks the memory accounting of the cache\n");
+				debugPrintf(" <size in KiB> - changes the maximum size of the cache\n");
+				return true;
+			}
+			resMan->setMaxCacheMemory(size * 1024);
+		}
+	}
+
+	static const char *const poolNames[kResCachePoolCount] = { "graphics", "audio", "other" };
+
+	debugPrintf("Resource cache: %d of %d KiB in use\n", resMan->getCacheMemory() / 1024, resMan->getMaxCacheMemory() / 1024);
+	for (int i = 0; i < kResCachePoolCount; i++) {
+		const ResourceManager::CachePool &pool = resMan->getCachePool((ResourceCachePool)i);
+		debugPrintf(" %-8s: %6d of %6d KiB, %u hits, %u misses, %u evictions\n", poolNames[i],
+			pool._memory / 1024, pool._budget / 1024, pool._hits, pool._misses, pool._evictions);
+	}
+	debugPrintf("Prefetched %u resources, %u of which were used\n", resMan->getPrefetchCount(), resMan->getPrefetchHits());
+
+	return true;
+}
+
 bool Console::cmdHexgrep(int argc, const char **argv) {
 	if (argc < 4) {
 		debugPrintf("Searches some resources for a particular sequence of bytes, represented as decimal or hexadecimal numbers.\n");
@@ -2713,6 +2760,19 @@ bool Console::cmdGCInvoke(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdGCStats(int argc, const char **argv) {
+	const EngineState *s = _engine->_gamestate;
+	const GCStatistics &stats = s->_gcStats;
+
+	debugPrintf("Collections: %d, total pause time: %d ms, longest pause: %d ms\n",
+		stats.cycles, stats.totalPauseTime, stats.maxPauseTime);
+	debugPrintf("Last collection: %d ms, %d reachable addresses, %d unreachable objects\n",
+		stats.lastPauseTime, stats.lastReachable, stats.lastGarbage);
+	debugPrintf("Objects freed: %d, still queued for freeing: %d\n",
+		stats.totalFreed, s->_gcPendingFrees.size() - s->_gcPendingFreesPos);
+	return true;
+}
+
 bool Console::cmdGCObjects(int argc, const char **argv) {
 	AddrSet *use_map = findAllActiveReferences(_engine->_gamestate);
 
@@ -3248,6 +3308,142 @@ bool Console::cmdScriptSteps(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdVMBenchmark(int argc, const char **argv) {
+	if (argc < 2) {
+		debugPrintf("Records the addresses of executed SCI operations, and replays\n");
+		debugPrintf("the recorded trace to benchmark instruction decoding.\n");
+		debugPrintf("Usage: %s record <operations>\n", argv[0]);
+		debugPrintf("       %s run [<iterations>]\n", argv[0]);
+		return true;
+	}
+
+	if (!scumm_stricmp(argv[1], "record")) {
+		if (argc < 3) {
+			debugPrintf("Please specify the number of operations to record\n");
+			return true;
+		}
+		_debugState._vmTrace.clear();
+		_debugState._vmTraceRemaining = atoi(argv[2]);
+		debugPrintf("Recording the next %d operations\n", _debugState._vmTraceRemaining);
+		return true;
+	}
+
+	if (scumm_stricmp(argv[1], "run")) {
+		debugPrintf("Unknown subcommand '%s'\n", argv[1]);
+		return true;
+	}
+
+	if (_debugState._vmTrace.empty()) {
+		debugPrintf("No operations recorded yet\n");
+		return true;
+	}
+
+	const int iterations = (argc > 2) ? atoi(argv[2]) : 100;
+	SegManager *segMan = _engine->_gamestate->_segMan;
+
+	// Only replay operations of scripts which are still loaded
+	Common::Array<Script *> scripts;
+	Common::Array<uint32> offsets;
+	for (uint i = 0; i < _debugState._vmTrace.size(); ++i) {
+		Script *script = segMan->getScriptIfLoaded(_debugState._vmTrace[i].getSegment());
+		if (script && _debugState._vmTrace[i].getOffset() < script->getBufSize()) {
+			scripts.push_back(script);
+			offsets.push_back(_debugState._vmTrace[i].getOffset());
+		}
+	}
+
+	byte extOpcode;
+	int16 opparams[4];
+	uint checksum = 0;
+
+	uint32 start = g_system->getMillis();
+	for (int n = 0; n < iterations; ++n) {
+		for (uint i = 0; i < scripts.size(); ++i) {
+			checksum += readPMachineInstruction(scripts[i]->getBuf(offsets[i]), extOpcode, opparams);
+			checksum += extOpcode + opparams[0];
+		}
+	}
+	const uint32 decodeTime = g_system->getMillis() - start;
+
+	start = g_system->getMillis();
+	for (int n = 0; n < iterations; ++n) {
+		for (uint i = 0; i < scripts.size(); ++i) {
+			const PMachineInstruction &instruction = scripts[i]->getInstruction(offsets[i]);
+			checksum -= instruction.size;
+			checksum -= instruction.extOpcode + instruction.opparams[0];
+		}
+	}
+	const uint32 cachedTime = g_system->getMillis() - start;
+
+	debugPrintf("Replayed %d of %d recorded operations %d times\n", scripts.size(), _debugState._vmTrace.size(), iterations);
+	debugPrintf("Decoding: %d ms, cached: %d ms%s\n", decodeTime, cachedTime, checksum ? " (mismatch!)" : "");
+	return true;
+}
+
+extern void replayAvoidPath(EngineState *s, const AvoidPathInput &input, bool useCache, Common::Array<Common::Point> &path);
+
+bool Console::cmdAvoidPathBenchmark(int argc, const char **argv) {
+	if (argc < 2) {
+		debugPrintf("Records the input of kAvoidPath calls, and replays the recorded\n");
+		debugPrintf("calls with and without the cached visibility graphs.\n");
+		debugPrintf("Usage: %s record <calls>\n", argv[0]);
+		debugPrintf("       %s run [<iterations>]\n", argv[0]);
+		return true;
+	}
+
+	if (!scumm_stricmp(argv[1], "record")) {
+		if (argc < 3) {
+			debugPrintf("Please specify the number of calls to record\n");
+			return true;
+		}
+		_debugState._avoidPathTrace.clear();
+		_debugState._avoidPathTraceRemaining = atoi(argv[2]);
+		debugPrintf("Recording the next %d calls\n", _debugState._avoidPathTraceRemaining);
+		return true;
+	}
+
+	if (scumm_stricmp(argv[1], "run")) {
+		debugPrintf("Unknown subcommand '%s'\n", argv[1]);
+		return true;
+	}
+
+	const Common::Array<AvoidPathInput> &trace = _debugState._avoidPathTrace;
+
+	if (trace.empty()) {
+		debugPrintf("No calls recorded yet\n");
+		return true;
+	}
+
+	const int iterations = (argc > 2) ? atoi(argv[2]) : 10;
+	EngineState *s = _engine->_gamestate;
+	Common::Array<Common::Array<Common::Point> > paths(trace.size());
+	Common::Array<Common::Point> path;
+	uint mismatches = 0;
+
+	uint32 start = g_system->getMillis();
+	for (int n = 0; n < iterations; ++n) {
+		for (uint i = 0; i < trace.size(); ++i)
+			replayAvoidPath(s, trace[i], false, paths[i]);
+	}
+	const uint32 uncachedTime = g_system->getMillis() - start;
+
+	start = g_system->getMillis();
+	for (int n = 0; n < iterations; ++n) {
+		for (uint i = 0; i < trace.size(); ++i) {
+			replayAvoidPath(s, trace[i], true, path);
+			if (path != paths[i])
+				++mismatches;
+		}
+	}
+	const uint32 cachedTime = g_system->getMillis() - start;
+
+	debugPrintf("Replayed %d recorded calls %d times\n", trace.size(), iterations);
+	debugPrintf("Uncached: %d ms, cached: %d ms\n", uncachedTime, cachedTime);
+	if (mismatches)
+		debugPrintf("%d paths differ from the uncached search!\n", mismatches);
+	return true;
+}
+
 bool Console::cmdScriptObjects(int argc, const char **argv) {
 	int curScriptNr = -1;
 
@@ -23,7 +23,9 @@
 #ifndef SCI_DEBUG_H
 #define SCI_DEBUG_H
 
+#include "common/array.h"
 #include "common/list.h"
+#include "common/rect.h"
 #include "sci/engine/vm_types.h"	// for StackPtr
 
 namespace Sci {
@@ -63,6 +65,20 @@ struct Breakpoint {
 	BreakpointAction _action;
 };
 
+/** Input of a kAvoidPath call, recorded for the avoidpath_benchmark command */
+struct AvoidPathInput {
+	struct Obstacle {
+		int type;
+		Common::Array<Common::Point> points;
+	};
+
+	Common::Point start;
+	Common::Point end;
+	int width, height;
+	int opt;
+	Common::Array<Obstacle> obstacles;
+};
+
 enum DebugSeeking {
 	kDebugSeekNothing = 0,
 	kDebugSeekCallk = 1,        // Step forward until callk is found
@@ -84,6 +100,10 @@ struct DebugState {
 	StackPtr old_sp;
 	Common::List<Breakpoint> _breakpoints;   //< List of breakpoints
 	int _activeBreakpointTypes;  //< Bit mask specifying which types of breakpoints are active
+	Common::Array<reg32_t> _vmTrace;  //< Recorded addresses of executed instructions, see vm_benchmark
+	uint _vmTraceRemaining;  //< Number of instructions still to be recorded into _vmTrace
+	Common::Array<AvoidPathInput> _avoidPathTrace;  //< Recorded pathfinding inputs, see avoidpath_benchmark
+	uint _avoidPathTraceRemaining;  //< Number of kAvoidPath calls still to be recorded into _avoidPathTrace
 
 	void updateActiveBreakpointTypes();
 };
@@ -22,6 +22,7 @@
 
 #include "sci/engine/gc.h"
 #include "common/array.h"
+#include "common/system.h"
 #include "sci/graphics/ports.h"
 
 #ifdef ENABLE_SCI32
@@ -179,9 +180,37 @@ AddrSet *findAllActiveReferences(EngineState *s) {
 	return normalizeAddresses(s->_segMan, wm._map);
 }
 
-void run_gc(EngineState *s) {
+void run_gc_sweep(EngineState *s, uint maxFrees) {
 	SegManager *segMan = s->_segMan;
 
+	while (maxFrees-- && s->_gcPendingFreesPos < s->_gcPendingFrees.size()) {
+		const reg_t addr = s->_gcPendingFrees[s->_gcPendingFreesPos++];
+		SegmentObj *mobj = segMan->getSegmentObj(addr.getSegment());
+
+		// Nothing references the object anymore, so it can't have been freed
+		// in the meantime. But better be safe than sorry.
+		if (mobj && mobj->isValidOffset(addr.getOffset())) {
+			mobj->freeAtAddress(segMan, addr);
+			debugC(kDebugLevelGC, "[GC] Deallocating %04x:%04x", PRINT_REG(addr));
+			s->_gcStats.totalFreed++;
+		}
+	}
+
+	if (s->_gcPendingFreesPos >= s->_gcPendingFrees.size()) {
+		s->_gcPendingFrees.clear();
+		s->_gcPendingFreesPos = 0;
+	}
+}
+
+void run_gc(EngineState *s, bool incremental) {
+	SegManager *segMan = s->_segMan;
+	GCStatistics &stats = s->_gcStats;
+	const uint32 startTime = g_system->getMillis();
+
+	// Objects left over from the previous incremental collection have to be
+	// freed first, as they would show up as unreachable once more.
+	run_gc_sweep(s, s->_gcPendingFrees.size());
+
 	// Some debug stuff
 	debugC(kDebugLevelGC, "[GC] Running...");
 #ifdef GC_DEBUG_CODE
@@ -193,6 +222,8 @@ void run_gc(EngineState *s) {
 
 	// Compute the set of all segments references currently in use.
 	AddrSet *activeRefs = findAllActiveReferences(s);
+	stats.lastReachable = activeRefs->size();
+	stats.lastGarbage = 0;
 
 	// Iterate over all segments, and check for each whether it
 	// contains stuff that can be collected.
@@ -212,9 +243,16 @@ void run_gc(EngineState *s) {
 			for (Common::Array<reg_t>::const_iterator it = tmp.begin(); it != tmp.end(); ++it) {
 				const reg_t addr = *it;
 				if (!activeRefs->contains(addr)) {
-					// Not found -> we can free it
-					mobj->freeAtAddress(segMan, addr);
-					debugC(kDebugLevelGC, "[GC] Deallocating %04x:%04x", PRINT_REG(addr));
+					stats.lastGarbage++;
+					if (incremental) {
+						// Not found -> free it later
+						s->_gcPendingFrees.push_back(addr);
+					} else {
+						// Not found -> we can free it
+						mobj->freeAtAddress(segMan, addr);
+						debugC(kDebugLevelGC, "[GC] Deallocating %04x:%04x", PRINT_REG(addr));
+						stats.totalFreed++;
+					}
 #ifdef GC_DEBUG_CODE
 					segcount[type]++;
 #endif
@@ -226,6 +264,15 @@ void run_gc(EngineState *s) {
 
 	delete activeRefs;
 
+	stats.cycles++;
+	stats.lastPauseTime = g_system->getMillis() - startTime;
+	stats.maxPauseTime = MAX(stats.maxPauseTime, stats.lastPauseTime);
+	stats.totalPauseTime += stats.lastPauseTime;
+
+	debugC(kDebugLevelGC, "[GC] Cycle %d took %d ms: %d reachable addresses, %d unreachable objects%s",
+		stats.cycles, stats.lastPauseTime, stats.lastReachable, stats.lastGarbage,
+		incremental ? " queued for freeing" : " freed");
+
 #ifdef GC_DEBUG_CODE
 	// Output debug summary of garbage collection
 	debugC(kDebugLevelGC, "[GC] Summary:");
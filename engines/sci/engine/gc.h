@@ -50,10 +50,27 @@ typedef Common::HashMap<reg_t, bool, reg_t_Hash> AddrSet;
 AddrSet *findAllActiveReferences(EngineState *s);
 
 /**
- * Runs garbage collection on the current system state
- * @param s The state in which we should gc
+ * Runs garbage collection on the current system state.
+ *
+ * Finding the reachable objects always happens in one go: scripts and
+ * kernel functions write references directly into objects, lists and
+ * arrays, so there is no write barrier which would allow spreading this
+ * over several calls. Freeing the unreachable objects can be spread,
+ * though, since nothing can reference them anymore.
+ *
+ * @param s				The state in which we should gc
+ * @param incremental	If true, unreachable objects are only queued, to be
+ *						freed by subsequent calls of run_gc_sweep(). Else
+ *						they are freed right away.
+ */
+void run_gc(EngineState *s, bool incremental = false);
+
+/**
+ * Frees objects queued by an incremental garbage collection.
+ * @param s			The state in which we should gc
+ * @param maxFrees	The maximum number of objects to free
  */
-void run_gc(EngineState *s);
+void run_gc_sweep(EngineState *s, uint maxFrees);
 
 struct WorklistManager {
 	Common::Array<reg_t> _worklist;
@@ -111,10 +111,20 @@ struct Vertex {
 	// Previous vertex in shortest path
 	Vertex *path_prev;
 
+	// A* set membership
+	bool inOpenSet;
+	bool inClosedSet;
+
+	// Index in the cached visibility graph, or -1 if not part of it
+	int graphIndex;
+
 public:
 	Vertex(const Common::Point &p) : v(p) {
 		costG = HUGE_DISTANCE;
 		path_prev = NULL;
+		inOpenSet = false;
+		inClosedSet = false;
+		graphIndex = -1;
 	}
 };
 
@@ -257,12 +267,16 @@ struct PathfindingState {
 	// Screen size
 	int _width, _height;
 
+	// Cached visibility between the vertices of the polygon set, if any
+	VisibilityGraph *_visibilityGraph;
+
 	PathfindingState(int width, int height) : _width(width), _height(height) {
 		vertex_start = NULL;
 		vertex_end = NULL;
 		vertex_index = NULL;
 		_prependPoint = NULL;
 		_appendPoint = NULL;
+		_visibilityGraph = NULL;
 		vertices = 0;
 	}
 
@@ -659,6 +673,39 @@ static int inside(const Common::Point &p, Vertex *vertex) {
 	return 0;
 }
 
+/**
+ * Determines whether a vertex is visible from another vertex
+ * @param s				the pathfinding state
+ * @param vertex_cur	the vertex to look from
+ * @param vertex		the vertex to check
+ * @return true if the line between both vertices doesn't cross any polygon
+ */
+static bool vertex_visible(PathfindingState *s, Vertex *vertex_cur, Vertex *vertex) {
+	// Make sure we don't intersect a polygon locally at the vertices
+	if ((vertex == vertex_cur) || (inside(vertex->v, vertex_cur)) || (inside(vertex_cur->v, vertex)))
+		return false;
+
+	// Check for intersecting edges
+	for (int j = 0; j < s->vertices; j++) {
+		Vertex *edge = s->vertex_index[j];
+		if (VERTEX_HAS_EDGES(edge)) {
+			if (between(vertex_cur->v, vertex->v, edge->v)) {
+				// If we hit a vertex, make sure we can pass through it without intersecting its polygon
+				if ((inside(vertex_cur->v, edge)) || (inside(vertex->v, edge)))
+					return false;
+
+				// This edge won't properly intersect, so we continue
+				continue;
+			}
+
+			if (intersect_proper(vertex_cur->v, vertex->v, edge->v, CLIST_NEXT(edge)->v))
+				return false;
+		}
+	}
+
+	return true;
+}
+
 /**
  * Returns a list of all vertices that are visible from a particular vertex.
  * @param s				the pathfinding state
@@ -667,35 +714,49 @@ static int inside(const Common::Point &p, Vertex *vertex) {
  */
 static VertexList *visible_vertices(PathfindingState *s, Vertex *vertex_cur) {
 	VertexList *visVerts = new VertexList();
+	VisibilityGraph *graph = s->_visibilityGraph;
 
-	for (int i = 0; i < s->vertices; i++) {
-		Vertex *vertex = s->vertex_index[i];
+	if (!graph || vertex_cur->graphIndex < 0) {
+		for (int i = 0; i < s->vertices; i++) {
+			Vertex *vertex = s->vertex_index[i];
 
-		// Make sure we don't intersect a polygon locally at the vertices
-		if ((vertex == vertex_cur) || (inside(vertex->v, vertex_cur)) || (inside(vertex_cur->v, vertex)))
-			continue;
+			if (vertex_visible(s, vertex_cur, vertex))
+				visVerts->push_front(vertex);
+		}
 
-		// Check for intersecting edges
-		int j;
-		for (j = 0; j < s->vertices; j++) {
-			Vertex *edge = s->vertex_index[j];
-			if (VERTEX_HAS_EDGES(edge)) {
-				if (between(vertex_cur->v, vertex->v, edge->v)) {
-					// If we hit a vertex, make sure we can pass through it without intersecting its polygon
-					if ((inside(vertex_cur->v, edge)) || (inside(vertex->v, edge)))
-						break;
-
-					// This edge won't properly intersect, so we continue
-					continue;
-				}
+		return visVerts;
+	}
 
-				if (intersect_proper(vertex_cur->v, vertex->v, edge->v, CLIST_NEXT(edge)->v))
-					break;
-			}
+	// Visibility between two vertices of the graph only depends on the
+	// polygon set, so it is computed once and then reused by all further
+	// searches on the same polygons
+	Common::Array<uint16> &visible = graph->visible[vertex_cur->graphIndex];
+
+	if (!graph->computed[vertex_cur->graphIndex]) {
+		for (int i = 0; i < s->vertices; i++) {
+			Vertex *vertex = s->vertex_index[i];
+
+			if (vertex->graphIndex >= 0 && vertex_visible(s, vertex_cur, vertex))
+				visible.push_back(vertex->graphIndex);
 		}
 
-		if (j == s->vertices)
+		graph->computed[vertex_cur->graphIndex] = true;
+	}
+
+	// Merge in the vertices outside of the graph, keeping the order of the
+	// uncached search
+	uint next = 0;
+
+	for (int i = 0; i < s->vertices; i++) {
+		Vertex *vertex = s->vertex_index[i];
+
+		if (vertex->graphIndex < 0) {
+			if (vertex_visible(s, vertex_cur, vertex))
+				visVerts->push_front(vertex);
+		} else if (next < visible.size() && visible[next] == vertex->graphIndex) {
 			visVerts->push_front(vertex);
+			next++;
+		}
 	}
 
 	return visVerts;
@@ -1186,39 +1247,18 @@ static void change_polygons_opt_0(PathfindingState *s) {
 }
 
 /**
- * Converts the SCI input data for pathfinding
+ * Prepares the converted polygons of a pathfinding state for the search
  * Parameters: (EngineState *) s: The game state
- *             (reg_t) poly_list: Polygon list
+ *             (PathfindingState *) pf_s: The pathfinding state
  *             (Common::Point) start: The start point
  *             (Common::Point) end: The end point
  *             (int) opt: Optimization level (0, 1 or 2)
- * Returns   : (PathfindingState *) On success a newly allocated pathfinding state,
- *                            NULL otherwise
+ * Returns   : (PathfindingState *) pf_s on success, NULL otherwise, in which
+ *                            case pf_s has been deleted
  */
-static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Common::Point start, Common::Point end, int width, int height, int opt) {
-	SegManager *segMan = s->_segMan;
+static PathfindingState *prepare_polygon_set(EngineState *s, PathfindingState *pf_s, Common::Point start, Common::Point end, int opt) {
 	Polygon *polygon;
 	int count = 0;
-	PathfindingState *pf_s = new PathfindingState(width, height);
-
-	// Convert all polygons
-	if (poly_list.getSegment()) {
-		List *list = s->_segMan->lookupList(poly_list);
-		Node *node = s->_segMan->lookupNode(list->first);
-
-		while (node) {
-			// The node value might be null, in which case there's no polygon to parse.
-			// Happens in LB2 floppy - refer to bug #3041232
-			polygon = !node->value.isNull() ? convert_polygon(s, node->value) : NULL;
-
-			if (polygon) {
-				pf_s->polygons.push_back(polygon);
-				count += readSelectorValue(segMan, node->value, SELECTOR(size));
-			}
-
-			node = s->_segMan->lookupNode(node->succ);
-		}
-	}
 
 	if (opt == 0)
 		change_polygons_opt_0(pf_s);
@@ -1284,7 +1324,10 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 	delete new_end;
 
 	// Allocate and build vertex index
-	pf_s->vertex_index = (Vertex**)malloc(sizeof(Vertex *) * (count + 2));
+	for (PolygonList::iterator it = pf_s->polygons.begin(); it != pf_s->polygons.end(); ++it)
+		count += (*it)->vertices.size();
+
+	pf_s->vertex_index = (Vertex**)malloc(sizeof(Vertex *) * count);
 
 	count = 0;
 
@@ -1302,6 +1345,150 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 	return pf_s;
 }
 
+/**
+ * Records the converted polygons of a kAvoidPath call for the
+ * avoidpath_benchmark console command
+ * Parameters: (PathfindingState *) pf_s: The pathfinding state
+ *             (Common::Point) start: The start point
+ *             (Common::Point) end: The end point
+ *             (int) opt: Optimization level (0, 1 or 2)
+ */
+static void record_input(PathfindingState *pf_s, Common::Point start, Common::Point end, int opt) {
+	AvoidPathInput input;
+
+	input.start = start;
+	input.end = end;
+	input.width = pf_s->_width;
+	input.height = pf_s->_height;
+	input.opt = opt;
+
+	for (PolygonList::iterator it = pf_s->polygons.begin(); it != pf_s->polygons.end(); ++it) {
+		AvoidPathInput::Obstacle obstacle;
+		Vertex *vertex;
+
+		obstacle.type = (*it)->type;
+		CLIST_FOREACH(vertex, &(*it)->vertices) {
+			obstacle.points.push_back(vertex->v);
+		}
+
+		input.obstacles.push_back(obstacle);
+	}
+
+	g_sci->_debugState._avoidPathTrace.push_back(input);
+}
+
+/**
+ * Converts the SCI input data for pathfinding
+ * Parameters: (EngineState *) s: The game state
+ *             (reg_t) poly_list: Polygon list
+ *             (Common::Point) start: The start point
+ *             (Common::Point) end: The end point
+ *             (int) opt: Optimization level (0, 1 or 2)
+ * Returns   : (PathfindingState *) On success a newly allocated pathfinding state,
+ *                            NULL otherwise
+ */
+static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Common::Point start, Common::Point end, int width, int height, int opt) {
+	Polygon *polygon;
+	PathfindingState *pf_s = new PathfindingState(width, height);
+
+	// Convert all polygons
+	if (poly_list.getSegment()) {
+		List *list = s->_segMan->lookupList(poly_list);
+		Node *node = s->_segMan->lookupNode(list->first);
+
+		while (node) {
+			// The node value might be null, in which case there's no polygon to parse.
+			// Happens in LB2 floppy - refer to bug #3041232
+			polygon = !node->value.isNull() ? convert_polygon(s, node->value) : NULL;
+
+			if (polygon)
+				pf_s->polygons.push_back(polygon);
+
+			node = s->_segMan->lookupNode(node->succ);
+		}
+	}
+
+	if (g_sci->_debugState._avoidPathTraceRemaining) {
+		record_input(pf_s, start, end, opt);
+		--g_sci->_debugState._avoidPathTraceRemaining;
+	}
+
+	return prepare_polygon_set(s, pf_s, start, end, opt);
+}
+
+
+/**
+ * Attaches the cached visibility graph of the polygon set to a pathfinding
+ * state, creating a new graph if the polygon set hasn't been seen recently
+ * Parameters: (EngineState *) s: The game state
+ *             (PathfindingState *) p: The pathfinding state
+ */
+static void attach_visibility_graph(EngineState *s, PathfindingState *p) {
+	Common::Array<int16> geometry;
+	int count = 0;
+
+	// Start and end points which weren't merged into a polygon are
+	// single-vertex polygons. These don't have any edges and can't block
+	// the view between other vertices, so they're left out of the graph
+	// to let it be reused for other start and end points.
+	for (int i = 0; i < p->vertices; i++) {
+		Vertex *vertex = p->vertex_index[i];
+
+		if ((vertex == p->vertex_start || vertex == p->vertex_end) && !VERTEX_HAS_EDGES(vertex))
+			continue;
+
+		vertex->graphIndex = count++;
+	}
+
+	geometry.reserve(count * 4);
+	uint32 hash = 0;
+
+	for (int i = 0; i < p->vertices; i++) {
+		Vertex *vertex = p->vertex_index[i];
+
+		if (vertex->graphIndex < 0)
+			continue;
+
+		geometry.push_back(vertex->v.x);
+		geometry.push_back(vertex->v.y);
+		geometry.push_back(CLIST_NEXT(vertex)->graphIndex);
+		geometry.push_back(CLIST_PREV(vertex)->graphIndex);
+	}
+
+	for (uint i = 0; i < geometry.size(); i++)
+		hash = hash * 31 + (uint16)geometry[i];
+
+	Common::List<VisibilityGraph> &graphs = s->_visibilityGraphs;
+
+	for (Common::List<VisibilityGraph>::iterator it = graphs.begin(); it != graphs.end(); ++it) {
+		if (it->hash == hash && it->geometry == geometry) {
+			if (it != graphs.begin()) {
+				graphs.push_front(*it);
+				graphs.erase(it);
+			}
+
+			p->_visibilityGraph = &graphs.front();
+			return;
+		}
+	}
+
+	if (graphs.size() >= kMaxVisibilityGraphs)
+		graphs.pop_back();
+
+	graphs.push_front(VisibilityGraph());
+
+	VisibilityGraph &graph = graphs.front();
+	graph.hash = hash;
+	graph.geometry = geometry;
+	graph.visible.resize(count);
+	graph.computed.resize(count);
+
+	for (int i = 0; i < count; i++)
+		graph.computed[i] = false;
+
+	p->_visibilityGraph = &graph;
+}
+
 /**
  * Computes a shortest path from vertex_start to vertex_end. The caller can
  * construct the resulting path by following the path_prev links from
@@ -1310,13 +1497,28 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
  * Parameters: (PathfindingState *) s: The pathfinding state
  */
 static void AStar(PathfindingState *s) {
-	// Vertices of which the shortest path is known
-	VertexList closedSet;
-
-	// The remaining vertices
+	// The remaining vertices. Vertices of which the shortest path is known
+	// are marked as being in the closed set.
 	VertexList openSet;
 
+	// When travelling to a vertex on the screen edge, we
+	// add a penalty score to make this path less appealing.
+	// NOTE: If an obstacle has only one vertex on a screen edge,
+	// later SSCI pathfinders will treat that vertex like any
+	// other, while we apply a penalty to paths traversing it.
+	// This difference might lead to problems, but none are
+	// known at the time of writing.
+
+	// WORKAROUND: This check fails in QFG1VGA, room 81 (bug report #3568452).
+	// However, it is needed in other SCI1.1 games, such as LB2. Therefore, we
+	// add this workaround for that scene in QFG1VGA, until our algorithm matches
+	// better what SSCI is doing. With this workaround, QFG1VGA no longer freezes
+	// in that scene.
+	const bool qfg1VgaWorkaround = (g_sci->getGameId() == GID_QFG1VGA &&
+									g_sci->getEngineState()->currentRoomNumber() == 81);
+
 	openSet.push_front(s->vertex_start);
+	s->vertex_start->inOpenSet = true;
 	s->vertex_start->costG = 0;
 	s->vertex_start->costF = (uint32)sqrt((float)s->vertex_start->v.sqrDist(s->vertex_end->v));
 
@@ -1342,7 +1544,8 @@ static void AStar(PathfindingState *s) {
 			break;
 
 		// Move vertex from set open to set closed
-		closedSet.push_front(vertex_min);
+		vertex_min->inClosedSet = true;
+		vertex_min->inOpenSet = false;
 		openSet.erase(vertex_min_it);
 
 		VertexList *visVerts = visible_vertices(s, vertex_min);
@@ -1351,30 +1554,16 @@ static void AStar(PathfindingState *s) {
 			uint32 new_dist;
 			Vertex *vertex = *it;
 
-			if (closedSet.contains(vertex))
+			if (vertex->inClosedSet)
 				continue;
 
-			if (!openSet.contains(vertex))
+			if (!vertex->inOpenSet) {
 				openSet.push_front(vertex);
+				vertex->inOpenSet = true;
+			}
 
 			new_dist = vertex_min->costG + (uint32)sqrt((float)vertex_min->v.sqrDist(vertex->v));
 
-			// When travelling to a vertex on the screen edge, we
-			// add a penalty score to make this path less appealing.
-			// NOTE: If an obstacle has only one vertex on a screen edge,
-			// later SSCI pathfinders will treat that vertex like any
-			// other, while we apply a penalty to paths traversing it.
-			// This difference might lead to problems, but none are
-			// known at the time of writing.
-
-			// WORKAROUND: This check fails in QFG1VGA, room 81 (bug report #3568452).
-			// However, it is needed in other SCI1.1 games, such as LB2. Therefore, we
-			// add this workaround for that scene in QFG1VGA, until our algorithm matches
-			// better what SSCI is doing. With this workaround, QFG1VGA no longer freezes
-			// in that scene.
-			bool qfg1VgaWorkaround = (g_sci->getGameId() == GID_QFG1VGA &&
-									  g_sci->getEngineState()->currentRoomNumber() == 81);
-
 			if (s->pointOnScreenBorder(vertex->v) && !qfg1VgaWorkaround)
 				new_dist += 10000;
 
@@ -1483,6 +1672,48 @@ static reg_t output_path(PathfindingState *p, EngineState *s) {
 	return output;
 }
 
+/**
+ * Runs the pathfinder on a recorded kAvoidPath input, for the
+ * avoidpath_benchmark console command
+ * Parameters: (EngineState *) s: The game state
+ *             (const AvoidPathInput &) input: The recorded input
+ *             (bool) useCache: Whether to use the cached visibility graphs
+ *             (Common::Array<Common::Point> &) path: Receives the path from
+ *                            the end point back to the start point, empty
+ *                            if no path was found
+ */
+void replayAvoidPath(EngineState *s, const AvoidPathInput &input, bool useCache, Common::Array<Common::Point> &path) {
+	PathfindingState *p = new PathfindingState(input.width, input.height);
+
+	for (uint i = 0; i < input.obstacles.size(); i++) {
+		const AvoidPathInput::Obstacle &obstacle = input.obstacles[i];
+		Polygon *polygon = new Polygon(obstacle.type);
+
+		for (uint j = 0; j < obstacle.points.size(); j++)
+			polygon->vertices.insertAtEnd(new Vertex(obstacle.points[j]));
+
+		p->polygons.push_back(polygon);
+	}
+
+	path.clear();
+	p = prepare_polygon_set(s, p, input.start, input.end, input.opt);
+
+	if (!p)
+		return;
+
+	if (useCache)
+		attach_visibility_graph(s, p);
+
+	AStar(p);
+
+	if (p->vertex_end->path_prev) {
+		for (Vertex *vertex = p->vertex_end; vertex; vertex = vertex->path_prev)
+			path.push_back(vertex->v);
+	}
+
+	delete p;
+}
+
 reg_t kAvoidPath(EngineState *s, int argc, reg_t *argv) {
 	Common::Point start = Common::Point(argv[0].toSint16(), argv[1].toSint16());
 
@@ -1561,7 +1792,7 @@ reg_t kAvoidPath(EngineState *s, int argc, reg_t *argv) {
 			return output;
 		}
 
-		// Apply Dijkstra
+		attach_visibility_graph(s, p);
 		AStar(p);
 
 		output = output_path(p, s);
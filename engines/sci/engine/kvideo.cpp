@@ -51,6 +51,9 @@
 namespace Sci {
 
 void playVideo(Video::VideoDecoder &videoDecoder) {
+	// Decode a few frames ahead while waiting, so slow frames don't stall
+	// playback
+	videoDecoder.setDecodeAhead(4);
 	videoDecoder.start();
 
 	Common::SpanOwner<SciSpan<byte> > scaleBuffer;
@@ -111,7 +114,12 @@ void playVideo(Video::VideoDecoder &videoDecoder) {
 		if (g_sci->getEngineState()->_delayedRestoreGameId != -1)
 			skipVideo = true;
 
-		g_system->delayMillis(10);
+		uint32 startTime = g_system->getMillis();
+		videoDecoder.decodeAhead(10);
+
+		uint32 decodeTime = g_system->getMillis() - startTime;
+		if (decodeTime < 10)
+			g_system->delayMillis(10 - decodeTime);
 	}
 }
 
@@ -73,6 +73,9 @@ void Script::freeScript(const bool keepLocalsSegment) {
 	_offsetLookupObjectCount = 0;
 	_offsetLookupStringCount = 0;
 	_offsetLookupSaidCount = 0;
+
+	_instructionIndex.clear();
+	_instructions.clear();
 }
 
 enum {
@@ -641,6 +644,39 @@ Object *Script::getObject(uint32 offset) {
 		return 0;
 }
 
+const PMachineInstruction &Script::getInstruction(uint32 offset) {
+	assert(offset < _buf->size());
+
+	if (_instructionIndex.empty())
+		_instructionIndex.resize(_buf->size());
+
+	const uint16 index = _instructionIndex[offset];
+	const byte *src = getBuf(offset);
+
+	// Script code is never modified after loading. Still, make sure that
+	// we notice it, should some kernel function write over the code.
+	if (index && _instructions[index - 1].extOpcode == *src)
+		return _instructions[index - 1];
+
+	PMachineInstruction instruction;
+	instruction.size = readPMachineInstruction(src, instruction.extOpcode, instruction.opparams);
+
+	if (index) {
+		_instructions[index - 1] = instruction;
+		return _instructions[index - 1];
+	}
+
+	if (_instructions.size() < 0xFFFF) {
+		_instructions.push_back(instruction);
+		_instructionIndex[offset] = _instructions.size();
+		return _instructions.back();
+	}
+
+	// Index space exhausted, which should never happen for real scripts
+	_uncachedInstruction = instruction;
+	return _uncachedInstruction;
+}
+
 const Object *Script::getObject(uint32 offset) const {
 	if (_objects.contains(offset))
 		return &_objects[offset];
@@ -69,6 +69,15 @@ struct offsetLookupArrayEntry {
 
 typedef Common::Array<offsetLookupArrayEntry> offsetLookupArrayType;
 
+/**
+ * A decoded PMachine instruction, as returned by Script::getInstruction().
+ */
+struct PMachineInstruction {
+	int16 opparams[4]; /**< Parameters of the instruction */
+	uint16 size;       /**< Length of the instruction in bytes */
+	byte extOpcode;    /**< "Extended" opcode of the instruction */
+};
+
 class Script : public SegmentObj {
 private:
 	int _nr; /**< Script number */
@@ -94,6 +103,16 @@ private:
 
 	ObjMap _objects;	/**< Table for objects, contains property variables */
 
+	/**
+	 * Decoded instructions, see getInstruction(). For every offset into the
+	 * script buffer, _instructionIndex holds the index of the instruction
+	 * at that offset in _instructions plus one, or 0 if the instruction has
+	 * not been decoded yet.
+	 */
+	Common::Array<uint16> _instructionIndex;
+	Common::Array<PMachineInstruction> _instructions;
+	PMachineInstruction _uncachedInstruction;
+
 protected:
 	offsetLookupArrayType _offsetLookupArray; // Table of all elements of currently loaded script, that may get pointed to
 
@@ -155,6 +174,14 @@ public:
 	Object *getObject(uint32 offset);
 	const Object *getObject(uint32 offset) const;
 
+	/**
+	 * Returns the decoded PMachine instruction at the given offset. Each
+	 * instruction is only decoded the first time it is executed; later
+	 * calls return the cached result. The returned reference is only valid
+	 * until the next call.
+	 */
+	const PMachineInstruction &getInstruction(uint32 offset);
+
 	/**
 	 * Initializes an object within the segment manager
 	 * @param obj_pos	Location (segment, offset) of the object. It must
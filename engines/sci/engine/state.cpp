@@ -100,6 +100,10 @@ void EngineState::reset(bool isRestoring) {
 	lastWaitTime = 0;
 
 	gcCountDown = 0;
+	// Any objects still queued belong to the previous game state
+	_gcPendingFrees.clear();
+	_gcPendingFreesPos = 0;
+	_visibilityGraphs.clear();
 
 #ifdef ENABLE_SCI32
 	_eventCounter = 0;
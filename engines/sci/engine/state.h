@@ -25,6 +25,7 @@
 
 #include "common/scummsys.h"
 #include "common/array.h"
+#include "common/list.h"
 #include "common/serializer.h"
 #include "common/str-array.h"
 
@@ -98,6 +99,35 @@ struct SciCallOrigin {
 	}
 };
 
+/** Statistics of the garbage collector, see run_gc() */
+struct GCStatistics {
+	uint cycles;           /**< Number of collections so far */
+	uint32 lastPauseTime;  /**< Duration of the last collection in ms, excluding its incremental sweep */
+	uint32 maxPauseTime;   /**< Longest duration of a collection in ms */
+	uint32 totalPauseTime; /**< Total duration of all collections in ms */
+	uint lastReachable;    /**< Number of addresses found reachable by the last collection */
+	uint lastGarbage;      /**< Number of objects found unreachable by the last collection */
+	uint totalFreed;       /**< Total number of objects freed */
+
+	GCStatistics() : cycles(0), lastPauseTime(0), maxPauseTime(0), totalPauseTime(0),
+		lastReachable(0), lastGarbage(0), totalFreed(0) {}
+};
+
+/**
+ * Visibility between the vertices of a pathfinding polygon set, shared by
+ * kAvoidPath calls on the same obstacles. See kpathing.cpp.
+ */
+struct VisibilityGraph {
+	uint32 hash;                     /**< Hash of the geometry */
+	Common::Array<int16> geometry;   /**< Position and neighbour indices of each vertex */
+	Common::Array<Common::Array<uint16> > visible; /**< Ascending indices of the vertices visible from each vertex */
+	Common::Array<bool> computed;    /**< Whether the visible vertices of each vertex are known */
+};
+
+enum {
+	kMaxVisibilityGraphs = 4 /**< Number of visibility graphs kept by kAvoidPath */
+};
+
 struct EngineState : public Common::Serializable {
 public:
 	EngineState(SegManager *segMan);
@@ -189,6 +219,11 @@ public:
 	void shrinkStackToBase();
 
 	int gcCountDown; /**< Number of kernel calls until next gc */
+	Common::Array<reg_t> _gcPendingFrees; /**< Unreachable objects not yet freed by an incremental gc */
+	uint _gcPendingFreesPos; /**< Index of the next object in _gcPendingFrees to free */
+	GCStatistics _gcStats;
+
+	Common::List<VisibilityGraph> _visibilityGraphs; /**< Recently used pathfinding visibility graphs, most recent first */
 
 	MessageState *_msgState;
 
@@ -194,6 +194,11 @@ static void write_var(EngineState *s, int type, int index, reg_t value) {
 		if (type == VAR_TEMP && value.getSegment() == kUninitializedSegment)
 			value.setSegment(0);
 
+		// Start prefetching the resources of the next room while the
+		// current one is being disposed of
+		if (index == kGlobalVarNewRoomNo && type == VAR_GLOBAL && value != s->variables[type][index])
+			g_sci->getResMan()->prefetchRoom(value.toUint16());
+
 		s->variables[type][index] = value;
 
 		g_sci->_guestAdditions->writeVarHook(type, index, value);
@@ -650,9 +655,17 @@ void run_vm(EngineState *s) {
 			error("run_vm(): program counter gone astray, addr: %d, code buffer size: %d",
 			s->xs->addr.pc.getOffset(), scr->getBufSize());
 
-		// Get opcode
-		byte extOpcode;
-		s->xs->addr.pc.incOffset(readPMachineInstruction(scr->getBuf(s->xs->addr.pc.getOffset()), extOpcode, opparams));
+		if (g_sci->_debugState._vmTraceRemaining) {
+			g_sci->_debugState._vmTrace.push_back(s->xs->addr.pc);
+			--g_sci->_debugState._vmTraceRemaining;
+		}
+
+		// Get opcode. The instruction is copied, since nested calls of
+		// run_vm() may decode further instructions of the same script.
+		const PMachineInstruction &instruction = scr->getInstruction(s->xs->addr.pc.getOffset());
+		const byte extOpcode = instruction.extOpcode;
+		memcpy(opparams, instruction.opparams, sizeof(opparams));
+		s->xs->addr.pc.incOffset(instruction.size);
 		const byte opcode = extOpcode >> 1;
 		//debug("%s: %d, %d, %d, %d, acc = %04x:%04x, script %d, local script %d", opcodeNames[opcode], opparams[0], opparams[1], opparams[2], opparams[3], PRINT_REG(s->r_acc), scr->getScriptNumber(), local_script->getScriptNumber());
 
@@ -878,7 +891,9 @@ void run_vm(EngineState *s) {
 			// Run the garbage collector, if needed
 			if (s->gcCountDown-- <= 0) {
 				s->gcCountDown = s->scriptGCInterval;
-				run_gc(s);
+				run_gc(s, true);
+			} else if (s->_gcPendingFreesPos < s->_gcPendingFrees.size()) {
+				run_gc_sweep(s, GC_SWEEP_STEP);
 			}
 
 			// Call kernel function
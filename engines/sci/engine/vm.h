@@ -184,6 +184,11 @@ enum {
 	GC_INTERVAL = 0x8000
 };
 
+/** Number of objects freed per kernel call after an incremental gc */
+enum {
+	GC_SWEEP_STEP = 16
+};
+
 enum SciOpcodes {
 	op_bnot     = 0x00,	// 000
 	op_add      = 0x01,	// 001
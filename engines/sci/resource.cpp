@@ -22,9 +22,12 @@
 
 // Resource library
 
+#include "common/algorithm.h"
+#include "common/config-manager.h"
 #include "common/file.h"
 #include "common/fs.h"
 #include "common/macresman.h"
+#include "common/system.h"
 #include "common/textconsole.h"
 #include "common/translation.h"
 #ifdef ENABLE_SCI32
@@ -208,6 +211,10 @@ Resource::Resource(ResourceManager *resMan, ResourceId id) : SciSpan<const byte>
 	_source = nullptr;
 	_header = nullptr;
 	_headerSize = 0;
+	_prefetched = false;
+	_lruPrev = nullptr;
+	_lruNext = nullptr;
+	_lruTime = 0;
 }
 
 Resource::~Resource() {
@@ -963,10 +970,20 @@ ResourceManager::ResourceManager(const bool detectionMode) :
 	_detectionMode(detectionMode) {}
 
 void ResourceManager::init() {
-	_maxMemoryLRU = 256 * 1024; // 256KiB
 	_memoryLocked = 0;
 	_memoryLRU = 0;
-	_LRU.clear();
+	_lruTime = 0;
+	for (int i = 0; i < kResCachePoolCount; i++) {
+		_cachePools[i]._mostRecent = nullptr;
+		_cachePools[i]._leastRecent = nullptr;
+		_cachePools[i]._memory = 0;
+	}
+	setMaxCacheMemory(256 * 1024); // 256KiB
+	resetCacheStats();
+	_roomResources.clear();
+	_prefetchRoom = -1;
+	_prefetchQueue.clear();
+	_prefetchMemory = 0;
 	_resMap.clear();
 	_audioMapSCI1 = NULL;
 #ifdef ENABLE_SCI32
@@ -1018,7 +1035,12 @@ void ResourceManager::init() {
 	// cache, leading to constant decompression of picture resources
 	// and making the renderer very slow.
 	if (getSciVersion() >= SCI_VERSION_2) {
-		_maxMemoryLRU = 4096 * 1024; // 4MiB
+		setMaxCacheMemory(4096 * 1024); // 4MiB
+	}
+
+	// Allow the cache size to be tuned for devices with little memory
+	if (!_detectionMode && ConfMan.hasKey("sci_resource_cache_size")) {
+		setMaxCacheMemory(ConfMan.getInt("sci_resource_cache_size") * 1024);
 	}
 
 	switch (_viewType) {
@@ -1062,12 +1084,165 @@ ResourceManager::~ResourceManager() {
 	}
 }
 
+ResourceCachePool ResourceManager::getCachePoolForType(ResourceType type) {
+	switch (type) {
+	case kResourceTypeView:
+	case kResourceTypePic:
+	case kResourceTypeFont:
+	case kResourceTypeCursor:
+	case kResourceTypePalette:
+	case kResourceTypeBitmap:
+	case kResourceTypeClut:
+	case kResourceTypeTGA:
+	case kResourceTypeMacIconBarPictN:
+	case kResourceTypeMacIconBarPictS:
+	case kResourceTypeMacPict:
+		return kResCachePoolGraphics;
+	case kResourceTypeAudio:
+	case kResourceTypeAudio36:
+	case kResourceTypeSync:
+	case kResourceTypeSync36:
+	case kResourceTypeCdAudio:
+	case kResourceTypeRave:
+		return kResCachePoolAudio;
+	default:
+		return kResCachePoolOther;
+	}
+}
+
+void ResourceManager::setMaxCacheMemory(int maxMemory) {
+	_maxMemoryLRU = MAX(maxMemory, 0);
+
+	// Graphics and other resources only share the global limit, while audio,
+	// which is rarely reused, may only take up a quarter of the cache
+	_cachePools[kResCachePoolGraphics]._budget = _maxMemoryLRU;
+	_cachePools[kResCachePoolAudio]._budget = _maxMemoryLRU / 4;
+	_cachePools[kResCachePoolOther]._budget = _maxMemoryLRU;
+
+	freeOldResources();
+}
+
+void ResourceManager::resetCacheStats() {
+	for (int i = 0; i < kResCachePoolCount; i++) {
+		_cachePools[i]._hits = 0;
+		_cachePools[i]._misses = 0;
+		_cachePools[i]._evictions = 0;
+	}
+	_prefetchCount = 0;
+	_prefetchHits = 0;
+}
+
+void ResourceManager::prefetchRoom(uint16 roomNumber) {
+	static const ResourceType roomTypes[] = {
+		kResourceTypePic, kResourceTypePalette, kResourceTypeScript, kResourceTypeHeap, kResourceTypeMessage
+	};
+
+	_prefetchRoom = roomNumber;
+	_prefetchQueue.clear();
+	_prefetchMemory = 0;
+
+	for (int i = 0; i < ARRAYSIZE(roomTypes); i++)
+		_prefetchQueue.push_back(ResourceId(roomTypes[i], roomNumber));
+
+	RoomResourceMap::const_iterator it = _roomResources.find(roomNumber);
+	if (it != _roomResources.end()) {
+		for (uint i = 0; i < it->_value.size(); i++)
+			_prefetchQueue.push_back(it->_value[i]);
+	}
+
+	debugC(kDebugLevelResMan, "resMan: Queued %d resources of room %d for prefetching", _prefetchQueue.size(), roomNumber);
+}
+
+bool ResourceManager::prefetchResources(uint32 deadline) {
+	bool loaded = false;
+
+	while (!_prefetchQueue.empty() && g_system->getMillis() < deadline) {
+		// Don't let the prefetched resources push each other out of the cache
+		if (_prefetchMemory >= _maxMemoryLRU / 2) {
+			_prefetchQueue.clear();
+			break;
+		}
+
+		Resource *res = testResource(_prefetchQueue.front());
+		_prefetchQueue.pop_front();
+
+		if (!res || res->_status != kResStatusNoMalloc)
+			continue;
+
+		loadResource(res);
+		if (res->_status != kResStatusAllocated)
+			continue;
+
+		res->_prefetched = true;
+		_prefetchCount++;
+		_prefetchMemory += res->size();
+		loaded = true;
+		addToLRU(res);
+		freeOldResources();
+	}
+
+	return loaded;
+}
+
+uint ResourceManager::verifyCache() const {
+	uint errors = 0;
+	int memory[kResCachePoolCount] = { 0, 0, 0 };
+
+	for (ResourceMap::const_iterator it = _resMap.begin(); it != _resMap.end(); ++it) {
+		const Resource *res = it->_value;
+		if (res->_status == kResStatusNoMalloc && res->data()) {
+			warning("resMan: %s is not loaded, but still holds %u bytes", res->_id.toString().c_str(), res->size());
+			errors++;
+		} else if (res->_status == kResStatusEnqueued) {
+			memory[getCachePoolForType(res->getType())] += res->size();
+		}
+	}
+
+	int total = 0;
+	for (int i = 0; i < kResCachePoolCount; i++) {
+		const CachePool &pool = _cachePools[i];
+		int listed = 0;
+		for (const Resource *res = pool._mostRecent; res; res = res->_lruNext) {
+			if (res->_status != kResStatusEnqueued || getCachePoolForType(res->getType()) != i) {
+				warning("resMan: %s is in the wrong LRU list", res->_id.toString().c_str());
+				errors++;
+			}
+			listed += res->size();
+		}
+
+		if (listed != pool._memory || memory[i] != pool._memory) {
+			warning("resMan: Cache pool %d accounts for %d bytes, but lists %d and holds %d", i, pool._memory, listed, memory[i]);
+			errors++;
+		}
+		total += pool._memory;
+	}
+
+	if (total != _memoryLRU) {
+		warning("resMan: Cache pools hold %d bytes, but the cache accounts for %d", total, _memoryLRU);
+		errors++;
+	}
+
+	return errors;
+}
+
 void ResourceManager::removeFromLRU(Resource *res) {
 	if (res->_status != kResStatusEnqueued) {
 		warning("resMan: trying to remove resource that isn't enqueued");
 		return;
 	}
-	_LRU.remove(res);
+
+	CachePool &pool = _cachePools[getCachePoolForType(res->getType())];
+	if (res->_lruPrev)
+		res->_lruPrev->_lruNext = res->_lruNext;
+	else
+		pool._mostRecent = res->_lruNext;
+	if (res->_lruNext)
+		res->_lruNext->_lruPrev = res->_lruPrev;
+	else
+		pool._leastRecent = res->_lruPrev;
+	res->_lruPrev = res->_lruNext = nullptr;
+
+	pool._memory -= res->size();
 	_memoryLRU -= res->size();
 	res->_status = kResStatusAllocated;
 }
@@ -1077,7 +1252,18 @@ void ResourceManager::addToLRU(Resource *res) {
 		warning("resMan: trying to enqueue resource with state %d", res->_status);
 		return;
 	}
-	_LRU.push_front(res);
+
+	CachePool &pool = _cachePools[getCachePoolForType(res->getType())];
+	res->_lruPrev = nullptr;
+	res->_lruNext = pool._mostRecent;
+	if (pool._mostRecent)
+		pool._mostRecent->_lruPrev = res;
+	else
+		pool._leastRecent = res;
+	pool._mostRecent = res;
+	res->_lruTime = _lruTime++;
+
+	pool._memory += res->size();
 	_memoryLRU += res->size();
 #if SCI_VERBOSE_RESMAN
 	debug("Adding %s (%d bytes) to lru control: %d bytes total",
@@ -1090,29 +1276,47 @@ void ResourceManager::addToLRU(Resource *res) {
 void ResourceManager::printLRU() {
 	int mem = 0;
 	int entries = 0;
-	Common::List<Resource *>::iterator it = _LRU.begin();
-	Resource *res;
-
-	while (it != _LRU.end()) {
-		res = *it;
-		debug("\t%s: %u bytes", res->_id.toString().c_str(), res->size());
-		mem += res->size();
-		++entries;
-		++it;
+
+	for (int i = 0; i < kResCachePoolCount; i++) {
+		for (Resource *res = _cachePools[i]._mostRecent; res; res = res->_lruNext) {
+			debug("\t%s: %u bytes", res->_id.toString().c_str(), res->size());
+			mem += res->size();
+			++entries;
+		}
 	}
 
 	debug("Total: %d entries, %d bytes (mgr says %d)", entries, mem, _memoryLRU);
 }
 
-void ResourceManager::freeOldResources() {
-	while (_maxMemoryLRU < _memoryLRU) {
-		assert(!_LRU.empty());
-		Resource *goner = _LRU.back();
-		removeFromLRU(goner);
-		goner->unalloc();
+void ResourceManager::evictFromLRU(CachePool &pool) {
+	assert(pool._leastRecent);
+	Resource *goner = pool._leastRecent;
+	removeFromLRU(goner);
+	goner->unalloc();
+	goner->_prefetched = false;
+	pool._evictions++;
 #ifdef SCI_VERBOSE_RESMAN
-		debug("resMan-debug: LRU: Freeing %s (%d bytes)", goner->_id.toString().c_str(), goner->size);
+	debug("resMan-debug: LRU: Freeing %s (%d bytes)", goner->_id.toString().c_str(), goner->size);
 #endif
+}
+
+void ResourceManager::freeOldResources() {
+	for (int i = 0; i < kResCachePoolCount; i++) {
+		while (_cachePools[i]._budget < _cachePools[i]._memory)
+			evictFromLRU(_cachePools[i]);
+	}
+
+	// Evict the least recently used resource of all pools until the global
+	// limit is met
+	while (_maxMemoryLRU < _memoryLRU) {
+		CachePool *oldest = nullptr;
+		for (int i = 0; i < kResCachePoolCount; i++) {
+			Resource *res = _cachePools[i]._leastRecent;
+			if (res && (!oldest || res->_lruTime < oldest->_leastRecent->_lruTime))
+				oldest = &_cachePools[i];
+		}
+
+		evictFromLRU(*oldest);
 	}
 }
 
@@ -1135,9 +1339,29 @@ Resource *ResourceManager::findResource(ResourceId id, bool lock) {
 	if (!retval)
 		return NULL;
 
-	if (retval->_status == kResStatusNoMalloc)
+	const ResourceCachePool poolType = getCachePoolForType(retval->getType());
+	CachePool &pool = _cachePools[poolType];
+	if (retval->_status == kResStatusNoMalloc) {
+		pool._misses++;
 		loadResource(retval);
-	else if (retval->_status == kResStatusEnqueued)
+
+		// Remember the resource for the next visit of the current room.
+		// Audio is left out, as it is mostly played only once.
+		if (_prefetchRoom >= 0 && poolType != kResCachePoolAudio) {
+			Common::Array<ResourceId> &roomResources = _roomResources[_prefetchRoom];
+			if (roomResources.size() < kMaxPrefetchedResourcesPerRoom && Common::find(roomResources.begin(), roomResources.end(), id) == roomResources.end())
+				roomResources.push_back(id);
+		}
+	} else {
+		pool._hits++;
+	}
+
+	if (retval->_prefetched) {
+		retval->_prefetched = false;
+		_prefetchHits++;
+	}
+
+	if (retval->_status == kResStatusEnqueued)
 		// The resource is removed from its current position
 		// in the LRU list because it has been requested
 		// again. Below, it will either be locked, or it
@@ -2104,6 +2328,13 @@ Resource *ResourceManager::updateResource(ResourceId resId, ResourceSource *src,
 			_resMap.setVal(resId, res);
 		}
 
+		// The data of a cached resource is no longer accounted for once it
+		// leaves the LRU, so free it right away
+		if (res->_status == kResStatusEnqueued) {
+			removeFromLRU(res);
+			res->unalloc();
+		}
+
 		res->_status = kResStatusNoMalloc;
 		res->_source = src;
 		res->_headerSize = 0;
@@ -23,6 +23,7 @@
 #ifndef SCI_RESOURCE_H
 #define SCI_RESOURCE_H
 
+#include "common/array.h"
 #include "common/str.h"
 #include "common/list.h"
 #include "common/hashmap.h"
@@ -62,6 +63,17 @@ enum ResourceStatus {
 	kResStatusLocked /**< Allocated and in use */
 };
 
+/**
+ * Pools of the resource cache. Each pool has its own memory budget, so that
+ * e.g. large audio resources can't push all pics and views out of the cache.
+ */
+enum ResourceCachePool {
+	kResCachePoolGraphics = 0, /**< Views, pics, palettes, fonts and cursors */
+	kResCachePoolAudio,        /**< Digital audio and lip sync data */
+	kResCachePoolOther,        /**< All other resources, e.g. scripts and messages */
+	kResCachePoolCount
+};
+
 /** Resource error codes. Should be in sync with s_errorDescriptions */
 enum ResourceErrorCodes {
 	SCI_ERROR_NONE = 0,
@@ -76,7 +88,8 @@ enum ResourceErrorCodes {
 };
 
 enum {
-	MAX_OPENED_VOLUMES = 5 ///< Max number of simultaneously opened volumes
+	MAX_OPENED_VOLUMES = 5, ///< Max number of simultaneously opened volumes
+	kMaxPrefetchedResourcesPerRoom = 64 ///< Max number of resources remembered for prefetching per room
 };
 
 enum ResourceType {
@@ -299,6 +312,11 @@ protected:
 	ResourceSource *_source;
 	ResourceManager *_resMan;
 
+	bool _prefetched; /**< Loaded by the prefetcher and not requested since */
+	Resource *_lruPrev; /**< More recently used resource in the same cache pool */
+	Resource *_lruNext; /**< Less recently used resource in the same cache pool */
+	uint32 _lruTime; /**< Time at which the resource was enqueued, in enqueue operations */
+
 	bool loadPatch(Common::SeekableReadStream *file);
 	bool loadFromPatchFile();
 	bool loadFromWaveFile(Common::SeekableReadStream *file);
@@ -465,6 +483,59 @@ public:
 	 */
 	ResourceType convertResType(byte type);
 
+	/** State and statistics of a pool of the resource cache */
+	struct CachePool {
+		Resource *_mostRecent;  ///< Head of the LRU list of the pool
+		Resource *_leastRecent; ///< Tail of the LRU list of the pool
+		int _memory;            ///< Amount of resource bytes in the pool
+		int _budget;            ///< Maximum amount of resource bytes in the pool
+		uint _hits;             ///< Number of lookups of resources which were in memory
+		uint _misses;           ///< Number of lookups which had to load the resource
+		uint _evictions;        ///< Number of resources freed to stay within the budgets
+	};
+
+	const CachePool &getCachePool(ResourceCachePool pool) const { return _cachePools[pool]; }
+	int getCacheMemory() const { return _memoryLRU; }
+	int getMaxCacheMemory() const { return _maxMemoryLRU; }
+
+	/**
+	 * Sets the maximum amount of memory used by unlocked resources, and
+	 * derives the budgets of the cache pools from it.
+	 */
+	void setMaxCacheMemory(int maxMemory);
+
+	/** Resets the hit, miss and eviction counters of the cache pools. */
+	void resetCacheStats();
+
+	/**
+	 * Checks that the memory accounted for by the cache pools matches the
+	 * resources in their LRU lists, and that no resource which is not
+	 * loaded still holds data. Problems are reported as warnings.
+	 * @return the number of problems found
+	 */
+	uint verifyCache() const;
+
+	/**
+	 * Queues the resources of a room for prefetching. These are the resources
+	 * which had to be loaded during earlier visits of the room, and the pic,
+	 * palette, script and messages of the room itself.
+	 * @param roomNumber	The room the game is switching to
+	 */
+	void prefetchRoom(uint16 roomNumber);
+
+	/**
+	 * Loads queued resources into the cache until the given time. This is
+	 * meant to be called while the engine is idle. Resources which are
+	 * requested before they have been prefetched are simply loaded by
+	 * findResource() as usual.
+	 * @param deadline	Time in ms at which to stop loading resources
+	 * @return true if any resource was loaded
+	 */
+	bool prefetchResources(uint32 deadline);
+
+	uint getPrefetchCount() const { return _prefetchCount; }
+	uint getPrefetchHits() const { return _prefetchHits; }
+
 protected:
 	bool _detectionMode;
 
@@ -474,12 +545,22 @@ protected:
 	// issued whenever this limit is exceeded.
 	int _maxMemoryLRU;
 
+	CachePool _cachePools[kResCachePoolCount];
+	uint32 _lruTime; ///< Number of resources enqueued so far, used to compare ages across pools
+
+	typedef Common::HashMap<uint16, Common::Array<ResourceId> > RoomResourceMap;
+	RoomResourceMap _roomResources; ///< Resources loaded during earlier visits of each room
+	int _prefetchRoom; ///< Room whose loaded resources are recorded, or -1
+	Common::List<ResourceId> _prefetchQueue; ///< Resources still to be prefetched
+	int _prefetchMemory; ///< Amount of resource bytes prefetched for the current room
+	uint _prefetchCount; ///< Number of resources loaded by the prefetcher
+	uint _prefetchHits; ///< Number of prefetched resources which were requested later on
+
 	ViewType _viewType; // Used to determine if the game has EGA or VGA graphics
 	typedef Common::List<ResourceSource *> SourcesList;
 	SourcesList _sources;
 	int _memoryLocked;	///< Amount of resource bytes in locked memory
-	int _memoryLRU;		///< Amount of resource bytes under LRU control
-	Common::List<Resource *> _LRU; ///< Last Resource Used list
+	int _memoryLRU;		///< Amount of resource bytes under LRU control, in all pools
 	ResourceMap _resMap;
 	Common::List<Common::File *> _volumeFiles; ///< list of opened volume files
 	ResourceSource *_audioMapSCI1; ///< Currently loaded audio map for SCI1
@@ -614,6 +695,8 @@ protected:
 	void printLRU();
 	void addToLRU(Resource *res);
 	void removeFromLRU(Resource *res);
+	void evictFromLRU(CachePool &pool);
+	static ResourceCachePool getCachePoolForType(ResourceType type);
 
 	ResourceCompression getViewCompression();
 	ViewType detectViewType();
@@ -869,7 +869,9 @@ void SciEngine::sleep(uint32 msecs) {
 #endif
 		time = g_system->getMillis();
 		if (time + 10 < wakeUpTime) {
-			g_system->delayMillis(10);
+			// Use the idle time to prefetch resources, if there are any left
+			if (!_resMan->prefetchResources(time + 10))
+				g_system->delayMillis(10);
 		} else {
 			if (time < wakeUpTime)
 				g_system->delayMillis(wakeUpTime - time);
@@ -20,6 +20,7 @@
  *
  */
 
+#include "common/cpudetect.h"
 #include "common/debug-channels.h"
 #include "common/file.h"
 #include "common/str.h"
@@ -97,6 +98,8 @@ ScummDebugger::ScummDebugger(ScummEngine *s)
 	registerCmd("imuse",     WRAP_METHOD(ScummDebugger, Cmd_IMuse));
 
 	registerCmd("resetcursors",    WRAP_METHOD(ScummDebugger, Cmd_ResetCursors));
+
+	registerCmd("redraw",    WRAP_METHOD(ScummDebugger, Cmd_Redraw));
 }
 
 ScummDebugger::~ScummDebugger() {
@@ -842,4 +845,106 @@ bool ScummDebugger::Cmd_ResetCursors(int argc, const char **argv) {
 	return false;
 }
 
+void ScummDebugger::redrawScene() {
+	_vm->_fullRedraw = true;
+	_vm->redrawBGAreas();
+	_vm->updateDirtyScreen(kVerbVirtScreen);
+	_vm->updateDirtyScreen(kTextVirtScreen);
+	_vm->updateDirtyScreen(kMainVirtScreen);
+}
+
+void ScummDebugger::captureScene(Common::Array<byte> &pixels) {
+	pixels.clear();
+
+	// The FM-Towns versions compose into the layers of the Towns screen,
+	// all others into _compositeBuf, which is copied to the screen
+#ifndef DISABLE_TOWNS_DUAL_LAYER_MODE
+	if (_vm->_townsScreen) {
+		for (int layer = 0; layer < 2; layer++) {
+			const byte *src = _vm->_townsScreen->getLayerPixels(layer, 0, 0);
+			if (!src)
+				continue;
+			const uint size = _vm->_townsScreen->getLayerPitch(layer) * _vm->_townsScreen->getLayerHeight(layer);
+			for (uint i = 0; i < size; i++)
+				pixels.push_back(src[i]);
+		}
+		return;
+	}
+#endif
+
+	Graphics::Surface *screen = _vm->_system->lockScreen();
+	for (int y = 0; y < screen->h; y++) {
+		const byte *src = (const byte *)screen->getBasePtr(0, y);
+		for (int i = 0; i < screen->w * screen->format.bytesPerPixel; i++)
+			pixels.push_back(src[i]);
+	}
+	_vm->_system->unlockScreen();
+}
+
+bool ScummDebugger::Cmd_Redraw(int argc, const char **argv) {
+	if (argc == 2 && !strcmp(argv[1], "verify")) {
+		// Compose the scene once with the scalar code only, and once with
+		// the SIMD kernels the CPU supports
+		Common::Array<byte> scalar, simd;
+		Common::setCPUFeatureMask(0);
+		redrawScene();
+		captureScene(scalar);
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+		redrawScene();
+		captureScene(simd);
+
+		_vm->_fullRedraw = true;
+		_vm->_system->updateScreen();
+
+		uint mismatch = 0;
+		while (mismatch < scalar.size() && mismatch < simd.size() && scalar[mismatch] == simd[mismatch])
+			mismatch++;
+
+		if (scalar.size() != simd.size())
+			debugPrintf("The composed scene is %u bytes with the scalar code, but %u with SIMD\n", scalar.size(), simd.size());
+		else if (mismatch < scalar.size())
+			debugPrintf("The composed scene differs at byte %u: %02x with the scalar code, %02x with SIMD\n", mismatch, scalar[mismatch], simd[mismatch]);
+		else
+			debugPrintf("The SIMD kernels compose the same %u bytes as the scalar code\n", scalar.size());
+		return true;
+	}
+
+	int count = 100;
+	if (argc > 1)
+		count = atoi(argv[1]);
+
+	if (count <= 0 || argc > 2) {
+		debugPrintf("Usage: redraw [<count> | verify]\n");
+		debugPrintf("Redraws the whole scene <count> times and prints how long it took\n");
+		debugPrintf("With 'verify', checks that the SIMD kernels compose the scene like the scalar code\n");
+		return true;
+	}
+
+	uint32 redrawTime = 0;
+	uint32 composeTime = 0;
+
+	for (int i = 0; i < count; i++) {
+		const uint32 start = _vm->_system->getMillis();
+		_vm->_fullRedraw = true;
+		_vm->redrawBGAreas();
+
+		const uint32 redrawn = _vm->_system->getMillis();
+		_vm->updateDirtyScreen(kVerbVirtScreen);
+		_vm->updateDirtyScreen(kTextVirtScreen);
+		_vm->updateDirtyScreen(kMainVirtScreen);
+
+		redrawTime += redrawn - start;
+		composeTime += _vm->_system->getMillis() - redrawn;
+	}
+
+	// Only the background was drawn, let the next frame put the actors back
+	_vm->_fullRedraw = true;
+	_vm->_system->updateScreen();
+
+	debugPrintf("Redrew the scene %d times\n", count);
+	debugPrintf("  Background: %u ms total, %u us per frame\n", redrawTime, redrawTime * 1000 / (uint32)count);
+	debugPrintf("  Compose and blit: %u ms total, %u us per frame\n", composeTime, composeTime * 1000 / (uint32)count);
+	return true;
+}
+
 } // End of namespace Scumm
@@ -69,8 +69,15 @@ private:
 
 	bool Cmd_ResetCursors(int argc, const char **argv);
 
+	bool Cmd_Redraw(int argc, const char **argv);
+
 	void printBox(int box);
 	void drawBox(int box);
+
+	/** Redraws the background of the scene and composes it with the text. */
+	void redrawScene();
+	/** Copies the pixels composed by the last redraw. */
+	void captureScene(Common::Array<byte> &pixels);
 };
 
 } // End of namespace Scumm
@@ -20,9 +20,11 @@
  *
  */
 
+#include "common/cpudetect.h"
 #include "common/system.h"
 #include "scumm/actor.h"
 #include "scumm/charset.h"
+#include "scumm/gfx_simd.h"
 #ifdef ENABLE_HE
 #include "scumm/he/intern_he.h"
 #endif
@@ -574,29 +576,64 @@ void ScummEngine::updateDirtyScreen(VirtScreenNumber slot) {
 	if (vs->h == 0)
 		return;
 
-	int i;
-	int w = 8;
-	int start = 0;
-
-	for (i = 0; i < _gdi->_numStrips; i++) {
-		if (vs->bdirty[i]) {
-			const int top = vs->tdirty[i];
-			const int bottom = vs->bdirty[i];
-			vs->tdirty[i] = vs->h;
-			vs->bdirty[i] = 0;
-			if (i != (_gdi->_numStrips - 1) && vs->bdirty[i + 1] == bottom && vs->tdirty[i + 1] == top) {
-				// Simple optimizations: if two or more neighboring strips
-				// form one bigger rectangle, coalesce them.
-				w += 8;
-				continue;
+	int i = 0;
+
+	while (i < _gdi->_numStrips) {
+		if (!vs->bdirty[i]) {
+			i++;
+			continue;
+		}
+
+		// Batch neighboring dirty strips into one rectangle, so that they
+		// are composed and blitted in a single pass. A strip is only added
+		// while the rectangle stays at most twice as large as the dirty
+		// area it covers; the clean parts are simply drawn again.
+		int top = vs->tdirty[i];
+		int bottom = vs->bdirty[i];
+		int dirtyHeight = MAX(bottom - top, 0);
+		int end = i + 1;
+
+		while (end < _gdi->_numStrips && vs->bdirty[end]) {
+			const int stripTop = vs->tdirty[end];
+			const int stripBottom = vs->bdirty[end];
+			if (stripBottom > stripTop) {
+				const int newTop = MIN(top, stripTop);
+				const int newBottom = MAX(bottom, stripBottom);
+				if ((end + 1 - i) * (newBottom - newTop) > 2 * (dirtyHeight + stripBottom - stripTop))
+					break;
+				top = newTop;
+				bottom = newBottom;
+				dirtyHeight += stripBottom - stripTop;
 			}
-			drawStripToScreen(vs, start * 8, w, top, bottom);
-			w = 8;
+			end++;
 		}
-		start = i + 1;
+
+		for (int j = i; j < end; j++) {
+			vs->tdirty[j] = vs->h;
+			vs->bdirty[j] = 0;
+		}
+
+		drawStripToScreen(vs, i * 8, (end - i) * 8, top, bottom);
+		i = end;
 	}
 }
 
+const StripComposeProcs *getStripComposeProcs() {
+#ifdef SCUMMVM_AVX2
+	if (Common::hasCPUFeature(Common::kCPUFeatureAVX2))
+		return &g_stripComposeProcsAVX2;
+#endif
+#ifdef SCUMMVM_SSE2
+	if (Common::hasCPUFeature(Common::kCPUFeatureSSE2))
+		return &g_stripComposeProcsSSE2;
+#endif
+#ifdef SCUMMVM_NEON
+	if (Common::hasCPUFeature(Common::kCPUFeatureNEON))
+		return &g_stripComposeProcsNEON;
+#endif
+	return 0;
+}
+
 /**
  * Blit the specified rectangle from the given virtual screen to the display.
  * Note: t and b are in *virtual screen* coordinates, while x is relative to
@@ -665,8 +702,21 @@ void ScummEngine::drawStripToScreen(VirtScreen *vs, int x, int width, int top, i
 			const byte *textPtr = (byte *)_textSurface.getBasePtr(x * m, y * m);
 			byte *dstPtr = _compositeBuf;
 
+			// HE games can't draw text with the old charset, let the scalar
+			// code below stop on it
+			const StripComposeProcs *procs = (vs->format.bytesPerPixel == 2) ? getStripComposeProcs() : 0;
+			const uint16 *palette = (_game.heversion != 0) ? 0 : _16BitPalette;
+
 			for (int h = 0; h < height * m; ++h) {
-				for (int w = 0; w < width * m; ++w) {
+				int w = 0;
+				if (procs) {
+					w = procs->composeRow16((uint16 *)dstPtr, (const uint16 *)srcPtr, textPtr, width * m, palette);
+					dstPtr += w * 2;
+					srcPtr += w * 2;
+					textPtr += w;
+				}
+
+				for (; w < width * m; ++w) {
 					uint16 tmp = *textPtr++;
 					if (tmp == CHARSET_MASK_TRANSPARENCY) {
 						tmp = READ_UINT16(srcPtr);
@@ -693,8 +743,20 @@ void ScummEngine::drawStripToScreen(VirtScreen *vs, int x, int width, int top, i
 
 			const uint32 *text32 = (const uint32 *)text;
 			const int textPitch = (_textSurface.pitch - width * m) >> 2;
+			const StripComposeProcs *procs = getStripComposeProcs();
 			for (int h = height * m; h > 0; --h) {
-				for (int w = width * m; w > 0; w -= 4) {
+				int w = width * m;
+				if (procs) {
+					// Let the SIMD kernel compose as much of the row as it can,
+					// it always leaves a multiple of four pixels
+					const int done = procs->composeRow8((byte *)dst32, (const byte *)src32, (const byte *)text32, w);
+					dst32 += done >> 2;
+					src32 += done >> 2;
+					text32 += done >> 2;
+					w -= done;
+				}
+
+				for (; w > 0; w -= 4) {
 					uint32 temp = *text32++;
 
 					// Generate a byte mask for those text pixels (bytes) with
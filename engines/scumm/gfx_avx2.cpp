@@ -0,0 +1,84 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+#include "scumm/scumm.h"
+#include "scumm/gfx_simd.h"
+
+#include <immintrin.h>
+
+namespace Scumm {
+
+static int composeRow8AVX2(byte *dst, const byte *src, const byte *text, int width) {
+	const __m256i transparency = _mm256_set1_epi8((char)CHARSET_MASK_TRANSPARENCY);
+
+	int x = 0;
+	for (; x + 32 <= width; x += 32) {
+		const __m256i t = _mm256_loadu_si256((const __m256i *)(text + x));
+		const __m256i s = _mm256_loadu_si256((const __m256i *)(src + x));
+		_mm256_storeu_si256((__m256i *)(dst + x), _mm256_blendv_epi8(t, s, _mm256_cmpeq_epi8(t, transparency)));
+	}
+	return x;
+}
+
+static int composeRow16AVX2(uint16 *dst, const uint16 *src, const byte *text, int width, const uint16 *palette) {
+	const __m128i transparency = _mm_set1_epi8((char)CHARSET_MASK_TRANSPARENCY);
+
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(text + x)), transparency));
+		if (mask != 0xFFFF && !palette)
+			break;
+
+		_mm256_storeu_si256((__m256i *)(dst + x), _mm256_loadu_si256((const __m256i *)(src + x)));
+		if (mask != 0xFFFF) {
+			for (int i = 0; i < 16; ++i) {
+				if (!(mask & (1 << i)))
+					dst[x + i] = palette[text[x + i]];
+			}
+		}
+	}
+	return x;
+}
+
+static int mergeTownsRowAVX2(byte *dst, const byte *layer, const byte *text, int width) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i lowNibble = _mm256_set1_epi8(0x0F);
+	const __m256i highNibble = _mm256_set1_epi8((char)0xF0);
+
+	int x = 0;
+	for (; x + 32 <= width; x += 32) {
+		const __m256i t = _mm256_loadu_si256((const __m256i *)(text + x));
+		const __m256i l = _mm256_loadu_si256((const __m256i *)(layer + x));
+		const __m256i keep = _mm256_or_si256(
+			_mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(t, lowNibble), zero), lowNibble),
+			_mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(t, highNibble), zero), highNibble));
+		_mm256_storeu_si256((__m256i *)(dst + x), _mm256_or_si256(t, _mm256_and_si256(l, keep)));
+	}
+	return x;
+}
+
+const StripComposeProcs g_stripComposeProcsAVX2 = {
+	composeRow8AVX2,
+	composeRow16AVX2,
+	mergeTownsRowAVX2
+};
+
+} // End of namespace Scumm
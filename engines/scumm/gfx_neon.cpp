@@ -0,0 +1,84 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+#include "scumm/scumm.h"
+#include "scumm/gfx_simd.h"
+
+#include <arm_neon.h>
+
+namespace Scumm {
+
+static int composeRow8NEON(byte *dst, const byte *src, const byte *text, int width) {
+	const uint8x16_t transparency = vdupq_n_u8(CHARSET_MASK_TRANSPARENCY);
+
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		const uint8x16_t t = vld1q_u8(text + x);
+		const uint8x16_t s = vld1q_u8(src + x);
+		vst1q_u8(dst + x, vbslq_u8(vceqq_u8(t, transparency), s, t));
+	}
+	return x;
+}
+
+static int composeRow16NEON(uint16 *dst, const uint16 *src, const byte *text, int width, const uint16 *palette) {
+	const uint8x8_t transparency = vdup_n_u8(CHARSET_MASK_TRANSPARENCY);
+
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		const uint64 mask = vget_lane_u64(vreinterpret_u64_u8(vceq_u8(vld1_u8(text + x), transparency)), 0);
+		if (mask != ~(uint64)0 && !palette)
+			break;
+
+		vst1q_u16(dst + x, vld1q_u16(src + x));
+		if (mask != ~(uint64)0) {
+			for (int i = 0; i < 8; ++i) {
+				if (text[x + i] != CHARSET_MASK_TRANSPARENCY)
+					dst[x + i] = palette[text[x + i]];
+			}
+		}
+	}
+	return x;
+}
+
+static int mergeTownsRowNEON(byte *dst, const byte *layer, const byte *text, int width) {
+	const uint8x16_t lowNibble = vdupq_n_u8(0x0F);
+	const uint8x16_t highNibble = vdupq_n_u8(0xF0);
+
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		const uint8x16_t t = vld1q_u8(text + x);
+		const uint8x16_t l = vld1q_u8(layer + x);
+		// vtstq sets the lanes where the nibble is not zero
+		const uint8x16_t keep = vorrq_u8(
+			vbicq_u8(lowNibble, vtstq_u8(t, lowNibble)),
+			vbicq_u8(highNibble, vtstq_u8(t, highNibble)));
+		vst1q_u8(dst + x, vorrq_u8(t, vandq_u8(l, keep)));
+	}
+	return x;
+}
+
+const StripComposeProcs g_stripComposeProcsNEON = {
+	composeRow8NEON,
+	composeRow16NEON,
+	mergeTownsRowNEON
+};
+
+} // End of namespace Scumm
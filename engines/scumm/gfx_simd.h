@@ -0,0 +1,97 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef SCUMM_GFX_SIMD_H
+#define SCUMM_GFX_SIMD_H
+
+#include "common/scummsys.h"
+
+namespace Scumm {
+
+/**
+ * Composes the start of one row of 8 bit text surface pixels over the game
+ * graphics: text pixels equal to CHARSET_MASK_TRANSPARENCY let the game
+ * pixel through, all others replace it.
+ *
+ * @param dst   a pointer to the first output pixel
+ * @param src   a pointer to the first game pixel
+ * @param text  a pointer to the first text pixel
+ * @param width number of pixels in the row
+ * @return the number of pixels composed. Kernels only compose whole blocks
+ *         of pixels, the rest is left to the scalar code.
+ */
+typedef int (*ComposeRow8Proc)(byte *dst, const byte *src, const byte *text, int width);
+
+/**
+ * Composes the start of one row of 8 bit text surface pixels over 16 bit
+ * game graphics. Non transparent text pixels are looked up in the palette.
+ *
+ * @param palette the 16 bit palette for text pixels, or 0 if the row may
+ *                only contain transparent text pixels. The kernel stops at
+ *                the first block holding any other pixel then.
+ * @return the number of pixels composed
+ */
+typedef int (*ComposeRow16Proc)(uint16 *dst, const uint16 *src, const byte *text, int width, const uint16 *palette);
+
+/**
+ * Merges the start of one row of FM-Towns text pixels into the text layer:
+ * every nibble of a text pixel which is zero keeps the nibble of the layer
+ * pixel, like ScummEngine::_townsLayer2Mask does.
+ *
+ * @param dst   a pointer to the first output pixel
+ * @param layer a pointer to the first layer pixel, may be equal to dst
+ * @param text  a pointer to the first text pixel
+ * @param width number of pixels in the row
+ * @return the number of pixels merged
+ */
+typedef int (*MergeTownsRowProc)(byte *dst, const byte *layer, const byte *text, int width);
+
+/**
+ * The set of strip compositing kernels for one instruction set.
+ */
+struct StripComposeProcs {
+	ComposeRow8Proc composeRow8;
+	ComposeRow16Proc composeRow16;
+	MergeTownsRowProc mergeTownsRow;
+};
+
+#ifdef SCUMMVM_SSE2
+extern const StripComposeProcs g_stripComposeProcsSSE2;
+#endif
+
+#ifdef SCUMMVM_AVX2
+extern const StripComposeProcs g_stripComposeProcsAVX2;
+#endif
+
+#ifdef SCUMMVM_NEON
+extern const StripComposeProcs g_stripComposeProcsNEON;
+#endif
+
+/**
+ * Return the fastest set of kernels supported by the CPU we run on,
+ * or 0 if only the scalar code can be used.
+ */
+const StripComposeProcs *getStripComposeProcs();
+
+} // End of namespace Scumm
+
+#endif
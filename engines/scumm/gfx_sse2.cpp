@@ -0,0 +1,89 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+#include "scumm/scumm.h"
+#include "scumm/gfx_simd.h"
+
+#include <emmintrin.h>
+
+namespace Scumm {
+
+/**
+ * Compute the byte mask of the text pixels which let the game graphics
+ * through.
+ */
+static inline __m128i transparentMask(__m128i text) {
+	return _mm_cmpeq_epi8(text, _mm_set1_epi8((char)CHARSET_MASK_TRANSPARENCY));
+}
+
+static int composeRow8SSE2(byte *dst, const byte *src, const byte *text, int width) {
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		const __m128i t = _mm_loadu_si128((const __m128i *)(text + x));
+		const __m128i s = _mm_loadu_si128((const __m128i *)(src + x));
+		const __m128i mask = transparentMask(t);
+		_mm_storeu_si128((__m128i *)(dst + x), _mm_or_si128(_mm_and_si128(mask, s), _mm_andnot_si128(mask, t)));
+	}
+	return x;
+}
+
+static int composeRow16SSE2(uint16 *dst, const uint16 *src, const byte *text, int width, const uint16 *palette) {
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		const int mask = _mm_movemask_epi8(transparentMask(_mm_loadl_epi64((const __m128i *)(text + x)))) & 0xFF;
+		if (mask != 0xFF && !palette)
+			break;
+
+		_mm_storeu_si128((__m128i *)(dst + x), _mm_loadu_si128((const __m128i *)(src + x)));
+		if (mask != 0xFF) {
+			for (int i = 0; i < 8; ++i) {
+				if (!(mask & (1 << i)))
+					dst[x + i] = palette[text[x + i]];
+			}
+		}
+	}
+	return x;
+}
+
+static int mergeTownsRowSSE2(byte *dst, const byte *layer, const byte *text, int width) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i lowNibble = _mm_set1_epi8(0x0F);
+	const __m128i highNibble = _mm_set1_epi8((char)0xF0);
+
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		const __m128i t = _mm_loadu_si128((const __m128i *)(text + x));
+		const __m128i l = _mm_loadu_si128((const __m128i *)(layer + x));
+		const __m128i keep = _mm_or_si128(
+			_mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(t, lowNibble), zero), lowNibble),
+			_mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(t, highNibble), zero), highNibble));
+		_mm_storeu_si128((__m128i *)(dst + x), _mm_or_si128(t, _mm_and_si128(l, keep)));
+	}
+	return x;
+}
+
+const StripComposeProcs g_stripComposeProcsSSE2 = {
+	composeRow8SSE2,
+	composeRow16SSE2,
+	mergeTownsRowSSE2
+};
+
+} // End of namespace Scumm
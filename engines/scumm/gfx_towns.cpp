@@ -24,6 +24,7 @@
 
 #include "scumm/scumm.h"
 #include "scumm/charset.h"
+#include "scumm/gfx_simd.h"
 #include "scumm/util.h"
 #include "scumm/resource.h"
 
@@ -72,6 +73,7 @@ void ScummEngine::towns_drawStripToScreen(VirtScreen *vs, int dstX, int dstY, in
 			}
 		}
 	} else {
+		const StripComposeProcs *procs = getStripComposeProcs();
 		dst1 = dst2;
 		for (int h = 0; h < height; ++h) {
 			for (int w = 0; w < width; ++w) {
@@ -88,7 +90,20 @@ void ScummEngine::towns_drawStripToScreen(VirtScreen *vs, int dstX, int dstY, in
 				src3 += _townsScreen->getLayerPitch(1);
 			}
 
-			for (int w = 0; w < width * m; ++w) {
+			int w = 0;
+			if (procs) {
+				// The second text row is merged first, since it is based on
+				// the layer row before the first text row is merged into it.
+				// With m == 1 both merge the same row, which does no harm.
+				w = procs->mergeTownsRow(dst2, dst1, src3, width * m);
+				procs->mergeTownsRow(dst1, dst1, src2, w);
+				dst2 += w;
+				src2 += w;
+				src3 += w;
+				dst1 += w;
+			}
+
+			for (; w < width * m; ++w) {
 				*dst2++ = (*src3 | (*dst1 & _townsLayer2Mask[*src3]));
 				*dst1 = (*src2 | (*dst1 & _townsLayer2Mask[*src2]));
 				src2++;
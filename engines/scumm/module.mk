@@ -75,6 +75,24 @@ MODULE_OBJS := \
 	vars.o \
 	verbs.o
 
+ifdef SCUMMVM_SSE2
+MODULE_OBJS += \
+	gfx_sse2.o
+$(MODULE)/gfx_sse2.o: CXXFLAGS += $(SSE2_CXXFLAGS)
+endif
+
+ifdef SCUMMVM_AVX2
+MODULE_OBJS += \
+	gfx_avx2.o
+$(MODULE)/gfx_avx2.o: CXXFLAGS += $(AVX2_CXXFLAGS)
+endif
+
+ifdef SCUMMVM_NEON
+MODULE_OBJS += \
+	gfx_neon.o
+$(MODULE)/gfx_neon.o: CXXFLAGS += $(NEON_CXXFLAGS)
+endif
+
 ifdef USE_ARM_COSTUME_ASM
 MODULE_OBJS += \
 	proc3ARM.o
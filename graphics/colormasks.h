@@ -40,6 +40,9 @@ The meaning of these is masks is the following:
  kBytesPerPixel
     -> how many bytes per pixel for that format
 
+ PixelType
+    -> the unsigned integer type holding one pixel of that format
+
  kRedMask, kGreenMask, kBlueMask
     -> bitmask, and this with the color to select only the bits of the corresponding color
 
@@ -66,6 +69,8 @@ The meaning of these is masks is the following:
 
 template<>
 struct ColorMasks<565> {
+	typedef uint16 PixelType;
+
 	enum {
 		kHighBitsMask    = 0xF7DEF7DE,
 		kLowBitsMask     = 0x08210821,
@@ -100,6 +105,8 @@ struct ColorMasks<565> {
 
 template<>
 struct ColorMasks<555> {
+	typedef uint16 PixelType;
+
 	enum {
 		kHighBitsMask    = 0x7BDE7BDE,
 		kLowBitsMask     = 0x04210421,
@@ -142,6 +149,8 @@ struct ColorMasks<555> {
 
 template<>
 struct ColorMasks<1555> {
+	typedef uint16 PixelType;
+
 	enum {
 		kBytesPerPixel = 2,
 
@@ -166,6 +175,8 @@ struct ColorMasks<1555> {
 
 template<>
 struct ColorMasks<5551> {
+	typedef uint16 PixelType;
+
 	enum {
 		kBytesPerPixel = 2,
 
@@ -190,6 +201,8 @@ struct ColorMasks<5551> {
 
 template<>
 struct ColorMasks<4444> {
+	typedef uint16 PixelType;
+
 	enum {
 		kBytesPerPixel = 2,
 
@@ -221,6 +234,8 @@ struct ColorMasks<4444> {
 
 template<>
 struct ColorMasks<888> {
+	typedef uint32 PixelType;
+
 	enum {
 		kBytesPerPixel = 4,
 
@@ -245,6 +260,8 @@ struct ColorMasks<888> {
 
 template<>
 struct ColorMasks<8888> {
+	typedef uint32 PixelType;
+
 	enum {
 		kBytesPerPixel = 4,
 
@@ -271,6 +288,8 @@ struct ColorMasks<8888> {
 /* Gamecube/Wii specific ColorMask ARGB3444 */
 template<>
 struct ColorMasks<3444> {
+	typedef uint16 PixelType;
+
 	enum {
 		kBytesPerPixel = 2,
 
@@ -38,6 +38,30 @@ MODULE_OBJS := \
 	wincursor.o \
 	yuv_to_rgb.o
 
+ifdef SCUMMVM_SSE2
+MODULE_OBJS += \
+	transparent_surface_sse2.o \
+	yuv_to_rgb_sse2.o
+$(MODULE)/transparent_surface_sse2.o: CXXFLAGS += $(SSE2_CXXFLAGS)
+$(MODULE)/yuv_to_rgb_sse2.o: CXXFLAGS += $(SSE2_CXXFLAGS)
+endif
+
+ifdef SCUMMVM_AVX2
+MODULE_OBJS += \
+	transparent_surface_avx2.o \
+	yuv_to_rgb_avx2.o
+$(MODULE)/transparent_surface_avx2.o: CXXFLAGS += $(AVX2_CXXFLAGS)
+$(MODULE)/yuv_to_rgb_avx2.o: CXXFLAGS += $(AVX2_CXXFLAGS)
+endif
+
+ifdef SCUMMVM_NEON
+MODULE_OBJS += \
+	transparent_surface_neon.o \
+	yuv_to_rgb_neon.o
+$(MODULE)/transparent_surface_neon.o: CXXFLAGS += $(NEON_CXXFLAGS)
+$(MODULE)/yuv_to_rgb_neon.o: CXXFLAGS += $(NEON_CXXFLAGS)
+endif
+
 ifdef USE_SCALERS
 MODULE_OBJS += \
 	scaler/2xsai.o \
@@ -47,6 +71,18 @@ MODULE_OBJS += \
 	scaler/scale3x.o \
 	scaler/scalebit.o
 
+ifdef SCUMMVM_SSE2
+MODULE_OBJS += \
+	scaler/scaler32_sse2.o
+$(MODULE)/scaler/scaler32_sse2.o: CXXFLAGS += $(SSE2_CXXFLAGS)
+endif
+
+ifdef SCUMMVM_NEON
+MODULE_OBJS += \
+	scaler/scaler32_neon.o
+$(MODULE)/scaler/scaler32_neon.o: CXXFLAGS += $(NEON_CXXFLAGS)
+endif
+
 ifdef USE_ARM_SCALER_ASM
 MODULE_OBJS += \
 	scaler/downscalerARM.o \
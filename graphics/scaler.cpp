@@ -20,13 +20,16 @@
  *
  */
 
+#include "graphics/scaler.h"
 #include "graphics/scaler/intern.h"
 #include "graphics/scaler/scalebit.h"
+#include "common/cpudetect.h"
 #include "common/util.h"
 #include "common/system.h"
 #include "common/textconsole.h"
 
 int gBitFormat = 565;
+Graphics::PixelFormat gScalerFormat = Graphics::createPixelFormat<565>();
 
 #ifdef USE_HQ_SCALERS
 // RGB-to-YUV lookup table
@@ -117,39 +120,69 @@ void InitLUT(Graphics::PixelFormat format) {
 	hqx_green_redBlue_Mask = (hqx_greenMask << 16) | hqx_redBlueMask;
 #endif
 }
+
+void convertRowToYUV32(uint32 *dst, const uint32 *src, int count) {
+#ifdef SCUMMVM_SSE2
+	if (Common::hasCPUFeature(Common::kCPUFeatureSSE2)) {
+		convertRowToYUV32SSE2(dst, src, count);
+		return;
+	}
+#endif
+#ifdef SCUMMVM_NEON
+	if (Common::hasCPUFeature(Common::kCPUFeatureNEON)) {
+		convertRowToYUV32NEON(dst, src, count);
+		return;
+	}
+#endif
+	for (int i = 0; i < count; ++i)
+		dst[i] = convertToYUV32(src[i]);
+}
 #endif
 
 
 /** Lookup table for the DotMatrix scaler. */
-uint16 g_dotmatrix[16] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
+uint32 g_dotmatrix[16] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
 
 /** Init the scaler subsystem. */
 void InitScalers(uint32 BitFormat) {
-	gBitFormat = BitFormat;
-
-	// FIXME: The pixelformat should be param to this function, not the bitformat.
-	// Until then, determine the pixelformat in other ways. Unfortunately,
-	// calling OSystem::getOverlayFormat() here might not be safe on all ports.
+	// Determine the pixelformat from the bitformat. Unfortunately, calling
+	// OSystem::getOverlayFormat() here might not be safe on all ports, hence
+	// callers which know their format should use the overload below instead.
 	Graphics::PixelFormat format;
-	if (gBitFormat == 555) {
+	if (BitFormat == 555) {
 		format = Graphics::createPixelFormat<555>();
-	} else if (gBitFormat == 565) {
+	} else if (BitFormat == 565) {
 		format = Graphics::createPixelFormat<565>();
 	} else {
 		assert(g_system);
 		format = g_system->getOverlayFormat();
 	}
 
+	InitScalers(format);
+}
+
+void InitScalers(const Graphics::PixelFormat &format) {
+	gScalerFormat = format;
+
+	if (format.bytesPerPixel == 4) {
+		// The 32 bit scalers interpolate all four bytes separately
+		assert(format.rLoss == 0 && format.gLoss == 0 && format.bLoss == 0);
+		gBitFormat = 8888;
+	} else {
+		assert(format.bytesPerPixel == 2);
+		gBitFormat = (format.gLoss == 2) ? 565 : 555;
 #ifdef USE_HQ_SCALERS
-	InitLUT(format);
+		InitLUT(format);
 #endif
+	}
 
-	// Build dotmatrix lookup table for the DotMatrix scaler.
-	g_dotmatrix[0] = g_dotmatrix[10] = format.RGBToColor(0, 63, 0);
-	g_dotmatrix[1] = g_dotmatrix[11] = format.RGBToColor(0, 0, 63);
-	g_dotmatrix[2] = g_dotmatrix[8] = format.RGBToColor(63, 0, 0);
+	// Build dotmatrix lookup table for the DotMatrix scaler. The alpha
+	// channel is left out, so that it is not darkened by the scaler.
+	g_dotmatrix[0] = g_dotmatrix[10] = format.ARGBToColor(0, 0, 63, 0);
+	g_dotmatrix[1] = g_dotmatrix[11] = format.ARGBToColor(0, 0, 0, 63);
+	g_dotmatrix[2] = g_dotmatrix[8] = format.ARGBToColor(0, 63, 0, 0);
 	g_dotmatrix[4] = g_dotmatrix[6] =
-		g_dotmatrix[12] = g_dotmatrix[14] = format.RGBToColor(63, 63, 63);
+		g_dotmatrix[12] = g_dotmatrix[14] = format.ARGBToColor(0, 63, 63, 63);
 }
 
 void DestroyScalers() {
@@ -166,13 +199,15 @@ void DestroyScalers() {
  */
 void Normal1x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
 							int width, int height) {
+	const uint32 lineSize = gScalerFormat.bytesPerPixel * (uint)width;
+
 	// Spot the case when it can all be done in 1 hit
-	if ((srcPitch == sizeof(uint16) * (uint)width) && (dstPitch == sizeof(uint16) * (uint)width)) {
-		memcpy(dstPtr, srcPtr, sizeof(uint16) * width * height);
+	if ((srcPitch == lineSize) && (dstPitch == lineSize)) {
+		memcpy(dstPtr, srcPtr, lineSize * height);
 		return;
 	}
 	while (height--) {
-		memcpy(dstPtr, srcPtr, sizeof(uint16) * width);
+		memcpy(dstPtr, srcPtr, lineSize);
 		srcPtr += srcPitch;
 		dstPtr += dstPitch;
 	}
@@ -188,21 +223,8 @@ extern "C" void Normal2xARM(const uint8  *srcPtr,
                                   uint32  dstPitch,
                                   int     width,
                                   int     height);
-
-void Normal2x(const uint8  *srcPtr,
-                    uint32  srcPitch,
-                    uint8  *dstPtr,
-                    uint32  dstPitch,
-                    int     width,
-                    int     height) {
-	Normal2xARM(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
-}
-
 #else
-/**
- * Trivial nearest-neighbor 2x scaler.
- */
-void Normal2x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
+static void Normal2x16(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
 							int width, int height) {
 	uint8 *r;
 
@@ -223,36 +245,95 @@ void Normal2x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPit
 }
 #endif
 
+static void Normal2x32(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
+							int width, int height) {
+	assert(IS_ALIGNED(dstPtr, 4));
+	while (height--) {
+		const uint32 *s = (const uint32 *)srcPtr;
+		uint32 *d0 = (uint32 *)dstPtr;
+		uint32 *d1 = (uint32 *)(dstPtr + dstPitch);
+		for (int i = 0; i < width; ++i) {
+			const uint32 color = s[i];
+
+			d0[2 * i + 0] = color;
+			d0[2 * i + 1] = color;
+			d1[2 * i + 0] = color;
+			d1[2 * i + 1] = color;
+		}
+		srcPtr += srcPitch;
+		dstPtr += dstPitch << 1;
+	}
+}
+
 /**
- * Trivial nearest-neighbor 3x scaler.
+ * Trivial nearest-neighbor 2x scaler.
  */
-void Normal3x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
+void Normal2x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
+							int width, int height) {
+	if (gBitFormat == 8888) {
+#ifdef SCUMMVM_SSE2
+		if (Common::hasCPUFeature(Common::kCPUFeatureSSE2)) {
+			Normal2x32SSE2(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+			return;
+		}
+#endif
+#ifdef SCUMMVM_NEON
+		if (Common::hasCPUFeature(Common::kCPUFeatureNEON)) {
+			Normal2x32NEON(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+			return;
+		}
+#endif
+		Normal2x32(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+		return;
+	}
+
+#ifdef USE_ARM_SCALER_ASM
+	Normal2xARM(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+#else
+	Normal2x16(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+#endif
+}
+
+template<typename Pixel>
+static void Normal3xTemplate(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
 							int width, int height) {
 	uint8 *r;
 	const uint32 dstPitch2 = dstPitch * 2;
 	const uint32 dstPitch3 = dstPitch * 3;
+	const int pixelSize = sizeof(Pixel);
 
-	assert(IS_ALIGNED(dstPtr, 2));
+	assert(IS_ALIGNED(dstPtr, pixelSize));
 	while (height--) {
 		r = dstPtr;
-		for (int i = 0; i < width; ++i, r += 6) {
-			uint16 color = *(((const uint16 *)srcPtr) + i);
-
-			*(uint16 *)(r + 0) = color;
-			*(uint16 *)(r + 2) = color;
-			*(uint16 *)(r + 4) = color;
-			*(uint16 *)(r + 0 + dstPitch) = color;
-			*(uint16 *)(r + 2 + dstPitch) = color;
-			*(uint16 *)(r + 4 + dstPitch) = color;
-			*(uint16 *)(r + 0 + dstPitch2) = color;
-			*(uint16 *)(r + 2 + dstPitch2) = color;
-			*(uint16 *)(r + 4 + dstPitch2) = color;
+		for (int i = 0; i < width; ++i, r += 3 * pixelSize) {
+			Pixel color = *(((const Pixel *)srcPtr) + i);
+
+			*(Pixel *)(r + 0 * pixelSize) = color;
+			*(Pixel *)(r + 1 * pixelSize) = color;
+			*(Pixel *)(r + 2 * pixelSize) = color;
+			*(Pixel *)(r + 0 * pixelSize + dstPitch) = color;
+			*(Pixel *)(r + 1 * pixelSize + dstPitch) = color;
+			*(Pixel *)(r + 2 * pixelSize + dstPitch) = color;
+			*(Pixel *)(r + 0 * pixelSize + dstPitch2) = color;
+			*(Pixel *)(r + 1 * pixelSize + dstPitch2) = color;
+			*(Pixel *)(r + 2 * pixelSize + dstPitch2) = color;
 		}
 		srcPtr += srcPitch;
 		dstPtr += dstPitch3;
 	}
 }
 
+/**
+ * Trivial nearest-neighbor 3x scaler.
+ */
+void Normal3x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
+							int width, int height) {
+	if (gBitFormat == 8888)
+		Normal3xTemplate<uint32>(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+	else
+		Normal3xTemplate<uint16>(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+}
+
 #define interpolate_1_1		interpolate16_1_1<ColorMask>
 #define interpolate_1_1_1_1	interpolate16_1_1_1_1<ColorMask>
 
@@ -262,29 +343,31 @@ void Normal3x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPit
 template<typename ColorMask>
 void Normal1o5xTemplate(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
 							int width, int height) {
+	typedef typename ColorMask::PixelType Pixel;
 	uint8 *r;
 	const uint32 dstPitch2 = dstPitch * 2;
 	const uint32 dstPitch3 = dstPitch * 3;
 	const uint32 srcPitch2 = srcPitch * 2;
+	const int pixelSize = sizeof(Pixel);
 
-	assert(IS_ALIGNED(dstPtr, 2));
+	assert(IS_ALIGNED(dstPtr, pixelSize));
 	while (height > 0) {
 		r = dstPtr;
-		for (int i = 0; i < width; i += 2, r += 6) {
-			uint16 color0 = *(((const uint16 *)srcPtr) + i);
-			uint16 color1 = *(((const uint16 *)srcPtr) + i + 1);
-			uint16 color2 = *(((const uint16 *)(srcPtr + srcPitch)) + i);
-			uint16 color3 = *(((const uint16 *)(srcPtr + srcPitch)) + i + 1);
-
-			*(uint16 *)(r + 0) = color0;
-			*(uint16 *)(r + 2) = interpolate_1_1(color0, color1);
-			*(uint16 *)(r + 4) = color1;
-			*(uint16 *)(r + 0 + dstPitch) = interpolate_1_1(color0, color2);
-			*(uint16 *)(r + 2 + dstPitch) = interpolate_1_1_1_1(color0, color1, color2, color3);
-			*(uint16 *)(r + 4 + dstPitch) = interpolate_1_1(color1, color3);
-			*(uint16 *)(r + 0 + dstPitch2) = color2;
-			*(uint16 *)(r + 2 + dstPitch2) = interpolate_1_1(color2, color3);
-			*(uint16 *)(r + 4 + dstPitch2) = color3;
+		for (int i = 0; i < width; i += 2, r += 3 * pixelSize) {
+			Pixel color0 = *(((const Pixel *)srcPtr) + i);
+			Pixel color1 = *(((const Pixel *)srcPtr) + i + 1);
+			Pixel color2 = *(((const Pixel *)(srcPtr + srcPitch)) + i);
+			Pixel color3 = *(((const Pixel *)(srcPtr + srcPitch)) + i + 1);
+
+			*(Pixel *)(r + 0 * pixelSize) = color0;
+			*(Pixel *)(r + 1 * pixelSize) = interpolate_1_1(color0, color1);
+			*(Pixel *)(r + 2 * pixelSize) = color1;
+			*(Pixel *)(r + 0 * pixelSize + dstPitch) = interpolate_1_1(color0, color2);
+			*(Pixel *)(r + 1 * pixelSize + dstPitch) = interpolate_1_1_1_1(color0, color1, color2, color3);
+			*(Pixel *)(r + 2 * pixelSize + dstPitch) = interpolate_1_1(color1, color3);
+			*(Pixel *)(r + 0 * pixelSize + dstPitch2) = color2;
+			*(Pixel *)(r + 1 * pixelSize + dstPitch2) = interpolate_1_1(color2, color3);
+			*(Pixel *)(r + 2 * pixelSize + dstPitch2) = color3;
 		}
 		srcPtr += srcPitch2;
 		dstPtr += dstPitch3;
@@ -293,7 +376,9 @@ void Normal1o5xTemplate(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uin
 }
 
 void Normal1o5x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
-	if (gBitFormat == 565)
+	if (gBitFormat == 8888)
+		Normal1o5xTemplate<Graphics::ColorMasks<8888> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+	else if (gBitFormat == 565)
 		Normal1o5xTemplate<Graphics::ColorMasks<565> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
 	else
 		Normal1o5xTemplate<Graphics::ColorMasks<555> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
@@ -305,7 +390,7 @@ void Normal1o5x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstP
  */
 void AdvMame2x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
 							 int width, int height) {
-	scale(2, dstPtr, dstPitch, srcPtr - srcPitch, srcPitch, 2, width, height);
+	scale(2, dstPtr, dstPitch, srcPtr - srcPitch, srcPitch, gScalerFormat.bytesPerPixel, width, height);
 }
 
 /**
@@ -314,30 +399,45 @@ void AdvMame2x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPi
  */
 void AdvMame3x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
 							 int width, int height) {
-	scale(3, dstPtr, dstPitch, srcPtr - srcPitch, srcPitch, 2, width, height);
+	scale(3, dstPtr, dstPitch, srcPtr - srcPitch, srcPitch, gScalerFormat.bytesPerPixel, width, height);
+}
+
+template<typename ColorMask>
+static inline uint32 dimScanline(uint32 p) {
+	uint32 pi;
+
+	pi = (((p & ColorMask::kRedBlueMask) * 7) >> 3) & ColorMask::kRedBlueMask;
+	pi |= (((p & ColorMask::kGreenMask) * 7) >> 3) & ColorMask::kGreenMask;
+	return pi;
+}
+
+template<>
+inline uint32 dimScanline<Graphics::ColorMasks<8888> >(uint32 p) {
+	// The alpha channel, if any, is kept as is
+	const uint32 alphaMask = gScalerFormat.ARGBToColor(255, 0, 0, 0);
+	return (interpolate32_8888<7, 0, 0, 3>(p, 0, 0) & ~alphaMask) | (p & alphaMask);
 }
 
 template<typename ColorMask>
 void TV2xTemplate(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
 					int width, int height) {
-	const uint32 nextlineSrc = srcPitch / sizeof(uint16);
-	const uint16 *p = (const uint16 *)srcPtr;
+	typedef typename ColorMask::PixelType Pixel;
+
+	const uint32 nextlineSrc = srcPitch / sizeof(Pixel);
+	const Pixel *p = (const Pixel *)srcPtr;
 
-	const uint32 nextlineDst = dstPitch / sizeof(uint16);
-	uint16 *q = (uint16 *)dstPtr;
+	const uint32 nextlineDst = dstPitch / sizeof(Pixel);
+	Pixel *q = (Pixel *)dstPtr;
 
 	while (height--) {
 		for (int i = 0, j = 0; i < width; ++i, j += 2) {
-			uint16 p1 = *(p + i);
-			uint32 pi;
-
-			pi = (((p1 & ColorMask::kRedBlueMask) * 7) >> 3) & ColorMask::kRedBlueMask;
-			pi |= (((p1 & ColorMask::kGreenMask) * 7) >> 3) & ColorMask::kGreenMask;
+			Pixel p1 = *(p + i);
+			Pixel pi = (Pixel)dimScanline<ColorMask>(p1);
 
 			*(q + j) = p1;
 			*(q + j + 1) = p1;
-			*(q + j + nextlineDst) = (uint16)pi;
-			*(q + j + nextlineDst + 1) = (uint16)pi;
+			*(q + j + nextlineDst) = pi;
+			*(q + j + nextlineDst + 1) = pi;
 		}
 		p += nextlineSrc;
 		q += nextlineDst << 1;
@@ -345,13 +445,28 @@ void TV2xTemplate(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 ds
 }
 
 void TV2x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
-	if (gBitFormat == 565)
+	if (gBitFormat == 8888) {
+#ifdef SCUMMVM_SSE2
+		if (Common::hasCPUFeature(Common::kCPUFeatureSSE2)) {
+			TV2x32SSE2(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+			return;
+		}
+#endif
+#ifdef SCUMMVM_NEON
+		if (Common::hasCPUFeature(Common::kCPUFeatureNEON)) {
+			TV2x32NEON(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+			return;
+		}
+#endif
+		TV2xTemplate<Graphics::ColorMasks<8888> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+	} else if (gBitFormat == 565)
 		TV2xTemplate<Graphics::ColorMasks<565> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
 	else
 		TV2xTemplate<Graphics::ColorMasks<555> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
 }
 
-static inline uint16 DOT_16(const uint16 *dotmatrix, uint16 c, int j, int i) {
+template<typename Pixel>
+static inline Pixel DOT(const uint32 *dotmatrix, Pixel c, int j, int i) {
 	return c - ((c >> 2) & dotmatrix[((j & 3) << 2) + (i & 3)]);
 }
 
@@ -362,28 +477,37 @@ static inline uint16 DOT_16(const uint16 *dotmatrix, uint16 c, int j, int i) {
 // a way that also works together with aspect-ratio correction is left as an
 // exercise for the reader.)
 
-void DotMatrix(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
+template<typename Pixel>
+static void DotMatrixTemplate(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
 					int width, int height) {
 
-	const uint16 *dotmatrix = g_dotmatrix;
+	const uint32 *dotmatrix = g_dotmatrix;
 
-	const uint32 nextlineSrc = srcPitch / sizeof(uint16);
-	const uint16 *p = (const uint16 *)srcPtr;
+	const uint32 nextlineSrc = srcPitch / sizeof(Pixel);
+	const Pixel *p = (const Pixel *)srcPtr;
 
-	const uint32 nextlineDst = dstPitch / sizeof(uint16);
-	uint16 *q = (uint16 *)dstPtr;
+	const uint32 nextlineDst = dstPitch / sizeof(Pixel);
+	Pixel *q = (Pixel *)dstPtr;
 
 	for (int j = 0, jj = 0; j < height; ++j, jj += 2) {
 		for (int i = 0, ii = 0; i < width; ++i, ii += 2) {
-			uint16 c = *(p + i);
-			*(q + ii) = DOT_16(dotmatrix, c, jj, ii);
-			*(q + ii + 1) = DOT_16(dotmatrix, c, jj, ii + 1);
-			*(q + ii + nextlineDst) = DOT_16(dotmatrix, c, jj + 1, ii);
-			*(q + ii + nextlineDst + 1) = DOT_16(dotmatrix, c, jj + 1, ii + 1);
+			Pixel c = *(p + i);
+			*(q + ii) = DOT(dotmatrix, c, jj, ii);
+			*(q + ii + 1) = DOT(dotmatrix, c, jj, ii + 1);
+			*(q + ii + nextlineDst) = DOT(dotmatrix, c, jj + 1, ii);
+			*(q + ii + nextlineDst + 1) = DOT(dotmatrix, c, jj + 1, ii + 1);
 		}
 		p += nextlineSrc;
 		q += nextlineDst << 1;
 	}
 }
 
+void DotMatrix(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
+					int width, int height) {
+	if (gBitFormat == 8888)
+		DotMatrixTemplate<uint32>(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+	else
+		DotMatrixTemplate<uint16>(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+}
+
 #endif // #ifdef USE_SCALERS
@@ -27,6 +27,11 @@
 #include "graphics/surface.h"
 
 extern void InitScalers(uint32 BitFormat);
+/**
+ * Init the scaler subsystem for the given format. Next to the 16 bit formats,
+ * all scalers support 32 bit formats with 8 bits per color channel.
+ */
+extern void InitScalers(const Graphics::PixelFormat &format);
 extern void DestroyScalers();
 
 typedef void ScalerProc(const uint8 *srcPtr, uint32 srcPitch,
@@ -68,6 +68,10 @@ int stretch200To240(uint8 *buf,
 DECLARE_SCALER(Normal1xAspect);
 
 #ifdef USE_ARM_SCALER_ASM
+/**
+ * Normal2x combined with Normal1xAspect, in ARM assembly. Unlike the other
+ * scalers it supports 16bpp formats only.
+ */
 DECLARE_SCALER(Normal2xAspect);
 #endif
 
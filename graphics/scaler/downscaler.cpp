@@ -22,6 +22,30 @@
 #include "graphics/scaler/downscaler.h"
 #include "graphics/scaler/intern.h"
 
+template<typename ColorMask>
+void DownscaleAllByHalfTemplate(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
+	typedef typename ColorMask::PixelType Pixel;
+	uint8 *work;
+	uint32 srcPitchPixels = srcPitch / sizeof(Pixel);
+
+	while ((height -= 2) >= 0) {
+		work = dstPtr;
+
+		for (int i=0; i<width; i+=2) {
+			// Another lame filter attempt :)
+			Pixel color1 = *(((const Pixel *)srcPtr) + i);
+			Pixel color2 = *(((const Pixel *)srcPtr) + (i + 1));
+			Pixel color3 = *(((const Pixel *)srcPtr) + (i + srcPitchPixels));
+			Pixel color4 = *(((const Pixel *)srcPtr) + (i + srcPitchPixels + 1));
+			*(((Pixel *)work) + 0) = interpolate16_1_1_1_1<ColorMask>(color1, color2, color3, color4);
+
+			work += sizeof(Pixel);
+		}
+		srcPtr += 2 * srcPitch;
+		dstPtr += dstPitch;
+	}
+}
+
 #ifdef USE_ARM_SCALER_ASM
 extern "C" {
 	void DownscaleAllByHalfARM(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height, int mask, int round);
@@ -34,38 +58,23 @@ void DownscaleAllByHalf(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uin
 
 	extern int gBitFormat;
 
+	// The assembly version handles 16 bit pixels only
+	if (gBitFormat == 8888) {
+		DownscaleAllByHalfTemplate<Graphics::ColorMasks<8888> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+		return;
+	}
+
 	const int maskUsed = (gBitFormat == 565);
 	DownscaleAllByHalfARM(srcPtr, srcPitch, dstPtr, dstPitch, width, height, redbluegreenMasks[maskUsed], roundingconstants[maskUsed]);
 }
 
 #else
 
-template<typename ColorMask>
-void DownscaleAllByHalfTemplate(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
-	uint8 *work;
-	uint16 srcPitch16 = (uint16)(srcPitch / sizeof(uint16));
-
-	while ((height -= 2) >= 0) {
-		work = dstPtr;
-
-		for (int i=0; i<width; i+=2) {
-			// Another lame filter attempt :)
-			uint16 color1 = *(((const uint16 *)srcPtr) + i);
-			uint16 color2 = *(((const uint16 *)srcPtr) + (i + 1));
-			uint16 color3 = *(((const uint16 *)srcPtr) + (i + srcPitch16));
-			uint16 color4 = *(((const uint16 *)srcPtr) + (i + srcPitch16 + 1));
-			*(((uint16 *)work) + 0) = interpolate16_1_1_1_1<ColorMask>(color1, color2, color3, color4);
-
-			work += sizeof(uint16);
-		}
-		srcPtr += 2 * srcPitch;
-		dstPtr += dstPitch;
-	}
-}
-
 void DownscaleAllByHalf(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
 	extern int gBitFormat;
-	if (gBitFormat == 565)
+	if (gBitFormat == 8888)
+		DownscaleAllByHalfTemplate<Graphics::ColorMasks<8888> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+	else if (gBitFormat == 565)
 		DownscaleAllByHalfTemplate<Graphics::ColorMasks<565> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
 	else
 		DownscaleAllByHalfTemplate<Graphics::ColorMasks<555> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
@@ -80,17 +89,18 @@ void DownscaleAllByHalf(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uin
  */
 template<typename ColorMask>
 void DownscaleHorizByHalfTemplate(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
-	uint16 *work;
+	typedef typename ColorMask::PixelType Pixel;
+	Pixel *work;
 
 	// Various casts below go via (void *) to avoid warning. This is
-	// safe as these are all even addresses.
+	// safe as these are all aligned addresses.
 	while (height--) {
-		work = (uint16 *)(void *)dstPtr;
+		work = (Pixel *)(void *)dstPtr;
 
 		for (int i = 0; i < width; i += 2) {
-			uint16 color1 = *(((const uint16 *)(const void *)srcPtr) + i);
-			uint16 color2 = *(((const uint16 *)(const void *)srcPtr) + (i + 1));
-			*work++ = interpolate32_1_1<ColorMask>(color1, color2);
+			Pixel color1 = *(((const Pixel *)(const void *)srcPtr) + i);
+			Pixel color2 = *(((const Pixel *)(const void *)srcPtr) + (i + 1));
+			*work++ = interpolate16_1_1<ColorMask>(color1, color2);
 		}
 		srcPtr += srcPitch;
 		dstPtr += dstPitch;
@@ -99,7 +109,9 @@ void DownscaleHorizByHalfTemplate(const uint8 *srcPtr, uint32 srcPitch, uint8 *d
 
 void DownscaleHorizByHalf(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
 	extern int gBitFormat;
-	if (gBitFormat == 565)
+	if (gBitFormat == 8888)
+		DownscaleHorizByHalfTemplate<Graphics::ColorMasks<8888> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+	else if (gBitFormat == 565)
 		DownscaleHorizByHalfTemplate<Graphics::ColorMasks<565> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
 	else
 		DownscaleHorizByHalfTemplate<Graphics::ColorMasks<555> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
@@ -111,23 +123,24 @@ void DownscaleHorizByHalf(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, u
  */
 template<typename ColorMask>
 void DownscaleHorizByThreeQuartersTemplate(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
-	uint16 *work;
+	typedef typename ColorMask::PixelType Pixel;
+	Pixel *work;
 
 	// Various casts below go via (void *) to avoid warning. This is
-	// safe as these are all even addresses.
+	// safe as these are all aligned addresses.
 	while (height--) {
-		work = (uint16 *)(void *)dstPtr;
+		work = (Pixel *)(void *)dstPtr;
 
 		for (int i = 0; i < width; i += 4) {
 			// Work with 4 pixels
-			uint16 color1 = *(((const uint16 *)(const void *)srcPtr) + i);
-			uint16 color2 = *(((const uint16 *)(const void *)srcPtr) + (i + 1));
-			uint16 color3 = *(((const uint16 *)(const void *)srcPtr) + (i + 2));
-			uint16 color4 = *(((const uint16 *)(const void *)srcPtr) + (i + 3));
+			Pixel color1 = *(((const Pixel *)(const void *)srcPtr) + i);
+			Pixel color2 = *(((const Pixel *)(const void *)srcPtr) + (i + 1));
+			Pixel color3 = *(((const Pixel *)(const void *)srcPtr) + (i + 2));
+			Pixel color4 = *(((const Pixel *)(const void *)srcPtr) + (i + 3));
 
-			work[0] = interpolate32_3_1<ColorMask>(color1, color2);
-			work[1] = interpolate32_1_1<ColorMask>(color2, color3);
-			work[2] = interpolate32_3_1<ColorMask>(color4, color3);
+			work[0] = interpolate16_3_1<ColorMask>(color1, color2);
+			work[1] = interpolate16_1_1<ColorMask>(color2, color3);
+			work[2] = interpolate16_3_1<ColorMask>(color4, color3);
 
 			work += 3;
 		}
@@ -138,7 +151,9 @@ void DownscaleHorizByThreeQuartersTemplate(const uint8 *srcPtr, uint32 srcPitch,
 
 void DownscaleHorizByThreeQuarters(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
 	extern int gBitFormat;
-	if (gBitFormat == 565)
+	if (gBitFormat == 8888)
+		DownscaleHorizByThreeQuartersTemplate<Graphics::ColorMasks<8888> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+	else if (gBitFormat == 565)
 		DownscaleHorizByThreeQuartersTemplate<Graphics::ColorMasks<565> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
 	else
 		DownscaleHorizByThreeQuartersTemplate<Graphics::ColorMasks<555> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
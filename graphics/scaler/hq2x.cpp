@@ -21,9 +21,10 @@
  */
 
 #include "graphics/scaler/intern.h"
+#include "common/textconsole.h"
 
 #ifdef USE_NASM
-// Assembly version of HQ2x
+// Assembly version of HQ2x, only for 16 bit formats
 
 extern "C" {
 
@@ -34,12 +35,7 @@ extern "C" {
 void hq2x_16(const byte *, byte *, uint32, uint32, uint32, uint32);
 
 }
-
-void HQ2x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
-	hq2x_16(srcPtr, dstPtr, width, height, srcPitch, dstPitch);
-}
-
-#else
+#endif
 
 #define PIXEL00_0	*(q) = w5;
 #define PIXEL00_10	*(q) = interpolate16_3_1<ColorMask >(w5, w1);
@@ -93,23 +89,26 @@ void HQ2x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
 #define PIXEL11_90	*(q+1+nextlineDst) = interpolate16_2_3_3<ColorMask >(w5, w6, w8);
 #define PIXEL11_100	*(q+1+nextlineDst) = interpolate16_14_1_1<ColorMask >(w5, w6, w8);
 
-extern "C" uint32   *RGBtoYUV;
-#define YUV(x)	RGBtoYUV[w ## x]
+#define YUV(x)	yuv ## x
 
 /*
  * The HQ2x high quality 2x graphics filter.
  * Original author Maxim Stepin (see http://www.hiend3d.com/hq2x.html).
  * Adapted for ScummVM to 16 bit output and optimized by Max Horn.
+ * The YUV values are computed once per source row, which also makes
+ * 32 bit output possible without a huge lookup table.
  */
 template<typename ColorMask>
-static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
-	int w1, w2, w3, w4, w5, w6, w7, w8, w9;
+static void HQ2x_strip(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
+	typedef typename ColorMask::PixelType Pixel;
+	unsigned w1, w2, w3, w4, w5, w6, w7, w8, w9;
+	uint32 yuv1, yuv2, yuv3, yuv4, yuv5, yuv6, yuv7, yuv8, yuv9;
 
-	const uint32 nextlineSrc = srcPitch / sizeof(uint16);
-	const uint16 *p = (const uint16 *)srcPtr;
+	const uint32 nextlineSrc = srcPitch / sizeof(Pixel);
+	const Pixel *p = (const Pixel *)srcPtr;
 
-	const uint32 nextlineDst = dstPitch / sizeof(uint16);
-	uint16 *q = (uint16 *)dstPtr;
+	const uint32 nextlineDst = dstPitch / sizeof(Pixel);
+	Pixel *q = (Pixel *)dstPtr;
 
 	//	 +----+----+----+
 	//	 |    |    |    |
@@ -122,14 +121,38 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 	//	 | w7 | w8 | w9 |
 	//	 +----+----+----+
 
+	// YUV values of the source rows above, at and below the current one,
+	// including the pixels left and right of the scaled area.
+	assert(width <= kHQStripWidth);
+	const int yuvWidth = width + 2;
+	uint32 yuvBuffer[3 * (kHQStripWidth + 2)];
+
+	uint32 *yuvAbove = yuvBuffer;
+	uint32 *yuvCenter = yuvAbove + yuvWidth;
+	uint32 *yuvBelow = yuvCenter + yuvWidth;
+	convertRowToYUV(yuvAbove, p - 1 - nextlineSrc, yuvWidth);
+	convertRowToYUV(yuvCenter, p - 1, yuvWidth);
+
 	while (height--) {
+		convertRowToYUV(yuvBelow, p - 1 + nextlineSrc, yuvWidth);
+
 		w1 = *(p - 1 - nextlineSrc);
 		w4 = *(p - 1);
 		w7 = *(p - 1 + nextlineSrc);
+		yuv1 = yuvAbove[0];
+		yuv4 = yuvCenter[0];
+		yuv7 = yuvBelow[0];
 
 		w2 = *(p - nextlineSrc);
 		w5 = *(p);
 		w8 = *(p + nextlineSrc);
+		yuv2 = yuvAbove[1];
+		yuv5 = yuvCenter[1];
+		yuv8 = yuvBelow[1];
+
+		const uint32 *yuvRight0 = yuvAbove + 2;
+		const uint32 *yuvRight1 = yuvCenter + 2;
+		const uint32 *yuvRight2 = yuvBelow + 2;
 
 		int tmpWidth = width;
 		while (tmpWidth--) {
@@ -138,9 +161,11 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			w3 = *(p - nextlineSrc);
 			w6 = *(p);
 			w9 = *(p + nextlineSrc);
+			yuv3 = *yuvRight0++;
+			yuv6 = *yuvRight1++;
+			yuv9 = *yuvRight2++;
 
 			int pattern = 0;
-			const int yuv5 = YUV(5);
 			if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
 			if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
 			if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
@@ -1950,19 +1975,52 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			w5 = w6;
 			w8 = w9;
 
+			yuv1 = yuv2;
+			yuv4 = yuv5;
+			yuv7 = yuv8;
+
+			yuv2 = yuv3;
+			yuv5 = yuv6;
+			yuv8 = yuv9;
+
 			q += 2;
 		}
 		p += nextlineSrc - width;
 		q += (nextlineDst - width) * 2;
+
+		uint32 *yuvTmp = yuvAbove;
+		yuvAbove = yuvCenter;
+		yuvCenter = yuvBelow;
+		yuvBelow = yuvTmp;
+	}
+}
+
+template<typename ColorMask>
+static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
+	typedef typename ColorMask::PixelType Pixel;
+
+	// The pixels left and right of each strip are read from the source, so
+	// the output does not depend on the strip width.
+	while (width > kHQStripWidth) {
+		HQ2x_strip<ColorMask>(srcPtr, srcPitch, dstPtr, dstPitch, kHQStripWidth, height);
+		srcPtr += kHQStripWidth * sizeof(Pixel);
+		dstPtr += kHQStripWidth * 2 * sizeof(Pixel);
+		width -= kHQStripWidth;
 	}
+	HQ2x_strip<ColorMask>(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
 }
 
 void HQ2x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
 	extern int gBitFormat;
-	if (gBitFormat == 565)
+	if (gBitFormat == 8888)
+		HQ2x_implementation<Graphics::ColorMasks<8888> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+#ifdef USE_NASM
+	else
+		hq2x_16(srcPtr, dstPtr, width, height, srcPitch, dstPitch);
+#else
+	else if (gBitFormat == 565)
 		HQ2x_implementation<Graphics::ColorMasks<565> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
 	else
 		HQ2x_implementation<Graphics::ColorMasks<555> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+#endif
 }
-
-#endif // Assembly version
@@ -179,6 +179,153 @@ static inline unsigned interpolate16_1_1_1_1(unsigned p1, unsigned p2, unsigned
 	return ((p1+p2+p3+p4) - lowbits) >> 2;
 }
 
+/**
+ * Compute the weighted average of three 32 bit pixels with 8 bits per channel,
+ * i.e., (W1*p1+W2*p2+W3*p3) >> Shift for every channel. The even and odd
+ * bytes are handled separately, so every channel has 16 bits of headroom.
+ * All four channels are interpolated, hence this works for any byte order.
+ */
+template<int W1, int W2, int W3, int Shift>
+static inline uint32 interpolate32_8888(uint32 p1, uint32 p2, uint32 p3) {
+	const uint32 even = (((p1 & 0x00FF00FF) * W1 + (p2 & 0x00FF00FF) * W2 + (p3 & 0x00FF00FF) * W3) >> Shift) & 0x00FF00FF;
+	const uint32 odd = ((((p1 >> 8) & 0x00FF00FF) * W1 + ((p2 >> 8) & 0x00FF00FF) * W2 + ((p3 >> 8) & 0x00FF00FF) * W3) >> Shift) & 0x00FF00FF;
+	return even | (odd << 8);
+}
+
+/*
+ * Specializations of the interpolation functions above for 32 bit pixels with
+ * 8 bits per channel. Despite their name, this lets the scaler templates be
+ * instantiated with Graphics::ColorMasks<8888> without further changes.
+ */
+
+template<>
+inline unsigned interpolate16_1_1<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2) {
+	return interpolate32_8888<1, 1, 0, 1>(p1, p2, 0);
+}
+
+template<>
+inline unsigned interpolate16_3_1<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2) {
+	return interpolate32_8888<3, 1, 0, 2>(p1, p2, 0);
+}
+
+template<>
+inline unsigned interpolate16_5_3<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2) {
+	return interpolate32_8888<5, 3, 0, 3>(p1, p2, 0);
+}
+
+template<>
+inline unsigned interpolate16_7_1<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2) {
+	return interpolate32_8888<7, 1, 0, 3>(p1, p2, 0);
+}
+
+template<>
+inline unsigned interpolate16_2_1_1<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2, unsigned p3) {
+	return interpolate32_8888<2, 1, 1, 2>(p1, p2, p3);
+}
+
+template<>
+inline unsigned interpolate16_5_2_1<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2, unsigned p3) {
+	return interpolate32_8888<5, 2, 1, 3>(p1, p2, p3);
+}
+
+template<>
+inline unsigned interpolate16_6_1_1<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2, unsigned p3) {
+	return interpolate32_8888<6, 1, 1, 3>(p1, p2, p3);
+}
+
+template<>
+inline unsigned interpolate16_2_3_3<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2, unsigned p3) {
+	return interpolate32_8888<2, 3, 3, 3>(p1, p2, p3);
+}
+
+template<>
+inline unsigned interpolate16_2_7_7<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2, unsigned p3) {
+	return interpolate32_8888<2, 7, 7, 4>(p1, p2, p3);
+}
+
+template<>
+inline unsigned interpolate16_14_1_1<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2, unsigned p3) {
+	return interpolate32_8888<14, 1, 1, 4>(p1, p2, p3);
+}
+
+template<>
+inline unsigned interpolate16_1_1_1_1<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2, unsigned p3, unsigned p4) {
+	const uint32 even = (((p1 & 0x00FF00FF) + (p2 & 0x00FF00FF) + (p3 & 0x00FF00FF) + (p4 & 0x00FF00FF)) >> 2) & 0x00FF00FF;
+	const uint32 odd = ((((p1 >> 8) & 0x00FF00FF) + ((p2 >> 8) & 0x00FF00FF) + ((p3 >> 8) & 0x00FF00FF) + ((p4 >> 8) & 0x00FF00FF)) >> 2) & 0x00FF00FF;
+	return even | (odd << 8);
+}
+
+/**
+ * The format the scalers were initialized for, see InitScalers(). gBitFormat
+ * is 555 or 565 for 16 bit formats, and 8888 for any 32 bit format with
+ * 8 bits per channel.
+ */
+extern int gBitFormat;
+extern Graphics::PixelFormat gScalerFormat;
+
+/**
+ * 16bit RGB to YUV conversion table, see InitLUT().
+ */
+extern "C" uint32 *RGBtoYUV;
+
+/**
+ * Convert a 32 bit pixel in gScalerFormat to YUV (encoded 8-8-8), using the
+ * same formula as the RGBtoYUV table.
+ */
+static inline uint32 convertToYUV32(uint32 color) {
+	const int r = (color >> gScalerFormat.rShift) & 0xFF;
+	const int g = (color >> gScalerFormat.gShift) & 0xFF;
+	const int b = (color >> gScalerFormat.bShift) & 0xFF;
+
+	const int Y = (r + g + b) >> 2;
+	const int u = 128 + ((r - b) >> 2);
+	const int v = 128 + ((-r + 2 * g - b) >> 3);
+	return (Y << 16) | (u << 8) | v;
+}
+
+/**
+ * Convert a row of 32 bit pixels in gScalerFormat to YUV (encoded 8-8-8).
+ * Picks a SIMD implementation if the CPU supports one.
+ */
+void convertRowToYUV32(uint32 *dst, const uint32 *src, int count);
+
+/*
+ * SIMD versions of the 32 bit scalers and of convertRowToYUV32(). They are
+ * selected at runtime, see common/cpudetect.h.
+ */
+#ifdef SCUMMVM_SSE2
+void Normal2x32SSE2(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height);
+void TV2x32SSE2(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height);
+void convertRowToYUV32SSE2(uint32 *dst, const uint32 *src, int count);
+#endif
+
+#ifdef SCUMMVM_NEON
+void Normal2x32NEON(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height);
+void TV2x32NEON(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height);
+void convertRowToYUV32NEON(uint32 *dst, const uint32 *src, int count);
+#endif
+
+/**
+ * Convert a row of pixels to YUV (encoded 8-8-8) for diffYUV().
+ */
+static inline void convertRowToYUV(uint32 *dst, const uint16 *src, int count) {
+	for (int i = 0; i < count; ++i)
+		dst[i] = RGBtoYUV[src[i]];
+}
+
+static inline void convertRowToYUV(uint32 *dst, const uint32 *src, int count) {
+	convertRowToYUV32(dst, src, count);
+}
+
+/**
+ * The hq scalers handle wider areas in strips of at most this many pixels,
+ * so their YUV rows fit in a buffer on the stack. A shared buffer would not
+ * work, since the scalers may run on several threads at once.
+ */
+enum {
+	kHQStripWidth = 320
+};
+
 /**
  * Compare two YUV values (encoded 8-8-8) and check if they differ by more than
  * a certain hard coded threshold. Used by the hq scaler family.
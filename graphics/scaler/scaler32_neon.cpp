@@ -0,0 +1,121 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+#include "graphics/scaler/intern.h"
+
+#include <arm_neon.h>
+
+void Normal2x32NEON(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
+	while (height--) {
+		const uint32 *s = (const uint32 *)srcPtr;
+		uint32 *d0 = (uint32 *)dstPtr;
+		uint32 *d1 = (uint32 *)(dstPtr + dstPitch);
+
+		int i = 0;
+		for (; i + 4 <= width; i += 4) {
+			const uint32x4_t in = vld1q_u32(s + i);
+			const uint32x4x2_t out = vzipq_u32(in, in);
+
+			vst1q_u32(d0 + 2 * i + 0, out.val[0]);
+			vst1q_u32(d0 + 2 * i + 4, out.val[1]);
+			vst1q_u32(d1 + 2 * i + 0, out.val[0]);
+			vst1q_u32(d1 + 2 * i + 4, out.val[1]);
+		}
+
+		for (; i < width; ++i) {
+			const uint32 color = s[i];
+			d0[2 * i + 0] = d0[2 * i + 1] = color;
+			d1[2 * i + 0] = d1[2 * i + 1] = color;
+		}
+
+		srcPtr += srcPitch;
+		dstPtr += dstPitch << 1;
+	}
+}
+
+void TV2x32NEON(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
+	const uint32 alphaMask = gScalerFormat.ARGBToColor(255, 0, 0, 0);
+	const uint32x4_t alpha = vdupq_n_u32(alphaMask);
+	const uint8x8_t seven = vdup_n_u8(7);
+
+	while (height--) {
+		const uint32 *s = (const uint32 *)srcPtr;
+		uint32 *d0 = (uint32 *)dstPtr;
+		uint32 *d1 = (uint32 *)(dstPtr + dstPitch);
+
+		int i = 0;
+		for (; i + 4 <= width; i += 4) {
+			const uint32x4_t in = vld1q_u32(s + i);
+			const uint8x16_t bytes = vreinterpretq_u8_u32(in);
+
+			// Scale every channel by 7/8, like the scalar version does
+			const uint8x8_t lo = vshrn_n_u16(vmull_u8(vget_low_u8(bytes), seven), 3);
+			const uint8x8_t hi = vshrn_n_u16(vmull_u8(vget_high_u8(bytes), seven), 3);
+			const uint32x4_t dim = vbslq_u32(alpha, in, vreinterpretq_u32_u8(vcombine_u8(lo, hi)));
+
+			const uint32x4x2_t top = vzipq_u32(in, in);
+			const uint32x4x2_t bottom = vzipq_u32(dim, dim);
+			vst1q_u32(d0 + 2 * i + 0, top.val[0]);
+			vst1q_u32(d0 + 2 * i + 4, top.val[1]);
+			vst1q_u32(d1 + 2 * i + 0, bottom.val[0]);
+			vst1q_u32(d1 + 2 * i + 4, bottom.val[1]);
+		}
+
+		for (; i < width; ++i) {
+			const uint32 color = s[i];
+			const uint32 dim = (interpolate32_8888<7, 0, 0, 3>(color, 0, 0) & ~alphaMask) | (color & alphaMask);
+			d0[2 * i + 0] = d0[2 * i + 1] = color;
+			d1[2 * i + 0] = d1[2 * i + 1] = dim;
+		}
+
+		srcPtr += srcPitch;
+		dstPtr += dstPitch << 1;
+	}
+}
+
+#ifdef USE_HQ_SCALERS
+void convertRowToYUV32NEON(uint32 *dst, const uint32 *src, int count) {
+	const Graphics::PixelFormat &format = gScalerFormat;
+	const int32x4_t rShift = vdupq_n_s32(-(int)format.rShift);
+	const int32x4_t gShift = vdupq_n_s32(-(int)format.gShift);
+	const int32x4_t bShift = vdupq_n_s32(-(int)format.bShift);
+	const uint32x4_t channelMask = vdupq_n_u32(0xFF);
+	const int32x4_t bias = vdupq_n_s32(128);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const uint32x4_t in = vld1q_u32(src + i);
+		const int32x4_t r = vreinterpretq_s32_u32(vandq_u32(vshlq_u32(in, rShift), channelMask));
+		const int32x4_t g = vreinterpretq_s32_u32(vandq_u32(vshlq_u32(in, gShift), channelMask));
+		const int32x4_t b = vreinterpretq_s32_u32(vandq_u32(vshlq_u32(in, bShift), channelMask));
+
+		const int32x4_t y = vshrq_n_s32(vaddq_s32(vaddq_s32(r, g), b), 2);
+		const int32x4_t u = vaddq_s32(bias, vshrq_n_s32(vsubq_s32(r, b), 2));
+		const int32x4_t v = vaddq_s32(bias, vshrq_n_s32(vsubq_s32(vshlq_n_s32(g, 1), vaddq_s32(r, b)), 3));
+
+		const int32x4_t out = vorrq_s32(vorrq_s32(vshlq_n_s32(y, 16), vshlq_n_s32(u, 8)), v);
+		vst1q_u32(dst + i, vreinterpretq_u32_s32(out));
+	}
+
+	for (; i < count; ++i)
+		dst[i] = convertToYUV32(src[i]);
+}
+#endif
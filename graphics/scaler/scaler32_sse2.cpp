@@ -0,0 +1,122 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+#include "graphics/scaler/intern.h"
+
+#include <emmintrin.h>
+
+void Normal2x32SSE2(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
+	while (height--) {
+		const uint32 *s = (const uint32 *)srcPtr;
+		uint32 *d0 = (uint32 *)dstPtr;
+		uint32 *d1 = (uint32 *)(dstPtr + dstPitch);
+
+		int i = 0;
+		for (; i + 4 <= width; i += 4) {
+			const __m128i in = _mm_loadu_si128((const __m128i *)(s + i));
+			const __m128i lo = _mm_unpacklo_epi32(in, in);
+			const __m128i hi = _mm_unpackhi_epi32(in, in);
+
+			_mm_storeu_si128((__m128i *)(d0 + 2 * i + 0), lo);
+			_mm_storeu_si128((__m128i *)(d0 + 2 * i + 4), hi);
+			_mm_storeu_si128((__m128i *)(d1 + 2 * i + 0), lo);
+			_mm_storeu_si128((__m128i *)(d1 + 2 * i + 4), hi);
+		}
+
+		for (; i < width; ++i) {
+			const uint32 color = s[i];
+			d0[2 * i + 0] = d0[2 * i + 1] = color;
+			d1[2 * i + 0] = d1[2 * i + 1] = color;
+		}
+
+		srcPtr += srcPitch;
+		dstPtr += dstPitch << 1;
+	}
+}
+
+void TV2x32SSE2(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
+	const uint32 alphaMask = gScalerFormat.ARGBToColor(255, 0, 0, 0);
+	const __m128i alpha = _mm_set1_epi32(alphaMask);
+	const __m128i zero = _mm_setzero_si128();
+
+	while (height--) {
+		const uint32 *s = (const uint32 *)srcPtr;
+		uint32 *d0 = (uint32 *)dstPtr;
+		uint32 *d1 = (uint32 *)(dstPtr + dstPitch);
+
+		int i = 0;
+		for (; i + 4 <= width; i += 4) {
+			const __m128i in = _mm_loadu_si128((const __m128i *)(s + i));
+
+			// Scale every channel by 7/8, like the scalar version does
+			__m128i lo = _mm_unpacklo_epi8(in, zero);
+			__m128i hi = _mm_unpackhi_epi8(in, zero);
+			lo = _mm_srli_epi16(_mm_sub_epi16(_mm_slli_epi16(lo, 3), lo), 3);
+			hi = _mm_srli_epi16(_mm_sub_epi16(_mm_slli_epi16(hi, 3), hi), 3);
+			__m128i dim = _mm_packus_epi16(lo, hi);
+			dim = _mm_or_si128(_mm_andnot_si128(alpha, dim), _mm_and_si128(alpha, in));
+
+			_mm_storeu_si128((__m128i *)(d0 + 2 * i + 0), _mm_unpacklo_epi32(in, in));
+			_mm_storeu_si128((__m128i *)(d0 + 2 * i + 4), _mm_unpackhi_epi32(in, in));
+			_mm_storeu_si128((__m128i *)(d1 + 2 * i + 0), _mm_unpacklo_epi32(dim, dim));
+			_mm_storeu_si128((__m128i *)(d1 + 2 * i + 4), _mm_unpackhi_epi32(dim, dim));
+		}
+
+		for (; i < width; ++i) {
+			const uint32 color = s[i];
+			const uint32 dim = (interpolate32_8888<7, 0, 0, 3>(color, 0, 0) & ~alphaMask) | (color & alphaMask);
+			d0[2 * i + 0] = d0[2 * i + 1] = color;
+			d1[2 * i + 0] = d1[2 * i + 1] = dim;
+		}
+
+		srcPtr += srcPitch;
+		dstPtr += dstPitch << 1;
+	}
+}
+
+#ifdef USE_HQ_SCALERS
+void convertRowToYUV32SSE2(uint32 *dst, const uint32 *src, int count) {
+	const Graphics::PixelFormat &format = gScalerFormat;
+	const __m128i rShift = _mm_cvtsi32_si128(format.rShift);
+	const __m128i gShift = _mm_cvtsi32_si128(format.gShift);
+	const __m128i bShift = _mm_cvtsi32_si128(format.bShift);
+	const __m128i channelMask = _mm_set1_epi32(0xFF);
+	const __m128i bias = _mm_set1_epi32(128);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const __m128i in = _mm_loadu_si128((const __m128i *)(src + i));
+		const __m128i r = _mm_and_si128(_mm_srl_epi32(in, rShift), channelMask);
+		const __m128i g = _mm_and_si128(_mm_srl_epi32(in, gShift), channelMask);
+		const __m128i b = _mm_and_si128(_mm_srl_epi32(in, bShift), channelMask);
+
+		const __m128i y = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(r, g), b), 2);
+		const __m128i u = _mm_add_epi32(bias, _mm_srai_epi32(_mm_sub_epi32(r, b), 2));
+		const __m128i v = _mm_add_epi32(bias, _mm_srai_epi32(_mm_sub_epi32(_mm_slli_epi32(g, 1), _mm_add_epi32(r, b)), 3));
+
+		const __m128i out = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(y, 16), _mm_slli_epi32(u, 8)), v);
+		_mm_storeu_si128((__m128i *)(dst + i), out);
+	}
+
+	for (; i < count; ++i)
+		dst[i] = convertToYUV32(src[i]);
+}
+#endif
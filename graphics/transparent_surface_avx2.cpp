@@ -0,0 +1,177 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+#include "graphics/transparent_surface_blit.h"
+
+#include <immintrin.h>
+
+namespace Graphics {
+
+// All kernels expect little endian pixels, i.e. the alpha channel in the
+// lowest byte of every 32 bit lane, see getTransparentBlitProcs().
+
+/**
+ * Load eight input pixels, in output order.
+ */
+static inline __m256i loadPixels(const byte *in, int32 inStep) {
+	if (inStep > 0)
+		return _mm256_loadu_si256((const __m256i *)in);
+	else
+		return _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i *)(in - 28)),
+		                                   _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+/**
+ * Broadcast the alpha channel of four pixels with 16 bit channels.
+ */
+static inline __m256i broadcastAlpha(__m256i x) {
+	return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(x, 0x00), 0x00);
+}
+
+static void doBlitOpaqueAVX2(const byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep) {
+	const __m256i alphaMask = _mm256_set1_epi32(0xFF);
+	const uint32 blocks = width / 8;
+
+	for (uint32 i = 0; i < height; i++) {
+		// Like the scalar version, this always reads the row in order
+		const byte *in = ino;
+		byte *out = outo;
+		for (uint32 j = 0; j < blocks; j++) {
+			const __m256i pixels = _mm256_loadu_si256((const __m256i *)in);
+			_mm256_storeu_si256((__m256i *)out, _mm256_or_si256(pixels, alphaMask));
+			in += 32;
+			out += 32;
+		}
+		if (width & 7)
+			g_transparentBlitProcsScalar.opaque(in, out, width & 7, 1, pitch, inStep, inoStep);
+
+		outo += pitch;
+		ino += inoStep;
+	}
+}
+
+static void doBlitBinaryAVX2(const byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep) {
+	const __m256i alphaMask = _mm256_set1_epi32(0xFF);
+	const uint32 blocks = width / 8;
+
+	for (uint32 i = 0; i < height; i++) {
+		const byte *in = ino;
+		byte *out = outo;
+		for (uint32 j = 0; j < blocks; j++) {
+			const __m256i pixels = loadPixels(in, inStep);
+			const __m256i dst = _mm256_loadu_si256((const __m256i *)out);
+			const __m256i transparent = _mm256_cmpeq_epi32(_mm256_and_si256(pixels, alphaMask), _mm256_setzero_si256());
+
+			const __m256i result = _mm256_blendv_epi8(_mm256_or_si256(pixels, alphaMask), dst, transparent);
+			_mm256_storeu_si256((__m256i *)out, result);
+			in += 8 * inStep;
+			out += 32;
+		}
+		if (width & 7)
+			g_transparentBlitProcsScalar.binary(in, out, width & 7, 1, pitch, inStep, inoStep);
+
+		outo += pitch;
+		ino += inoStep;
+	}
+}
+
+/**
+ * Blend four pixels with 16 bit channels: (in * a + out * (255 - a)) >> 8.
+ */
+static inline __m256i blendPixels(__m256i in, __m256i out) {
+	const __m256i a = broadcastAlpha(in);
+	const __m256i invA = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+	return _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(in, a), _mm256_mullo_epi16(out, invA)), 8);
+}
+
+/**
+ * Blend four pixels with 16 bit channels and colour modulation.
+ */
+static inline __m256i blendPixelsColor(__m256i in, __m256i out, __m256i ca, __m256i cmod) {
+	const __m256i ina = _mm256_srli_epi16(_mm256_mullo_epi16(broadcastAlpha(in), ca), 8);
+	const __m256i invA = _mm256_sub_epi16(_mm256_set1_epi16(255), ina);
+
+	const __m256i dst = _mm256_srli_epi16(_mm256_mullo_epi16(out, invA), 8);
+	// (in * c * ina) >> 16, where in * c still fits into 16 bits
+	const __m256i src = _mm256_mulhi_epu16(_mm256_mullo_epi16(in, cmod), ina);
+	return _mm256_add_epi16(dst, src);
+}
+
+static void doBlitAlphaBlendAVX2(const byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	const __m256i alphaMask = _mm256_set1_epi32(0xFF);
+	const __m256i zero = _mm256_setzero_si256();
+	const uint32 blocks = width / 8;
+
+	const bool colorMod = (color != 0xFFFFFFFF);
+	const short ca = (color >> 24) & 0xFF;
+	const short cr = (color >> 16) & 0xFF;
+	const short cg = (color >> 8) & 0xFF;
+	const short cb = color & 0xFF;
+	const __m256i caVec = _mm256_set1_epi16(ca);
+	const __m256i cmod = _mm256_set_epi16(cr, cg, cb, 0, cr, cg, cb, 0, cr, cg, cb, 0, cr, cg, cb, 0);
+
+	for (uint32 i = 0; i < height; i++) {
+		const byte *in = ino;
+		byte *out = outo;
+		for (uint32 j = 0; j < blocks; j++) {
+			const __m256i pixels = loadPixels(in, inStep);
+			const __m256i dst = _mm256_loadu_si256((const __m256i *)out);
+
+			// The unpack and pack instructions work within 128 bit lanes,
+			// hence the pixel order is preserved
+			const __m256i inLo = _mm256_unpacklo_epi8(pixels, zero);
+			const __m256i inHi = _mm256_unpackhi_epi8(pixels, zero);
+			const __m256i outLo = _mm256_unpacklo_epi8(dst, zero);
+			const __m256i outHi = _mm256_unpackhi_epi8(dst, zero);
+
+			__m256i result;
+			if (colorMod) {
+				result = _mm256_packus_epi16(blendPixelsColor(inLo, outLo, caVec, cmod),
+				                             blendPixelsColor(inHi, outHi, caVec, cmod));
+				result = _mm256_or_si256(result, alphaMask);
+			} else {
+				// Fully transparent pixels are left alone
+				result = _mm256_packus_epi16(blendPixels(inLo, outLo), blendPixels(inHi, outHi));
+				result = _mm256_or_si256(result, alphaMask);
+
+				const __m256i transparent = _mm256_cmpeq_epi32(_mm256_and_si256(pixels, alphaMask), zero);
+				result = _mm256_blendv_epi8(result, dst, transparent);
+			}
+
+			_mm256_storeu_si256((__m256i *)out, result);
+			in += 8 * inStep;
+			out += 32;
+		}
+		if (width & 7)
+			g_transparentBlitProcsScalar.alphaBlend(in, out, width & 7, 1, pitch, inStep, inoStep, color);
+
+		outo += pitch;
+		ino += inoStep;
+	}
+}
+
+const TransparentBlitProcs g_transparentBlitProcsAVX2 = {
+	doBlitOpaqueAVX2,
+	doBlitBinaryAVX2,
+	doBlitAlphaBlendAVX2
+};
+
+} // End of namespace Graphics
@@ -0,0 +1,87 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+#ifndef GRAPHICS_TRANSPARENT_SURFACE_BLIT_H
+#define GRAPHICS_TRANSPARENT_SURFACE_BLIT_H
+
+#include "common/scummsys.h"
+
+namespace Graphics {
+
+/**
+ * Blits a block of 32bpp pixels without blending, as used for the
+ * ALPHA_OPAQUE and ALPHA_BINARY modes of TransparentSurface.
+ *
+ * @param ino     a pointer to the first input pixel
+ * @param outo    a pointer to the first output pixel
+ * @param width   number of pixels per row
+ * @param height  number of rows
+ * @param pitch   pitch of the output surface
+ * @param inStep  distance in bytes between two input pixels, 4 or -4
+ * @param inoStep distance in bytes between two input rows
+ */
+typedef void (*TransparentBlitProc)(const byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep);
+
+/**
+ * Blits a block of 32bpp pixels with blending and colour modulation.
+ * The parameters match TransparentBlitProc, color is the colour modulation
+ * in TS_ARGB format, 0xFFFFFFFF for none.
+ */
+typedef void (*TransparentBlendProc)(const byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+
+/**
+ * The set of blitting kernels for one instruction set.
+ */
+struct TransparentBlitProcs {
+	/** Copies pixels, forcing them to be opaque (ALPHA_OPAQUE). */
+	TransparentBlitProc opaque;
+	/** Copies all pixels with a non zero alpha value (ALPHA_BINARY). */
+	TransparentBlitProc binary;
+	/** Alpha blends pixels, with optional colour modulation (ALPHA_FULL). */
+	TransparentBlendProc alphaBlend;
+};
+
+/**
+ * The portable C++ kernels. These are the reference all other kernels
+ * have to be bit exact with.
+ */
+extern const TransparentBlitProcs g_transparentBlitProcsScalar;
+
+#ifdef SCUMMVM_SSE2
+extern const TransparentBlitProcs g_transparentBlitProcsSSE2;
+#endif
+
+#ifdef SCUMMVM_AVX2
+extern const TransparentBlitProcs g_transparentBlitProcsAVX2;
+#endif
+
+#ifdef SCUMMVM_NEON
+extern const TransparentBlitProcs g_transparentBlitProcsNEON;
+#endif
+
+/**
+ * Return the fastest set of kernels supported by the CPU we run on.
+ */
+const TransparentBlitProcs &getTransparentBlitProcs();
+
+} // End of namespace Graphics
+
+#endif
@@ -0,0 +1,158 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+#include "graphics/transparent_surface_blit.h"
+
+#include <arm_neon.h>
+
+namespace Graphics {
+
+// All kernels expect little endian pixels, i.e. the alpha channel in the
+// first byte of every pixel, see getTransparentBlitProcs(). The pixels are
+// deinterleaved on load, so val[0] holds alpha, val[1] blue, val[2] green
+// and val[3] red.
+
+/**
+ * Load eight input pixels, in output order.
+ */
+static inline uint8x8x4_t loadPixels(const byte *in, int32 inStep) {
+	if (inStep > 0)
+		return vld4_u8(in);
+
+	uint8x8x4_t pixels = vld4_u8(in - 28);
+	for (int c = 0; c < 4; ++c)
+		pixels.val[c] = vrev64_u8(pixels.val[c]);
+	return pixels;
+}
+
+static void doBlitOpaqueNEON(const byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep) {
+	const uint32 blocks = width / 8;
+
+	for (uint32 i = 0; i < height; i++) {
+		// Like the scalar version, this always reads the row in order
+		const byte *in = ino;
+		byte *out = outo;
+		for (uint32 j = 0; j < blocks; j++) {
+			uint8x8x4_t pixels = vld4_u8(in);
+			pixels.val[0] = vdup_n_u8(0xFF);
+			vst4_u8(out, pixels);
+			in += 32;
+			out += 32;
+		}
+		if (width & 7)
+			g_transparentBlitProcsScalar.opaque(in, out, width & 7, 1, pitch, inStep, inoStep);
+
+		outo += pitch;
+		ino += inoStep;
+	}
+}
+
+static void doBlitBinaryNEON(const byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep) {
+	const uint32 blocks = width / 8;
+
+	for (uint32 i = 0; i < height; i++) {
+		const byte *in = ino;
+		byte *out = outo;
+		for (uint32 j = 0; j < blocks; j++) {
+			const uint8x8x4_t pixels = loadPixels(in, inStep);
+			uint8x8x4_t dst = vld4_u8(out);
+			const uint8x8_t transparent = vceq_u8(pixels.val[0], vdup_n_u8(0));
+
+			dst.val[0] = vbsl_u8(transparent, dst.val[0], vdup_n_u8(0xFF));
+			for (int c = 1; c < 4; ++c)
+				dst.val[c] = vbsl_u8(transparent, dst.val[c], pixels.val[c]);
+
+			vst4_u8(out, dst);
+			in += 8 * inStep;
+			out += 32;
+		}
+		if (width & 7)
+			g_transparentBlitProcsScalar.binary(in, out, width & 7, 1, pitch, inStep, inoStep);
+
+		outo += pitch;
+		ino += inoStep;
+	}
+}
+
+static void doBlitAlphaBlendNEON(const byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	const uint32 blocks = width / 8;
+
+	const bool colorMod = (color != 0xFFFFFFFF);
+	uint8x8_t cmod[4];
+	cmod[0] = vdup_n_u8((color >> 24) & 0xFF);
+	cmod[1] = vdup_n_u8(color & 0xFF);
+	cmod[2] = vdup_n_u8((color >> 8) & 0xFF);
+	cmod[3] = vdup_n_u8((color >> 16) & 0xFF);
+	const uint8x8_t opaque = vdup_n_u8(0xFF);
+
+	for (uint32 i = 0; i < height; i++) {
+		const byte *in = ino;
+		byte *out = outo;
+		for (uint32 j = 0; j < blocks; j++) {
+			const uint8x8x4_t pixels = loadPixels(in, inStep);
+			uint8x8x4_t dst = vld4_u8(out);
+
+			if (colorMod) {
+				const uint8x8_t ina = vshrn_n_u16(vmull_u8(pixels.val[0], cmod[0]), 8);
+				const uint8x8_t invA = vsub_u8(opaque, ina);
+				const uint16x8_t ina16 = vmovl_u8(ina);
+
+				for (int c = 1; c < 4; ++c) {
+					const uint8x8_t d = vshrn_n_u16(vmull_u8(dst.val[c], invA), 8);
+					// (in * c * ina) >> 16, where in * c still fits into 16 bits
+					const uint16x8_t t = vmull_u8(pixels.val[c], cmod[c]);
+					const uint16x4_t lo = vshrn_n_u32(vmull_u16(vget_low_u16(t), vget_low_u16(ina16)), 16);
+					const uint16x4_t hi = vshrn_n_u32(vmull_u16(vget_high_u16(t), vget_high_u16(ina16)), 16);
+					dst.val[c] = vadd_u8(d, vmovn_u16(vcombine_u16(lo, hi)));
+				}
+				dst.val[0] = opaque;
+			} else {
+				// Fully transparent pixels are left alone
+				const uint8x8_t a = pixels.val[0];
+				const uint8x8_t invA = vsub_u8(opaque, a);
+				const uint8x8_t transparent = vceq_u8(a, vdup_n_u8(0));
+
+				for (int c = 1; c < 4; ++c) {
+					const uint8x8_t blended = vshrn_n_u16(vmlal_u8(vmull_u8(pixels.val[c], a), dst.val[c], invA), 8);
+					dst.val[c] = vbsl_u8(transparent, dst.val[c], blended);
+				}
+				dst.val[0] = vbsl_u8(transparent, dst.val[0], opaque);
+			}
+
+			vst4_u8(out, dst);
+			in += 8 * inStep;
+			out += 32;
+		}
+		if (width & 7)
+			g_transparentBlitProcsScalar.alphaBlend(in, out, width & 7, 1, pitch, inStep, inoStep, color);
+
+		outo += pitch;
+		ino += inoStep;
+	}
+}
+
+const TransparentBlitProcs g_transparentBlitProcsNEON = {
+	doBlitOpaqueNEON,
+	doBlitBinaryNEON,
+	doBlitAlphaBlendNEON
+};
+
+} // End of namespace Graphics
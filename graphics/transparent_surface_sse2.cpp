@@ -0,0 +1,175 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+#include "graphics/transparent_surface_blit.h"
+
+#include <emmintrin.h>
+
+namespace Graphics {
+
+// All kernels expect little endian pixels, i.e. the alpha channel in the
+// lowest byte of every 32 bit lane, see getTransparentBlitProcs().
+
+/**
+ * Load four input pixels, in output order.
+ */
+static inline __m128i loadPixels(const byte *in, int32 inStep) {
+	if (inStep > 0)
+		return _mm_loadu_si128((const __m128i *)in);
+	else
+		return _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(in - 12)), 0x1B);
+}
+
+/**
+ * Broadcast the alpha channel of two pixels with 16 bit channels.
+ */
+static inline __m128i broadcastAlpha(__m128i x) {
+	return _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0x00), 0x00);
+}
+
+static void doBlitOpaqueSSE2(const byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep) {
+	const __m128i alphaMask = _mm_set1_epi32(0xFF);
+	const uint32 blocks = width / 4;
+
+	for (uint32 i = 0; i < height; i++) {
+		// Like the scalar version, this always reads the row in order
+		const byte *in = ino;
+		byte *out = outo;
+		for (uint32 j = 0; j < blocks; j++) {
+			const __m128i pixels = _mm_loadu_si128((const __m128i *)in);
+			_mm_storeu_si128((__m128i *)out, _mm_or_si128(pixels, alphaMask));
+			in += 16;
+			out += 16;
+		}
+		if (width & 3)
+			g_transparentBlitProcsScalar.opaque(in, out, width & 3, 1, pitch, inStep, inoStep);
+
+		outo += pitch;
+		ino += inoStep;
+	}
+}
+
+static void doBlitBinarySSE2(const byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep) {
+	const __m128i alphaMask = _mm_set1_epi32(0xFF);
+	const uint32 blocks = width / 4;
+
+	for (uint32 i = 0; i < height; i++) {
+		const byte *in = ino;
+		byte *out = outo;
+		for (uint32 j = 0; j < blocks; j++) {
+			const __m128i pixels = loadPixels(in, inStep);
+			const __m128i dst = _mm_loadu_si128((const __m128i *)out);
+			const __m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(pixels, alphaMask), _mm_setzero_si128());
+
+			const __m128i result = _mm_or_si128(_mm_and_si128(transparent, dst),
+			                                    _mm_andnot_si128(transparent, _mm_or_si128(pixels, alphaMask)));
+			_mm_storeu_si128((__m128i *)out, result);
+			in += 4 * inStep;
+			out += 16;
+		}
+		if (width & 3)
+			g_transparentBlitProcsScalar.binary(in, out, width & 3, 1, pitch, inStep, inoStep);
+
+		outo += pitch;
+		ino += inoStep;
+	}
+}
+
+/**
+ * Blend two pixels with 16 bit channels: (in * a + out * (255 - a)) >> 8.
+ */
+static inline __m128i blendPixels(__m128i in, __m128i out) {
+	const __m128i a = broadcastAlpha(in);
+	const __m128i invA = _mm_sub_epi16(_mm_set1_epi16(255), a);
+	return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(in, a), _mm_mullo_epi16(out, invA)), 8);
+}
+
+/**
+ * Blend two pixels with 16 bit channels and colour modulation.
+ */
+static inline __m128i blendPixelsColor(__m128i in, __m128i out, __m128i ca, __m128i cmod) {
+	const __m128i ina = _mm_srli_epi16(_mm_mullo_epi16(broadcastAlpha(in), ca), 8);
+	const __m128i invA = _mm_sub_epi16(_mm_set1_epi16(255), ina);
+
+	const __m128i dst = _mm_srli_epi16(_mm_mullo_epi16(out, invA), 8);
+	// (in * c * ina) >> 16, where in * c still fits into 16 bits
+	const __m128i src = _mm_mulhi_epu16(_mm_mullo_epi16(in, cmod), ina);
+	return _mm_add_epi16(dst, src);
+}
+
+static void doBlitAlphaBlendSSE2(const byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	const __m128i alphaMask = _mm_set1_epi32(0xFF);
+	const __m128i zero = _mm_setzero_si128();
+	const uint32 blocks = width / 4;
+
+	const bool colorMod = (color != 0xFFFFFFFF);
+	const short ca = (color >> 24) & 0xFF;
+	const short cr = (color >> 16) & 0xFF;
+	const short cg = (color >> 8) & 0xFF;
+	const short cb = color & 0xFF;
+	const __m128i caVec = _mm_set1_epi16(ca);
+	const __m128i cmod = _mm_set_epi16(cr, cg, cb, 0, cr, cg, cb, 0);
+
+	for (uint32 i = 0; i < height; i++) {
+		const byte *in = ino;
+		byte *out = outo;
+		for (uint32 j = 0; j < blocks; j++) {
+			const __m128i pixels = loadPixels(in, inStep);
+			const __m128i dst = _mm_loadu_si128((const __m128i *)out);
+
+			const __m128i inLo = _mm_unpacklo_epi8(pixels, zero);
+			const __m128i inHi = _mm_unpackhi_epi8(pixels, zero);
+			const __m128i outLo = _mm_unpacklo_epi8(dst, zero);
+			const __m128i outHi = _mm_unpackhi_epi8(dst, zero);
+
+			__m128i result;
+			if (colorMod) {
+				result = _mm_packus_epi16(blendPixelsColor(inLo, outLo, caVec, cmod),
+				                          blendPixelsColor(inHi, outHi, caVec, cmod));
+				result = _mm_or_si128(result, alphaMask);
+			} else {
+				// Fully transparent pixels are left alone
+				result = _mm_packus_epi16(blendPixels(inLo, outLo), blendPixels(inHi, outHi));
+				result = _mm_or_si128(result, alphaMask);
+
+				const __m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(pixels, alphaMask), zero);
+				result = _mm_or_si128(_mm_and_si128(transparent, dst), _mm_andnot_si128(transparent, result));
+			}
+
+			_mm_storeu_si128((__m128i *)out, result);
+			in += 4 * inStep;
+			out += 16;
+		}
+		if (width & 3)
+			g_transparentBlitProcsScalar.alphaBlend(in, out, width & 3, 1, pitch, inStep, inoStep, color);
+
+		outo += pitch;
+		ino += inoStep;
+	}
+}
+
+const TransparentBlitProcs g_transparentBlitProcsSSE2 = {
+	doBlitOpaqueSSE2,
+	doBlitBinarySSE2,
+	doBlitAlphaBlendSSE2
+};
+
+} // End of namespace Graphics
@@ -83,8 +83,10 @@
 // BASIS, AND BROWN UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE,
 // SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
+#include "common/cpudetect.h"
 #include "graphics/surface.h"
 #include "graphics/yuv_to_rgb.h"
+#include "graphics/yuv_to_rgb_simd.h"
 
 namespace Common {
 DECLARE_SINGLETON(Graphics::YUVToRGBManager);
@@ -99,17 +101,46 @@ public:
 	Graphics::PixelFormat getFormat() const { return _format; }
 	YUVToRGBManager::LuminanceScale getScale() const { return _scale; }
 	const uint32 *getRGBToPix() const { return _rgbToPix; }
+	const YUVToRGBRowFormat &getRowFormat() const { return _rowFormat; }
 
 private:
 	Graphics::PixelFormat _format;
 	YUVToRGBManager::LuminanceScale _scale;
 	uint32 _rgbToPix[3 * 768]; // 9216 bytes
+	YUVToRGBRowFormat _rowFormat;
 };
 
 YUVToRGBLookup::YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::LuminanceScale scale) {
 	_format = format;
 	_scale = scale;
 
+	// The same conversion, described for the SIMD kernels
+	_rowFormat.scaleITU = (scale == YUVToRGBManager::kScaleITU);
+	_rowFormat.rLoss = format.rLoss;
+	_rowFormat.gLoss = format.gLoss;
+	_rowFormat.bLoss = format.bLoss;
+	_rowFormat.rShift = format.rShift;
+	_rowFormat.gShift = format.gShift;
+	_rowFormat.bShift = format.bShift;
+	_rowFormat.alpha = format.RGBToColor(0, 0, 0);
+
+	_rowFormat.rByte = _rowFormat.gByte = _rowFormat.bByte = _rowFormat.aByte = -1;
+	_rowFormat.alphaByte = 0;
+	if (format.bytesPerPixel == 4 && format.rLoss == 0 && format.gLoss == 0 && format.bLoss == 0 &&
+			(format.rShift & 7) == 0 && (format.gShift & 7) == 0 && (format.bShift & 7) == 0) {
+		const int rByte = format.rShift >> 3, gByte = format.gShift >> 3, bByte = format.bShift >> 3;
+		const int aByte = 6 - rByte - gByte - bByte;
+
+		// The alpha byte is the one left over, and has to hold all alpha bits
+		if (rByte != gByte && rByte != bByte && gByte != bByte && (_rowFormat.alpha & ~(0xFFU << (aByte * 8))) == 0) {
+			_rowFormat.rByte = rByte;
+			_rowFormat.gByte = gByte;
+			_rowFormat.bByte = bByte;
+			_rowFormat.aByte = aByte;
+			_rowFormat.alphaByte = _rowFormat.alpha >> (aByte * 8);
+		}
+	}
+
 	uint32 *r_2_pix_alloc = &_rgbToPix[0 * 768];
 	uint32 *g_2_pix_alloc = &_rgbToPix[1 * 768];
 	uint32 *b_2_pix_alloc = &_rgbToPix[2 * 768];
@@ -157,6 +188,25 @@ YUVToRGBLookup::YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::Lu
 	}
 }
 
+const YUVToRGBProcs *getYUVToRGBProcs() {
+#ifdef SCUMM_LITTLE_ENDIAN
+	// The SIMD kernels store pixels as little endian integers
+#ifdef SCUMMVM_AVX2
+	if (Common::hasCPUFeature(Common::kCPUFeatureAVX2))
+		return &g_yuvToRGBProcsAVX2;
+#endif
+#ifdef SCUMMVM_SSE2
+	if (Common::hasCPUFeature(Common::kCPUFeatureSSE2))
+		return &g_yuvToRGBProcsSSE2;
+#endif
+#ifdef SCUMMVM_NEON
+	if (Common::hasCPUFeature(Common::kCPUFeatureNEON))
+		return &g_yuvToRGBProcsNEON;
+#endif
+#endif
+	return 0;
+}
+
 YUVToRGBManager::YUVToRGBManager() {
 	_lookup = 0;
 
@@ -197,7 +247,7 @@ const YUVToRGBLookup *YUVToRGBManager::getLookup(Graphics::PixelFormat format, Y
 	*((PixelInt *)(d)) = (L[cr_r] | L[crb_g] | L[cb_b])
 
 template<typename PixelInt>
-void convertYUV444ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+void convertYUV444ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, YUVToRGB444Proc simdProc, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
 	// Keep the tables in pointers here to avoid a dereference on each pixel
 	const int16 *Cr_r_tab = colorTab;
 	const int16 *Cr_g_tab = Cr_r_tab + 256;
@@ -206,7 +256,17 @@ void convertYUV444ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 	const uint32 *rgbToPix = lookup->getRGBToPix();
 
 	for (int h = 0; h < yHeight; h++) {
-		for (int w = 0; w < yWidth; w++) {
+		// Let the SIMD kernel convert as much of the row as it can
+		int start = 0;
+		if (simdProc)
+			start = simdProc(dstPtr, ySrc, uSrc, vSrc, yWidth, lookup->getRowFormat());
+
+		dstPtr += start * sizeof(PixelInt);
+		ySrc += start;
+		uSrc += start;
+		vSrc += start;
+
+		for (int w = start; w < yWidth; w++) {
 			const uint32 *L;
 
 			int16 cr_r  = Cr_r_tab[*vSrc];
@@ -234,16 +294,17 @@ void YUVToRGBManager::convert444(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	assert(ySrc && uSrc && vSrc);
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
+	const YUVToRGBProcs *procs = getYUVToRGBProcs();
 
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
-		convertYUV444ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV444ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, procs ? procs->convert444To16 : 0, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 	else
-		convertYUV444ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV444ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, procs ? procs->convert444To32 : 0, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 }
 
 template<typename PixelInt>
-void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, YUVToRGB420Proc simdProc, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
 	int halfHeight = yHeight >> 1;
 	int halfWidth = yWidth >> 1;
 
@@ -255,7 +316,17 @@ void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 	const uint32 *rgbToPix = lookup->getRGBToPix();
 
 	for (int h = 0; h < halfHeight; h++) {
-		for (int w = 0; w < halfWidth; w++) {
+		// Let the SIMD kernel convert as much of both rows as it can
+		int start = 0;
+		if (simdProc)
+			start = simdProc(dstPtr, dstPitch, ySrc, yPitch, uSrc, vSrc, yWidth, lookup->getRowFormat());
+
+		dstPtr += start * sizeof(PixelInt);
+		ySrc += start;
+		uSrc += start >> 1;
+		vSrc += start >> 1;
+
+		for (int w = start >> 1; w < halfWidth; w++) {
 			const uint32 *L;
 
 			int16 cr_r  = Cr_r_tab[*vSrc];
@@ -274,7 +345,7 @@ void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 			dstPtr += sizeof(PixelInt);
 		}
 
-		dstPtr += dstPitch;
+		dstPtr += (dstPitch << 1) - yWidth * sizeof(PixelInt);
 		ySrc += (yPitch << 1) - yWidth;
 		uSrc += uvPitch - halfWidth;
 		vSrc += uvPitch - halfWidth;
@@ -290,12 +361,13 @@ void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	assert((yHeight & 1) == 0);
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
+	const YUVToRGBProcs *procs = getYUVToRGBProcs();
 
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
-		convertYUV420ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV420ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, procs ? procs->convert420To16 : 0, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 	else
-		convertYUV420ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV420ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, procs ? procs->convert420To32 : 0, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 }
 
 #define READ_QUAD(ptr, prefix) \
@@ -0,0 +1,265 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+#include "graphics/yuv_to_rgb_simd.h"
+
+#include <immintrin.h>
+
+namespace Graphics {
+
+// This works like the SSE2 version, on blocks of 32 pixels. Most AVX2
+// instructions work on the two 128 bit lanes separately, so the first lane
+// of each register holds pixels 0-7 and 16-23, the second one pixels 8-15
+// and 24-31 until the channels are saturated to bytes.
+
+/**
+ * Multiply eight 32 bit values with a constant, truncating the products
+ * towards zero like the color table does.
+ */
+static inline __m256i mulTrunc(__m256 x, float k) {
+	return _mm256_cvttps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(k)));
+}
+
+/**
+ * Narrow two registers of eight 32 bit values to sixteen 16 bit values,
+ * in order.
+ */
+static inline __m256i narrow(__m256i lo, __m256i hi) {
+	return _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xD8);
+}
+
+/**
+ * Compute the red, green and blue offsets of sixteen chroma samples.
+ */
+template<bool scaleITU>
+static inline void chromaOffsets(const byte *uSrc, const byte *vSrc, __m256i &r, __m256i &g, __m256i &b) {
+	const __m256i bias = _mm256_set1_epi32(128);
+	const __m256 uLo = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)uSrc)), bias));
+	const __m256 uHi = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(uSrc + 8))), bias));
+	const __m256 vLo = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)vSrc)), bias));
+	const __m256 vHi = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(vSrc + 8))), bias));
+
+	r = narrow(mulTrunc(vLo, kYUVToRGBCrR), mulTrunc(vHi, kYUVToRGBCrR));
+	g = narrow(_mm256_add_epi32(mulTrunc(vLo, kYUVToRGBCrG), mulTrunc(uLo, kYUVToRGBCbG)),
+	           _mm256_add_epi32(mulTrunc(vHi, kYUVToRGBCrG), mulTrunc(uHi, kYUVToRGBCbG)));
+	b = narrow(mulTrunc(uLo, kYUVToRGBCbB), mulTrunc(uHi, kYUVToRGBCbB));
+
+	if (scaleITU) {
+		r = _mm256_slli_epi16(r, 2);
+		g = _mm256_slli_epi16(g, 2);
+		b = _mm256_slli_epi16(b, 2);
+	}
+}
+
+/**
+ * Prepare sixteen luminance values.
+ */
+template<bool scaleITU>
+static inline __m256i luminance(__m256i y) {
+	if (scaleITU)
+		return _mm256_slli_epi16(_mm256_sub_epi16(y, _mm256_set1_epi16(16)), 2);
+	return y;
+}
+
+/**
+ * Compute sixteen channel values, not yet clamped.
+ */
+template<bool scaleITU>
+static inline __m256i channel(__m256i y, __m256i offset) {
+	if (scaleITU)
+		return _mm256_mulhi_epi16(_mm256_add_epi16(y, offset), _mm256_set1_epi16(kYUVToRGBITUScale));
+	return _mm256_add_epi16(y, offset);
+}
+
+/**
+ * Packs channel values into pixels of the output format.
+ */
+class PixelPackerAVX2 {
+public:
+	PixelPackerAVX2(const YUVToRGBRowFormat &format) :
+		_format(format),
+		_rLoss(_mm_cvtsi32_si128(format.rLoss)), _gLoss(_mm_cvtsi32_si128(format.gLoss)), _bLoss(_mm_cvtsi32_si128(format.bLoss)),
+		_rShift(_mm_cvtsi32_si128(format.rShift)), _gShift(_mm_cvtsi32_si128(format.gShift)), _bShift(_mm_cvtsi32_si128(format.bShift)),
+		_alpha16(_mm256_set1_epi16((int16)format.alpha)), _alphaByte(_mm256_set1_epi8((char)format.alphaByte)) {
+	}
+
+	/** Store 32 16 bit pixels, the channels are given as bytes. */
+	inline void store(uint16 *dst, __m256i r, __m256i g, __m256i b) const {
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i lo = pack16(_mm256_unpacklo_epi8(r, zero), _mm256_unpacklo_epi8(g, zero), _mm256_unpacklo_epi8(b, zero));
+		const __m256i hi = pack16(_mm256_unpackhi_epi8(r, zero), _mm256_unpackhi_epi8(g, zero), _mm256_unpackhi_epi8(b, zero));
+		_mm256_storeu_si256((__m256i *)dst,        _mm256_permute2x128_si256(lo, hi, 0x20));
+		_mm256_storeu_si256((__m256i *)(dst + 16), _mm256_permute2x128_si256(lo, hi, 0x31));
+	}
+
+	/** Store 32 32 bit pixels, the channels are given as bytes. */
+	inline void store(uint32 *dst, __m256i r, __m256i g, __m256i b) const {
+		__m256i bytes[4];
+		bytes[_format.aByte] = _alphaByte;
+		bytes[_format.rByte] = r;
+		bytes[_format.gByte] = g;
+		bytes[_format.bByte] = b;
+
+		const __m256i lo01 = _mm256_unpacklo_epi8(bytes[0], bytes[1]);
+		const __m256i hi01 = _mm256_unpackhi_epi8(bytes[0], bytes[1]);
+		const __m256i lo23 = _mm256_unpacklo_epi8(bytes[2], bytes[3]);
+		const __m256i hi23 = _mm256_unpackhi_epi8(bytes[2], bytes[3]);
+		const __m256i p0 = _mm256_unpacklo_epi16(lo01, lo23);
+		const __m256i p1 = _mm256_unpackhi_epi16(lo01, lo23);
+		const __m256i p2 = _mm256_unpacklo_epi16(hi01, hi23);
+		const __m256i p3 = _mm256_unpackhi_epi16(hi01, hi23);
+		_mm256_storeu_si256((__m256i *)dst,        _mm256_permute2x128_si256(p0, p1, 0x20));
+		_mm256_storeu_si256((__m256i *)(dst + 8),  _mm256_permute2x128_si256(p2, p3, 0x20));
+		_mm256_storeu_si256((__m256i *)(dst + 16), _mm256_permute2x128_si256(p0, p1, 0x31));
+		_mm256_storeu_si256((__m256i *)(dst + 24), _mm256_permute2x128_si256(p2, p3, 0x31));
+	}
+
+private:
+	inline __m256i pack16(__m256i r, __m256i g, __m256i b) const {
+		__m256i p = _alpha16;
+		p = _mm256_or_si256(p, _mm256_sll_epi16(_mm256_srl_epi16(r, _rLoss), _rShift));
+		p = _mm256_or_si256(p, _mm256_sll_epi16(_mm256_srl_epi16(g, _gLoss), _gShift));
+		p = _mm256_or_si256(p, _mm256_sll_epi16(_mm256_srl_epi16(b, _bLoss), _bShift));
+		return p;
+	}
+
+	const YUVToRGBRowFormat &_format;
+	const __m128i _rLoss, _gLoss, _bLoss;
+	const __m128i _rShift, _gShift, _bShift;
+	const __m256i _alpha16, _alphaByte;
+};
+
+/**
+ * Convert 32 pixels, given the chroma offsets in the lane order of the
+ * luminance values.
+ */
+template<typename PixelInt, bool scaleITU>
+static inline void convertBlock(PixelInt *dst, const byte *ySrc, const PixelPackerAVX2 &packer,
+		__m256i rLo, __m256i gLo, __m256i bLo, __m256i rHi, __m256i gHi, __m256i bHi) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i y = _mm256_loadu_si256((const __m256i *)ySrc);
+	const __m256i yLo = luminance<scaleITU>(_mm256_unpacklo_epi8(y, zero));
+	const __m256i yHi = luminance<scaleITU>(_mm256_unpackhi_epi8(y, zero));
+
+	packer.store(dst,
+		_mm256_packus_epi16(channel<scaleITU>(yLo, rLo), channel<scaleITU>(yHi, rHi)),
+		_mm256_packus_epi16(channel<scaleITU>(yLo, gLo), channel<scaleITU>(yHi, gHi)),
+		_mm256_packus_epi16(channel<scaleITU>(yLo, bLo), channel<scaleITU>(yHi, bHi)));
+}
+
+template<typename PixelInt, bool scaleITU>
+static int convert444(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBRowFormat &format) {
+	const PixelPackerAVX2 packer(format);
+	const int blocks = width / 32;
+	PixelInt *out = (PixelInt *)dst;
+
+	for (int i = 0; i < blocks; i++) {
+		__m256i r0, g0, b0, r1, g1, b1;
+		chromaOffsets<scaleITU>(uSrc, vSrc, r0, g0, b0);
+		chromaOffsets<scaleITU>(uSrc + 16, vSrc + 16, r1, g1, b1);
+
+		convertBlock<PixelInt, scaleITU>(out, ySrc, packer,
+			_mm256_permute2x128_si256(r0, r1, 0x20), _mm256_permute2x128_si256(g0, g1, 0x20), _mm256_permute2x128_si256(b0, b1, 0x20),
+			_mm256_permute2x128_si256(r0, r1, 0x31), _mm256_permute2x128_si256(g0, g1, 0x31), _mm256_permute2x128_si256(b0, b1, 0x31));
+
+		ySrc += 32;
+		uSrc += 32;
+		vSrc += 32;
+		out += 32;
+	}
+
+	return blocks * 32;
+}
+
+template<typename PixelInt, bool scaleITU>
+static int convert420(byte *dst, int dstPitch, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBRowFormat &format) {
+	const PixelPackerAVX2 packer(format);
+	const int blocks = width / 32;
+	PixelInt *out = (PixelInt *)dst;
+
+	for (int i = 0; i < blocks; i++) {
+		// Every chroma sample covers two pixels in both rows
+		__m256i r, g, b;
+		chromaOffsets<scaleITU>(uSrc, vSrc, r, g, b);
+
+		const __m256i rLo = _mm256_unpacklo_epi16(r, r), rHi = _mm256_unpackhi_epi16(r, r);
+		const __m256i gLo = _mm256_unpacklo_epi16(g, g), gHi = _mm256_unpackhi_epi16(g, g);
+		const __m256i bLo = _mm256_unpacklo_epi16(b, b), bHi = _mm256_unpackhi_epi16(b, b);
+		convertBlock<PixelInt, scaleITU>(out, ySrc, packer, rLo, gLo, bLo, rHi, gHi, bHi);
+		convertBlock<PixelInt, scaleITU>((PixelInt *)((byte *)out + dstPitch), ySrc + yPitch, packer, rLo, gLo, bLo, rHi, gHi, bHi);
+
+		ySrc += 32;
+		uSrc += 16;
+		vSrc += 16;
+		out += 32;
+	}
+
+	return blocks * 32;
+}
+
+template<typename PixelInt>
+static int convert444AVX2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBRowFormat &format) {
+	if (sizeof(PixelInt) == 4 && format.rByte < 0)
+		return 0;
+
+	int done;
+	if (format.scaleITU)
+		done = convert444<PixelInt, true>(dst, ySrc, uSrc, vSrc, width, format);
+	else
+		done = convert444<PixelInt, false>(dst, ySrc, uSrc, vSrc, width, format);
+
+#ifdef SCUMMVM_SSE2
+	// Leave a remaining block of 16 pixels to the SSE2 kernel
+	YUVToRGB444Proc sse2 = sizeof(PixelInt) == 2 ? g_yuvToRGBProcsSSE2.convert444To16 : g_yuvToRGBProcsSSE2.convert444To32;
+	done += sse2(dst + done * sizeof(PixelInt), ySrc + done, uSrc + done, vSrc + done, width - done, format);
+#endif
+
+	return done;
+}
+
+template<typename PixelInt>
+static int convert420AVX2(byte *dst, int dstPitch, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBRowFormat &format) {
+	if (sizeof(PixelInt) == 4 && format.rByte < 0)
+		return 0;
+
+	int done;
+	if (format.scaleITU)
+		done = convert420<PixelInt, true>(dst, dstPitch, ySrc, yPitch, uSrc, vSrc, width, format);
+	else
+		done = convert420<PixelInt, false>(dst, dstPitch, ySrc, yPitch, uSrc, vSrc, width, format);
+
+#ifdef SCUMMVM_SSE2
+	// Leave a remaining block of 16 pixels to the SSE2 kernel
+	YUVToRGB420Proc sse2 = sizeof(PixelInt) == 2 ? g_yuvToRGBProcsSSE2.convert420To16 : g_yuvToRGBProcsSSE2.convert420To32;
+	done += sse2(dst + done * sizeof(PixelInt), dstPitch, ySrc + done, yPitch, uSrc + done / 2, vSrc + done / 2, width - done, format);
+#endif
+
+	return done;
+}
+
+const YUVToRGBProcs g_yuvToRGBProcsAVX2 = {
+	convert444AVX2<uint16>,
+	convert444AVX2<uint32>,
+	convert420AVX2<uint16>,
+	convert420AVX2<uint32>
+};
+
+} // End of namespace Graphics
@@ -0,0 +1,220 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+#include "graphics/yuv_to_rgb_simd.h"
+
+#include <arm_neon.h>
+
+namespace Graphics {
+
+// This works like the SSE2 version, on blocks of 16 pixels. vqdmulhq_s16
+// doubles the product, so it is used with half of kYUVToRGBITUScale.
+
+/**
+ * Multiply eight 32 bit values with a constant, truncating the products
+ * towards zero like the color table does, and narrow them to 16 bits.
+ */
+static inline int16x8_t mulTrunc(float32x4_t lo, float32x4_t hi, float k) {
+	return vcombine_s16(vmovn_s32(vcvtq_s32_f32(vmulq_n_f32(lo, k))), vmovn_s32(vcvtq_s32_f32(vmulq_n_f32(hi, k))));
+}
+
+/**
+ * Compute the red, green and blue offsets of eight chroma samples.
+ */
+template<bool scaleITU>
+static inline void chromaOffsets(const byte *uSrc, const byte *vSrc, int16x8_t &r, int16x8_t &g, int16x8_t &b) {
+	const int16x8_t bias = vdupq_n_s16(128);
+	const int16x8_t u = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(uSrc))), bias);
+	const int16x8_t v = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(vSrc))), bias);
+	const float32x4_t uLo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(u)));
+	const float32x4_t uHi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(u)));
+	const float32x4_t vLo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v)));
+	const float32x4_t vHi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(v)));
+
+	r = mulTrunc(vLo, vHi, kYUVToRGBCrR);
+	g = vaddq_s16(mulTrunc(vLo, vHi, kYUVToRGBCrG), mulTrunc(uLo, uHi, kYUVToRGBCbG));
+	b = mulTrunc(uLo, uHi, kYUVToRGBCbB);
+
+	if (scaleITU) {
+		r = vshlq_n_s16(r, 2);
+		g = vshlq_n_s16(g, 2);
+		b = vshlq_n_s16(b, 2);
+	}
+}
+
+/**
+ * Prepare eight luminance values.
+ */
+template<bool scaleITU>
+static inline int16x8_t luminance(uint8x8_t y) {
+	const int16x8_t y16 = vreinterpretq_s16_u16(vmovl_u8(y));
+	if (scaleITU)
+		return vshlq_n_s16(vsubq_s16(y16, vdupq_n_s16(16)), 2);
+	return y16;
+}
+
+/**
+ * Compute eight channel values, not yet clamped.
+ */
+template<bool scaleITU>
+static inline int16x8_t channel(int16x8_t y, int16x8_t offset) {
+	if (scaleITU)
+		return vqdmulhq_n_s16(vaddq_s16(y, offset), kYUVToRGBITUScale / 2);
+	return vaddq_s16(y, offset);
+}
+
+/**
+ * Packs channel values into pixels of the output format.
+ */
+class PixelPackerNEON {
+public:
+	PixelPackerNEON(const YUVToRGBRowFormat &format) :
+		_format(format),
+		_rLoss(vdupq_n_s16(-format.rLoss)), _gLoss(vdupq_n_s16(-format.gLoss)), _bLoss(vdupq_n_s16(-format.bLoss)),
+		_rShift(vdupq_n_s16(format.rShift)), _gShift(vdupq_n_s16(format.gShift)), _bShift(vdupq_n_s16(format.bShift)),
+		_alpha16(vdupq_n_u16((uint16)format.alpha)), _alphaByte(vdupq_n_u8(format.alphaByte)) {
+	}
+
+	/** Store sixteen 16 bit pixels, the channels are given as bytes. */
+	inline void store(uint16 *dst, uint8x16_t r, uint8x16_t g, uint8x16_t b) const {
+		vst1q_u16(dst, pack16(vmovl_u8(vget_low_u8(r)), vmovl_u8(vget_low_u8(g)), vmovl_u8(vget_low_u8(b))));
+		vst1q_u16(dst + 8, pack16(vmovl_u8(vget_high_u8(r)), vmovl_u8(vget_high_u8(g)), vmovl_u8(vget_high_u8(b))));
+	}
+
+	/** Store sixteen 32 bit pixels, the channels are given as bytes. */
+	inline void store(uint32 *dst, uint8x16_t r, uint8x16_t g, uint8x16_t b) const {
+		uint8x16x4_t bytes;
+		bytes.val[_format.aByte] = _alphaByte;
+		bytes.val[_format.rByte] = r;
+		bytes.val[_format.gByte] = g;
+		bytes.val[_format.bByte] = b;
+		vst4q_u8((uint8_t *)dst, bytes);
+	}
+
+private:
+	inline uint16x8_t pack16(uint16x8_t r, uint16x8_t g, uint16x8_t b) const {
+		// Negative counts shift right
+		uint16x8_t p = _alpha16;
+		p = vorrq_u16(p, vshlq_u16(vshlq_u16(r, _rLoss), _rShift));
+		p = vorrq_u16(p, vshlq_u16(vshlq_u16(g, _gLoss), _gShift));
+		p = vorrq_u16(p, vshlq_u16(vshlq_u16(b, _bLoss), _bShift));
+		return p;
+	}
+
+	const YUVToRGBRowFormat &_format;
+	const int16x8_t _rLoss, _gLoss, _bLoss;
+	const int16x8_t _rShift, _gShift, _bShift;
+	const uint16x8_t _alpha16;
+	const uint8x16_t _alphaByte;
+};
+
+/**
+ * Convert sixteen pixels, given the chroma offsets for the first and the
+ * last eight of them.
+ */
+template<typename PixelInt, bool scaleITU>
+static inline void convertBlock(PixelInt *dst, const byte *ySrc, const PixelPackerNEON &packer,
+		int16x8_t rLo, int16x8_t gLo, int16x8_t bLo, int16x8_t rHi, int16x8_t gHi, int16x8_t bHi) {
+	const uint8x16_t y = vld1q_u8(ySrc);
+	const int16x8_t yLo = luminance<scaleITU>(vget_low_u8(y));
+	const int16x8_t yHi = luminance<scaleITU>(vget_high_u8(y));
+
+	packer.store(dst,
+		vcombine_u8(vqmovun_s16(channel<scaleITU>(yLo, rLo)), vqmovun_s16(channel<scaleITU>(yHi, rHi))),
+		vcombine_u8(vqmovun_s16(channel<scaleITU>(yLo, gLo)), vqmovun_s16(channel<scaleITU>(yHi, gHi))),
+		vcombine_u8(vqmovun_s16(channel<scaleITU>(yLo, bLo)), vqmovun_s16(channel<scaleITU>(yHi, bHi))));
+}
+
+template<typename PixelInt, bool scaleITU>
+static int convert444(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBRowFormat &format) {
+	const PixelPackerNEON packer(format);
+	const int blocks = width / 16;
+	PixelInt *out = (PixelInt *)dst;
+
+	for (int i = 0; i < blocks; i++) {
+		int16x8_t rLo, gLo, bLo, rHi, gHi, bHi;
+		chromaOffsets<scaleITU>(uSrc, vSrc, rLo, gLo, bLo);
+		chromaOffsets<scaleITU>(uSrc + 8, vSrc + 8, rHi, gHi, bHi);
+		convertBlock<PixelInt, scaleITU>(out, ySrc, packer, rLo, gLo, bLo, rHi, gHi, bHi);
+
+		ySrc += 16;
+		uSrc += 16;
+		vSrc += 16;
+		out += 16;
+	}
+
+	return blocks * 16;
+}
+
+template<typename PixelInt, bool scaleITU>
+static int convert420(byte *dst, int dstPitch, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBRowFormat &format) {
+	const PixelPackerNEON packer(format);
+	const int blocks = width / 16;
+	PixelInt *out = (PixelInt *)dst;
+
+	for (int i = 0; i < blocks; i++) {
+		// Every chroma sample covers two pixels in both rows
+		int16x8_t r, g, b;
+		chromaOffsets<scaleITU>(uSrc, vSrc, r, g, b);
+
+		const int16x8x2_t r2 = vzipq_s16(r, r);
+		const int16x8x2_t g2 = vzipq_s16(g, g);
+		const int16x8x2_t b2 = vzipq_s16(b, b);
+		convertBlock<PixelInt, scaleITU>(out, ySrc, packer, r2.val[0], g2.val[0], b2.val[0], r2.val[1], g2.val[1], b2.val[1]);
+		convertBlock<PixelInt, scaleITU>((PixelInt *)((byte *)out + dstPitch), ySrc + yPitch, packer, r2.val[0], g2.val[0], b2.val[0], r2.val[1], g2.val[1], b2.val[1]);
+
+		ySrc += 16;
+		uSrc += 8;
+		vSrc += 8;
+		out += 16;
+	}
+
+	return blocks * 16;
+}
+
+template<typename PixelInt>
+static int convert444NEON(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBRowFormat &format) {
+	if (sizeof(PixelInt) == 4 && format.rByte < 0)
+		return 0;
+
+	if (format.scaleITU)
+		return convert444<PixelInt, true>(dst, ySrc, uSrc, vSrc, width, format);
+	return convert444<PixelInt, false>(dst, ySrc, uSrc, vSrc, width, format);
+}
+
+template<typename PixelInt>
+static int convert420NEON(byte *dst, int dstPitch, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBRowFormat &format) {
+	if (sizeof(PixelInt) == 4 && format.rByte < 0)
+		return 0;
+
+	if (format.scaleITU)
+		return convert420<PixelInt, true>(dst, dstPitch, ySrc, yPitch, uSrc, vSrc, width, format);
+	return convert420<PixelInt, false>(dst, dstPitch, ySrc, yPitch, uSrc, vSrc, width, format);
+}
+
+const YUVToRGBProcs g_yuvToRGBProcsNEON = {
+	convert444NEON<uint16>,
+	convert444NEON<uint32>,
+	convert420NEON<uint16>,
+	convert420NEON<uint32>
+};
+
+} // End of namespace Graphics
@@ -0,0 +1,121 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+#ifndef GRAPHICS_YUV_TO_RGB_SIMD_H
+#define GRAPHICS_YUV_TO_RGB_SIMD_H
+
+#include "common/scummsys.h"
+
+namespace Graphics {
+
+/**
+ * The chroma coefficients used to build the YUVToRGBManager color table.
+ * Multiplying a chroma value from -128 to 127 with them in single precision
+ * and truncating gives the same results as the table, which is built using
+ * double precision.
+ */
+static const float kYUVToRGBCrR =  (float)(0.419 / 0.299);
+static const float kYUVToRGBCrG = -(float)(0.299 / 0.419);
+static const float kYUVToRGBCbG = -(float)(0.114 / 0.331);
+static const float kYUVToRGBCbB =  (float)(0.587 / 0.331);
+
+/**
+ * The ITU luminance range is scaled with a signed 16 bit multiplication:
+ * for x = c - 16, ((x << 2) * kYUVToRGBITUScale) >> 16 equals
+ * (x * 255) / 219 for all x from 0 to 219. It is negative for c < 16 and
+ * at least 255 for c > 235, so saturating to 0..255 afterwards gives the
+ * same result as clamping c to 16..235 first.
+ */
+static const int kYUVToRGBITUScale = 19078;
+
+/**
+ * How the SIMD kernels pack the RGB channels into a pixel.
+ */
+struct YUVToRGBRowFormat {
+	bool scaleITU;   ///< Luminance values range from 16 to 235 instead of 0 to 255
+	byte rLoss, gLoss, bLoss;
+	byte rShift, gShift, bShift;
+	uint32 alpha;    ///< Bits to set in every pixel for an opaque alpha channel
+
+	/**
+	 * For 32 bit formats with one byte per channel, the byte of the pixel
+	 * holding each channel, and the value of the alpha byte. The positions
+	 * are -1 for formats the kernels can't store directly.
+	 */
+	int8 rByte, gByte, bByte, aByte;
+	byte alphaByte;
+};
+
+/**
+ * Converts the start of one row of YUV444 pixels into 16 or 32 bit RGB
+ * pixels.
+ *
+ * @param dst    a pointer to the first output pixel
+ * @param ySrc   a pointer to the first luminance value
+ * @param uSrc   a pointer to the first u value
+ * @param vSrc   a pointer to the first v value
+ * @param width  number of pixels in the row
+ * @param format the output pixel format
+ * @return the number of pixels converted. Kernels only convert whole
+ *         blocks of pixels, the rest is left to the lookup tables.
+ */
+typedef int (*YUVToRGB444Proc)(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBRowFormat &format);
+
+/**
+ * Converts the start of two rows of YUV420 pixels, which share one row of
+ * chroma samples, into 16 or 32 bit RGB pixels. The parameters match
+ * YUVToRGB444Proc, dstPitch and yPitch lead to the second row.
+ *
+ * @return the number of pixels converted in each row, always even
+ */
+typedef int (*YUVToRGB420Proc)(byte *dst, int dstPitch, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBRowFormat &format);
+
+/**
+ * The set of YUV to RGB kernels for one instruction set.
+ */
+struct YUVToRGBProcs {
+	YUVToRGB444Proc convert444To16;
+	YUVToRGB444Proc convert444To32;
+	YUVToRGB420Proc convert420To16;
+	YUVToRGB420Proc convert420To32;
+};
+
+#ifdef SCUMMVM_SSE2
+extern const YUVToRGBProcs g_yuvToRGBProcsSSE2;
+#endif
+
+#ifdef SCUMMVM_AVX2
+extern const YUVToRGBProcs g_yuvToRGBProcsAVX2;
+#endif
+
+#ifdef SCUMMVM_NEON
+extern const YUVToRGBProcs g_yuvToRGBProcsNEON;
+#endif
+
+/**
+ * Return the fastest set of kernels supported by the CPU we run on,
+ * or 0 if only the lookup tables can be used.
+ */
+const YUVToRGBProcs *getYUVToRGBProcs();
+
+} // End of namespace Graphics
+
+#endif
@@ -0,0 +1,231 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+#include "graphics/yuv_to_rgb_simd.h"
+
+#include <emmintrin.h>
+
+namespace Graphics {
+
+// The channels are computed in signed 16 bit lanes as luminance plus chroma
+// offset. With the ITU scale, both are premultiplied by four and biased so
+// that a single multiplication does the scaling, see kYUVToRGBITUScale.
+// Saturating to bytes does the clamping of the rgb-to-pixel tables.
+
+/**
+ * Multiply eight 32 bit values with a constant, truncating the products
+ * towards zero like the color table does, and narrow them to 16 bits.
+ */
+static inline __m128i mulTrunc(__m128 lo, __m128 hi, float k) {
+	const __m128 factor = _mm_set1_ps(k);
+	return _mm_packs_epi32(_mm_cvttps_epi32(_mm_mul_ps(lo, factor)), _mm_cvttps_epi32(_mm_mul_ps(hi, factor)));
+}
+
+/**
+ * Compute the red, green and blue offsets of eight chroma samples.
+ */
+template<bool scaleITU>
+static inline void chromaOffsets(const byte *uSrc, const byte *vSrc, __m128i &r, __m128i &g, __m128i &b) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i bias = _mm_set1_epi32(128);
+	const __m128i u = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)uSrc), zero);
+	const __m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)vSrc), zero);
+	const __m128 uLo = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_unpacklo_epi16(u, zero), bias));
+	const __m128 uHi = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_unpackhi_epi16(u, zero), bias));
+	const __m128 vLo = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_unpacklo_epi16(v, zero), bias));
+	const __m128 vHi = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_unpackhi_epi16(v, zero), bias));
+
+	r = mulTrunc(vLo, vHi, kYUVToRGBCrR);
+	g = _mm_add_epi16(mulTrunc(vLo, vHi, kYUVToRGBCrG), mulTrunc(uLo, uHi, kYUVToRGBCbG));
+	b = mulTrunc(uLo, uHi, kYUVToRGBCbB);
+
+	if (scaleITU) {
+		r = _mm_slli_epi16(r, 2);
+		g = _mm_slli_epi16(g, 2);
+		b = _mm_slli_epi16(b, 2);
+	}
+}
+
+/**
+ * Prepare eight luminance values.
+ */
+template<bool scaleITU>
+static inline __m128i luminance(__m128i y) {
+	if (scaleITU)
+		return _mm_slli_epi16(_mm_sub_epi16(y, _mm_set1_epi16(16)), 2);
+	return y;
+}
+
+/**
+ * Compute eight channel values, not yet clamped.
+ */
+template<bool scaleITU>
+static inline __m128i channel(__m128i y, __m128i offset) {
+	if (scaleITU)
+		return _mm_mulhi_epi16(_mm_add_epi16(y, offset), _mm_set1_epi16(kYUVToRGBITUScale));
+	return _mm_add_epi16(y, offset);
+}
+
+/**
+ * Packs channel values into pixels of the output format.
+ */
+class PixelPackerSSE2 {
+public:
+	PixelPackerSSE2(const YUVToRGBRowFormat &format) :
+		_format(format),
+		_rLoss(_mm_cvtsi32_si128(format.rLoss)), _gLoss(_mm_cvtsi32_si128(format.gLoss)), _bLoss(_mm_cvtsi32_si128(format.bLoss)),
+		_rShift(_mm_cvtsi32_si128(format.rShift)), _gShift(_mm_cvtsi32_si128(format.gShift)), _bShift(_mm_cvtsi32_si128(format.bShift)),
+		_alpha16(_mm_set1_epi16((int16)format.alpha)), _alphaByte(_mm_set1_epi8((char)format.alphaByte)) {
+	}
+
+	/** Store sixteen 16 bit pixels, the channels are given as bytes. */
+	inline void store(uint16 *dst, __m128i r, __m128i g, __m128i b) const {
+		const __m128i zero = _mm_setzero_si128();
+		_mm_storeu_si128((__m128i *)dst, pack16(_mm_unpacklo_epi8(r, zero), _mm_unpacklo_epi8(g, zero), _mm_unpacklo_epi8(b, zero)));
+		_mm_storeu_si128((__m128i *)(dst + 8), pack16(_mm_unpackhi_epi8(r, zero), _mm_unpackhi_epi8(g, zero), _mm_unpackhi_epi8(b, zero)));
+	}
+
+	/** Store sixteen 32 bit pixels, the channels are given as bytes. */
+	inline void store(uint32 *dst, __m128i r, __m128i g, __m128i b) const {
+		__m128i bytes[4];
+		bytes[_format.aByte] = _alphaByte;
+		bytes[_format.rByte] = r;
+		bytes[_format.gByte] = g;
+		bytes[_format.bByte] = b;
+
+		const __m128i lo01 = _mm_unpacklo_epi8(bytes[0], bytes[1]);
+		const __m128i hi01 = _mm_unpackhi_epi8(bytes[0], bytes[1]);
+		const __m128i lo23 = _mm_unpacklo_epi8(bytes[2], bytes[3]);
+		const __m128i hi23 = _mm_unpackhi_epi8(bytes[2], bytes[3]);
+		_mm_storeu_si128((__m128i *)dst,        _mm_unpacklo_epi16(lo01, lo23));
+		_mm_storeu_si128((__m128i *)(dst + 4),  _mm_unpackhi_epi16(lo01, lo23));
+		_mm_storeu_si128((__m128i *)(dst + 8),  _mm_unpacklo_epi16(hi01, hi23));
+		_mm_storeu_si128((__m128i *)(dst + 12), _mm_unpackhi_epi16(hi01, hi23));
+	}
+
+private:
+	inline __m128i pack16(__m128i r, __m128i g, __m128i b) const {
+		__m128i p = _alpha16;
+		p = _mm_or_si128(p, _mm_sll_epi16(_mm_srl_epi16(r, _rLoss), _rShift));
+		p = _mm_or_si128(p, _mm_sll_epi16(_mm_srl_epi16(g, _gLoss), _gShift));
+		p = _mm_or_si128(p, _mm_sll_epi16(_mm_srl_epi16(b, _bLoss), _bShift));
+		return p;
+	}
+
+	const YUVToRGBRowFormat &_format;
+	const __m128i _rLoss, _gLoss, _bLoss;
+	const __m128i _rShift, _gShift, _bShift;
+	const __m128i _alpha16, _alphaByte;
+};
+
+/**
+ * Convert sixteen pixels, given the chroma offsets for the first and the
+ * last eight of them.
+ */
+template<typename PixelInt, bool scaleITU>
+static inline void convertBlock(PixelInt *dst, const byte *ySrc, const PixelPackerSSE2 &packer,
+		__m128i rLo, __m128i gLo, __m128i bLo, __m128i rHi, __m128i gHi, __m128i bHi) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i y = _mm_loadu_si128((const __m128i *)ySrc);
+	const __m128i yLo = luminance<scaleITU>(_mm_unpacklo_epi8(y, zero));
+	const __m128i yHi = luminance<scaleITU>(_mm_unpackhi_epi8(y, zero));
+
+	packer.store(dst,
+		_mm_packus_epi16(channel<scaleITU>(yLo, rLo), channel<scaleITU>(yHi, rHi)),
+		_mm_packus_epi16(channel<scaleITU>(yLo, gLo), channel<scaleITU>(yHi, gHi)),
+		_mm_packus_epi16(channel<scaleITU>(yLo, bLo), channel<scaleITU>(yHi, bHi)));
+}
+
+template<typename PixelInt, bool scaleITU>
+static int convert444(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBRowFormat &format) {
+	const PixelPackerSSE2 packer(format);
+	const int blocks = width / 16;
+	PixelInt *out = (PixelInt *)dst;
+
+	for (int i = 0; i < blocks; i++) {
+		__m128i rLo, gLo, bLo, rHi, gHi, bHi;
+		chromaOffsets<scaleITU>(uSrc, vSrc, rLo, gLo, bLo);
+		chromaOffsets<scaleITU>(uSrc + 8, vSrc + 8, rHi, gHi, bHi);
+		convertBlock<PixelInt, scaleITU>(out, ySrc, packer, rLo, gLo, bLo, rHi, gHi, bHi);
+
+		ySrc += 16;
+		uSrc += 16;
+		vSrc += 16;
+		out += 16;
+	}
+
+	return blocks * 16;
+}
+
+template<typename PixelInt, bool scaleITU>
+static int convert420(byte *dst, int dstPitch, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBRowFormat &format) {
+	const PixelPackerSSE2 packer(format);
+	const int blocks = width / 16;
+	PixelInt *out = (PixelInt *)dst;
+
+	for (int i = 0; i < blocks; i++) {
+		// Every chroma sample covers two pixels in both rows
+		__m128i r, g, b;
+		chromaOffsets<scaleITU>(uSrc, vSrc, r, g, b);
+
+		const __m128i rLo = _mm_unpacklo_epi16(r, r), rHi = _mm_unpackhi_epi16(r, r);
+		const __m128i gLo = _mm_unpacklo_epi16(g, g), gHi = _mm_unpackhi_epi16(g, g);
+		const __m128i bLo = _mm_unpacklo_epi16(b, b), bHi = _mm_unpackhi_epi16(b, b);
+		convertBlock<PixelInt, scaleITU>(out, ySrc, packer, rLo, gLo, bLo, rHi, gHi, bHi);
+		convertBlock<PixelInt, scaleITU>((PixelInt *)((byte *)out + dstPitch), ySrc + yPitch, packer, rLo, gLo, bLo, rHi, gHi, bHi);
+
+		ySrc += 16;
+		uSrc += 8;
+		vSrc += 8;
+		out += 16;
+	}
+
+	return blocks * 16;
+}
+
+template<typename PixelInt>
+static int convert444SSE2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBRowFormat &format) {
+	if (sizeof(PixelInt) == 4 && format.rByte < 0)
+		return 0;
+
+	if (format.scaleITU)
+		return convert444<PixelInt, true>(dst, ySrc, uSrc, vSrc, width, format);
+	return convert444<PixelInt, false>(dst, ySrc, uSrc, vSrc, width, format);
+}
+
+template<typename PixelInt>
+static int convert420SSE2(byte *dst, int dstPitch, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBRowFormat &format) {
+	if (sizeof(PixelInt) == 4 && format.rByte < 0)
+		return 0;
+
+	if (format.scaleITU)
+		return convert420<PixelInt, true>(dst, dstPitch, ySrc, yPitch, uSrc, vSrc, width, format);
+	return convert420<PixelInt, false>(dst, dstPitch, ySrc, yPitch, uSrc, vSrc, width, format);
+}
+
+const YUVToRGBProcs g_yuvToRGBProcsSSE2 = {
+	convert444SSE2<uint16>,
+	convert444SSE2<uint32>,
+	convert420SSE2<uint16>,
+	convert420SSE2<uint32>
+};
+
+} // End of namespace Graphics
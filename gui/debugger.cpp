@@ -34,6 +34,8 @@
 #include "common/stream.h"
 #endif
 
+#include "audio/mixer_intern.h"
+
 #include "engines/engine.h"
 
 #include "gui/debugger.h"
@@ -78,6 +80,8 @@ Debugger::Debugger() {
 	registerCmd("debugflag_list",		WRAP_METHOD(Debugger, cmdDebugFlagsList));
 	registerCmd("debugflag_enable",	WRAP_METHOD(Debugger, cmdDebugFlagEnable));
 	registerCmd("debugflag_disable",	WRAP_METHOD(Debugger, cmdDebugFlagDisable));
+
+	registerCmd("mixer_stats",		WRAP_METHOD(Debugger, cmdMixerStats));
 }
 
 Debugger::~Debugger() {
@@ -781,6 +785,42 @@ bool Debugger::cmdDebugFlagDisable(int argc, const char **argv) {
 	return true;
 }
 
+static Common::String formatHistogram(const char *name, const Audio::MixerImpl::Histogram &histogram) {
+	Common::String line = Common::String::format("%-20s", name);
+	for (int i = 0; i < Audio::MixerImpl::Histogram::kNumBuckets; i++)
+		line += Common::String::format(" %7u", histogram.buckets[i]);
+	return line + Common::String::format(" %5u\n", histogram.max);
+}
+
+bool Debugger::cmdMixerStats(int argc, const char **argv) {
+	Audio::MixerImpl *mixer = dynamic_cast<Audio::MixerImpl *>(g_system->getMixer());
+	if (!mixer) {
+		debugPrintf("The mixer of this backend does not collect statistics\n");
+		return true;
+	}
+
+	if (argc > 1) {
+		if (scumm_stricmp(argv[1], "reset")) {
+			debugPrintf("Usage: %s [reset]\n", argv[0]);
+			return true;
+		}
+		mixer->resetStats();
+		debugPrintf("Mixer statistics reset\n");
+		return true;
+	}
+
+	const Audio::MixerImpl::Stats stats = mixer->getStats();
+	debugPrintf("Number of calls per duration in ms, and the longest duration:\n");
+	debugPrintf("%-20s %7s %7s %7s %7s %7s %7s %7s %7s %5s\n", "", "<1", "1", "2-3", "4-7", "8-15", "16-31", "32-63", ">=64", "max");
+	debugPrintf("%s", formatHistogram("callback", stats.callbackTime).c_str());
+	debugPrintf("%s", formatHistogram("callback lock wait", stats.callbackLockWait).c_str());
+	debugPrintf("%s", formatHistogram("callback lock hold", stats.callbackLockHold).c_str());
+	debugPrintf("%s", formatHistogram("engine lock wait", stats.engineLockWait).c_str());
+	debugPrintf("%s", formatHistogram("engine lock hold", stats.engineLockHold).c_str());
+	debugPrintf("Channel changes: %u queued, %u applied directly\n", stats.queuedCommands, stats.directCommands);
+	return true;
+}
+
 // Console handler
 #ifndef USE_TEXT_CONSOLE_FOR_DEBUGGER
 bool Debugger::debuggerInputCallback(GUI::ConsoleDialog *console, const char *input, void *refCon) {
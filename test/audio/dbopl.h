@@ -0,0 +1,112 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/softsynth/opl/dbopl.h"
+#include "common/cpudetect.h"
+
+#ifndef DISABLE_DOSBOX_OPL
+
+class DBOPLTestSuite : public CxxTest::TestSuite
+{
+private:
+	uint32 _seed;
+
+	byte nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return (byte)(_seed >> 16);
+	}
+
+	// Register offset of the first operator of a channel, the second one is 3 higher
+	static uint32 operatorOffset(int channel) {
+		return (channel / 3) * 8 + channel % 3;
+	}
+
+	void setupChannel(OPL::DOSBox::DBOPL::Chip &chip, uint32 bank, int channel, bool opl3) {
+		for (int op = 0; op < 2; ++op) {
+			const uint32 offset = bank + operatorOffset(channel) + op * 3;
+			// Mix sustaining and decaying instruments, with or without tremolo and vibrato
+			chip.WriteReg(0x20 + offset, nextRandom());
+			chip.WriteReg(0x40 + offset, nextRandom() & (op ? 0x1F : 0xFF));
+			chip.WriteReg(0x60 + offset, nextRandom() | 0x11);
+			chip.WriteReg(0x80 + offset, nextRandom());
+			chip.WriteReg(0xE0 + offset, nextRandom() & 7);
+		}
+		// Feedback, connection and with OPL3 also the panning bits
+		chip.WriteReg(0xC0 + bank + channel, (nextRandom() & 0x0F) | (opl3 ? (nextRandom() & 0x30) : 0));
+	}
+
+	void render(uint32 mask, bool opl3, OPL::DOSBox::DBOPL::Bit32s *output, int total) {
+		Common::setCPUFeatureMask(mask);
+
+		OPL::DOSBox::DBOPL::Chip *chip = new OPL::DOSBox::DBOPL::Chip();
+		OPL::DOSBox::DBOPL::InitTables();
+		chip->Setup(44100);
+		chip->WriteReg(0x01, 0x20);
+		if (opl3)
+			chip->WriteReg(0x105, 1);
+		chip->WriteReg(0xBD, 0xC0);
+
+		const int channels = opl3 ? 18 : 9;
+		const int width = opl3 ? 2 : 1;
+		for (int done = 0; done < total; ) {
+			// Retrigger a few notes between the blocks
+			for (int i = 0; i < 3; ++i) {
+				const int channel = nextRandom() % channels;
+				const uint32 bank = channel >= 9 ? 0x100 : 0;
+				const int index = channel % 9;
+				setupChannel(*chip, bank, index, opl3);
+				chip->WriteReg(0xA0 + bank + index, nextRandom());
+				chip->WriteReg(0xB0 + bank + index, nextRandom() & 0x1F);
+				chip->WriteReg(0xB0 + bank + index, 0x20 | (nextRandom() & 0x1F));
+			}
+
+			// Odd block sizes make sure the scalar remainder is covered
+			const int samples = MIN(total - done, 1 + nextRandom() * 3);
+			if (opl3)
+				chip->GenerateBlock3(samples, output + done * width);
+			else
+				chip->GenerateBlock2(samples, output + done * width);
+			done += samples;
+		}
+
+		delete chip;
+	}
+
+	void compareBlocks(bool opl3) {
+		const int total = 44100;
+		const int size = total * (opl3 ? 2 : 1);
+		OPL::DOSBox::DBOPL::Bit32s *ref = new OPL::DOSBox::DBOPL::Bit32s[size];
+		OPL::DOSBox::DBOPL::Bit32s *out = new OPL::DOSBox::DBOPL::Bit32s[size];
+
+		_seed = 0x1234;
+		render(0, opl3, ref, total);
+
+		// Check every instruction set the CPU supports
+		static const uint32 masks[] = {
+			Common::kCPUFeatureSSE2 | Common::kCPUFeatureNEON,
+			0xFFFFFFFF
+		};
+		for (int i = 0; i < ARRAYSIZE(masks); ++i) {
+			_seed = 0x1234;
+			render(masks[i], opl3, out, total);
+			TS_ASSERT_EQUALS(memcmp(out, ref, size * sizeof(OPL::DOSBox::DBOPL::Bit32s)), 0);
+		}
+
+		delete[] ref;
+		delete[] out;
+	}
+
+public:
+	void tearDown() {
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+	}
+
+	void test_opl2_blocks() {
+		compareBlocks(false);
+	}
+
+	void test_opl3_blocks() {
+		compareBlocks(true);
+	}
+};
+
+#endif
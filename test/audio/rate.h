@@ -0,0 +1,295 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/rate.h"
+#include "audio/rate_mix.h"
+#include "audio/audiostream.h"
+#include "common/cpudetect.h"
+
+#include "helper.h"
+
+class RateConverterTestSuite : public CxxTest::TestSuite
+{
+private:
+	uint32 _seed;
+
+	int16 nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return (int16)(_seed >> 16);
+	}
+
+	void fillRandom(int16 *buf, int count) {
+		for (int i = 0; i < count; ++i)
+			buf[i] = nextRandom();
+
+		// Make sure the extreme values are always covered
+		if (count > 2) {
+			buf[0] = -32768;
+			buf[1] = 32767;
+		}
+	}
+
+	void compareMixProcs(const Audio::RateMixProcs &procs) {
+		static const uint16 volumes[] = { 0, 1, 77, 128, 255, 256, 300, 65535 };
+		const int maxFrames = 67;
+
+		int16 in[maxFrames * 2];
+		int16 out[maxFrames * 2], ref[maxFrames * 2];
+
+		for (int channels = 0; channels < 3; ++channels) {
+			const bool stereo = (channels != 0);
+			const bool reverseStereo = (channels == 2);
+			Audio::RateMixProc proc = Audio::selectRateMixProc(procs, stereo, reverseStereo);
+			Audio::RateMixProc refProc = Audio::selectRateMixProc(Audio::g_rateMixProcsScalar, stereo, reverseStereo);
+
+			for (int frames = 0; frames <= maxFrames; ++frames) {
+				for (int vl = 0; vl < ARRAYSIZE(volumes); ++vl) {
+					const uint16 vr = volumes[ARRAYSIZE(volumes) - 1 - vl];
+
+					fillRandom(in, maxFrames * 2);
+					fillRandom(out, maxFrames * 2);
+					memcpy(ref, out, sizeof(ref));
+
+					proc(out, in, frames, volumes[vl], vr);
+					refProc(ref, in, frames, volumes[vl], vr);
+					TS_ASSERT_EQUALS(memcmp(out, ref, sizeof(ref)), 0);
+				}
+			}
+		}
+
+		// The mixing bus, with sums from silent to far beyond full scale
+		int32 bus[maxFrames * 2], refBus[maxFrames * 2];
+		for (int samples = 0; samples <= maxFrames * 2; ++samples) {
+			for (int i = 0; i < maxFrames * 2; ++i)
+				bus[i] = refBus[i] = (nextRandom() >> (samples % 8)) * (samples % 5);
+
+			fillRandom(in, maxFrames * 2);
+			procs.busAccumulate(bus, in, samples);
+			Audio::g_rateMixProcsScalar.busAccumulate(refBus, in, samples);
+			TS_ASSERT_EQUALS(memcmp(bus, refBus, sizeof(bus)), 0);
+
+			fillRandom(out, maxFrames * 2);
+			memcpy(ref, out, sizeof(ref));
+			procs.busLimit(out, bus, samples);
+			Audio::g_rateMixProcsScalar.busLimit(ref, refBus, samples);
+			TS_ASSERT_EQUALS(memcmp(out, ref, sizeof(ref)), 0);
+		}
+	}
+
+	int16 *convert(Audio::SeekableAudioStream *stream, int inRate, int outRate, bool stereo, bool reverseStereo, int frames, int &written, Audio::ResamplerQuality quality = Audio::kResamplerLinear, Audio::FIRFilterBankCache *cache = 0) {
+		int16 *out = new int16[frames * 2];
+		memset(out, 0, frames * 2 * sizeof(int16));
+
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, stereo, reverseStereo, quality, cache);
+
+		// Use odd chunk sizes so that block boundaries do not line up
+		written = 0;
+		int chunk = 1;
+		while (written < frames) {
+			const int len = MIN(chunk, frames - written);
+			const int res = converter->flow(*stream, out + written * 2, len, 200, 97);
+			written += res;
+			if (res < len)
+				break;
+			chunk = (chunk * 7 + 3) % 1031;
+		}
+
+		delete converter;
+		return out;
+	}
+
+	void compareConverter(int inRate, int outRate, bool stereo, bool reverseStereo, Audio::ResamplerQuality quality = Audio::kResamplerLinear) {
+		const int frames = 3 * outRate / 2;
+		int writtenScalar, writtenSimd;
+
+		Common::setCPUFeatureMask(0);
+		Audio::SeekableAudioStream *s = createSineStream<int16>(inRate, 1, 0, false, stereo);
+		int16 *scalar = convert(s, inRate, outRate, stereo, reverseStereo, frames, writtenScalar, quality);
+		delete s;
+
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+		s = createSineStream<int16>(inRate, 1, 0, false, stereo);
+		int16 *simd = convert(s, inRate, outRate, stereo, reverseStereo, frames, writtenSimd, quality);
+		delete s;
+
+		TS_ASSERT_EQUALS(writtenScalar, writtenSimd);
+		TS_ASSERT_EQUALS(memcmp(scalar, simd, frames * 2 * sizeof(int16)), 0);
+
+		// The stream is only one second long, so conversion has to stop early
+		TS_ASSERT_LESS_THAN(writtenScalar, frames);
+
+		delete[] scalar;
+		delete[] simd;
+	}
+
+	Audio::SeekableAudioStream *createConstantStream(int16 value, int rate, int frames, bool stereo) {
+		const int samples = frames * (stereo ? 2 : 1);
+		int16 *data = (int16 *)malloc(samples * sizeof(int16));
+		for (int i = 0; i < samples; ++i)
+			WRITE_LE_UINT16(&data[i], (stereo && (i & 1)) ? -value : value);
+
+		Common::SeekableReadStream *memStream = new Common::MemoryReadStream((const byte *)data, samples * sizeof(int16), DisposeAfterUse::YES);
+		return Audio::makeRawStream(memStream, rate, Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN | (stereo ? Audio::FLAG_STEREO : 0));
+	}
+
+	void checkFIRConstant(int inRate, int outRate, bool stereo, Audio::ResamplerQuality quality) {
+		const int16 value = 12345;
+		Audio::SeekableAudioStream *s = createConstantStream(value, inRate, inRate, stereo);
+
+		int written;
+		int16 *out = convert(s, inRate, outRate, stereo, false, 2 * outRate, written, quality);
+
+		// All input gets converted, including the tail of the filter
+		TS_ASSERT_EQUALS(written, outRate);
+		TS_ASSERT_DIFFERS(out[(written - 1) * 2], 0);
+
+		// Once the filter is filled, a constant input has to stay constant
+		const int16 expectedL = (value * 200) / 256;
+		const int16 expectedR = ((stereo ? -value : value) * 97) / 256;
+		int maxError = 0;
+		for (int i = written / 4; i < written * 3 / 4; ++i) {
+			maxError = MAX(maxError, ABS(out[i * 2] - expectedL));
+			maxError = MAX(maxError, ABS(out[i * 2 + 1] - expectedR));
+		}
+		TS_ASSERT_LESS_THAN_EQUALS(maxError, 1);
+
+		delete[] out;
+		delete s;
+	}
+
+public:
+	void setUp() {
+		_seed = 0x1234;
+	}
+
+	void tearDown() {
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+	}
+
+	void test_mix_procs_default() {
+		compareMixProcs(Audio::getRateMixProcs());
+	}
+
+	void test_mix_procs_sse2() {
+#ifdef SCUMMVM_SSE2
+		if (Common::hasCPUFeature(Common::kCPUFeatureSSE2))
+			compareMixProcs(Audio::g_rateMixProcsSSE2);
+#endif
+	}
+
+	void test_mix_procs_avx2() {
+#ifdef SCUMMVM_AVX2
+		if (Common::hasCPUFeature(Common::kCPUFeatureAVX2))
+			compareMixProcs(Audio::g_rateMixProcsAVX2);
+#endif
+	}
+
+	void test_mix_procs_neon() {
+#ifdef SCUMMVM_NEON
+		if (Common::hasCPUFeature(Common::kCPUFeatureNEON))
+			compareMixProcs(Audio::g_rateMixProcsNEON);
+#endif
+	}
+
+	void test_bus_limiter() {
+		// Quiet samples pass unchanged
+		for (int32 i = -Audio::kBusLimiterThreshold; i <= Audio::kBusLimiterThreshold; i += 7)
+			TS_ASSERT_EQUALS(Audio::limitBusSample(i), i);
+
+		// Loud ones are compressed monotonically, without ever clipping
+		int prev = Audio::kBusLimiterThreshold;
+		for (int32 i = Audio::kBusLimiterThreshold + 1; i <= 16 * 32768; i += 13) {
+			const int high = Audio::limitBusSample(i);
+			TS_ASSERT(high >= prev);
+			TS_ASSERT(high < 32767);
+			TS_ASSERT_EQUALS(Audio::limitBusSample(-i), -high);
+			prev = high;
+		}
+		TS_ASSERT(prev > 32000);
+	}
+
+	void test_copy_converter() {
+		compareConverter(22050, 22050, false, false);
+		compareConverter(22050, 22050, true, false);
+		compareConverter(22050, 22050, true, true);
+	}
+
+	void test_simple_converter() {
+		compareConverter(44100, 22050, false, false);
+		compareConverter(44100, 11025, true, false);
+		compareConverter(44100, 22050, true, true);
+	}
+
+	void test_linear_converter() {
+		compareConverter(11025, 44100, false, false);
+		compareConverter(22050, 48000, true, false);
+		compareConverter(8000, 44100, true, true);
+	}
+
+	void test_copy_converter_volume() {
+		const int16 data[] = { 1000, -1000, 32767, -32768, 255, -255 };
+		Common::SeekableReadStream *memStream = new Common::MemoryReadStream((const byte *)data, sizeof(data));
+		Audio::SeekableAudioStream *s = Audio::makeRawStream(memStream, 22050, Audio::FLAG_16BITS
+#ifdef SCUMM_LITTLE_ENDIAN
+		                                                     | Audio::FLAG_LITTLE_ENDIAN
+#endif
+		                                                     | Audio::FLAG_STEREO);
+
+		int16 out[8] = { 0, 0, 0, 0, 32767, -32768, 0, 0 };
+		Audio::RateConverter *converter = Audio::makeRateConverter(22050, 22050, true, false);
+		TS_ASSERT_EQUALS(converter->flow(*s, out, 4, 128, 256), 3);
+
+		TS_ASSERT_EQUALS(out[0], 500);
+		TS_ASSERT_EQUALS(out[1], -1000);
+		TS_ASSERT_EQUALS(out[2], 16383);
+		TS_ASSERT_EQUALS(out[3], -32768);
+		TS_ASSERT_EQUALS(out[4], 32767);
+		TS_ASSERT_EQUALS(out[5], -32768);
+		TS_ASSERT_EQUALS(out[6], 0);
+		TS_ASSERT_EQUALS(out[7], 0);
+
+		delete converter;
+		delete s;
+	}
+
+	void test_fir_converter() {
+		compareConverter(11025, 44100, false, false, Audio::kResamplerMedium);
+		compareConverter(22050, 48000, true, false, Audio::kResamplerHigh);
+		compareConverter(44100, 11025, true, true, Audio::kResamplerHigh);
+	}
+
+	void test_fir_converter_constant() {
+		checkFIRConstant(11025, 44100, false, Audio::kResamplerMedium);
+		checkFIRConstant(22050, 44100, true, Audio::kResamplerHigh);
+		checkFIRConstant(22254, 48000, true, Audio::kResamplerHigh);
+		checkFIRConstant(48000, 22050, false, Audio::kResamplerHigh);
+		checkFIRConstant(96000, 8000, true, Audio::kResamplerMedium);
+	}
+
+	void test_fir_filter_bank_cache() {
+		Audio::FIRFilterBankCache cache;
+		const int frames = 44100;
+		int written, writtenCached;
+
+		Audio::SeekableAudioStream *s = createSineStream<int16>(22050, 1, 0, false, true);
+		int16 *out = convert(s, 22050, 44100, true, false, frames, written, Audio::kResamplerHigh);
+		delete s;
+
+		// Converters sharing a cached bank give the same output as one with its own
+		for (int i = 0; i < 2; ++i) {
+			s = createSineStream<int16>(22050, 1, 0, false, true);
+			int16 *cached = convert(s, 22050, 44100, true, false, frames, writtenCached, Audio::kResamplerHigh, &cache);
+			delete s;
+
+			TS_ASSERT_EQUALS(written, writtenCached);
+			TS_ASSERT_EQUALS(memcmp(out, cached, frames * 2 * sizeof(int16)), 0);
+			delete[] cached;
+		}
+		delete[] out;
+	}
+
+	void test_fir_converter_high_rates() {
+		// Rates beyond the limits of the fixed point converters
+		checkFIRConstant(44100, 192000, true, Audio::kResamplerMedium);
+		checkFIRConstant(176400, 44100, false, Audio::kResamplerHigh);
+	}
+};
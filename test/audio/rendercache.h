@@ -0,0 +1,237 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/mididrv.h"
+#include "audio/softsynth/rendercache.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/memstream.h"
+
+class RenderCacheTestSuite : public CxxTest::TestSuite
+{
+private:
+	typedef Common::HashMap<Common::String, Common::Array<byte> > Files;
+
+	static const int kTicks = 16;
+	static const int kFrames = 10;
+
+	// Keeps the files in memory
+	class WriteStream : public Common::WriteStream {
+	public:
+		WriteStream(Common::Array<byte> &data) : _data(data) { _data.clear(); }
+
+		uint32 write(const void *dataPtr, uint32 dataSize) {
+			for (uint32 i = 0; i < dataSize; ++i)
+				_data.push_back(((const byte *)dataPtr)[i]);
+			return dataSize;
+		}
+		int32 pos() const { return _data.size(); }
+
+	private:
+		Common::Array<byte> &_data;
+	};
+
+	class Cache : public MidiRenderCache {
+	public:
+		Cache(MidiDriver_BASE *driver, Files &files) : MidiRenderCache(driver, Common::FSNode(), "test", 2), _files(files) {}
+
+	protected:
+		Common::SeekableReadStream *openForReading(const Common::String &name) {
+			if (!_files.contains(name))
+				return 0;
+			const Common::Array<byte> &data = _files[name];
+			byte *copy = (byte *)malloc(data.size());
+			memcpy(copy, &data[0], data.size());
+			return new Common::MemoryReadStream(copy, data.size(), DisposeAfterUse::YES);
+		}
+
+		Common::WriteStream *openForWriting(const Common::String &name) {
+			return new WriteStream(_files[name]);
+		}
+
+	private:
+		Files &_files;
+	};
+
+	// Its output only depends on the notes held, the program and the volume,
+	// which a real synthesizer would take much longer to work out
+	class Synth : public MidiDriver_BASE {
+	public:
+		Synth() : cache(0), rendered(0), noteOns(0), program(0), volume(100) {
+			memset(notes, 0, sizeof(notes));
+		}
+
+		void send(uint32 b) {
+			if (cache && cache->send(b))
+				return;
+
+			const byte note = (b >> 8) & 0x7F;
+			switch (b & 0xF0) {
+			case 0x80:
+				notes[note] = false;
+				break;
+			case 0x90:
+				notes[note] = ((b >> 16) & 0x7F) != 0;
+				noteOns += notes[note];
+				break;
+			case 0xB0:
+				volume = (b >> 16) & 0x7F;
+				break;
+			case 0xC0:
+				program = note;
+				break;
+			}
+		}
+
+		void generate(int16 *buf, int len) {
+			int16 sample = 0;
+			for (int i = 0; i < 128; ++i)
+				sample += notes[i] ? i * volume : 0;
+			sample += program;
+
+			for (int i = 0; i < len; ++i) {
+				buf[i * 2] = sample + i;
+				buf[i * 2 + 1] = -sample;
+			}
+			rendered += len;
+		}
+
+		MidiRenderCache *cache;
+		int rendered;
+		int noteOns;
+		bool notes[128];
+		byte program;
+		byte volume;
+	};
+
+	// Plays a looping song like MidiDriver_Emulated does, optionally with a
+	// volume change the song itself does not contain
+	void play(MidiRenderCache *cache, Synth &synth, int passes, Common::Array<int16> &output, int changePass = -1, bool jobs = true) {
+		synth.cache = cache;
+		for (int pass = 0; pass < passes; ++pass) {
+			for (int tick = 0; tick < kTicks; ++tick) {
+				// The jobs are done right away, like the timer would in time
+				if (tick == 0 && pass > 0 && cache) {
+					cache->loop();
+					if (jobs)
+						cache->runJobs();
+				}
+
+				if (tick == 0)
+					synth.send(0xC0 | (5 << 8));
+				if (tick == 2)
+					synth.send(0x90 | (60 << 8) | (100 << 16));
+				if (tick == 6) {
+					synth.send(0x80 | (60 << 8));
+					synth.send(0x90 | (64 << 8) | (90 << 16));
+				}
+				if (tick == 12)
+					synth.send(0x90 | (64 << 8));
+				if (pass == changePass && tick == 8)
+					synth.send(0xB0 | (7 << 8) | (50 << 16));
+
+				if (cache)
+					cache->tick();
+
+				int16 buf[kFrames * 2];
+				if (!cache || !cache->replay(buf, kFrames)) {
+					synth.generate(buf, kFrames);
+					if (cache)
+						cache->record(buf, kFrames);
+				}
+				for (int i = 0; i < kFrames * 2; ++i)
+					output.push_back(buf[i]);
+			}
+		}
+		synth.cache = 0;
+	}
+
+	static bool equal(const Common::Array<int16> &a, const Common::Array<int16> &b) {
+		return a.size() == b.size() && !memcmp(&a[0], &b[0], a.size() * sizeof(int16));
+	}
+
+public:
+	void test_replay() {
+		Common::Array<int16> reference;
+		Synth referenceSynth;
+		play(0, referenceSynth, 5, reference);
+
+		// The first pass identifies the song and the second one is stored
+		Files files;
+		Common::Array<int16> output;
+		Synth synth;
+		Cache cache(&synth, files);
+		play(&cache, synth, 5, output);
+		TS_ASSERT(cache.isReplaying());
+		TS_ASSERT_EQUALS(synth.rendered, 2 * kTicks * kFrames);
+		TS_ASSERT_EQUALS(files.size(), 2u);
+		TS_ASSERT(equal(output, reference));
+
+		// A later session only needs the first pass
+		Common::Array<int16> later;
+		Synth laterSynth;
+		Cache laterCache(&laterSynth, files);
+		play(&laterCache, laterSynth, 5, later);
+		TS_ASSERT_EQUALS(laterSynth.rendered, kTicks * kFrames);
+		TS_ASSERT(equal(later, reference));
+	}
+
+	void test_resume() {
+		Common::Array<int16> reference;
+		Synth referenceSynth;
+		play(0, referenceSynth, 7, reference, 3);
+
+		Files files;
+		Common::Array<int16> output;
+		Synth synth;
+		Cache cache(&synth, files);
+		play(&cache, synth, 7, output, 3);
+
+		// The change switches back to synthesizing halfway through the fourth
+		// pass, and the note held then is started again. The fifth pass only
+		// identifies the song again, and as the volume at its end differs
+		// from before the sixth pass is stored separately.
+		TS_ASSERT(cache.isReplaying());
+		TS_ASSERT_EQUALS(synth.rendered, (2 * kTicks + (kTicks - 8) + 2 * kTicks) * kFrames);
+		TS_ASSERT_EQUALS(synth.noteOns, 2 * 2 + 1 + 2 * 2);
+		TS_ASSERT_EQUALS(files.size(), 4u);
+		TS_ASSERT(equal(output, reference));
+	}
+
+	void test_incomplete() {
+		Files files;
+		Common::Array<int16> output;
+		Synth synth;
+		Cache cache(&synth, files);
+		play(&cache, synth, 3, output);
+
+		// Without its events the stored output is not used
+		for (Files::iterator i = files.begin(); i != files.end(); ++i) {
+			if (i->_key.hasSuffix(".evt"))
+				i->_value.resize(10);
+		}
+
+		Common::Array<int16> later;
+		Synth laterSynth;
+		Cache laterCache(&laterSynth, files);
+		play(&laterCache, laterSynth, 3, later);
+		TS_ASSERT_EQUALS(laterSynth.rendered, 2 * kTicks * kFrames);
+		TS_ASSERT(equal(later, output));
+	}
+
+	void test_no_jobs() {
+		Common::Array<int16> reference;
+		Synth referenceSynth;
+		play(0, referenceSynth, 5, reference);
+
+		// Without the jobs the song is synthesized all along
+		Files files;
+		Common::Array<int16> output;
+		Synth synth;
+		Cache cache(&synth, files);
+		play(&cache, synth, 5, output, -1, false);
+		TS_ASSERT(!cache.isReplaying());
+		TS_ASSERT_EQUALS(synth.rendered, 5 * kTicks * kFrames);
+		TS_ASSERT_EQUALS(files.size(), 0u);
+		TS_ASSERT(equal(output, reference));
+	}
+};
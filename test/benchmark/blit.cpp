@@ -0,0 +1,90 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Benchmark for TransparentSurface::blit. Build and run it with
+// 'make benchmark'.
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_printf
+
+#include "graphics/transparent_surface.h"
+#include "common/cpudetect.h"
+
+#include <time.h>
+#include <stdio.h>
+
+static const int kIterations = 200;
+
+static void fill(Graphics::Surface &surf, uint32 seed) {
+	for (int y = 0; y < surf.h; ++y) {
+		uint32 *p = (uint32 *)surf.getBasePtr(0, y);
+		for (int x = 0; x < surf.w; ++x) {
+			seed = seed * 1103515245 + 12345;
+			p[x] = seed;
+		}
+	}
+}
+
+static double run(Graphics::TransparentSurface &src, Graphics::Surface &dst, int flipping, uint color) {
+	const clock_t start = clock();
+	for (int i = 0; i < kIterations; ++i)
+		src.blit(dst, 0, 0, flipping, nullptr, color);
+	return (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC / kIterations;
+}
+
+int main(int argc, char *argv[]) {
+	static const struct {
+		Graphics::AlphaType type;
+		uint32 color;
+		const char *name;
+	} modes[] = {
+		{ Graphics::ALPHA_OPAQUE, (uint32)TS_ARGB(255, 255, 255, 255), "opaque" },
+		{ Graphics::ALPHA_BINARY, (uint32)TS_ARGB(255, 255, 255, 255), "binary" },
+		{ Graphics::ALPHA_FULL,   (uint32)TS_ARGB(255, 255, 255, 255), "full" },
+		{ Graphics::ALPHA_FULL,   (uint32)TS_ARGB(160, 255, 128, 64),  "full, colour modulated" }
+	};
+
+	Graphics::TransparentSurface src;
+	src.create(640, 480, Graphics::TransparentSurface::getSupportedPixelFormat());
+	fill(src, 1);
+
+	Graphics::Surface dst;
+	dst.create(640, 480, Graphics::TransparentSurface::getSupportedPixelFormat());
+
+	printf("%-24s %12s %12s\n", "mode (640x480)", "scalar ms", "SIMD ms");
+	for (int i = 0; i < ARRAYSIZE(modes); ++i) {
+		src.setAlphaMode(modes[i].type);
+
+		double time[2];
+		for (int simd = 0; simd < 2; ++simd) {
+			Common::setCPUFeatureMask(simd ? 0xFFFFFFFF : 0);
+			fill(dst, 2);
+			time[simd] = run(src, dst, Graphics::FLIP_NONE, modes[i].color);
+		}
+
+		printf("%-24s %12.3f %12.3f\n", modes[i].name, time[0], time[1]);
+	}
+
+	src.free();
+	dst.free();
+	return 0;
+}
@@ -0,0 +1,117 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Benchmark for Common::HashMap. Build and run it with 'make benchmark'.
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_printf
+
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/array.h"
+
+#include <time.h>
+#include <stdio.h>
+
+static const int kIntKeys = 200000;
+static const int kStringKeys = 50000;
+static const int kIterations = 5;
+
+static clock_t g_start;
+
+static void start() {
+	g_start = clock();
+}
+
+static void report(const char *type, const char *name, int ops) {
+	const double ms = (double)(clock() - g_start) * 1000.0 / CLOCKS_PER_SEC;
+	printf("%-6s %-20s %10.3f ms %10.1f ns/op\n", type, name, ms, ms * 1000000.0 / ops);
+}
+
+template<class Key, class HM>
+static void run(const char *type, const Common::Array<Key> &keys, const Common::Array<Key> &missing) {
+	const int count = keys.size();
+	uint sum = 0;
+
+	HM h;
+	start();
+	for (int n = 0; n < kIterations; ++n) {
+		h.clear();
+		for (int i = 0; i < count; ++i)
+			h[keys[i]] = i;
+	}
+	report(type, "insert", count * kIterations);
+
+	start();
+	for (int n = 0; n < kIterations; ++n) {
+		for (int i = 0; i < count; ++i)
+			sum += h.getVal(keys[i], 0);
+	}
+	report(type, "lookup (hit)", count * kIterations);
+
+	start();
+	for (int n = 0; n < kIterations; ++n) {
+		for (int i = 0; i < count; ++i)
+			sum += h.contains(missing[i]);
+	}
+	report(type, "lookup (miss)", count * kIterations);
+
+	start();
+	for (int n = 0; n < kIterations; ++n) {
+		for (typename HM::const_iterator i = h.begin(); i != h.end(); ++i)
+			sum += i->_value;
+	}
+	report(type, "iterate", count * kIterations);
+
+	start();
+	for (int n = 0; n < kIterations; ++n) {
+		for (int i = 0; i < count; i += 2)
+			h.erase(keys[i]);
+		for (int i = 0; i < count; i += 2)
+			h[keys[i]] = i;
+	}
+	report(type, "erase + reinsert", count * kIterations);
+
+	// Keep the compiler from optimizing the lookups away
+	if (sum == 0xFFFFFFFF)
+		printf("\n");
+}
+
+int main(int argc, char *argv[]) {
+	Common::Array<int> intKeys, intMissing;
+	uint32 seed = 1;
+	for (int i = 0; i < kIntKeys; ++i) {
+		seed = seed * 1103515245 + 12345;
+		intKeys.push_back((int)(seed & 0x7FFFFFF0));
+		intMissing.push_back((int)(seed & 0x7FFFFFF0) + 1);
+	}
+
+	Common::Array<Common::String> stringKeys, stringMissing;
+	for (int i = 0; i < kStringKeys; ++i) {
+		stringKeys.push_back(Common::String::format("resource.%d.selector_%d", i % 1000, i));
+		stringMissing.push_back(Common::String::format("resource.%d.missing_%d", i % 1000, i));
+	}
+
+	run<int, Common::HashMap<int, int> >("int", intKeys, intMissing);
+	run<Common::String, Common::HashMap<Common::String, int> >("string", stringKeys, stringMissing);
+	return 0;
+}
@@ -0,0 +1,140 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Benchmark comparing the 16 bit mixing path of MixerImpl with the 32 bit
+// mixing bus used with headroom_mixing, for CPU time and for how far the
+// output is from the exact sum of the channels. Build and run it with
+// 'make benchmark'.
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_printf
+
+#include "audio/rate_mix.h"
+#include "common/util.h"
+
+#include <math.h>
+#include <time.h>
+#include <stdio.h>
+
+static const int kFrames = 1024;
+static const int kBlocks = 2000;
+static const int kMaxChannels = 16;
+
+// Each channel plays a sine wave, at an amplitude where four or more
+// channels together can exceed full scale
+static void makeChannels(int16 in[kMaxChannels][kFrames * 2]) {
+	for (int c = 0; c < kMaxChannels; ++c) {
+		for (int i = 0; i < kFrames; ++i) {
+			const double phase = 2.0 * M_PI * (110.0 * (c + 1)) * i / 44100.0;
+			in[c][2 * i] = (int16)(12000.0 * sin(phase));
+			in[c][2 * i + 1] = (int16)(12000.0 * cos(phase));
+		}
+	}
+}
+
+static void mix16(int16 *out, int16 in[kMaxChannels][kFrames * 2], int channels, Audio::RateMixProc mix) {
+	memset(out, 0, kFrames * 2 * sizeof(int16));
+	for (int c = 0; c < channels; ++c)
+		mix(out, in[c], kFrames, 200, 200);
+}
+
+static void mixBus(int16 *out, int32 *bus, int16 *channelBuffer, int16 in[kMaxChannels][kFrames * 2], int channels, const Audio::RateMixProcs &procs, Audio::RateMixProc mix) {
+	memset(bus, 0, kFrames * 2 * sizeof(int32));
+	for (int c = 0; c < channels; ++c) {
+		memset(channelBuffer, 0, kFrames * 2 * sizeof(int16));
+		mix(channelBuffer, in[c], kFrames, 200, 200);
+		procs.busAccumulate(bus, channelBuffer, kFrames * 2);
+	}
+	procs.busLimit(out, bus, kFrames * 2);
+}
+
+// Print how many samples differ from the exact sum, the RMS of the
+// difference, and the RMS of its first derivative, in dB relative to full
+// scale. The latter is a crude measure of the high frequency distortion
+// which makes hard clipping sound harsh.
+static void printError(const int16 *out, const int32 *exact) {
+	int changed = 0;
+	double error = 0, slopeError = 0;
+	for (int i = 0; i < kFrames * 2; ++i) {
+		const double diff = out[i] - exact[i];
+		if (diff != 0)
+			changed++;
+		error += diff * diff;
+
+		if (i >= 2) {
+			const double slope = diff - (out[i - 2] - exact[i - 2]);
+			slopeError += slope * slope;
+		}
+	}
+
+	printf(" %9.1f%%", changed * 100.0 / (kFrames * 2));
+	if (changed) {
+		printf(" %7.1f dB %7.1f dB", 20.0 * log10(sqrt(error / (kFrames * 2)) / 32768.0),
+		       20.0 * log10(sqrt(slopeError / (kFrames * 2 - 2)) / 32768.0));
+	} else {
+		printf(" %10s %10s", "", "");
+	}
+}
+
+int main(int argc, char *argv[]) {
+	static int16 in[kMaxChannels][kFrames * 2];
+	static int16 out[kFrames * 2];
+	static int16 channelBuffer[kFrames * 2];
+	static int32 bus[kFrames * 2];
+	static int32 exact[kFrames * 2];
+
+	makeChannels(in);
+
+	const Audio::RateMixProcs &procs = Audio::getRateMixProcs();
+	const Audio::RateMixProc mix = procs.stereo;
+	const double seconds = (double)kBlocks * kFrames / 44100.0;
+
+	// CPU time per second of audio, and the difference to the exact sum
+	printf("%-8s %9s %9s  %-32s %-32s\n", "", "16 bit", "32 bit", "16 bit difference", "32 bit difference");
+	printf("%-8s %9s %9s  %-32s %-32s\n", "channels", "ms/s", "ms/s", "   changed        RMS   slope", "   changed        RMS   slope");
+	for (int channels = 1; channels <= kMaxChannels; channels *= 2) {
+		clock_t start = clock();
+		for (int b = 0; b < kBlocks; ++b)
+			mix16(out, in, channels, mix);
+		const double time16 = (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC / seconds;
+
+		start = clock();
+		for (int b = 0; b < kBlocks; ++b)
+			mixBus(out, bus, channelBuffer, in, channels, procs, mix);
+		const double time32 = (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC / seconds;
+
+		for (int i = 0; i < kFrames * 2; ++i) {
+			exact[i] = 0;
+			for (int c = 0; c < channels; ++c)
+				exact[i] += (in[c][i] * 200) / Audio::Mixer::kMaxMixerVolume;
+		}
+
+		printf("%-8d %9.3f %9.3f ", channels, time16, time32);
+		mix16(out, in, channels, mix);
+		printError(out, exact);
+		mixBus(out, bus, channelBuffer, in, channels, procs, mix);
+		printError(out, exact);
+		printf("\n");
+	}
+
+	return 0;
+}
@@ -0,0 +1,300 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Benchmark rendering MIDI and SysEx streams through the MT-32 emulator, the
+// way MidiDriver_MT32 does it. It needs the control and PCM ROMs, which are
+// not part of ScummVM:
+//
+//   test/benchmark/mt32 CONTROL.ROM PCM.ROM [capture.mid...]
+//
+// Without captures it plays a generated song keeping all 32 partials busy,
+// setting up the synthesizer with SysEx messages first, or it plays the
+// Standard MIDI Files given, including the SysEx events in them. The hash of
+// the output allows checking changes to the emulator keep it bit-identical.
+// Build and run it with 'make benchmark'; without ROMs it does nothing.
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_printf
+#define FORBIDDEN_SYMBOL_EXCEPTION_FILE
+#define FORBIDDEN_SYMBOL_EXCEPTION_fopen
+#define FORBIDDEN_SYMBOL_EXCEPTION_fread
+#define FORBIDDEN_SYMBOL_EXCEPTION_fclose
+
+#include "common/scummsys.h"
+
+#ifdef USE_MT32EMU
+
+#include "audio/mididrv.h"
+#include "audio/midiparser.h"
+#include "common/array.h"
+#include "common/util.h"
+
+// prevents load of unused FileStream API because it includes a standard library
+// include, per _sev
+#define MT32EMU_FILE_STREAM_H
+
+#include "audio/softsynth/mt32/c_interface/cpp_interface.h"
+
+#include <time.h>
+#include <stdio.h>
+
+// MidiDriver_MT32 renders the events of every timer tick separately
+static const int kTicksPerSecond = 250;
+
+struct Event {
+	uint32 tick;
+	uint32 msg;		// The packed event, 0xF0 for SysEx
+	uint32 sysExOffset;	// The offset of the SysEx data, with F0 and F7, in sysExData
+	uint32 sysExLength;
+};
+
+struct EventStream : public MidiDriver_BASE {
+	Common::Array<Event> events;
+	Common::Array<byte> sysExData;
+	uint32 tick;
+
+	EventStream() : tick(0) {}
+
+	void send(uint32 b) {
+		Event e = { tick, b, 0, 0 };
+		events.push_back(e);
+	}
+
+	void sysEx(const byte *msg, uint16 length) {
+		Event e = { tick, 0xF0, sysExData.size(), (uint32)length + 2 };
+		events.push_back(e);
+		sysExData.push_back(0xF0);
+		for (uint16 i = 0; i < length; ++i)
+			sysExData.push_back(msg[i]);
+		sysExData.push_back(0xF7);
+	}
+
+	// Writes data to the MT-32 memory, without the F0 and F7 sysEx() adds
+	void write(uint32 address, const byte *data, int length) {
+		byte msg[32] = { 0x41, 0x10, 0x16, 0x12, (byte)(address >> 16), (byte)(address >> 8), (byte)address };
+		byte checksum = msg[4] + msg[5] + msg[6];
+		for (int i = 0; i < length; ++i) {
+			msg[7 + i] = data[i];
+			checksum += data[i];
+		}
+		msg[7 + length] = (128 - (checksum & 0x7F)) & 0x7F;
+		sysEx(msg, 8 + length);
+	}
+};
+
+// Generates a song of a few minutes for the eight melodic parts and the
+// rhythm part, with chords and overlapping notes using all partials
+static void generateStream(EventStream &stream) {
+	uint32 seed = 0x5eed;
+
+	// Hall reverb, all partials reserved for the melodic parts
+	static const byte kReverb[] = { 1, 5, 4 };
+	static const byte kReserve[] = { 4, 4, 4, 4, 4, 4, 4, 4, 0 };
+	stream.write(0x100001, kReverb, sizeof(kReverb));
+	stream.write(0x100004, kReserve, sizeof(kReserve));
+
+	byte notes[9][4];
+	memset(notes, 0, sizeof(notes));
+	for (int step = 0; step < 180 * 8; ++step) {
+		stream.tick = step * kTicksPerSecond / 8;
+		for (int part = 0; part < 9; ++part) {
+			const byte channel = part + 1;
+			seed = seed * 1103515245 + 12345;
+			const uint32 r = seed >> 8;
+			if ((r & 3) != 0 && step % 8 != 0)
+				continue;
+
+			// Release the chord, pick a timbre every few bars, also through
+			// the patch temporary area, and play a new chord
+			for (int i = 0; i < 4; ++i) {
+				if (notes[part][i])
+					stream.send(0x80 | channel | (notes[part][i] << 8));
+				notes[part][i] = 0;
+			}
+			if (part < 8 && step % 64 == 0) {
+				if (step % 128 == 0) {
+					const byte patch[] = { (byte)((r >> 4) & 1), (byte)((r >> 5) & 63) };
+					stream.write(0x030000 + (part << 4), patch, sizeof(patch));
+				} else {
+					stream.send(0xC0 | channel | (((r >> 4) & 127) << 8));
+				}
+			}
+			if (part < 8 && step % 16 == 0)
+				stream.send(0xE0 | channel | (((r >> 12) & 127) << 16));
+
+			const byte velocity = 64 + ((r >> 16) & 63);
+			const int chord = part < 8 ? 1 + (r >> 4) % 3 : 1 + (r >> 4) % 2;
+			for (int i = 0; i < chord; ++i) {
+				notes[part][i] = part < 8 ? 36 + ((r >> (8 + i * 3)) % 48) : 35 + ((r >> (8 + i * 5)) % 47);
+				stream.send(0x90 | channel | (notes[part][i] << 8) | (velocity << 16));
+			}
+		}
+	}
+
+	stream.tick += kTicksPerSecond;
+	for (int part = 0; part < 9; ++part)
+		stream.send(0xB0 | (part + 1) | (0x7B << 8));
+}
+
+// Plays a Standard MIDI File with MidiParser_SMF, like the engines do
+static bool loadStream(EventStream &stream, const char *filename) {
+	FILE *file = fopen(filename, "rb");
+	if (!file)
+		return false;
+
+	Common::Array<byte> data;
+	byte buffer[4096];
+	size_t read;
+	while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		for (size_t i = 0; i < read; ++i)
+			data.push_back(buffer[i]);
+	fclose(file);
+
+	MidiParser *parser = MidiParser::createParser_SMF();
+	parser->setMidiDriver(&stream);
+	parser->setTimerRate(1000000 / kTicksPerSecond);
+	if (data.empty() || !parser->loadMusic(&data[0], data.size())) {
+		delete parser;
+		return false;
+	}
+
+	// At most ten minutes
+	for (stream.tick = 0; stream.tick < 600 * kTicksPerSecond && parser->isPlaying(); ++stream.tick)
+		parser->onTimer();
+	parser->unloadMusic();
+	delete parser;
+	return true;
+}
+
+static bool loadROM(Common::Array<byte> &rom, const char *filename) {
+	FILE *file = fopen(filename, "rb");
+	if (!file)
+		return false;
+
+	byte buffer[4096];
+	size_t read;
+	while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		for (size_t i = 0; i < read; ++i)
+			rom.push_back(buffer[i]);
+	fclose(file);
+	return !rom.empty();
+}
+
+static bool benchmark(const char *name, const EventStream &stream, const Common::Array<byte> &controlROM, const Common::Array<byte> &pcmROM) {
+	MT32Emu::Service service;
+	service.createContext();
+	if (service.addROMData(&controlROM[0], controlROM.size()) != MT32EMU_RC_ADDED_CONTROL_ROM ||
+	    service.addROMData(&pcmROM[0], pcmROM.size()) != MT32EMU_RC_ADDED_PCM_ROM ||
+	    service.openSynth() != MT32EMU_RC_OK) {
+		printf("%s: the ROMs are not supported\n", name);
+		return false;
+	}
+
+	const uint32 rate = service.getActualStereoOutputSamplerate();
+	const uint32 partialCount = service.getPartialCount();
+	const uint32 ticks = stream.events.empty() ? 0 : stream.events.back().tick + 1;
+	uint32 rendered = 0;
+	uint32 busiest = 0;
+	uint32 hash = 2166136261u;
+	int16 buffer[2 * 1024];
+	byte states[(32 + 3) / 4];
+
+	uint event = 0;
+	clock_t spent = 0;
+	for (uint32 tick = 0; tick < ticks; ++tick) {
+		clock_t start = clock();
+		for (; event < stream.events.size() && stream.events[event].tick == tick; ++event) {
+			const Event &e = stream.events[event];
+			if (e.msg == 0xF0)
+				service.playSysex(&stream.sysExData[e.sysExOffset], e.sysExLength);
+			else
+				service.playMsg(e.msg);
+		}
+		const uint32 frames = (uint64)(tick + 1) * rate / kTicksPerSecond - rendered;
+		service.renderBit16s(buffer, frames);
+		rendered += frames;
+		spent += clock() - start;
+
+		for (uint32 i = 0; i < frames * 2; ++i)
+			hash = (hash ^ (uint16)buffer[i]) * 16777619u;
+
+		if (partialCount <= 32) {
+			service.getPartialStates(states);
+			uint32 busy = 0;
+			for (uint32 i = 0; i < partialCount; ++i)
+				busy += ((states[i / 4] >> ((i % 4) * 2)) & 3) != 0;
+			busiest = MAX(busiest, busy);
+		}
+	}
+	service.closeSynth();
+	service.freeContext();
+
+	const double seconds = (double)rendered / rate;
+	const double elapsed = (double)spent / CLOCKS_PER_SEC;
+	printf("%-24s %8.1f %10.3f %9.1fx %8u %08x\n", name, seconds,
+	       elapsed * 1000.0 / seconds, elapsed > 0 ? seconds / elapsed : 0.0, busiest, hash);
+	return true;
+}
+
+int main(int argc, char *argv[]) {
+	if (argc < 3) {
+		printf("Usage: %s CONTROL.ROM PCM.ROM [capture.mid...]\n", argv[0]);
+		return 0;
+	}
+
+	Common::Array<byte> controlROM, pcmROM;
+	if (!loadROM(controlROM, argv[1]) || !loadROM(pcmROM, argv[2])) {
+		printf("Could not read the ROMs\n");
+		return 1;
+	}
+
+	bool success = true;
+
+	// CPU time per second of audio, how much faster than real time the
+	// rendering is, and the most partials playing at once
+	printf("%-24s %8s %10s %10s %8s %s\n", "stream", "seconds", "ms/s", "realtime", "partials", "hash");
+	if (argc > 3) {
+		for (int i = 3; i < argc; ++i) {
+			EventStream stream;
+			if (!loadStream(stream, argv[i])) {
+				printf("%s: not a Standard MIDI File\n", argv[i]);
+				success = false;
+				continue;
+			}
+			success &= benchmark(argv[i], stream, controlROM, pcmROM);
+		}
+	} else {
+		EventStream stream;
+		generateStream(stream);
+		success &= benchmark("generated song", stream, controlROM, pcmROM);
+	}
+
+	return success ? 0 : 1;
+}
+
+#else
+
+int main(int argc, char *argv[]) {
+	return 0;
+}
+
+#endif
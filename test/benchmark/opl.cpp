@@ -0,0 +1,284 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Benchmark replaying OPL register streams through the DOSBox emulator,
+// once sample by sample and once with the vectorized block renderer, and
+// checking both give the same output. Without arguments it plays generated
+// OPL2 and dual OPL2 songs, or it plays the DOSBox raw OPL (.dro version 2)
+// captures given on the command line. Build and run it with 'make benchmark'.
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_printf
+#define FORBIDDEN_SYMBOL_EXCEPTION_FILE
+#define FORBIDDEN_SYMBOL_EXCEPTION_fopen
+#define FORBIDDEN_SYMBOL_EXCEPTION_fread
+#define FORBIDDEN_SYMBOL_EXCEPTION_fclose
+
+#include "audio/softsynth/opl/dbopl.h"
+#include "common/array.h"
+#include "common/cpudetect.h"
+#include "common/endian.h"
+
+#include <time.h>
+#include <stdio.h>
+
+#ifndef DISABLE_DOSBOX_OPL
+
+using namespace OPL::DOSBox;
+
+static const int kRate = 44100;
+
+enum StreamType {
+	kStreamOpl2,
+	kStreamDualOpl2,
+	kStreamOpl3
+};
+
+struct RegisterWrite {
+	uint32 delay;	// Milliseconds to render before the write
+	uint16 reg;
+	byte val;
+};
+
+struct RegisterStream {
+	StreamType type;
+	Common::Array<RegisterWrite> writes;
+	uint32 length;	// Milliseconds
+
+	RegisterStream() : type(kStreamOpl2), length(0) {}
+
+	void add(uint32 delay, uint16 reg, byte val) {
+		RegisterWrite w = { delay, reg, val };
+		writes.push_back(w);
+		length += delay;
+	}
+};
+
+// A few two operator instruments: 20, 40, 60, 80, E0 for both operators, then C0
+static const byte kInstruments[][11] = {
+	{ 0x01, 0x4F, 0xF1, 0x53, 0x00, 0x11, 0x00, 0xD2, 0x74, 0x00, 0x06 },	// Piano
+	{ 0x21, 0x1A, 0x72, 0x1A, 0x00, 0x21, 0x00, 0x61, 0x06, 0x00, 0x0E },	// Strings
+	{ 0xE1, 0x16, 0xF3, 0x0F, 0x01, 0x61, 0x00, 0x72, 0x0F, 0x00, 0x0A },	// Brass, with vibrato
+	{ 0x02, 0x29, 0xF5, 0x75, 0x00, 0x01, 0x00, 0xF3, 0xF6, 0x00, 0x00 },	// Bass
+	{ 0xB1, 0x1C, 0x41, 0x1F, 0x02, 0xA1, 0x00, 0x41, 0x0F, 0x01, 0x01 }	// Organ, additive
+};
+
+// Register offset of the first operator of a channel, the second one is 3 higher
+static uint16 operatorOffset(int channel) {
+	return (channel / 3) * 8 + channel % 3;
+}
+
+// Generates a song of a few minutes, changing instruments and playing notes
+// with overlapping releases on every channel, like AdLib music does
+static void generateStream(RegisterStream &stream, StreamType type) {
+	uint32 seed = 0x5eed;
+	const int chips = (type == kStreamDualOpl2) ? 2 : 1;
+
+	stream.type = type;
+	stream.add(0, 0x01, 0x20);
+	stream.add(0, 0xBD, 0xC0);
+
+	uint32 delay = 0;
+	for (int step = 0; step < 180 * 8; ++step) {
+		for (int chip = 0; chip < chips; ++chip) {
+			const uint16 bank = chip ? 0x100 : 0;
+			for (int channel = 0; channel < 9; ++channel) {
+				seed = seed * 1103515245 + 12345;
+				const uint32 r = seed >> 8;
+				if ((r & 3) != 0 && step % 8 != 0)
+					continue;
+
+				// Key off, pick an instrument every few bars and start a new note
+				stream.add(delay, bank + 0xB0 + channel, 0);
+				delay = 0;
+				if (step % 64 == 0) {
+					const byte *ins = kInstruments[(channel + step / 64 + chip) % ARRAYSIZE(kInstruments)];
+					for (int op = 0; op < 2; ++op) {
+						const uint16 reg = bank + operatorOffset(channel) + op * 3;
+						stream.add(0, reg + 0x20, ins[op * 5 + 0]);
+						stream.add(0, reg + 0x40, ins[op * 5 + 1]);
+						stream.add(0, reg + 0x60, ins[op * 5 + 2]);
+						stream.add(0, reg + 0x80, ins[op * 5 + 3]);
+						stream.add(0, reg + 0xE0, ins[op * 5 + 4]);
+					}
+					stream.add(0, bank + 0xC0 + channel, ins[10]);
+				}
+				const uint16 fnum = 0x157 + ((r >> 4) & 0xFF);
+				const byte block = 2 + ((r >> 12) % 4);
+				stream.add(0, bank + 0xA0 + channel, fnum & 0xFF);
+				stream.add(0, bank + 0xB0 + channel, 0x20 | (block << 2) | (fnum >> 8));
+			}
+		}
+		delay += 125;
+	}
+	stream.add(delay, 0xBD, 0);
+}
+
+// Loads a DOSBox raw OPL capture, only version 2 files are supported
+static bool loadStream(RegisterStream &stream, const char *filename) {
+	FILE *file = fopen(filename, "rb");
+	if (!file)
+		return false;
+
+	Common::Array<byte> data;
+	byte buffer[4096];
+	size_t read;
+	while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		for (size_t i = 0; i < read; ++i)
+			data.push_back(buffer[i]);
+	fclose(file);
+
+	if (data.size() < 26 || memcmp(&data[0], "DBRAWOPL", 8) || READ_LE_UINT16(&data[8]) != 2)
+		return false;
+
+	const uint32 pairs = READ_LE_UINT32(&data[12]);
+	const byte hardware = data[20];
+	const byte shortDelay = data[23];
+	const byte longDelay = data[24];
+	const byte codemapLength = data[25];
+	const byte *codemap = &data[26];
+	const uint32 start = 26 + codemapLength;
+	if (data.size() < start + pairs * 2)
+		return false;
+
+	stream.type = (hardware == 0) ? kStreamOpl2 : (hardware == 1 ? kStreamDualOpl2 : kStreamOpl3);
+	uint32 delay = 0;
+	for (uint32 i = 0; i < pairs; ++i) {
+		const byte code = data[start + i * 2];
+		const byte val = data[start + i * 2 + 1];
+		if (code == shortDelay) {
+			delay += val + 1;
+		} else if (code == longDelay) {
+			delay += (val + 1) << 8;
+		} else if ((code & 0x7F) < codemapLength) {
+			stream.add(delay, ((code & 0x80) ? 0x100 : 0) | codemap[code & 0x7F], val);
+			delay = 0;
+		}
+	}
+	return true;
+}
+
+// Writes a register like OPL::DOSBox::OPL::write does, which renders dual
+// OPL2 streams as one OPL3 chip with each half panned to one side
+static void writeRegister(DBOPL::Chip &chip, StreamType type, uint16 reg, byte val) {
+	if (type == kStreamDualOpl2) {
+		const byte r = reg & 0xFF;
+		if (r == 5)
+			return;
+		if (r >= 0xE0 && r <= 0xE8)
+			val &= 3;
+		if (r >= 0xC0 && r <= 0xC8)
+			val = (val & 15) | ((reg & 0x100) ? 0xA0 : 0x50);
+	}
+	chip.WriteReg(reg, val);
+}
+
+// Renders the stream to 32 bit samples and returns the CPU time it took
+static double render(const RegisterStream &stream, uint32 features, int32 *output) {
+	Common::setCPUFeatureMask(features);
+
+	DBOPL::Chip *chip = new DBOPL::Chip();
+	DBOPL::InitTables();
+	chip->Setup(kRate);
+	if (stream.type != kStreamOpl2)
+		chip->WriteReg(0x105, 1);
+
+	const clock_t start = clock();
+	uint64 time = 0;
+	uint32 rendered = 0;
+	for (uint i = 0; i < stream.writes.size(); ++i) {
+		const RegisterWrite &w = stream.writes[i];
+		time += w.delay;
+		uint32 samples = (uint32)(time * kRate / 1000) - rendered;
+		rendered += samples;
+		while (samples > 0) {
+			const uint32 block = MIN<uint32>(samples, 512);
+			if (chip->opl3Active) {
+				chip->GenerateBlock3(block, output);
+				output += block * 2;
+			} else {
+				chip->GenerateBlock2(block, output);
+				output += block;
+			}
+			samples -= block;
+		}
+		writeRegister(*chip, stream.type, w.reg, w.val);
+	}
+	const double elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	delete chip;
+	return elapsed;
+}
+
+static bool benchmark(const char *name, const RegisterStream &stream) {
+	const double seconds = stream.length / 1000.0;
+	const uint32 size = ((uint32)((uint64)stream.length * kRate / 1000) + 1) * 2;
+	int32 *reference = new int32[size];
+	int32 *output = new int32[size];
+	memset(reference, 0, size * sizeof(int32));
+	memset(output, 0, size * sizeof(int32));
+
+	const double scalar = render(stream, 0, reference);
+	const double simd = render(stream, 0xFFFFFFFF, output);
+	const bool match = memcmp(reference, output, size * sizeof(int32)) == 0;
+
+	printf("%-24s %8.1f %10.3f %10.3f %8.2fx %s\n", name, seconds,
+	       scalar * 1000.0 / seconds, simd * 1000.0 / seconds, scalar / simd, match ? "yes" : "NO");
+
+	delete[] reference;
+	delete[] output;
+	return match;
+}
+
+int main(int argc, char *argv[]) {
+	bool match = true;
+
+	// CPU time per second of audio, sample by sample and with blocks
+	printf("%-24s %8s %10s %10s %9s %s\n", "stream", "seconds", "scalar", "blocks", "speedup", "match");
+	if (argc > 1) {
+		for (int i = 1; i < argc; ++i) {
+			RegisterStream stream;
+			if (!loadStream(stream, argv[i])) {
+				printf("%s: not a DOSBox raw OPL version 2 file\n", argv[i]);
+				match = false;
+				continue;
+			}
+			match &= benchmark(argv[i], stream);
+		}
+	} else {
+		RegisterStream opl2, dualOpl2;
+		generateStream(opl2, kStreamOpl2);
+		generateStream(dualOpl2, kStreamDualOpl2);
+		match &= benchmark("generated OPL2", opl2);
+		match &= benchmark("generated dual OPL2", dualOpl2);
+	}
+
+	return match ? 0 : 1;
+}
+
+#else
+
+int main(int argc, char *argv[]) {
+	return 0;
+}
+
+#endif
@@ -0,0 +1,136 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Benchmark comparing the SIMD mixing kernels the rate converters use with
+// the scalar ones, for every channel configuration and a few block sizes,
+// and checking they give the same output. Build and run it with
+// 'make benchmark'.
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_printf
+
+#include "audio/rate_mix.h"
+#include "common/cpudetect.h"
+#include "common/util.h"
+
+#include <time.h>
+#include <stdio.h>
+
+static const int kMaxFrames = 2048;
+static const int kSamples = 64 * 1024 * 1024;
+
+struct Kernels {
+	const char *name;
+	const Audio::RateMixProcs *procs;
+};
+
+struct Layout {
+	const char *name;
+	bool stereo;
+	bool reverseStereo;
+};
+
+static const Layout kLayouts[] = {
+	{ "mono", false, false },
+	{ "stereo", true, false },
+	{ "reverse stereo", true, true }
+};
+
+static const int kBlockSizes[] = { 16, 128, 1024 };
+
+// Mixes blocks of the given size until kSamples output samples were mixed,
+// and returns the CPU time it took
+static double mix(Audio::RateMixProc proc, int16 *out, const int16 *in, int frames) {
+	const clock_t start = clock();
+	for (int done = 0; done < kSamples; done += frames * 2) {
+		// Keep the output away from clipping, like a few channels playing at once
+		if ((done / (frames * 2)) % 8 == 0)
+			memset(out, 0, kMaxFrames * 2 * sizeof(int16));
+		proc(out, in, frames, 200, 150);
+	}
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char *argv[]) {
+	static int16 in[kMaxFrames * 2];
+	static int16 reference[kMaxFrames * 2];
+	static int16 out[kMaxFrames * 2];
+
+	uint32 seed = 0x5eed;
+	for (int i = 0; i < kMaxFrames * 2; ++i) {
+		seed = seed * 1103515245 + 12345;
+		in[i] = (int16)(seed >> 16);
+	}
+
+	Kernels kernels[4];
+	int count = 0;
+#ifdef SCUMMVM_SSE2
+	if (Common::hasCPUFeature(Common::kCPUFeatureSSE2)) {
+		kernels[count].name = "SSE2";
+		kernels[count++].procs = &Audio::g_rateMixProcsSSE2;
+	}
+#endif
+#ifdef SCUMMVM_AVX2
+	if (Common::hasCPUFeature(Common::kCPUFeatureAVX2)) {
+		kernels[count].name = "AVX2";
+		kernels[count++].procs = &Audio::g_rateMixProcsAVX2;
+	}
+#endif
+#ifdef SCUMMVM_NEON
+	if (Common::hasCPUFeature(Common::kCPUFeatureNEON)) {
+		kernels[count].name = "NEON";
+		kernels[count++].procs = &Audio::g_rateMixProcsNEON;
+	}
+#endif
+
+	if (!count) {
+		printf("No SIMD mixing kernels are available\n");
+		return 0;
+	}
+
+	bool match = true;
+
+	// CPU time in ms per million output samples, for the scalar and the SIMD kernels
+	printf("%-16s %6s %-6s %10s %10s %9s %s\n", "layout", "frames", "SIMD", "scalar", "SIMD", "speedup", "match");
+	for (int l = 0; l < ARRAYSIZE(kLayouts); ++l) {
+		const Layout &layout = kLayouts[l];
+		const Audio::RateMixProc scalar = Audio::selectRateMixProc(Audio::g_rateMixProcsScalar, layout.stereo, layout.reverseStereo);
+
+		for (int b = 0; b < ARRAYSIZE(kBlockSizes); ++b) {
+			const int frames = kBlockSizes[b];
+			const double scalarTime = mix(scalar, reference, in, frames);
+
+			for (int k = 0; k < count; ++k) {
+				const Audio::RateMixProc simd = Audio::selectRateMixProc(*kernels[k].procs, layout.stereo, layout.reverseStereo);
+				const double simdTime = mix(simd, out, in, frames);
+				const bool same = memcmp(reference, out, sizeof(out)) == 0;
+				match &= same;
+
+				printf("%-16s %6d %-6s %10.3f %10.3f %8.2fx %s\n", layout.name, frames, kernels[k].name,
+				       scalarTime * 1000000.0 / kSamples * 1000.0, simdTime * 1000000.0 / kSamples * 1000.0,
+				       scalarTime / simdTime, same ? "yes" : "NO");
+			}
+		}
+	}
+
+	return match ? 0 : 1;
+}
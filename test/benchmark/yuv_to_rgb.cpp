@@ -0,0 +1,105 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Benchmark for YUVToRGBManager::convert420. Build and run it with
+// 'make benchmark'.
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_printf
+
+#include "graphics/yuv_to_rgb.h"
+#include "common/cpudetect.h"
+#include "common/util.h"
+
+#include <time.h>
+#include <stdio.h>
+
+static const int kIterations = 50;
+
+static double run(Graphics::Surface &dst, Graphics::YUVToRGBManager::LuminanceScale scale, const byte *y, const byte *u, const byte *v) {
+	// Warm up the lookup tables for this format
+	YUVToRGBMan.convert420(&dst, scale, y, u, v, dst.w, dst.h, dst.w, dst.w / 2);
+
+	const clock_t start = clock();
+	for (int i = 0; i < kIterations; ++i)
+		YUVToRGBMan.convert420(&dst, scale, y, u, v, dst.w, dst.h, dst.w, dst.w / 2);
+	return (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC / kIterations;
+}
+
+int main(int argc, char *argv[]) {
+	static const struct {
+		int width, height;
+	} sizes[] = {
+		{ 320, 240 },
+		{ 640, 480 },
+		{ 1280, 720 },
+		{ 1920, 1080 }
+	};
+
+	static const struct {
+		Graphics::PixelFormat format;
+		Graphics::YUVToRGBManager::LuminanceScale scale;
+		const char *name;
+	} formats[] = {
+		{ Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),     Graphics::YUVToRGBManager::kScaleITU,  "565, ITU" },
+		{ Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0),    Graphics::YUVToRGBManager::kScaleITU,  "8888, ITU" },
+		{ Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0),    Graphics::YUVToRGBManager::kScaleFull, "8888, full" }
+	};
+
+	printf("%-24s %12s %12s\n", "convert420", "scalar ms", "SIMD ms");
+	for (int s = 0; s < ARRAYSIZE(sizes); ++s) {
+		const int width = sizes[s].width, height = sizes[s].height;
+		byte *y = new byte[width * height];
+		byte *u = new byte[width * height / 4];
+		byte *v = new byte[width * height / 4];
+
+		uint32 seed = 1;
+		for (int i = 0; i < width * height; ++i) {
+			seed = seed * 1103515245 + 12345;
+			y[i] = seed >> 16;
+			if (i < width * height / 4) {
+				u[i] = seed >> 8;
+				v[i] = seed >> 24;
+			}
+		}
+
+		for (int f = 0; f < ARRAYSIZE(formats); ++f) {
+			Graphics::Surface dst;
+			dst.create(width, height, formats[f].format);
+
+			double time[2];
+			for (int simd = 0; simd < 2; ++simd) {
+				Common::setCPUFeatureMask(simd ? 0xFFFFFFFF : 0);
+				time[simd] = run(dst, formats[f].scale, y, u, v);
+			}
+
+			printf("%4dx%-4d %-14s %12.3f %12.3f\n", width, height, formats[f].name, time[0], time[1]);
+			dst.free();
+		}
+
+		delete[] y;
+		delete[] u;
+		delete[] v;
+	}
+
+	return 0;
+}
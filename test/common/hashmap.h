@@ -230,5 +230,123 @@ class HashMapTestSuite : public CxxTest::TestSuite
 		TS_ASSERT(found == 16+8+4);
 }
 
+	void test_many_int_keys() {
+		// Insert, look up and erase enough keys to trigger several
+		// storage expansions and long probe sequences.
+		Common::HashMap<int, int> h;
+		const int kCount = 5000;
+		for (int i = 0; i < kCount; ++i)
+			h[i * 256] = i;
+		TS_ASSERT_EQUALS(h.size(), (uint)kCount);
+
+		for (int i = 0; i < kCount; ++i) {
+			TS_ASSERT(h.contains(i * 256));
+			TS_ASSERT_EQUALS(h[i * 256], i);
+			TS_ASSERT(!h.contains(i * 256 + 1));
+		}
+
+		for (int i = 0; i < kCount; i += 2)
+			h.erase(i * 256);
+		TS_ASSERT_EQUALS(h.size(), (uint)kCount / 2);
+
+		for (int i = 0; i < kCount; ++i) {
+			TS_ASSERT_EQUALS(h.contains(i * 256), (i & 1) != 0);
+			TS_ASSERT(h.find(i * 256) == h.end() || (i & 1));
+		}
+
+		// Refill the erased buckets.
+		for (int i = 0; i < kCount; i += 2)
+			h[i * 256] = -i;
+		for (int i = 0; i < kCount; ++i)
+			TS_ASSERT_EQUALS(h[i * 256], (i & 1) ? i : -i);
+	}
+
+	void test_many_string_keys() {
+		Common::StringMap h;
+		const int kCount = 2000;
+		for (int i = 0; i < kCount; ++i)
+			h[Common::String::format("key%d", i)] = Common::String::format("val%d", i);
+		TS_ASSERT_EQUALS(h.size(), (uint)kCount);
+
+		for (int i = 0; i < kCount; i += 3)
+			h.erase(Common::String::format("key%d", i));
+
+		for (int i = 0; i < kCount; ++i) {
+			const Common::String key = Common::String::format("key%d", i);
+			if (i % 3 == 0) {
+				TS_ASSERT(!h.contains(key));
+			} else {
+				TS_ASSERT(h.contains(key));
+				TS_ASSERT_EQUALS(h[key], Common::String::format("val%d", i));
+			}
+		}
+	}
+
+	void test_erase_churn() {
+		// Repeatedly inserting and erasing keys must neither lose entries
+		// nor let the storage grow without bounds.
+		Common::HashMap<int, int> h;
+		for (int i = 0; i < 100; ++i)
+			h[i] = i;
+		for (int i = 100; i < 100000; ++i) {
+			h.erase(i - 100);
+			h[i] = i;
+		}
+		TS_ASSERT_EQUALS(h.size(), 100U);
+		for (int i = 100000 - 100; i < 100000; ++i)
+			TS_ASSERT_EQUALS(h[i], i);
+	}
+
+	void test_erase_while_iterating() {
+		Common::HashMap<int, int> h;
+		for (int i = 0; i < 1000; ++i)
+			h[i * 7] = i;
+
+		int visited = 0;
+		for (Common::HashMap<int, int>::iterator i = h.begin(); i != h.end(); ) {
+			++visited;
+			if (i->_value & 1)
+				h.erase(i++);
+			else
+				++i;
+		}
+		TS_ASSERT_EQUALS(visited, 1000);
+		TS_ASSERT_EQUALS(h.size(), 500U);
+
+		for (int i = 0; i < 1000; ++i)
+			TS_ASSERT_EQUALS(h.contains(i * 7), (i & 1) == 0);
+	}
+
+	void test_reference_stability() {
+		// References to values must stay valid while the map grows.
+		Common::HashMap<int, int> h;
+		int &first = h[42];
+		first = 1;
+		for (int i = 0; i < 1000; ++i)
+			h[i + 1000] = i;
+		TS_ASSERT_EQUALS(&first, &h[42]);
+		TS_ASSERT_EQUALS(first, 1);
+	}
+
+	void test_copy_with_erased() {
+		Common::HashMap<int, int> h;
+		for (int i = 0; i < 100; ++i)
+			h[i] = i;
+		for (int i = 0; i < 100; i += 2)
+			h.erase(i);
+
+		Common::HashMap<int, int> copy(h);
+		TS_ASSERT_EQUALS(copy.size(), 50U);
+		for (int i = 0; i < 100; ++i)
+			TS_ASSERT_EQUALS(copy.contains(i), (i & 1) != 0);
+
+		h.clear(true);
+		TS_ASSERT(h.empty());
+		for (int i = 0; i < 100; ++i)
+			h[i] = i;
+		TS_ASSERT_EQUALS(h.size(), 100U);
+		TS_ASSERT_EQUALS(h[99], 99);
+	}
+
 	// TODO: Add test cases for iterators, find, ...
 };
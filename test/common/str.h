@@ -1,6 +1,8 @@
 #include <cxxtest/TestSuite.h>
 
 #include "common/str.h"
+#include "common/str-id.h"
+#include "common/hashmap.h"
 
 class StringTestSuite : public CxxTest::TestSuite
 {
@@ -538,4 +540,93 @@ class StringTestSuite : public CxxTest::TestSuite
 		TS_ASSERT_EQUALS(s3, "TestTestTest");
 		TS_ASSERT_EQUALS(s4, "TestTestTestTestTestTestTestTestTestTestTest");
 	}
+
+	void test_heap_sharing() {
+		// Long enough to be stored on the heap for any string size
+		const char *text = "This string is far too long for the internal storage of String";
+
+		Common::String::resetAllocStats();
+		Common::String *s1 = new Common::String(text);
+		TS_ASSERT_EQUALS(Common::String::getAllocStats().allocs, 1U);
+
+		// Copies share the heap buffer ...
+		Common::String *s2 = new Common::String(*s1);
+		Common::String s3;
+		s3 = *s2;
+		TS_ASSERT_EQUALS(Common::String::getAllocStats().allocs, 1U);
+		TS_ASSERT_EQUALS(Common::String::getAllocStats().shares, 2U);
+		TS_ASSERT_EQUALS(s1->c_str(), s3.c_str());
+
+		// ... until one of them is modified
+		s3.setChar('t', 0);
+		TS_ASSERT_EQUALS(Common::String::getAllocStats().allocs, 2U);
+		TS_ASSERT_EQUALS(*s1, text);
+		TS_ASSERT_EQUALS(s3[0], 't');
+
+		// The buffer is only freed along with its last user
+		delete s1;
+		TS_ASSERT_EQUALS(Common::String::getAllocStats().frees, 0U);
+		TS_ASSERT_EQUALS(*s2, text);
+		delete s2;
+		TS_ASSERT_EQUALS(Common::String::getAllocStats().frees, 1U);
+		s3.clear();
+		TS_ASSERT_EQUALS(Common::String::getAllocStats().frees, 2U);
+	}
+
+	void test_builtin_capacity() {
+		// Strings shorter than the built-in capacity never touch the heap,
+		// the terminating zero takes the last byte
+		const uint32 capacity = SCUMMVM_STRING_SIZE - sizeof(uint32) - sizeof(char *);
+		char text[SCUMMVM_STRING_SIZE];
+		memset(text, 'a', capacity - 1);
+		text[capacity - 1] = 0;
+		const char *rest = text + capacity / 2;
+
+		Common::String::resetAllocStats();
+		Common::String s(text, capacity / 2);
+		s += rest;
+		Common::String copy(s);
+		TS_ASSERT_EQUALS(copy.size(), capacity - 1);
+		TS_ASSERT_EQUALS(copy, text);
+
+		// format() cannot tell a result filling the storage from a truncated
+		// one, so it only stays within it up to one character less
+		copy = Common::String::format("%s", text + 1);
+		TS_ASSERT_EQUALS(copy, text + 1);
+		TS_ASSERT_EQUALS(Common::String::getAllocStats().allocs, 0U);
+
+		// One more character moves the string to the heap
+		s += 'c';
+		TS_ASSERT_EQUALS(Common::String::getAllocStats().allocs, 1U);
+	}
+
+	void test_string_id() {
+		Common::StringId empty;
+		TS_ASSERT(empty.empty());
+		TS_ASSERT_EQUALS(empty, Common::StringId(""));
+		TS_ASSERT_EQUALS(empty.toString(), "");
+
+		Common::String name("sci_selector");
+		Common::StringId id1(name);
+		Common::StringId id2("sci_selector");
+		Common::StringId id3("sci_Selector");
+		TS_ASSERT(!id1.empty());
+		TS_ASSERT_EQUALS(id1, id2);
+		TS_ASSERT_DIFFERS(id1, id3);
+		TS_ASSERT_EQUALS(id1.toString(), name);
+		TS_ASSERT_EQUALS(&id1.toString(), &id2.toString());
+
+		// Interning the same string again does not add to the table
+		const uint count = Common::StringId::getInternedCount();
+		Common::StringId id4(Common::String("sci_") + "selector");
+		TS_ASSERT_EQUALS(id1, id4);
+		TS_ASSERT_EQUALS(Common::StringId::getInternedCount(), count);
+
+		Common::HashMap<Common::StringId, int> map;
+		map[id1] = 1;
+		map[id3] = 3;
+		TS_ASSERT_EQUALS(map[Common::StringId("sci_selector")], 1);
+		TS_ASSERT_EQUALS(map[Common::StringId("sci_Selector")], 3);
+		TS_ASSERT(!map.contains(empty));
+	}
 };
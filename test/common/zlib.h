@@ -0,0 +1,108 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "common/zlib.h"
+
+class ZlibTestSuite : public CxxTest::TestSuite {
+	// Creates some compressible data, large enough to span several deflate blocks
+	static byte *createData(uint32 size) {
+		static const char *const words[] = { "pathfinding ", "palette ", "room ", "actor ", "script ", "\n" };
+		byte *data = (byte *)malloc(size);
+		uint32 seed = 1;
+
+		for (uint32 i = 0; i < size; ) {
+			seed = seed * 1103515245 + 12345;
+			const char *word = words[(seed >> 16) % ARRAYSIZE(words)];
+			while (*word && i < size)
+				data[i++] = *word++;
+		}
+
+		return data;
+	}
+
+	// Compresses data into gzip data
+	static byte *compress(const byte *data, uint32 size, uint32 &compressedSize) {
+		Common::MemoryWriteStreamDynamic *output = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+		Common::WriteStream *gzip = Common::wrapCompressedWriteStream(output);
+		gzip->write(data, size);
+		gzip->finalize();
+
+		byte *compressed = output->getData();
+		compressedSize = output->size();
+		delete gzip;
+		return compressed;
+	}
+
+	static void checkSeeks(const byte *data, uint32 size, Common::SeekableReadStream *stream) {
+		TS_ASSERT(stream);
+		TS_ASSERT_EQUALS(stream->size(), (int32)size);
+
+		// Read everything sequentially first
+		byte *buffer = (byte *)malloc(size);
+		TS_ASSERT_EQUALS(stream->read(buffer, size), size);
+		TS_ASSERT(memcmp(buffer, data, size) == 0);
+		TS_ASSERT(!stream->eos());
+		stream->readByte();
+		TS_ASSERT(stream->eos());
+
+		// Then jump around, backward and forward
+		uint32 seed = 7;
+		for (int i = 0; i < 50; ++i) {
+			seed = seed * 1103515245 + 12345;
+			uint32 pos = (seed >> 8) % (size - 1000);
+
+			TS_ASSERT(stream->seek(pos));
+			TS_ASSERT_EQUALS(stream->pos(), (int32)pos);
+			TS_ASSERT_EQUALS(stream->read(buffer, 1000), 1000u);
+			TS_ASSERT(memcmp(buffer, data + pos, 1000) == 0);
+		}
+
+		TS_ASSERT(stream->seek(-10, SEEK_END));
+		TS_ASSERT_EQUALS(stream->read(buffer, 100), 10u);
+		TS_ASSERT(memcmp(buffer, data + size - 10, 10) == 0);
+		TS_ASSERT(stream->eos());
+		TS_ASSERT(!stream->err());
+
+		free(buffer);
+		delete stream;
+	}
+
+	public:
+	void test_deflate_read_stream() {
+#ifdef USE_ZLIB
+		const uint32 size = 1024 * 1024;
+		byte *data = createData(size);
+		uint32 compressedSize;
+		byte *compressed = compress(data, size, compressedSize);
+
+		// Strip the gzip header and trailer to get the raw deflate data
+		const byte *deflated = compressed + 10;
+		const uint32 deflatedSize = compressedSize - 10 - 8;
+
+		checkSeeks(data, size, Common::wrapDeflateReadStream(
+			new Common::MemoryReadStream(deflated, deflatedSize), size, 64 * 1024));
+		checkSeeks(data, size, Common::wrapDeflateReadStream(
+			new Common::MemoryReadStream(deflated, deflatedSize), size, 0));
+
+		free(compressed);
+		free(data);
+#endif
+	}
+
+	void test_gzip_read_stream() {
+#ifdef USE_ZLIB
+		const uint32 size = 1024 * 1024;
+		byte *data = createData(size);
+		uint32 compressedSize;
+		byte *compressed = compress(data, size, compressedSize);
+
+		checkSeeks(data, size, Common::wrapCompressedReadStream(
+			new Common::MemoryReadStream(compressed, compressedSize), 0, 64 * 1024));
+		checkSeeks(data, size, Common::wrapCompressedReadStream(
+			new Common::MemoryReadStream(compressed, compressedSize), 0, 0));
+
+		free(compressed);
+		free(data);
+#endif
+	}
+};
@@ -0,0 +1,219 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/scaler.h"
+#include "graphics/scaler/aspect.h"
+#include "graphics/scaler/downscaler.h"
+#include "graphics/scaler/intern.h"
+#include "common/array.h"
+#include "common/cpudetect.h"
+
+class ScalerTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kWidth = 21,
+		kHeight = 10
+	};
+
+	uint32 _seed;
+
+	uint32 nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return (_seed >> 8) ^ (_seed << 16);
+	}
+
+	/**
+	 * Source image with one extra pixel on every side, since some of
+	 * the scalers access the pixels around the scaled area.
+	 */
+	struct Image {
+		uint32 pixels[(kHeight + 2) * (kWidth + 2)];
+
+		const uint8 *src() const { return (const uint8 *)(pixels + kWidth + 2 + 1); }
+		uint32 pitch() const { return (kWidth + 2) * sizeof(uint32); }
+	};
+
+	void fillSolid(Image &image, uint32 color) {
+		for (int i = 0; i < ARRAYSIZE(image.pixels); ++i)
+			image.pixels[i] = color;
+	}
+
+	void fillRandom(Image &image) {
+		for (int i = 0; i < ARRAYSIZE(image.pixels); ++i)
+			image.pixels[i] = nextRandom() | 0xFF000000;
+	}
+
+	void checkSolid(ScalerProc *scaler, int factor, const Image &image, uint32 color) {
+		Common::Array<uint32> dst(kWidth * kHeight * factor * factor, 0);
+		scaler(image.src(), image.pitch(), (uint8 *)dst.begin(), kWidth * factor * sizeof(uint32), kWidth, kHeight);
+
+		for (uint i = 0; i < dst.size(); ++i)
+			TS_ASSERT_EQUALS(dst[i], color);
+	}
+
+	void compareSIMD(ScalerProc *scaler, const Image &image) {
+		Common::Array<uint32> dst(kWidth * kHeight * 4, 0);
+		Common::Array<uint32> ref(kWidth * kHeight * 4, 0);
+		const uint32 dstPitch = kWidth * 2 * sizeof(uint32);
+
+		Common::setCPUFeatureMask(0);
+		scaler(image.src(), image.pitch(), (uint8 *)ref.begin(), dstPitch, kWidth, kHeight);
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+		scaler(image.src(), image.pitch(), (uint8 *)dst.begin(), dstPitch, kWidth, kHeight);
+
+		for (uint i = 0; i < dst.size(); ++i)
+			TS_ASSERT_EQUALS(dst[i], ref[i]);
+	}
+
+public:
+	void setUp() {
+		_seed = 0x1234;
+		InitScalers(Graphics::createPixelFormat<8888>());
+	}
+
+	void tearDown() {
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+		InitScalers(Graphics::createPixelFormat<565>());
+	}
+
+	void test_interpolate_8888() {
+		for (int i = 0; i < 1000; ++i) {
+			const uint32 p1 = nextRandom(), p2 = nextRandom(), p3 = nextRandom();
+			const uint32 result = interpolate16_5_2_1<Graphics::ColorMasks<8888> >(p1, p2, p3);
+
+			for (int shift = 0; shift < 32; shift += 8) {
+				const uint32 c1 = (p1 >> shift) & 0xFF, c2 = (p2 >> shift) & 0xFF, c3 = (p3 >> shift) & 0xFF;
+				TS_ASSERT_EQUALS((result >> shift) & 0xFF, (c1 * 5 + c2 * 2 + c3) >> 3);
+			}
+		}
+	}
+
+	void test_solid_32bpp() {
+		const uint32 color = 0xFF336699;
+		Image image;
+		fillSolid(image, color);
+
+		checkSolid(Normal1x, 1, image, color);
+#ifdef USE_SCALERS
+		checkSolid(Normal2x, 2, image, color);
+		checkSolid(Normal3x, 3, image, color);
+		checkSolid(AdvMame2x, 2, image, color);
+		checkSolid(AdvMame3x, 3, image, color);
+		checkSolid(_2xSaI, 2, image, color);
+		checkSolid(Super2xSaI, 2, image, color);
+		checkSolid(SuperEagle, 2, image, color);
+#ifdef USE_HQ_SCALERS
+		checkSolid(HQ2x, 2, image, color);
+		checkSolid(HQ3x, 3, image, color);
+#endif
+#endif
+	}
+
+	void test_aspect_32bpp() {
+#ifdef USE_SCALERS
+		Image image;
+		fillSolid(image, 0xFF336699);
+
+		// Lines 1 to 4 of every six are interpolated
+		const int dstHeight = kHeight * 6 / 5;
+		Common::Array<uint32> dst(kWidth * dstHeight, 0);
+		Normal1xAspect(image.src(), image.pitch(), (uint8 *)dst.begin(), kWidth * sizeof(uint32), kWidth, kHeight);
+		for (uint i = 0; i < dst.size(); ++i)
+			TS_ASSERT_EQUALS(dst[i], 0xFF336699U);
+
+		// In place, from lines 0 to 9 onto lines 0 to 11. Line 2 is mixed
+		// from lines 1 and 2 with weights 3 and 5.
+		Common::Array<uint32> buf(kWidth * dstHeight, 0);
+		for (int i = 0; i < kWidth * kHeight; ++i)
+			buf[i] = i < kWidth * 2 ? 0xFF000000 : 0xFFF8F8F8;
+		TS_ASSERT_EQUALS(stretch200To240((uint8 *)buf.begin(), kWidth * sizeof(uint32), kWidth, kHeight, 0, 0, 0), dstHeight);
+		TS_ASSERT_EQUALS(buf[0], 0xFF000000U);
+		TS_ASSERT_EQUALS(buf[kWidth], 0xFF000000U);
+		TS_ASSERT_EQUALS(buf[kWidth * 2], 0xFF9B9B9BU);
+		TS_ASSERT_EQUALS(buf[kWidth * 3], 0xFFF8F8F8U);
+		TS_ASSERT_EQUALS(buf[kWidth * 11 + kWidth - 1], 0xFFF8F8F8U);
+#endif
+	}
+
+	void test_downscale_32bpp() {
+#ifdef USE_SCALERS
+		Image image;
+		for (int i = 0; i < ARRAYSIZE(image.pixels); ++i)
+			image.pixels[i] = (i & 1) ? 0xFF0040C0 : 0xFF804000;
+
+		// The pixels alternate between two colors, from one row to the next
+		// as well, since every row has an odd number of pixels
+		Common::Array<uint32> dst(kWidth * kHeight, 0);
+		DownscaleAllByHalf(image.src(), image.pitch(), (uint8 *)dst.begin(), kWidth * sizeof(uint32), kWidth - 1, kHeight);
+		TS_ASSERT_EQUALS(dst[0], 0xFF404060U);
+
+		DownscaleHorizByHalf(image.src(), image.pitch(), (uint8 *)dst.begin(), kWidth * sizeof(uint32), kWidth - 1, kHeight);
+		TS_ASSERT_EQUALS(dst[0], 0xFF404060U);
+
+		DownscaleHorizByThreeQuarters(image.src(), image.pitch(), (uint8 *)dst.begin(), kWidth * sizeof(uint32), kWidth - 1, kHeight);
+		TS_ASSERT_EQUALS(dst[0], 0xFF604030U);
+		TS_ASSERT_EQUALS(dst[1], 0xFF404060U);
+		TS_ASSERT_EQUALS(dst[2], 0xFF204090U);
+#endif
+	}
+
+	void test_hq_strips_32bpp() {
+#ifdef USE_HQ_SCALERS
+		// Wide areas are scaled in strips, which must not show at their edges
+		const int width = kHQStripWidth + 30;
+		const int height = 3;
+		const uint32 pitch = (width + 2) * sizeof(uint32);
+		Common::Array<uint32> src((width + 2) * (height + 2));
+		for (uint i = 0; i < src.size(); ++i)
+			src[i] = (nextRandom() & 0x01010101) * 0xFF | 0xFF000000;
+		const uint8 *srcPtr = (const uint8 *)(src.begin() + width + 2 + 1);
+
+		Common::Array<uint32> dst(width * height * 4, 0), ref(width * height * 4, 0);
+		const uint32 dstPitch = width * 2 * sizeof(uint32);
+		HQ2x(srcPtr, pitch, (uint8 *)dst.begin(), dstPitch, width, height);
+		for (int x = 0; x < width; x += 10)
+			HQ2x(srcPtr + x * sizeof(uint32), pitch, (uint8 *)(ref.begin() + x * 2), dstPitch, 10, height);
+
+		for (uint i = 0; i < dst.size(); ++i)
+			TS_ASSERT_EQUALS(dst[i], ref[i]);
+#endif
+	}
+
+	void test_tv2x_32bpp() {
+#ifdef USE_SCALERS
+		Image image;
+		fillSolid(image, 0xFF8040FF);
+
+		Common::Array<uint32> dst(kWidth * kHeight * 4, 0);
+		TV2x(image.src(), image.pitch(), (uint8 *)dst.begin(), kWidth * 2 * sizeof(uint32), kWidth, kHeight);
+
+		// Every second line is darkened, the alpha channel is left alone
+		TS_ASSERT_EQUALS(dst[0], 0xFF8040FFU);
+		TS_ASSERT_EQUALS(dst[kWidth * 2], 0xFF7038DFU);
+#endif
+	}
+
+	void test_simd_32bpp() {
+#ifdef USE_SCALERS
+		Image image;
+		fillRandom(image);
+
+		compareSIMD(Normal2x, image);
+		compareSIMD(TV2x, image);
+#endif
+	}
+
+	void test_yuv_32bpp() {
+#ifdef USE_HQ_SCALERS
+		Image image;
+		fillRandom(image);
+
+		const int count = ARRAYSIZE(image.pixels);
+		uint32 yuv[count];
+		convertRowToYUV32(yuv, image.pixels, count);
+
+		for (int i = 0; i < count; ++i)
+			TS_ASSERT_EQUALS(yuv[i], convertToYUV32(image.pixels[i]));
+#endif
+	}
+};
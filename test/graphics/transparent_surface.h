@@ -0,0 +1,106 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/transparent_surface.h"
+#include "graphics/transparent_surface_blit.h"
+#include "common/cpudetect.h"
+
+class TransparentSurfaceTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kWidth = 37,
+		kHeight = 5
+	};
+
+	uint32 _seed;
+
+	uint32 nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return (_seed >> 8) ^ (_seed << 16);
+	}
+
+	void fillRandom(Graphics::Surface &surf) {
+		for (int y = 0; y < surf.h; ++y) {
+			uint32 *p = (uint32 *)surf.getBasePtr(0, y);
+			for (int x = 0; x < surf.w; ++x) {
+				p[x] = nextRandom();
+
+				// Make sure the special alpha values are covered
+				const int select = nextRandom() % 4;
+				if (select == 0)
+					p[x] = TS_ARGB(0, 0, 0, 0) | (p[x] & ~TS_ARGB(255, 0, 0, 0));
+				else if (select == 1)
+					p[x] |= TS_ARGB(255, 0, 0, 0);
+			}
+		}
+	}
+
+	void compareBlit(Graphics::AlphaType alphaType, int flipping, uint color) {
+		Graphics::TransparentSurface src;
+		src.create(kWidth, kHeight, Graphics::TransparentSurface::getSupportedPixelFormat());
+		src.setAlphaMode(alphaType);
+		fillRandom(src);
+
+		Graphics::Surface background;
+		background.create(kWidth + 3, kHeight + 2, Graphics::TransparentSurface::getSupportedPixelFormat());
+		fillRandom(background);
+
+		Graphics::Surface ref;
+		ref.copyFrom(background);
+		Common::setCPUFeatureMask(0);
+		src.blit(ref, 1, 1, flipping, nullptr, color);
+
+		// Check every instruction set the CPU supports
+		static const uint32 masks[] = {
+			Common::kCPUFeatureSSE2 | Common::kCPUFeatureNEON,
+			0xFFFFFFFF
+		};
+		for (int i = 0; i < ARRAYSIZE(masks); ++i) {
+			Graphics::Surface dst;
+			dst.copyFrom(background);
+			Common::setCPUFeatureMask(masks[i]);
+			src.blit(dst, 1, 1, flipping, nullptr, color);
+
+			TS_ASSERT_EQUALS(memcmp(dst.getPixels(), ref.getPixels(), dst.pitch * dst.h), 0);
+			dst.free();
+		}
+
+		src.free();
+		background.free();
+		ref.free();
+	}
+
+public:
+	void setUp() {
+		_seed = 0x4321;
+	}
+
+	void tearDown() {
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+	}
+
+	void test_blit_opaque() {
+		compareBlit(Graphics::ALPHA_OPAQUE, Graphics::FLIP_NONE, TS_ARGB(255, 255, 255, 255));
+		compareBlit(Graphics::ALPHA_OPAQUE, Graphics::FLIP_V, TS_ARGB(255, 255, 255, 255));
+	}
+
+	void test_blit_binary() {
+		compareBlit(Graphics::ALPHA_BINARY, Graphics::FLIP_NONE, TS_ARGB(255, 255, 255, 255));
+		compareBlit(Graphics::ALPHA_BINARY, Graphics::FLIP_H, TS_ARGB(255, 255, 255, 255));
+		compareBlit(Graphics::ALPHA_BINARY, Graphics::FLIP_HV, TS_ARGB(255, 255, 255, 255));
+	}
+
+	void test_blit_full() {
+		compareBlit(Graphics::ALPHA_FULL, Graphics::FLIP_NONE, TS_ARGB(255, 255, 255, 255));
+		compareBlit(Graphics::ALPHA_FULL, Graphics::FLIP_H, TS_ARGB(255, 255, 255, 255));
+		compareBlit(Graphics::ALPHA_FULL, Graphics::FLIP_NONE, TS_ARGB(128, 255, 255, 255));
+		compareBlit(Graphics::ALPHA_FULL, Graphics::FLIP_H, TS_ARGB(200, 30, 128, 255));
+		compareBlit(Graphics::ALPHA_FULL, Graphics::FLIP_V, TS_ARGB(255, 0, 77, 1));
+	}
+
+	void test_blit_color_mod_opaque() {
+		// Colour modulation always goes through the blending kernels
+		compareBlit(Graphics::ALPHA_OPAQUE, Graphics::FLIP_NONE, TS_ARGB(255, 10, 20, 30));
+		compareBlit(Graphics::ALPHA_BINARY, Graphics::FLIP_H, TS_ARGB(99, 255, 255, 255));
+	}
+};
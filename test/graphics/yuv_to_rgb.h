@@ -0,0 +1,115 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/yuv_to_rgb.h"
+#include "common/cpudetect.h"
+
+class YUVToRGBTestSuite : public CxxTest::TestSuite
+{
+private:
+	uint32 _seed;
+
+	byte nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 16;
+	}
+
+	void convert(Graphics::Surface &dst, bool subsampled, Graphics::YUVToRGBManager::LuminanceScale scale,
+			const byte *y, const byte *u, const byte *v, int width, int height, int yPitch, int uvPitch) {
+		if (subsampled)
+			YUVToRGBMan.convert420(&dst, scale, y, u, v, width, height, yPitch, uvPitch);
+		else
+			YUVToRGBMan.convert444(&dst, scale, y, u, v, width, height, yPitch, uvPitch);
+	}
+
+	// Converts the planes with the lookup tables and with every instruction
+	// set the CPU supports, the results have to be identical
+	void compareConvert(bool subsampled, const byte *y, const byte *u, const byte *v, int width, int height, int yPitch, int uvPitch) {
+		static const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0)
+		};
+		static const Graphics::YUVToRGBManager::LuminanceScale scales[] = {
+			Graphics::YUVToRGBManager::kScaleFull,
+			Graphics::YUVToRGBManager::kScaleITU
+		};
+		static const uint32 masks[] = {
+			Common::kCPUFeatureSSE2 | Common::kCPUFeatureNEON,
+			0xFFFFFFFF
+		};
+
+		for (int f = 0; f < ARRAYSIZE(formats); ++f) {
+			for (int s = 0; s < ARRAYSIZE(scales); ++s) {
+				// Leave some room to the right to catch stray writes
+				Graphics::Surface ref;
+				ref.create(width + 5, height, formats[f]);
+				ref.w = width;
+				Common::setCPUFeatureMask(0);
+				convert(ref, subsampled, scales[s], y, u, v, width, height, yPitch, uvPitch);
+
+				for (int i = 0; i < ARRAYSIZE(masks); ++i) {
+					Graphics::Surface dst;
+					dst.create(width + 5, height, formats[f]);
+					dst.w = width;
+					Common::setCPUFeatureMask(masks[i]);
+					convert(dst, subsampled, scales[s], y, u, v, width, height, yPitch, uvPitch);
+
+					TS_ASSERT_EQUALS(memcmp(dst.getPixels(), ref.getPixels(), dst.pitch * dst.h), 0);
+					dst.free();
+				}
+
+				ref.free();
+			}
+		}
+	}
+
+public:
+	void setUp() {
+		_seed = 0x1234;
+	}
+
+	void tearDown() {
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+	}
+
+	void test_convert444() {
+		// Every combination of u and v, with random luminance
+		const int width = 258, height = 256, pitch = 260;
+		byte *y = new byte[pitch * height];
+		byte *u = new byte[pitch * height];
+		byte *v = new byte[pitch * height];
+
+		for (int i = 0; i < pitch * height; ++i) {
+			y[i] = nextRandom();
+			u[i] = i % pitch;
+			v[i] = i / pitch;
+		}
+
+		compareConvert(false, y, u, v, width, height, pitch, pitch);
+
+		delete[] y;
+		delete[] u;
+		delete[] v;
+	}
+
+	void test_convert420() {
+		const int width = 86, height = 38, yPitch = 96, uvPitch = 48;
+		byte *y = new byte[yPitch * height];
+		byte *u = new byte[uvPitch * height / 2];
+		byte *v = new byte[uvPitch * height / 2];
+
+		for (int i = 0; i < yPitch * height; ++i)
+			y[i] = nextRandom();
+		for (int i = 0; i < uvPitch * height / 2; ++i) {
+			u[i] = nextRandom();
+			v[i] = nextRandom();
+		}
+
+		compareConvert(true, y, u, v, width, height, yPitch, uvPitch);
+
+		delete[] y;
+		delete[] u;
+		delete[] v;
+	}
+};
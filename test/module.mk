@@ -5,8 +5,8 @@
 #
 ######################################################################
 
-TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h
-TEST_LIBS    := audio/libaudio.a common/libcommon.a
+TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/graphics/*.h
+TEST_LIBS    := audio/libaudio.a graphics/libgraphics.a common/libcommon.a
 
 ifeq ($(ENABLE_WINTERMUTE), STATIC_PLUGIN)
 	TESTS += $(srcdir)/test/engines/wintermute/*.h
@@ -42,8 +42,23 @@ test/runner.cpp: $(TESTS)
 	@mkdir -p test
 	$(srcdir)/test/cxxtest/cxxtestgen.py $(TEST_FLAGS) -o $@ $+
 
+# Benchmarks, not run by the 'test' target
+BENCHMARK_LIBS := audio/libaudio.a graphics/libgraphics.a common/libcommon.a
+
+BENCHMARKS   := test/benchmark/blit test/benchmark/hashmap test/benchmark/mixer_bus test/benchmark/mt32 test/benchmark/opl test/benchmark/rate_mix test/benchmark/yuv_to_rgb
+
+ifdef USE_MT32EMU
+test/benchmark/mt32: audio/softsynth/mt32/libmt32.a
+endif
+
+benchmark: $(BENCHMARKS)
+	$(foreach b,$(BENCHMARKS),./$(b) &&) true
+test/benchmark/%: $(srcdir)/test/benchmark/%.cpp $(BENCHMARK_LIBS)
+	@mkdir -p test/benchmark
+	$(QUIET_CXX)$(CXX) $(TEST_CXXFLAGS) $(CPPFLAGS) -o $@ $+ $(TEST_LDFLAGS)
+
 clean: clean-test
 clean-test:
-	-$(RM) test/runner.cpp test/runner
+	-$(RM) test/runner.cpp test/runner $(BENCHMARKS)
 
-.PHONY: test clean-test
+.PHONY: test benchmark clean-test
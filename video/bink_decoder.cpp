@@ -312,6 +312,10 @@ BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, const G
 	memset(_oldPlanes[2],   0, _uvBlockWidth * 8 * _uvBlockHeight * 8);
 	memset(_oldPlanes[3], 255, _yBlockWidth  * 8 * _yBlockHeight  * 8);
 
+	// Nothing has been converted into the surface yet
+	_dirtyBlocks = new byte[_uvBlockWidth * _uvBlockHeight];
+	memset(_dirtyBlocks, 1, _uvBlockWidth * _uvBlockHeight);
+
 	initBundles();
 	initHuffman();
 }
@@ -322,6 +326,8 @@ BinkDecoder::BinkVideoTrack::~BinkVideoTrack() {
 		delete[] _oldPlanes[i]; _oldPlanes[i] = 0;
 	}
 
+	delete[] _dirtyBlocks;
+
 	deinitBundles();
 
 	for (int i = 0; i < 16; i++) {
@@ -350,17 +356,19 @@ void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 
 		decodePlane(frame, planeIdx, i != 0);
 
-		if (frame.bits->pos() >= frame.bits->size())
+		if (frame.bits->pos() >= frame.bits->size()) {
+			// The remaining planes keep stale data, so the skip
+			// information can't be trusted for this frame
+			if (i != 2)
+				memset(_dirtyBlocks, 1, _uvBlockWidth * _uvBlockHeight);
 			break;
+		}
 	}
 
 	// Convert the YUV data we have to our format
 	// We're ignoring alpha for now
-	// The width used here is the surface-width, and not the video-width
-	// to allow for odd-sized videos.
 	assert(_curPlanes[0] && _curPlanes[1] && _curPlanes[2]);
-	YUVToRGBMan.convert420(&_surface, Graphics::YUVToRGBManager::kScaleITU, _curPlanes[0], _curPlanes[1], _curPlanes[2],
-			_surfaceWidth, _surfaceHeight, _yBlockWidth * 8, _uvBlockWidth * 8);
+	convertDirtyBlocks();
 
 	// And swap the planes with the reference planes
 	for (int i = 0; i < 4; i++)
@@ -369,6 +377,72 @@ void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 	_curFrame++;
 }
 
+void BinkDecoder::BinkVideoTrack::markDirty(const DecodeContext &ctx, bool isChroma, bool isScaled) {
+	// The alpha plane isn't part of the surface
+	if (ctx.planeIdx == 3)
+		return;
+
+	uint32 x1 = ctx.blockX, y1 = ctx.blockY;
+	uint32 x2 = x1 + (isScaled ? 1 : 0), y2 = y1 + (isScaled ? 1 : 0);
+
+	if (!isChroma) {
+		x1 >>= 1; y1 >>= 1;
+		x2 >>= 1; y2 >>= 1;
+	}
+
+	x2 = MIN(x2, _uvBlockWidth  - 1);
+	y2 = MIN(y2, _uvBlockHeight - 1);
+
+	for (uint32 y = y1; y <= y2; y++)
+		for (uint32 x = x1; x <= x2; x++)
+			_dirtyBlocks[y * _uvBlockWidth + x] = 1;
+}
+
+void BinkDecoder::BinkVideoTrack::convertDirtyBlocks() {
+	// Skipped blocks are copies of the last frame, which is already in the
+	// surface, so only runs of changed macroblocks need to be converted.
+	// All offsets are multiples of 16, so the 4:2:0 chroma sampling lines
+	// up with a full conversion and the result is identical.
+	// The width used here is the surface-width, and not the video-width
+	// to allow for odd-sized videos.
+	const uint32 yPitch  = _yBlockWidth  * 8;
+	const uint32 uvPitch = _uvBlockWidth * 8;
+
+	for (uint32 blockY = 0; blockY < _uvBlockHeight; blockY++) {
+		byte *dirty = _dirtyBlocks + blockY * _uvBlockWidth;
+
+		const int y = blockY * 16;
+		const int height = MIN<int>(16, _surfaceHeight - y);
+
+		uint32 blockX = 0;
+		while (blockX < _uvBlockWidth) {
+			if (!dirty[blockX]) {
+				blockX++;
+				continue;
+			}
+
+			uint32 runEnd = blockX + 1;
+			while (runEnd < _uvBlockWidth && dirty[runEnd])
+				runEnd++;
+
+			const int x = blockX * 16;
+			const int width = MIN<int>((runEnd - blockX) * 16, _surfaceWidth - x);
+
+			Graphics::Surface dst;
+			dst.init(width, height, _surface.pitch, _surface.getBasePtr(x, y), _surface.format);
+
+			YUVToRGBMan.convert420(&dst, Graphics::YUVToRGBManager::kScaleITU,
+					_curPlanes[0] + y * yPitch + x,
+					_curPlanes[1] + (y / 2) * uvPitch + x / 2,
+					_curPlanes[2] + (y / 2) * uvPitch + x / 2,
+					width, height, yPitch, uvPitch);
+
+			memset(dirty + blockX, 0, runEnd - blockX);
+			blockX = runEnd;
+		}
+	}
+}
+
 void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, bool isChroma) {
 	uint32 blockWidth  = isChroma ? _uvBlockWidth  : _yBlockWidth;
 	uint32 blockHeight = isChroma ? _uvBlockHeight : _yBlockHeight;
@@ -425,6 +499,9 @@ void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, b
 				continue;
 			}
 
+			if (blockType != kBlockSkip)
+				markDirty(ctx, isChroma, blockType == kBlockScaled);
+
 			switch (blockType) {
 			case kBlockSkip:
 				blockSkip(ctx);
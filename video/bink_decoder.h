@@ -262,6 +262,18 @@ private:
 		byte *_curPlanes[4]; ///< The 4 color planes, YUVA, current frame.
 		byte *_oldPlanes[4]; ///< The 4 color planes, YUVA, last frame.
 
+		/**
+		 * One flag per 16x16 macroblock (one U/V block), set when the frame
+		 * changed any Y, U or V pixel of it. Only those get converted to RGB.
+		 */
+		byte *_dirtyBlocks;
+
+		/** Mark the macroblocks covered by a decoded, non-skipped block. */
+		void markDirty(const DecodeContext &ctx, bool isChroma, bool isScaled);
+
+		/** Convert the changed parts of the YUV planes into the surface. */
+		void convertDirtyBlocks();
+
 		/** Initialize the bundles. */
 		void initBundles();
 		/** Deinitialize the bundles. */
@@ -27,12 +27,26 @@
 
 #include "common/rational.h"
 #include "common/file.h"
+#include "common/rect.h"
 #include "common/system.h"
 
 #include "graphics/palette.h"
+#include "graphics/surface.h"
 
 namespace Video {
 
+struct VideoDecoder::DecodeAheadFrame {
+	Graphics::Surface surface;
+	bool hasSurface;
+	bool dirtyPalette;
+	byte palette[3 * 256];
+
+	// The state of the track after decoding this frame
+	int curFrame;
+	uint32 nextFrameStartTime;
+	bool endOfTrack;
+};
+
 VideoDecoder::VideoDecoder() {
 	_startTime = 0;
 	_dirtyPalette = false;
@@ -49,6 +63,15 @@ VideoDecoder::VideoDecoder() {
 	_nextVideoTrack = 0;
 	_mainAudioTrack = 0;
 	_canSetDither = true;
+	_decodeAheadTrack = 0;
+	_decodeAheadFrames = 0;
+	_decodeAheadSize = 0;
+	_decodeAheadStart = 0;
+	_decodeAheadCount = 0;
+	memset(&_decodeAheadStats, 0, sizeof(_decodeAheadStats));
+	_presentedFrame = -1;
+	_presentedNextFrameStartTime = 0;
+	_presentedEndOfTrack = false;
 
 	// Find the best format for output
 	_defaultHighColorFormat = g_system->getScreenFormat();
@@ -57,10 +80,16 @@ VideoDecoder::VideoDecoder() {
 		_defaultHighColorFormat = Graphics::PixelFormat(4, 8, 8, 8, 8, 8, 16, 24, 0);
 }
 
+VideoDecoder::~VideoDecoder() {
+	freeDecodeAhead();
+}
+
 void VideoDecoder::close() {
 	if (isPlaying())
 		stop();
 
+	freeDecodeAhead();
+
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
 		delete *it;
 
@@ -185,6 +214,9 @@ const Graphics::Surface *VideoDecoder::decodeNextFrame() {
 	_needsUpdate = false;
 	_canSetDither = false;
 
+	if (_decodeAheadTrack)
+		return takeQueuedFrame();
+
 	readNextPacket();
 
 	// If we have no next video track at this point, there shouldn't be
@@ -210,6 +242,10 @@ bool VideoDecoder::setReverse(bool reverse) {
 	if (reverse && hasAudio())
 		return false;
 
+	// Frames are only decoded ahead going forward
+	if (reverse && _decodeAheadTrack)
+		return false;
+
 	// Attempt to make sure all the tracks are in the requested direction
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		if ((*it)->getTrackType() == Track::kTrackTypeVideo && ((VideoTrack *)*it)->isReversed() != reverse) {
@@ -230,6 +266,10 @@ const byte *VideoDecoder::getPalette() {
 }
 
 int VideoDecoder::getCurFrame() const {
+	// There is only one video track when decoding ahead
+	if (_decodeAheadTrack)
+		return _presentedFrame;
+
 	int32 frame = -1;
 
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
@@ -271,13 +311,19 @@ uint32 VideoDecoder::getTime() const {
 }
 
 uint32 VideoDecoder::getTimeToNextFrame() const {
-	if (endOfVideo() || _needsUpdate || !_nextVideoTrack)
+	const VideoTrack *track = _nextVideoTrack;
+
+	// When decoding ahead, _nextVideoTrack refers to the next frame to decode
+	if (_decodeAheadTrack)
+		track = _presentedEndOfTrack ? 0 : _decodeAheadTrack;
+
+	if (endOfVideo() || _needsUpdate || !track)
 		return 0;
 
 	uint32 currentTime = getTime();
-	uint32 nextFrameStartTime = _nextVideoTrack->getNextFrameStartTime();
+	uint32 nextFrameStartTime = getTrackNextFrameStartTime(track);
 
-	if (_nextVideoTrack->isReversed()) {
+	if (track->isReversed()) {
 		// For reversed videos, we need to handle the time difference the opposite way.
 		if (nextFrameStartTime >= currentTime)
 			return 0;
@@ -296,8 +342,8 @@ bool VideoDecoder::endOfVideo() const {
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		const Track *track = *it;
 
-		bool videoEndTimeReached = _endTimeSet && track->getTrackType() == Track::kTrackTypeVideo && ((const VideoTrack *)track)->getNextFrameStartTime() >= (uint)_endTime.msecs();
-		bool endReached = track->endOfTrack() || (isPlaying() && videoEndTimeReached);
+		bool videoEndTimeReached = _endTimeSet && track->getTrackType() == Track::kTrackTypeVideo && getTrackNextFrameStartTime((const VideoTrack *)track) >= (uint)_endTime.msecs();
+		bool endReached = hasTrackEnded(track) || (isPlaying() && videoEndTimeReached);
 		if (!endReached)
 			return false;
 	}
@@ -336,6 +382,7 @@ bool VideoDecoder::rewind() {
 	_startTime = g_system->getMillis();
 	resetPauseStartTime();
 	findNextVideoTrack();
+	flushDecodeAhead();
 	return true;
 }
 
@@ -378,6 +425,7 @@ bool VideoDecoder::seek(const Audio::Timestamp &time) {
 
 	resetPauseStartTime();
 	findNextVideoTrack();
+	flushDecodeAhead();
 	_needsUpdate = true;
 	return true;
 }
@@ -523,6 +571,154 @@ bool VideoDecoder::setDitheringPalette(const byte *palette) {
 	return result;
 }
 
+bool VideoDecoder::setDecodeAhead(uint frameCount) {
+	freeDecodeAhead();
+
+	if (frameCount == 0)
+		return true;
+
+	VideoTrack *track = 0;
+
+	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo) {
+			// We only allow decoding ahead when one video track
+			// is present
+			if (track)
+				return false;
+
+			track = (VideoTrack *)*it;
+		}
+	}
+
+	if (!track || track->isReversed())
+		return false;
+
+	_decodeAheadTrack = track;
+	_decodeAheadFrames = new DecodeAheadFrame[frameCount + 1];
+	_decodeAheadSize = frameCount;
+	memset(&_decodeAheadStats, 0, sizeof(_decodeAheadStats));
+	flushDecodeAhead();
+	return true;
+}
+
+void VideoDecoder::decodeAhead(uint32 maxTime) {
+	if (!_decodeAheadTrack)
+		return;
+
+	uint32 startTime = g_system->getMillis();
+
+	while (decodeFrameAhead()) {
+		if (g_system->getMillis() - startTime >= maxTime)
+			break;
+	}
+}
+
+bool VideoDecoder::decodeFrameAhead() {
+	if (_decodeAheadCount == _decodeAheadSize || _decodeAheadTrack->endOfTrack())
+		return false;
+
+	uint32 startTime = g_system->getMillis();
+
+	readNextPacket();
+	const Graphics::Surface *surface = _decodeAheadTrack->decodeNextFrame();
+
+	_decodeAheadStats.maxDecodeTime = MAX<uint32>(_decodeAheadStats.maxDecodeTime, g_system->getMillis() - startTime);
+
+	// The slot before _decodeAheadStart holds the frame being displayed, so
+	// this never overwrites it
+	DecodeAheadFrame &frame = _decodeAheadFrames[(_decodeAheadStart + _decodeAheadCount) % (_decodeAheadSize + 1)];
+
+	frame.hasSurface = (surface != 0);
+	if (surface) {
+		// Keep the copy's pixels around from frame to frame
+		if (frame.surface.w != surface->w || frame.surface.h != surface->h || frame.surface.format != surface->format) {
+			frame.surface.free();
+			frame.surface.create(surface->w, surface->h, surface->format);
+		}
+
+		frame.surface.copyRectToSurface(*surface, 0, 0, Common::Rect(surface->w, surface->h));
+	}
+
+	frame.dirtyPalette = _decodeAheadTrack->hasDirtyPalette();
+	if (frame.dirtyPalette)
+		memcpy(frame.palette, _decodeAheadTrack->getPalette(), sizeof(frame.palette));
+
+	frame.curFrame = _decodeAheadTrack->getCurFrame();
+	frame.nextFrameStartTime = _decodeAheadTrack->getNextFrameStartTime();
+	frame.endOfTrack = _decodeAheadTrack->endOfTrack();
+
+	_decodeAheadCount++;
+	findNextVideoTrack();
+	return true;
+}
+
+const Graphics::Surface *VideoDecoder::takeQueuedFrame() {
+	if (_decodeAheadCount == 0) {
+		// Nothing was decoded ahead, so the frame has to be decoded now
+		if (!decodeFrameAhead())
+			return 0;
+
+		_decodeAheadStats.underruns++;
+	}
+
+	const DecodeAheadFrame &frame = _decodeAheadFrames[_decodeAheadStart];
+	_decodeAheadStart = (_decodeAheadStart + 1) % (_decodeAheadSize + 1);
+	_decodeAheadCount--;
+	_decodeAheadStats.framesPresented++;
+
+	_presentedFrame = frame.curFrame;
+	_presentedNextFrameStartTime = frame.nextFrameStartTime;
+	_presentedEndOfTrack = frame.endOfTrack;
+
+	if (frame.dirtyPalette) {
+		memcpy(_decodeAheadPalette, frame.palette, sizeof(_decodeAheadPalette));
+		_palette = _decodeAheadPalette;
+		_dirtyPalette = true;
+	}
+
+	return frame.hasSurface ? &frame.surface : 0;
+}
+
+void VideoDecoder::flushDecodeAhead() {
+	if (!_decodeAheadTrack)
+		return;
+
+	// _decodeAheadStart is kept, so the frame being displayed stays valid
+	_decodeAheadCount = 0;
+	_presentedFrame = _decodeAheadTrack->getCurFrame();
+	_presentedNextFrameStartTime = _decodeAheadTrack->getNextFrameStartTime();
+	_presentedEndOfTrack = _decodeAheadTrack->endOfTrack();
+}
+
+void VideoDecoder::freeDecodeAhead() {
+	if (_decodeAheadFrames) {
+		for (uint i = 0; i < _decodeAheadSize + 1; i++)
+			_decodeAheadFrames[i].surface.free();
+
+		delete[] _decodeAheadFrames;
+	}
+
+	_decodeAheadTrack = 0;
+	_decodeAheadFrames = 0;
+	_decodeAheadSize = 0;
+	_decodeAheadStart = 0;
+	_decodeAheadCount = 0;
+}
+
+bool VideoDecoder::hasTrackEnded(const Track *track) const {
+	if (track == _decodeAheadTrack)
+		return _presentedEndOfTrack;
+
+	return track->endOfTrack();
+}
+
+uint32 VideoDecoder::getTrackNextFrameStartTime(const VideoTrack *track) const {
+	if (track == _decodeAheadTrack)
+		return _presentedNextFrameStartTime;
+
+	return track->getNextFrameStartTime();
+}
+
 VideoDecoder::Track::Track() {
 	_paused = false;
 }
@@ -921,8 +1117,8 @@ bool VideoDecoder::hasFramesLeft() const {
 
 		const VideoTrack *track = (const VideoTrack *)*it;
 
-		bool videoEndTimeReached = _endTimeSet && track->getNextFrameStartTime() >= (uint)_endTime.msecs();
-		bool endReached = track->endOfTrack() || (isPlaying() && videoEndTimeReached);
+		bool videoEndTimeReached = _endTimeSet && getTrackNextFrameStartTime(track) >= (uint)_endTime.msecs();
+		bool endReached = hasTrackEnded(track) || (isPlaying() && videoEndTimeReached);
 		if (!endReached)
 			return true;
 	}
@@ -52,7 +52,7 @@ namespace Video {
 class VideoDecoder {
 public:
 	VideoDecoder();
-	virtual ~VideoDecoder() {}
+	virtual ~VideoDecoder();
 
 	/////////////////////////////////////////
 	// Opening/Closing a Video
@@ -396,6 +396,60 @@ public:
 	 */
 	bool setDitheringPalette(const byte *palette);
 
+	/**
+	 * Statistics about decoding ahead.
+	 *
+	 * @see setDecodeAhead()
+	 */
+	struct DecodeAheadStats {
+		uint32 framesPresented; ///< Frames returned by decodeNextFrame()
+		uint32 underruns;       ///< Frames decodeNextFrame() had to decode itself, because none was queued
+		uint32 maxDecodeTime;   ///< The longest time decoding a single frame took, in ms
+	};
+
+	/**
+	 * Let the video decode frames before they are due.
+	 *
+	 * Decoded frames are copied, together with their palettes, into a queue
+	 * of the given length. decodeAhead() fills the queue and decodeNextFrame()
+	 * takes frames from it, so the time a frame takes to decode is spent
+	 * while the caller would otherwise be waiting. getCurFrame(),
+	 * getTimeToNextFrame(), needsUpdate() and endOfVideo() still refer to the
+	 * frames returned by decodeNextFrame(). Seeking and rewinding flush the
+	 * queue.
+	 *
+	 * This only works for videos with exactly one video track, played
+	 * forward. It should be called after loadStream(), and is reset by
+	 * close().
+	 *
+	 * @param frameCount The number of frames to queue, or 0 to stop decoding
+	 *                   ahead and drop the queued frames
+	 * @return true on success, false otherwise
+	 */
+	bool setDecodeAhead(uint frameCount);
+
+	/**
+	 * Decode frames into the queue set up by setDecodeAhead().
+	 *
+	 * This decodes at least one frame, unless the queue is full or the video
+	 * track has ended, and then keeps decoding until the given time has
+	 * passed. Call this when there is time to spare, e.g. instead of waiting
+	 * for getTimeToNextFrame() to reach zero.
+	 *
+	 * @param maxTime How long to keep decoding, in ms
+	 */
+	void decodeAhead(uint32 maxTime);
+
+	/**
+	 * Get the number of frames currently decoded ahead.
+	 */
+	uint getQueuedFrameCount() const { return _decodeAheadCount; }
+
+	/**
+	 * Get the statistics of decoding ahead since setDecodeAhead() was called.
+	 */
+	const DecodeAheadStats &getDecodeAheadStats() const { return _decodeAheadStats; }
+
 	/////////////////////////////////////////
 	// Audio Control
 	/////////////////////////////////////////
@@ -964,6 +1018,27 @@ private:
 	Audio::Mixer::SoundType _soundType;
 
 	AudioTrack *_mainAudioTrack;
+
+	// Decoding ahead, see setDecodeAhead()
+	struct DecodeAheadFrame;
+	VideoTrack *_decodeAheadTrack;
+	DecodeAheadFrame *_decodeAheadFrames; // _decodeAheadSize + 1 frames, one being displayed
+	uint _decodeAheadSize, _decodeAheadStart, _decodeAheadCount;
+	DecodeAheadStats _decodeAheadStats;
+	byte _decodeAheadPalette[3 * 256];
+
+	// The state of the video track as of the last frame returned, which
+	// lags behind the track itself when decoding ahead
+	int _presentedFrame;
+	uint32 _presentedNextFrameStartTime;
+	bool _presentedEndOfTrack;
+
+	bool decodeFrameAhead();
+	const Graphics::Surface *takeQueuedFrame();
+	void flushDecodeAhead();
+	void freeDecodeAhead();
+	bool hasTrackEnded(const Track *track) const;
+	uint32 getTrackNextFrameStartTime(const VideoTrack *track) const;
 };
 
 } // End of namespace Video